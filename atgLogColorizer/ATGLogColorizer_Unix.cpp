@@ -29,2425 +29,3485 @@
  *			-Enhanced the ability of the tool to recognize different types of messages
  *			-Fixed bug that caused a crash when printing out certain % sequence
  *			-Added ability to recognize thread dumps
+ * Version 1.3
+ *			-Moved the classifier into libatgcolorize (atgcolorize.h) so it can be embedded
+ *			 without going through a pipe. input is now read, classified and written a batch
+ *			 of lines at a time
+ *			-Added --rules to color lines with user-defined rules
+ *			-Rule files are reloaded on SIGHUP or a "reload" written to the --control fifo,
+ *			 without restarting the pipe
+ *			-Added --rules-cache to map compiled rules back in instead of compiling them every run
+ *			-Added --fold-traces to print a stack trace seen before as a one line reference
+ *			-Added --report exceptions, the most frequent exceptions of a log instead of the log
+ *			-Added --stats, line counts per hour and per category or component instead of the log
+ *			-Added --output=ndjson, the lines as JSON objects with their type and header fields
+ *			-Added --output=html, a page with the stack traces folded away under their exception
+ *			-Added --report threads, thread states, deadlocks and contended monitors of every thread dump
+ *			-Added --report stacks and --report folded, the running threads of all the thread dumps
+ *			 added up as a table of the busiest frames or as folded stacks for flamegraph.pl
+ *			-Added --report sql, the SQL statements a repository reported failing most, by shape
+ *			-ENVIRONMENT= dumps are colored however long they are. added --collapse-blocks to print
+ *			 a line saying how many entries an ENVIRONMENT, CLASSPATH or CONFIGPATH dump has instead
+ *			-Added --min-type, --only and --match to print only some of the lines, instead of piping
+ *			 through grep and losing the colors
+ *			-Added --storm to print a line counting the repeats of a line a component keeps logging
+ *			 in a loop instead of every one of them
+ *			-Added --daemon, one process coloring the logs of every app server on the box sent to
+ *			 it over a unix socket with --connect, and --daemon-stats for its throughput counters
+ *			-Added --input to color the logs of several app servers in one go, each line written
+ *			 with the name of its log in front
+ *			-Several log files or a directory are colored as one log, read through io_uring with
+ *			 reads running ahead of the coloring. added --io blocking to read them the old way
+ *			-Added --index to copy a log unchanged, spliced straight through, while writing which
+ *			 byte ranges of it are errors, warnings and so on to an index file
+ *			-Added --theme to load the colors from a theme file, 16, 256 or truecolor ones, and
+ *			 --colors to say what the terminal shows. NO_COLOR and TERM=dumb turn the colors off
+ *			-Added --latency, the percentiles of how long lines take from being read to being written,
+ *			 printed at the end or on SIGUSR1
+ *			-Added --metrics, a Prometheus metrics file written every few seconds with the lines
+ *			 colored by type, the time classifying takes and what was filtered out or collapsed
+ *			-Added static probes for bpftrace and systemtap (atgcolorize_probes.h) on lines read,
+ *			 classified and written, state changes and --daemon streams held back
+ *			-Added --stats=stages, the time spent reading, classifying, rendering and writing the
+ *			 lines and waiting for the input or the output, timed on a sample of the reads
  */
 
 #include <stdio.h>
-#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include <string>
-#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <thread>
 #include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "atgcolorize.h"
+#include "atgcolorize_ansi.h"
+#include "atgcolorize_json.h"
+#include "atgcolorize_html.h"
+#include "atgcolorize_fold.h"
+#include "atgcolorize_report.h"
+#include "atgcolorize_stats.h"
+#include "atgcolorize_threads.h"
+#include "atgcolorize_profile.h"
+#include "atgcolorize_sql.h"
+#include "atgcolorize_filter.h"
+#include "atgcolorize_storm.h"
+#include "atgcolorize_uring.h"
+#include "atgcolorize_latency.h"
+#include "atgcolorize_probes.h"
 
 using namespace std;
 
+ATGC_PROBE_SEMAPHORE(line_read);
+ATGC_PROBE_SEMAPHORE(batch_flush);
+ATGC_PROBE_SEMAPHORE(backpressure);
+
 const char NULL_CHARACTER = '\0';
 
-const string RELEASE_NUMBER="1.2"; // as in ATGLogColorizer vX.X
+const string RELEASE_NUMBER=ATGC_VERSION; // as in ATGLogColorizer vX.X
+
+// colors are looked up through atgcolorize_ansi.h. the intro and exit messages reuse the line colors
+const int INFO_COLOR = ATGC_INFO_LINE; // green
+const int WARNING_COLOR = ATGC_WARNING_LINE; // cyan
+const int DEBUG_COLOR = ATGC_DEBUG_LINE; // white
+const int ERROR_COLOR = ATGC_ERROR_LINE; // red
+const int INTRO_COLOR = ATGC_DEBUG_LINE; // white
+const int OTHER_COLOR = ATGC_OTHER_LINE; // yellow
+const int EXITING_COLOR = ATGC_NUCLEUS_LINE; // purple
+const int NUCLEUS_COLOR = ATGC_NUCLEUS_LINE; // purple
+const int ORIGINAL_COLOR = ATGC_BLANK_LINE; // no color at all
+
+// input is read in chunks of this size. a line longer than this grows the buffer
+const size_t READ_BUFFER_SIZE = 64 * 1024;
+
+// how many lines are classified and written together
+const size_t MAX_BATCH_LINES = 1024;
+
+// with --fold-traces or --storm, a trace still being held or a count of repeats is let through after the input is quiet this long
+const int FOLD_IDLE_MS = 200;
+
+// how many exceptions, frames or statements --report and categories --stats list unless --top says otherwise
+const size_t DEFAULT_REPORT_TOP = 20;
+
+// line type names, in line type order, for the --stats columns, --min-type, --only and the --index runs
+const char* const LINE_TYPE_NAMES[ATGC_NUM_LINE_TYPES] = { "info", "warning", "debug", "error", "other", "nucleus", "blank" };
+
+// how much a line type says, for --min-type: debug lowest, then everything but warnings and errors
+const int LINE_TYPE_RANKS[ATGC_NUM_LINE_TYPES] = { 1, 2, 0, 3, 1, 1, 1 };
 
-// how many previous lines of output are held in saved?
-const int NUM_SAVED_LINES = 20;
+// highlighted --match literals in a line, the ones past this aren't
+const size_t MAX_HIGHLIGHTS = 64;
+
+// with --daemon, a stream isn't read from while this much of its colored output waits for its client
+const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+
+// how many epoll events the daemon takes at a time
+const int MAX_DAEMON_EVENTS = 64;
+
+// the pipes --index splices the log through, as big as an unprivileged process can make them
+const size_t INDEX_PIPE_SIZE = 1024 * 1024;
 
 /*
-	here we keep three arrays: previous line types, previous trimmed lines, and previous lines.
-	this is done so that we can look through the previous lines to determine what type they are,
-	which helps determine the current line. for instance, some stack traces are followed by a
-	). looking back on the past line types, we can determine this is part of an error and it is
-	colored appropriately
+	--stats=stages times the work on one read in this many and scales it up to all of them. the
+	waiting for the input and the output comes in bursts a sample would miss or blow up, it's
+	timed on every read
 */
-int previousLineTypes[NUM_SAVED_LINES];
-string previousLines[NUM_SAVED_LINES];
-string previousLinesTrimmed[NUM_SAVED_LINES];
-
-// used in setTextColor. windows.h sets colors...not using ANSI escape sequences
-string INFO_COLOR = "[1;32m"; // green
-string WARNING_COLOR = "[1;36m"; // cyan
-string DEBUG_COLOR = "[1;37m"; // white
-string ERROR_COLOR = "[1;31m"; // red
-string INTRO_COLOR = "[1;37m"; // white
-string OTHER_COLOR = "[1;33m"; // yellow
-string EXITING_COLOR = "[1;40;35m"; // purple
-string NUCLEUS_COLOR = "[1;40;35m"; // purple
-string ORIGINAL_COLOR = "[0m"; // purple
+const unsigned long long STAGE_SAMPLE_INTERVAL = 8;
+
+// what a line goes through, in order. read and write include waiting for the input and the output
+const int STAGE_READ = 0;
+const int STAGE_STRIP = 1;
+const int STAGE_CLASSIFY = 2;
+const int STAGE_RENDER = 3; // filtering, folding and reports too, and with --storm that's in classify
+const int STAGE_WRITE = 4;
+const int NUM_STAGES = 5;
+const char* const STAGE_NAMES[NUM_STAGES] = { "read", "strip", "classify", "render", "write" };
+
+// how often the --metrics file is written when --metrics-interval doesn't say
+const unsigned long DEFAULT_METRICS_INTERVAL = 10;
+
+// --collapse-blocks summaries, by ATGC_BLOCK_
+const char* const BLOCK_NAMES[] = { "", "ENVIRONMENT", "CLASSPATH", "CONFIGPATH" };
+
+// what the lines are written as
+const int OUTPUT_ANSI = 0;
+const int OUTPUT_NDJSON = 1;
+const int OUTPUT_HTML = 2;
+
+// rendered output waiting for the next fwrite
+struct RenderedOutput
+{
+	vector<char> bytes;
+	size_t used;
+	int format; // one of the OUTPUT_ constants
+	int serverType; // for OUTPUT_NDJSON
+	atgc_html* html; // for OUTPUT_HTML
+	atgc_filter* highlight; // for OUTPUT_ANSI with --match, NULL otherwise
+	vector<char>* sink; // what's written out goes here instead of stdout, for --daemon and --input
+	string prefix; // for OUTPUT_ANSI, written in front of every line. the name of the log with --input
+};
+
+// --latency. how long the lines of each read took to be written, and how much went through
+struct LatencyMeter
+{
+	atgc_latency* histogram;
+	unsigned long long startNs;
+	unsigned long long busyNs; // from each read to its lines being written, added up
+	unsigned long long bytesIn;
+	unsigned long long reads;
+};
+
+// --stats=stages. the time stamp counter ticks spent in each stage, during the reads sampled for strip, classify and render
+struct StageMeter
+{
+	unsigned long long ticks[NUM_STAGES];
+	unsigned long long reads;
+	unsigned long long sampledReads;
+	unsigned long long lines;
+	unsigned long long sampledLines;
+	bool sampling; // the read being colored is one of the sampled ones
+	unsigned long long startTicks; // to work out how many ticks there are per nanosecond
+	unsigned long long startNs;
+	unsigned long long lastTicks; // with io_uring, when the last chunk was done with
+};
 
 /*
-	int determineLineType is the function responsible for determining a single output line's type.
-	it returns one of the six constants
+	--metrics. the counters of one pipeline, kept with plain increments by the thread running it.
+	they're only added up when the metrics file is written. lines, stormCollapsed and foldedTraces
+	are only filled in then, from the pipeline, the storm collapser and the trace folder
 */
-const int INFO_LINE = 0;
-const int WARNING_LINE = 1;
-const int DEBUG_LINE = 2;
-const int ERROR_LINE = 3;
-const int OTHER_LINE = 4;
-const int NUCLEUS_LINE = 5;
-
-bool contains(string haystack, string needle)
+struct PipelineCounters
 {
-	return (haystack.find(needle) != string::npos);
-}
+	unsigned long long lines;
+	unsigned long long bytes; // newlines included
+	unsigned long long types[ATGC_NUM_LINE_TYPES]; // with --storm, of the lines it let through
+	unsigned long long classifyNs;
+	unsigned long long classified; // the lines classifyNs was measured on, none with --storm
+	unsigned long long filterIn; // lines handed to --min-type, --only or --match
+	unsigned long long filterOut; // and let through by it
+	unsigned long long blockEntries; // entries of a dump --collapse-blocks reduced to one line
+	unsigned long long stormCollapsed;
+	unsigned long long foldedTraces;
+};
+
+// what happens to the lines once they're classified
+struct Pipeline
+{
+	atgc_stream* stream;
+	atgc_filter* filter; // --min-type, --only or --match, NULL otherwise
+	atgc_storm* storm; // --storm, NULL otherwise. it classifies the lines it lets through itself
+	atgc_folder* folder; // --fold-traces, NULL otherwise
+	atgc_exception_report* exceptions; // --report exceptions, nothing is written while reading when set
+	atgc_stats* stats; // --stats, same
+	atgc_thread_dumps* threadDumps; // --report threads, stacks or folded, same
+	atgc_profile* profile; // --report stacks or folded, fed each thread of threadDumps
+	atgc_failed_sql_report* failedSQL; // --report sql, same as exceptions
+	bool collapseBlocks; // --collapse-blocks
+	int openBlock; // the ATGC_BLOCK_ being collapsed
+	unsigned long blockEntries; // and how many of its entries were seen so far
+	unsigned long long lines; // lines read so far
+	LatencyMeter* latency; // --latency, NULL otherwise
+	StageMeter* stages; // --stats=stages, NULL otherwise
+	PipelineCounters counters; // kept with --metrics
+	RenderedOutput output;
+};
+
+/*
+	rule reloading. the classifier thread never waits for a reload: a reloader thread compiles the
+	rule files into a new set and publishes it in publishedRules, and the classifier thread picks it
+	up between two batches. activeRules is the set the classifier thread may be using right now, so
+	the reloader only destroys a replaced set once activeRules has moved past it
+*/
+atomic<atgc_rules*> publishedRules(NULL);
+atomic<atgc_rules*> activeRules(NULL);
+int reloadPipe[2] = { -1, -1 }; // written to by the SIGHUP handler, read by the reloader thread
+
+const char RELOAD_REQUEST = 'r';
+const char STOP_REQUEST = 'q';
+
+// how often the reloader checks whether a replaced rule set can be freed
+const int RECLAIM_INTERVAL_MS = 100;
+
+// set when stdout is for another program (--stats=csv, --output=ndjson or html): no banner and no colors
+bool plainOutput = false;
+
+// --theme compiled for the terminal, NULL for the built-in colors
+atgc_theme* colorTheme = NULL;
 
-bool startsWith(string haystack, string needle)
+/*
+	--metrics. the file is written to a temporary file next to it and renamed over it, so whatever
+	reads it never sees half of it
+*/
+struct MetricsFile
 {
-	return contains(haystack.substr(0, needle.size()), needle);
-}
+	string path;
+	string temporaryPath;
+	unsigned long long intervalMs;
+	unsigned long long nextMs; // when it's written next
+	PipelineCounters retired; // of the --daemon streams and --input logs that ended
+	bool failed; // couldn't be written the last time, said once
+};
+
+// NULL without --metrics, the counters aren't kept then
+MetricsFile* metricsFile = NULL;
 
-bool endsWith(string a, string b)
+// sets text color of console. any text printed to the screen after a color has been set
+// is colored as set
+void setTextColor(int color)
 {
-	if (a.size() < b.size())
+	if (!plainOutput)
 	{
-		return false;
+		fputs(atgc_theme_color(colorTheme, color), stdout);
 	}
-	return contains(a.substr(a.size()-b.size(), a.size()), b);
 }
 
 /*
  *	scripts like startDynamoOnJBOSS.bat sometimes stick a bunch of null characters in the
  *	output. this method replaces all of those null characters with empty spaces
  */
-string stripNullChars(string str)
+void stripNullChars(char* str, size_t length)
 {
-	while (str.find_last_of(NULL_CHARACTER) != string::npos)
+	char* end = str + length;
+	for (char* c = (char*) memchr(str, NULL_CHARACTER, length); c != NULL; c = (char*) memchr(c, NULL_CHARACTER, end - c))
 	{
-		size_t start = str.find_last_of(NULL_CHARACTER);
-		str = str.replace(start, 1, " ");
+		*c = ' ';
 	}
-	return str;
 }
 
-// performs left and right trim
-string trim(const string& String)
+// this is called whenever ctrl + c is hit. it displays a message and resets the window text
+void ctrlcCatcher(int sig)
 {
-	string::size_type string_size = String.size();
-	string::size_type start = 0;
-	for(; start != string_size; ++start)
-	{
-		if(!isspace(String[start]))
-			break;
-	}
+	printf("\n");
+	setTextColor(EXITING_COLOR);
+	printf("Ctrl + C detected\n");
+	printf("Exiting now...\n");
+	setTextColor(ORIGINAL_COLOR);
+	printf("\n");
+	printf("\n");
+	(void) signal(SIGINT, SIG_DFL);
+}
 
-	string::size_type end = string_size;
-	for(; end != start; --end)
-	{
-		if(!isspace(String[end-1]))
-		break;
-	}
+// set on SIGUSR1 with --latency or --stats=stages, the reports are printed between two reads
+volatile sig_atomic_t reportRequested = 0;
 
-	return string(String.substr(start, end - start));
+void reportCatcher(int /*sig*/)
+{
+	reportRequested = 1;
 }
 
-// sets text color of console. any text printed to the screen after a color has been set
-// is colored as set. SetConsoleTextAttribute() is provided via windows.h
-void setTextColor(string color)
-{
-	string ESCAPE_CODE = "\e";
-	cout << ESCAPE_CODE;
-	cout << color;
-}
-
-bool isSopErrorLine(string trimmedLine)
-{
-	if (
-				contains(trimmedLine, "Ids cannot be null") ||
-				contains(trimmedLine, "Ids cannot be empty") ||
-				contains(trimmedLine, "Attempt to add a NULL item to the repository") ||
-				contains(trimmedLine, "Attempt to add an item to the repository without specifying") ||
-				contains(trimmedLine, "Invalid data type name:") ||
-				contains(trimmedLine, "Invalid item class name") ||
-				contains(trimmedLine, "Invalid item descriptor name") ||
-				(contains(trimmedLine, "No property named") && contains(trimmedLine, "could be found in the item descriptor")) ||
-				(contains(trimmedLine, "No item with ID") && contains(trimmedLine, "could be found in item descriptor")) ||
-				contains(trimmedLine, "is not queryable and thus cannot be used in this query") ||
-				contains(trimmedLine, "Error initializing id generator") ||
-				contains(trimmedLine, "Error reading list or array index from the database") ||
-				contains(trimmedLine, "Attempt to create a sub-property query expression for the property") ||
-				contains(trimmedLine, "Attempt to create a query using transient property") ||
-				contains(trimmedLine, "Attempt to create a case-insenstive query with no SQL") ||
-				contains(trimmedLine, "does not appear to be defined correctly in the database") ||
-				contains(trimmedLine, "Query or QueryExpression object that is null or was not created by this repository") ||
-				contains(trimmedLine, "invalid array of Query objects") ||
-				(contains(trimmedLine, "The argument") && contains(trimmedLine, "cannot be null")) ||
-				contains(trimmedLine, "Multi-valued properties may not be used") ||
-				contains(trimmedLine, "using QueryExpressions that cannot be compared") ||
-				contains(trimmedLine, "No default properties are defained") ||
-				(contains(trimmedLine, "The query operator") && contains(trimmedLine, "is invalid")) ||
-				contains(trimmedLine, "Attempt to execute a query with pQueryOptions = null") ||
-				contains(trimmedLine, "SQL Repository not configured with DatabaseTableInfos") ||
-				contains(trimmedLine, "Could not remove entry or entries for item descriptor") ||
-				contains(trimmedLine, "An SQL error was encountered") ||
-				contains(trimmedLine, "An SQL error was encountered") ||
-				contains(trimmedLine, "Unable to decode composite ID") ||
-				contains(trimmedLine, "has incorrectly configured IdSpaces") ||
-				contains(trimmedLine, "Id values must match Id column count") ||
-				contains(trimmedLine, "Unable to set Id values of table") ||
-				contains(trimmedLine, "Attempt to execute or build a text comparison query") ||
-				(contains(trimmedLine, "Unable to convert ID") && contains(trimmedLine, "to type")) ||
-				contains(trimmedLine, "Unable to convert composite ID element") ||
-				contains(trimmedLine, "Unable to initialize stored procedure helper") ||
-				(contains(trimmedLine, "Arguments were provided for the query") && contains(trimmedLine, "which does not contain parameters")) ||
-				contains(trimmedLine, "Invalid parameter type passed to query") ||
-				contains(trimmedLine, "Unable to rebuild this expression.") ||
-				contains(trimmedLine, "No arguments supplied for the parameter query") ||
-				contains(trimmedLine, "Wrong number of arguments supplied for parameter query") ||
-				contains(trimmedLine, "Null return property specified for query") ||
-				contains(trimmedLine, "is not readable, and cannot be specified ") ||
-				contains(trimmedLine, "is not a GSA property, and cannot be specified") ||
-				contains(trimmedLine, "is transient, and cannot be a return property") ||
-				contains(trimmedLine, "is multi-valued, and cannot be a return property") ||
-				contains(trimmedLine, "Null dependent property specified") ||
-				contains(trimmedLine, "Null or blank sql string argument entered for DirectSqlQuery") ||
-				contains(trimmedLine, "Unable to create a DirectSqlQuery against a transient item descriptor") ||
-				(contains(trimmedLine, "Unable to load class") && contains(trimmedLine, "for input parameter at index")) ||
-				contains(trimmedLine, "Invalid parameter type at index") ||
-				contains(trimmedLine, "Error initializing sql query") ||
-				contains(trimmedLine, "Error parsing template") ||
-				contains(trimmedLine, "No template files defined, be sure the property") ||
-				contains(trimmedLine, "Unable to read template file") ||
-				contains(trimmedLine, "No XML parser could be found") ||
-				contains(trimmedLine, "Unable to find the id space") ||
-				contains(trimmedLine, "Invalid protocol magic number read") ||
-				contains(trimmedLine, "Exception while reading events from data input stream") ||
-				contains(trimmedLine, "No current transaction for getPropertyValue()") ||
-				contains(trimmedLine, "Error setting the RQL filter string") ||
-				contains(trimmedLine, "Unable to load database meta data for columns in table") ||
-				contains(trimmedLine, "Attempt to perform a Sybase full text search query on property") ||
-				contains(trimmedLine, "Attempt to perform a DB2 full text search query on property") ||
-				contains(trimmedLine, "Attempt to set value of property") ||
-				contains(trimmedLine, "An error occurred processing an invalidate cache entry") ||
-
-				contains(trimmedLine, "*** failed to clone super-type") ||
-				contains(trimmedLine, "can't read properties") ||
-				contains(trimmedLine, "unkown bean:") ||
-				contains(trimmedLine, "can't introspect property:") ||
-				contains(trimmedLine, "unkown property:") ||
-				contains(trimmedLine, "can't set property:") ||
-				contains(trimmedLine, "Naming Exception caught") ||
-				contains(trimmedLine, "Error: caught exception") ||
-
-				contains(trimmedLine, "no getter for:") ||
-				contains(trimmedLine, "NumberFormatException reading schema info cache") ||
-				contains(trimmedLine, "does not exist in a table space accessible by the data source") ||
-				contains(trimmedLine, "Found a one-to-many shared table definition in versioned case with one side using") ||
-				contains(trimmedLine, "Found shared table definition in versioned case with only one asset version column") ||
-
-				// from /atg/deployment/common/Resources.properties
-				contains(trimmedLine, "Error parsing file") ||
-				contains(trimmedLine, "deployment topology failed to load properly") ||
-				contains(trimmedLine, "no JNDI name defined for JNDI transport of agent") ||
-				contains(trimmedLine, "no transport found for JNDI name") ||
-				contains(trimmedLine, "error looking up transport") ||
-				contains(trimmedLine, "no targets defined in topology definition file") ||
-				contains(trimmedLine, "no transport defined for agent") ||
-				contains(trimmedLine, "no transport type defined for agent") ||
-				contains(trimmedLine, "unknown transport type") ||
-				contains(trimmedLine, "no URI defined for RMI transport of agent") ||
-				contains(trimmedLine, "could not instantiate RMI server-side agent transport with URI") ||
-				contains(trimmedLine, "to an indeterminate snapshot due to an interruption in the committed apply phase") ||
-				contains(trimmedLine, "Simulating failure : DeploymentAgent.debugApplyFailIndex is set to") ||
-				contains(trimmedLine, "Manifest application aborted at server request") ||
-				contains(trimmedLine, "An error was encountered applying manifest data before any data was committed") ||
-				contains(trimmedLine, "Data store switch preparation aborted at server request") ||
-				contains(trimmedLine, "is either not configured or failed to start up properly") ||
-				contains(trimmedLine, "The version manager is either not configured or failed to start up properly") ||
-				contains(trimmedLine, "The manifest manager is either not configured or failed to start up properly") ||
-				contains(trimmedLine, "The transaction manager is either not configured or failed to start up properly") ||
-				contains(trimmedLine, "The rmi server is either not configured or failed to start up properly") ||
-				contains(trimmedLine, "The topology manager is either not configured or failed to start up properly") ||
-				contains(trimmedLine, "The deployment server failed to start-up properly") ||
-				contains(trimmedLine, "received unknown deployment command") ||
-				contains(trimmedLine, "forcing initialization of snapshot from") ||
-				contains(trimmedLine, "cannot initialize snapshot, the agent is either active or already has an snapshot") ||
-				contains(trimmedLine, "because the agent is inaccessible") ||
-				contains(trimmedLine, "agent is locked by a different deployment") ||
-				contains(trimmedLine, "deployment server system version does not match this agent") ||
-				contains(trimmedLine, "attempt to resume or rollback a deployment on this agent but the agent has been changed by another deployment") ||
-				contains(trimmedLine, "only full deployments are allowed when the agent snapshot is uninitialized") ||
-				contains(trimmedLine, "was not found on the local agent") ||
-				(contains(trimmedLine, "cannot enter phase") && contains(trimmedLine, "from phase")) ||
-				contains(trimmedLine, "could not get manifest stream for writing manifest") ||
-				contains(trimmedLine, "manifest stream is null for install of manifest") ||
-				contains(trimmedLine, "error closing manifest stream : stream is being ignored") ||
-				contains(trimmedLine, "A maintained Status object could not be cloned to create a safe copy to return") ||
-				contains(trimmedLine, "A maintained Status could not write to file") ||
-				contains(trimmedLine, "could not delete Status file") ||
-				contains(trimmedLine, "error encountered reading in persisted status") ||
-				contains(trimmedLine, "cannot interrupt a deployment in state") ||
-				contains(trimmedLine, "A system error was encountered trying to lookup the RMI URI") ||
-				contains(trimmedLine, "transport error from agent") ||
-				contains(trimmedLine, "transport failed to start or is otherwise uninitialized") ||
-				contains(trimmedLine, "could not send manifest to agent") ||
-				contains(trimmedLine, "error reading manifest stream") ||
-				contains(trimmedLine, "transport error installing manifest on agent") ||
-				contains(trimmedLine, "error closing manifest stream") ||
-				contains(trimmedLine, "deployment server is starting up with an uninitialized topology") ||
-				contains(trimmedLine, "no topology XML configured") ||
-				contains(trimmedLine, "could not remove completed deployment") ||
-				contains(trimmedLine, "topology cannot reinit due to deployment") ||
-				contains(trimmedLine, "error closing agent transport for target") ||
-				contains(trimmedLine, "recovered deployment status is either not from this server") ||
-				contains(trimmedLine, "there is a target with no name : each target must be named") ||
-				contains(trimmedLine, "no agents were given deployment responsibilities in target") ||
-				contains(trimmedLine, "no agents defined in target") ||
-				contains(trimmedLine, "there is an agent with no name in target") ||
-				contains(trimmedLine, "due to error from transport") ||
-				contains(trimmedLine, "suggesting an unclean shutdown") ||
-				contains(trimmedLine, "hard reset requested from user") ||
-				contains(trimmedLine, "mis-match in live data store name of switchable data stores") ||
-				contains(trimmedLine, "error encountered reverting deployment switch") ||
-				contains(trimmedLine, "error encountered preparing switchable for switch") ||
-				contains(trimmedLine, "all files not deleted from") ||
-				contains(trimmedLine, "cannot initialize snapshot on target") ||
-				contains(trimmedLine, "forcing initialization of snapshot on target") ||
-				contains(trimmedLine, "due to error from agent") ||
-				contains(trimmedLine, "could not discern snapshot due to error from target") ||
-				contains(trimmedLine, "error mismatch in snapshot on target") ||
-				contains(trimmedLine, "has a current deployment that cannot be removed") ||
-				contains(trimmedLine, "error recovering deployment from status") ||
-				contains(trimmedLine, "cannot be instantiated because the deployment target") ||
-				contains(trimmedLine, "An unidentified deployment cannot be instantiated due to errors") ||
-				contains(trimmedLine, "cannot be instantiated due to errors accessing the repository") ||
-				contains(trimmedLine, "An error occurred attempting to move deployment") ||
-				contains(trimmedLine, "a repository level error occurred during deployment initialization") ||
-				contains(trimmedLine, "An error occurred attempting to delete deployment") ||
-				contains(trimmedLine, "A transaction-level error occurred while trying to delete deployment") ||
-				contains(trimmedLine, "encountered a transaction-level error while preparing Target") ||
-				contains(trimmedLine, "cannot be started because there is already a current deployment") ||
-				contains(trimmedLine, "could not be made the current deployment in order to start it") ||
-				contains(trimmedLine, "the deployment is flagged as a revert but has more than one project") ||
-				contains(trimmedLine, "the target has no initial snapshot") ||
-				contains(trimmedLine, "should have a Snapshot by now but does not") ||
-				contains(trimmedLine, "encountered a versioning error building the manifest") ||
-				contains(trimmedLine, "encountered a system level deployment error during data transfer") ||
-				contains(trimmedLine, "No destination repositories or virtual file systems were configured for this deployment") ||
-				contains(trimmedLine, "could not be resolved as a Nucleus component") ||
-				contains(trimmedLine, "The source virtual file system could not be found for the following file asset") ||
-				contains(trimmedLine, "encountered an error with manifest") ||
-				contains(trimmedLine, "A call to the current deployment running remotely on another deployment server") ||
-				contains(trimmedLine, "is no longer the current deployment and thus could not be called") ||
-				contains(trimmedLine, "An RMI error encountered calling remote current deployment") ||
-				contains(trimmedLine, "suggesting an unclean shutdown") ||
-				contains(trimmedLine, "but could find no such manifest") ||
-				contains(trimmedLine, "cannot be started, either it was previously started or the deployment queue is running and this deployment is not next in the queue.") ||
-				contains(trimmedLine, "cannot stop a deployment that is in a non-active or non-error state") ||
-				contains(trimmedLine, "since the deployment has not stopped due to an error") ||
-				contains(trimmedLine, "the deployment has started and must either complete successfully or be stopped in order to be deleted") ||
-				contains(trimmedLine, "unrecognized deployment type") ||
-				contains(trimmedLine, "cannot be found in the VersionManager : full deployment is required") ||
-				contains(trimmedLine, "cannot perform an online deployment on target") ||
-				contains(trimmedLine, "cannot perform an incremental deployment on target") ||
-				contains(trimmedLine, "error communicating with target:agent") ||
-				contains(trimmedLine, "could not lock target:agent") ||
-				contains(trimmedLine, "error preparing target:agent") ||
-				contains(trimmedLine, "error loading manifest on target:agent") ||
-				contains(trimmedLine, "error installing manifest on target:agent") ||
-				contains(trimmedLine, "error applying manifest on target:agent") ||
-				contains(trimmedLine, "error activating deployment on target:agent") ||
-				contains(trimmedLine, "event interrupt on target:agent") ||
-				contains(trimmedLine, "error from target:agent") ||
-				contains(trimmedLine, "Unexpected error occured. See log for details.") ||
-				contains(trimmedLine, "do not have the same live data store : ") ||
-				contains(trimmedLine, "Cannot deploy to target") ||
-				contains(trimmedLine, "does not match current target snapshot : ") ||
-				contains(trimmedLine, "unexpected state returned telling target:agent") ||
-				contains(trimmedLine, "transport error unlocking target:agent") ||
-				contains(trimmedLine, "error stopping deployment on target:agent") ||
-				contains(trimmedLine, "agent errors encountered while stopping deployment") ||
-				contains(trimmedLine, "error deleting manifest") ||
-				contains(trimmedLine, "agent errors encountered while deleting manifests") ||
-				contains(trimmedLine, "Deployment manifests could not be deleted from the agent") ||
-				contains(trimmedLine, "encountered an exception while loading") ||
-				contains(trimmedLine, "An exception was encountered while installing Manifest") ||
-				contains(trimmedLine, "An exception was encountered switching data stores") ||
-				contains(trimmedLine, "An exception was encountered sending update events to affected VirtualFileSystems") ||
-				contains(trimmedLine, "runtime exception caught from event listener") ||
-				contains(trimmedLine, "Failed to connect to agent ") ||
-				contains(trimmedLine, "This agent not allowed to be absent for a deployment") ||
-				contains(trimmedLine, "error resolving CMS catalog for deployment checks") ||
-				contains(trimmedLine, "error updating foreign repository references") ||
-				contains(trimmedLine, "Running deployment cannot be changed") ||
-				contains(trimmedLine, "error resetting shadow") ||
-				contains(trimmedLine, "Target is already initialized with a snapshot") ||
-				contains(trimmedLine, "has pending or current deployment. It cannot be deleted or updated") ||
-				contains(trimmedLine, "The name was given as a branch from which to initialize the new target branch") ||
-				contains(trimmedLine, "When creating a new target the source target to initialize from is required") ||
-				contains(trimmedLine, "cannot be deleted.  It is choosen to act as an initialization source") ||
-				contains(trimmedLine, "Target preparation failed because the one-time server-side target initialization encountered an error") ||
-				contains(trimmedLine, "due to lower level errors") ||
-				contains(trimmedLine, "could not be found in the version manager for rollback") ||
-				contains(trimmedLine, "because the Project is not checked in and does not have locked assets") ||
-				contains(trimmedLine, "as a new Project because the Project has already been deployed to the target") ||
-				contains(trimmedLine, "A system level error ") ||
-				contains(trimmedLine, "could not be found in the Publishing repository.") ||
-				contains(trimmedLine, "A transaction-level error occurring while trying to create a") ||
-				contains(trimmedLine, "cannot be back-deployed to Project") ||
-				contains(trimmedLine, "cannot revert a null Project") ||
-				contains(trimmedLine, "cannot revert Project ID") ||
-				contains(trimmedLine, "Exception encountered while trying to revert Project") ||
-				contains(trimmedLine, "A transaction-level error occurring while trying to revert Project") ||
-				contains(trimmedLine, "but there is no merge workspace associated with the project") ||
-				contains(trimmedLine, "is marked as completed but the workspace, for the workspace name associated with it") ||
-				contains(trimmedLine, "cannot be started : Target site") ||
-				contains(trimmedLine, "cannot be reverted from deployment target site") ||
-				contains(trimmedLine, "A transaction-level error occurring while trying to initialize Target site") ||
-				contains(trimmedLine, "could not find snapshot") ||
-				contains(trimmedLine, "internal error: unexpected diff from version manager") ||
-				contains(trimmedLine, "must have exactly two underlying data sources to be used for deployment") ||
-				contains(trimmedLine, "not a GSARepository. Instead it is of type:") ||
-				contains(trimmedLine, "error creating shadow for:") ||
-				contains(trimmedLine, "not a VirtualFileSystem. Instead it is of type:") ||
-				contains(trimmedLine, "cannot create temp file:") ||
-				contains(trimmedLine, "no manifest manager at") ||
-				contains(trimmedLine, "no transaction manager at") ||
-				contains(trimmedLine, "no version manager at") ||
-				contains(trimmedLine, "no repository registry a") ||
-				contains(trimmedLine, "no repository at ") ||
-				contains(trimmedLine, "invalid starting index:") ||
-				contains(trimmedLine, "invalid ending index:") ||
-				contains(trimmedLine, "batch size must be either -1 or a postive integer") ||
-				contains(trimmedLine, "unrecognized argument: ") ||
-				contains(trimmedLine, "you must specify a data file") ||
-				contains(trimmedLine, "you must specifiy at least one repository or -all for exports") ||
-				contains(trimmedLine, "does not appear to be valid data file") ||
-				contains(trimmedLine, "internal error reserving the id for the repository item") ||
-				contains(trimmedLine, "attempt to export the versioned repository") ||
-				contains(trimmedLine, "I/O error creating deferred update store") ||
-				contains(trimmedLine, "I/O error writing int value") ||
-				contains(trimmedLine, "could not find repository service") ||
-				contains(trimmedLine, "could not find item descriptor") ||
-				contains(trimmedLine, "could not find virtual file system") ||
-				contains(trimmedLine, "no snapshot diff returned for") ||
-				contains(trimmedLine, "internal error: unrecognized deployment type:") ||
-				contains(trimmedLine, "A deployment cannot be created without a project.") ||
-				contains(trimmedLine, "Cannot revert project") ||
-				contains(trimmedLine, "An error occurred while importing topology") ||
-				contains(trimmedLine, "Error occurred while invalidating the destination repository caches.") ||
-				contains(trimmedLine, "No target repository mapping defined for") ||
-				(contains(trimmedLine, "state change") && contains(trimmedLine, "received event interrupted from")) ||
-				(contains(trimmedLine, "data file") && contains(trimmedLine, "does not exist")) ||
-				(contains(trimmedLine, "invalid value") && contains(trimmedLine, "for argument:")) ||
-				(contains(trimmedLine, "The deploy time of Deployment") && contains(trimmedLine, "could not be changed to")) ||
-				(contains(trimmedLine, "for target") && contains(trimmedLine, "cannot be started twice")) ||
-				(contains(trimmedLine, "Snapshot") && contains(trimmedLine, "could not be retrieved for Project")) ||
-				(contains(trimmedLine, "Project with ID") && contains(trimmedLine, "is required to deploy Project(s)")) ||
-				(contains(trimmedLine, "requested destination") && contains(trimmedLine, "not found")) ||
-				(contains(trimmedLine, "data source for repository:") && contains(trimmedLine, "is not a switching data source")) ||
-				(contains(trimmedLine, "data file") && contains(trimmedLine, "is not readable")) ||
-				(contains(trimmedLine, "data file") && contains(trimmedLine, "is not writable")) ||
-				contains(trimmedLine, "The connection pool failed to initialize propertly") ||
-				(contains(trimmedLine, "The suppplied DataSource JNDI name") && contains(trimmedLine, "did not resolve to a DataSource")) ||
-				contains(trimmedLine, "No Transaction could be found or created for the current thread") ||
-				contains(trimmedLine, "failed to obtain the current Transaction from the TransactionManager") ||
-				contains(trimmedLine, "transaction demarcation should be controled through JTA interfaces") ||
-				contains(trimmedLine, "the currentDataSource property is NULL") ||
-				contains(trimmedLine, "the dataSources property is NULL or contains no data sources") ||
-				contains(trimmedLine, "is not recognized as the name of one of the data sources configured for this SwitchingDataSource") ||
-				contains(trimmedLine, "mis-match between Transaction and Connection : FakeXA forces") ||
-				contains(trimmedLine, "attempting to use a closed connection") ||
-				contains(trimmedLine, "error reclaiming resource") ||
-				contains(trimmedLine, "Synchronization detected probable missing Connection.close()") ||
-
-				// /atg/adapter/gsa/xml/ParserResources.properties
-				contains(trimmedLine, " has parsing errors.") ||
-				contains(trimmedLine, "Fatal error parsing file") ||
-				contains(trimmedLine, "Warning parsing file ") ||
-				contains(trimmedLine, "File contains duplicate definition of item-descriptor ") ||
-				contains(trimmedLine, "You must supply an item-descriptor attribute for the print-item tag") ||
-				contains(trimmedLine, "You supplied an invalid item-descriptor") ||
-				contains(trimmedLine, "should not have both super-type and copy-from attributes") ||
-				contains(trimmedLine, "has an invalid item-descriptor for the super-type attribute") ||
-				contains(trimmedLine, "has an invalid item-descriptor for the copy-from attribute") ||
-				contains(trimmedLine, "must specify a valid property name for the sub-type-property attribute") ||
-				contains(trimmedLine, "must specify a property for the sub-type-property") ||
-				contains(trimmedLine, "must specify a valid property for the display-property attribute") ||
-				contains(trimmedLine, "must specify a valid property for the version-property attribute") ||
-				contains(trimmedLine, "must specify valid properties for the text-search-properties attribute") ||
-				contains(trimmedLine, "must specify a valid integer for the cache-size attribute") ||
-				contains(trimmedLine, "must specify a valid integer for the cache-timeout attribute") ||
-				contains(trimmedLine, "must have a table tag with type=") ||
-				contains(trimmedLine, "cannot have the sub-type-property attribute on it") ||
-				contains(trimmedLine, "but is missing at least one of content-property, folder-id-property, or one of content-name-property") ||
-				contains(trimmedLine, "but is missing at least one of folder-id-property, or one of content-name-property, content-path-property") ||
-				contains(trimmedLine, "has a version-property which is not a number type.") ||
-				(contains(trimmedLine, "Your attribute ") && contains(trimmedLine, "refers to a non-existent property")) ||
-				contains(trimmedLine, "refers to a property that is not a repository property descriptor") ||
-				contains(trimmedLine, "must have type attribute of primary, auxiliary, or multi.  You have") ||
-				contains(trimmedLine, "which is not a sub-class of GSAPropertyDescriptor.") ||
-				contains(trimmedLine, "has a property whose data-type is not valid for a multi table:") ||
-				contains(trimmedLine, "is missing an item-descriptor.") ||
-				contains(trimmedLine, "is missing an id-column-name attribute.") ||
-				contains(trimmedLine, "specifies an invalid foreign repository name") ||
-				contains(trimmedLine, "only specify one of the attributes item-type or data-type(s), not both") ||
-				contains(trimmedLine, "specifies both component-item-type and component-data-type attributes") ||
-				contains(trimmedLine, "specifies a repository attribute which is only valid for properties with") ||
-				contains(trimmedLine, "has an invalid property-type") ||
-				contains(trimmedLine, "has an invalid data type ") ||
-				contains(trimmedLine, "is missing one of the component-data-type") ||
-				contains(trimmedLine, "specifies an invalid item-descriptor") ||
-				contains(trimmedLine, "specifies a value for both component-data-type and") ||
-				contains(trimmedLine, "specifies an invalid value for the component-data-type attribute") ||
-				contains(trimmedLine, "specifies an invalid item-type") ||
-				contains(trimmedLine, "is improperly defined according to") ||
-				contains(trimmedLine, ".  Using default property editor.") ||
-				(contains(trimmedLine, "insert,update,delete") && contains(trimmedLine, "but does not refer to another item.")) ||
-				(contains(trimmedLine, "insert,update,delete") && contains(trimmedLine, "but does not refer to another item.")) ||
-				(contains(trimmedLine, "delete,insert") && contains(trimmedLine, "and refers to a item which has a property that refers back")) ||
-				contains(trimmedLine, "All entries should be insert,update or delete.") ||
-				contains(trimmedLine, "specifies a column-name property but is not inside of a table tag.") ||
-				contains(trimmedLine, "specifies the group attribute but is not defined inside of a table tag") ||
-				contains(trimmedLine, "specifies the default attribute but is not a scalar property.") ||
-				contains(trimmedLine, "is a scalar property but is defined in a table tag with type=") ||
-				contains(trimmedLine, "is a set but also specifies a multi-column-name") ||
-				contains(trimmedLine, " is missing the multi-column-name attribute.") ||
-				contains(trimmedLine, " must have either a component-item-type or component-data-type attribute.") ||
-				contains(trimmedLine, "is a multi-valued property defined in a table that does not have type=") ||
-				contains(trimmedLine, "sets a cache-mode that is not supported on property tags") ||
-				contains(trimmedLine, "has some option tags which set the code value and others which do not set it explicitly") ||
-				contains(trimmedLine, "specifies a code value which is not a valid integer.") ||
-				contains(trimmedLine, "specifies an option code or value more than once:") ||
-				contains(trimmedLine, "already has an attribute tag with name") ||
-				contains(trimmedLine, "specifies an invalid data-type for an attribute tag") ||
-				contains(trimmedLine, "specifies an invalid value for an attribute tag.") ||
-				contains(trimmedLine, "Detailed error: ") ||
-				contains(trimmedLine, "is not a valid data-type.") ||
-				contains(trimmedLine, " could not be converted to the type ") ||
-				contains(trimmedLine, "attribute with an invalid bean attribute.") ||
-				contains(trimmedLine, "has an attribute with a null bean value ") ||
-				contains(trimmedLine, "item-descriptor tag does not have a valid name:") ||
-				contains(trimmedLine, "You have two item-descriptor tags with default=") ||
-				(contains(trimmedLine, "in item-descriptor") && contains(trimmedLine, "You have two properties called ")) ||
-				contains(trimmedLine, "Error trying to set an id generator high water mark:") ||
-				contains(trimmedLine, " is an illegal value for the sub-type-property.") ||
-				contains(trimmedLine, " has two id properties specified.") ||
-				contains(trimmedLine, "Specify either value or bean, but not both.") ||
-				contains(trimmedLine, "so the data-type attribute is not meaningful when ") ||
-				contains(trimmedLine, "Invalid tag value: ") ||
-				contains(trimmedLine, "Invalid composite format for repository ID:") ||
-				contains(trimmedLine, "This item type does not support composite repository IDs:") ||
-				contains(trimmedLine, "You specified both attributes id-column-name and id-column-names for table") ||
-				contains(trimmedLine, "You must specify either id-column-name or id-column-names for table element") ||
-				contains(trimmedLine, "You specified both attributes id-space-name and id-space-names for descriptor") ||
-				contains(trimmedLine, "The parsed ID has values that do not correspond to the configured id-space-names:") ||
-				contains(trimmedLine, "was specified with multiple columns. It will be treated as a read-only property") ||
-				contains(trimmedLine, "was specified with multiple columns. It must either share all or none of") ||
-				contains(trimmedLine, "Failed to add item to repository:") ||
-				(contains(trimmedLine, "must both be versioning.") && contains(trimmedLine, "Your item-descriptor definitions for")) ||
-				contains(trimmedLine, "Please specify the desired range when calling") ||
-				contains(trimmedLine, "This repository may not yet be properly initialized.") ||
-
-				contains(trimmedLine, "You must specify an XML configuration template file") ||
-				contains(trimmedLine, "You must specify a repository") ||
-				contains(trimmedLine, "You must specify an XMLTools object") ||
-				contains(trimmedLine, "Secured repository failed to start") ||
-				contains(trimmedLine, "There are no secured-repository-template elements") ||
-				contains(trimmedLine, "Invalid/unknown identity:") ||
-				contains(trimmedLine, "Invalid/unknown access right:") ||
-				contains(trimmedLine, "Invalid/unknown owner identity:") ||
-				contains(trimmedLine, "Invalid access control list:") ||
-				contains(trimmedLine, "An item descriptor name must be specified") ||
-				contains(trimmedLine, "is not a configured item descriptor of the repository") ||
-				contains(trimmedLine, "A property name must be specified") ||
-				contains(trimmedLine, "is not a configured property of the repository item") ||
-				contains(trimmedLine, "An error occurred while evaluating function") ||
-				contains(trimmedLine, "No function is mapped to the name") ||
-				contains(trimmedLine, "An error occurred while parsing custom action attribute") ||
-				contains(trimmedLine, "No such implicit object") ||
-				contains(trimmedLine, "An exception occurred while trying to compare a value of") ||
-				contains(trimmedLine, "An error occurred obtaining the indexed property value of an") ||
-				contains(trimmedLine, "Unable to find a value for name") ||
-				contains(trimmedLine, "An error occurred calling equals() on an object of type") ||
-				contains(trimmedLine, "An error occurred applying operator") ||
-				contains(trimmedLine, "Unable to parse value ") ||
-				contains(trimmedLine, "but there is no PropertyEditor for that type") ||
-				contains(trimmedLine, "An exception occurred trying to convert String") ||
-				contains(trimmedLine, "Attempt to coerce ") ||
-				contains(trimmedLine, "threw an exception in its toString()") ||
-				contains(trimmedLine, "Unable to find a value for") ||
-				contains(trimmedLine, "An exception occurred while trying to ") ||
-				contains(trimmedLine, "that value cannot be converted to an integer.") ||
-				contains(trimmedLine, "operator may not be null") ||
-				contains(trimmedLine, "Attempt to apply a null index to the") ||
-				contains(trimmedLine, "An error occurred while getting property") ||
-				contains(trimmedLine, "does not have a public getter method") ||
-				contains(trimmedLine, "Attempt to get property") ||
-				contains(trimmedLine, "A null expression string may not be passed to the") ||
-				contains(trimmedLine, "An Exception occurred getting the BeanInfo for class") ||
-				contains(trimmedLine, "An attempt was made to register two Home") ||
-				contains(trimmedLine, "Failed to delete file") ||
-				contains(trimmedLine, "Did not successfully copy file") ||
-				contains(trimmedLine, "IOException received while copying or checking file") ||
-				contains(trimmedLine, "Error received while performing operation") ||
-				contains(trimmedLine, "Unable to extract data from cache data file") ||
-				contains(trimmedLine, "IOException received while operating on cache data file") ||
-				contains(trimmedLine, "Incorrect format for checksum file cache line") ||
-				contains(trimmedLine, "Checksum cache file nonexistent during load.  If you see this warning repeatedly") ||
-				contains(trimmedLine, "Null file passed to checksum cache") ||
-				contains(trimmedLine, "File System is immutable. Cannot create new file.") ||
-				contains(trimmedLine, "Invalidate transAttribute value") ||
-				contains(trimmedLine, "Registry is Not Defined") ||
-				contains(trimmedLine, "Missing the Security Configuration") ||
-				contains(trimmedLine, "Missing Default Access Control List") ||
-				contains(trimmedLine, "unknown JDBC types for property") ||
-
-				// from /atg/nucleus/servlet/NucleusServletResources.properties
-				contains(trimmedLine, "***** ERROR:  Could not get ServletContext for atg_bootstrap.war") ||
-				contains(trimmedLine, "Failing NucleusServlet startup") ||
-				contains(trimmedLine, "Nucleus was not properly initialized") ||
-				contains(trimmedLine, "RuntimeException caught by proxy servlet") ||
-				contains(trimmedLine, "NucleusServlet: Could not load class") ||
-				contains(trimmedLine, "NucleusServlet: Could not instantiate class") ||
-				contains(trimmedLine, "NucleusServlet: IllegalAccessException while invoking initializer") ||
-				contains(trimmedLine, "NucleusServlet: NoSuchMethodException while invoking initializer") ||
-				contains(trimmedLine, "NucleusServlet: InvocationTargetException while invoking initializer") ||
-				contains(trimmedLine, "Cannot determine Nucleus configpath root.") ||
-				contains(trimmedLine, "NucleusServlet: can't set init properties") ||
-				contains(trimmedLine, "ERROR: no system nucleus after launching") ||
-				contains(trimmedLine, "NucleusServlet: can't set init properties") ||
-				contains(trimmedLine, "Nucleus failed to start") ||
-				contains(trimmedLine, "Error spawning a local nucleus for context") ||
-				contains(trimmedLine, "Error stopping nucleus") ||
-				contains(trimmedLine, "Could not get the class for the JBoss TransactionManagerFactory") ||
-				contains(trimmedLine, "does not have a method named") ||
-				contains(trimmedLine, "Could not get the class for the IBM TransactionManagerFactory") ||
-				contains(trimmedLine, "Error encountered while initializing Nucleus servlet") ||
-
-				contains(trimmedLine, "adding form exception:") ||
-				contains(trimmedLine, "SystemErr     R 	at ") ||
-
-				contains(trimmedLine, "An error occurred at line:") ||
-				contains(trimmedLine, "Generated servlet error:") ||
-				contains(trimmedLine, "could not be found. Please ensure that the JNDI name in the weblogic-ejb-jar.xml") ||
-				startsWith(trimmedLine, "Caught exception in ") ||
-				contains(trimmedLine, "Marking this deployment as FAILED") ||
-				contains(trimmedLine, "Invalid object name '") ||
-				contains(trimmedLine, "Can't find element with id=") ||
-				contains(trimmedLine, "*** unable to find GSARepository component:") ||
-				contains(trimmedLine, "Nested exception is:") ||
-				contains(trimmedLine, "OutOfMemoryException") ||
-				endsWith(trimmedLine, " cannot be resolved") ||
-				startsWith(trimmedLine, "Error:") ||
-				startsWith(trimmedLine, "log4j:ERROR") ||
-				contains(trimmedLine, "ERROR:") ||
-				startsWith(trimmedLine, "Nested Exception is") ||
-				contains(trimmedLine, "message = Deployment Failed time") ||
-				contains(trimmedLine, "atg.deployment.DeploymentFailure@") ||
-				contains(trimmedLine, "has more than one primary table defined") ||
-				contains(trimmedLine, "specifies a component-item-type or component-data-type attribute for a single value property") ||
-				contains(trimmedLine, "has super-type product but no sub-type attribute") ||
-				startsWith(trimmedLine, "Stacktrace:") ||
-				contains(trimmedLine, "Ensure that the first WebLogic Server is completely shutdown and restart the server") ||
-				contains(trimmedLine, "The WebLogic Server did not start up properly.") ||
-				contains(trimmedLine, "[STDOUT] java.lang.OutOfMemoryError") ||
-				contains(trimmedLine, "[STDOUT] AxisFault") ||
-				startsWith(trimmedLine, "faultCode:") ||
-				endsWith(trimmedLine, "faultSubcode:") ||
-				endsWith(trimmedLine, "faultActor:") ||
-				startsWith(trimmedLine, "faultString:") ||
-				startsWith(trimmedLine, "AxisFault") ||
-				startsWith(trimmedLine, "Fault occurred in processing") ||
-				endsWith(trimmedLine, "faultNode:") ||
-				endsWith(trimmedLine, "faultDetail:"))
-				{
-					return true;
-				}
-				return false;
+// this is called on SIGHUP. only wakes up the reloader thread, which does the actual work
+void hangupCatcher(int /*sig*/)
+{
+	int savedErrno = errno;
+	char request = RELOAD_REQUEST;
+	(void) write(reloadPipe[1], &request, 1);
+	errno = savedErrno;
 }
 
 /*
- *	these booleans are for specific conditions that often happen in log files. for instance,
- *	you may see the following in a log:
- *		[4/6/07 9:58:53:799 EDT] 0000000a SystemOut     O /atg/dynamo/security/AdminSqlRepository       SQL Statement Failed: [++SQLInsert++]
- *		INSERT INTO das_account(account_name,type,description,lastpwdupdate)
- *		VALUES(?,?,?,?)
- *		-- Parameters --
- *		p[1] = {pd} tools-integrations-privilege (java.lang.String)
- *		p[2] = {pd: type} 4 (java.lang.Integer)
- *		p[3] = {pd: description} Tools: Integrations (java.lang.String)
- *		p[4] = {pd: lastPasswordUpdate} 2007-04-06 09:58:51.221 (java.sql.Timestamp)
- *		[--SQLInsert--]
- *	Everything past the first line is printed to the screen via SOP. If the below method encounters
- *	"-- Parameters --" it's a dead give-away that we've hit this scenario. In that instance,
- *	isSQLDebug is set to true and the subsequent lines are colored red until "--SQLInsert--"
- *	is encountered, which signals the end of that condition. Had this logic not been there, those
- *	SOP's would have been colored as "other" lines. jbossObjectNameDump and the rest of the booleans
- *	are for similar logic. it sure would be nice if each line were prefixed with the appropriate line type
- */
-
-bool jbossObjectNameDump = false;
-bool jbossTableDebug = false;
-bool isWebSphere = false;
-bool isJBoss = false;
-bool isWebLogic = false;
-bool isSQLDebug = false;
-bool isClassPath = false;
-bool isConfigPath = false;
-bool isJBossInterceptorChain = false;
-bool isJBossNamingFactory = false;
-bool isWSError = false;
-bool isThreadDump = false;
-
-/*
- *	given a specific line in a log file along with arrays containing previous lines and their
- *  types, this method returns its type. there isn't any magic to this. i've poured over
- *  hundreds of thousands of log files from JBoss, DAS, WebSphere, and WebLogic to determine
- *  their individual patterns. unfortunately, not everybody uses log4j and even when log4j is
- *  used, it's often mis-configured or there are weird SOP's and that kind of thing. this
- *  method is pretty much a whole bunch of if/else's. it returns one of six line types:
- *  INFO_LINE, WARNING_LINE, DEBUG_LINE, ERROR_LINE, OTHER_LINE, and NUCLEUS_LINE
- */
-int determineLineType(string line, string trimmedLine, int previousLineTypes[], string previousLines[], string previousLinesTrimmed[])
+	called by the classifier thread between two batches. returns the rule set published since the
+	last call, NULL when there's none, and the streams have to switch to it. activeRules is stored
+	before the streams use the set and checked against publishedRules again, so the reloader can't
+	free a set between the two
+*/
+atgc_rules* takeReloadedRules()
 {
-	// most recent items are in the first positions of the array
-	int previousLineType = previousLineTypes[0];
-	string trimmedPreviousLine = previousLinesTrimmed[0];
-
-	// I'm assuming here that this is always the last thread in the dump. If so, break out of loop
-	if (contains(trimmedLine, "VM Periodic Task Thread") || contains(trimmedLine, "Suspend Checker Thread"))
+	atgc_rules* rules = publishedRules.load();
+	if (rules == activeRules.load(memory_order_relaxed))
 	{
-		isThreadDump=false;
-		return INFO_LINE;
+		return NULL;
 	}
-
-	if (startsWith(trimmedLine, "Full thread dump Java HotSpot"))
+	while (true)
 	{
-		isThreadDump=true;
+		activeRules.store(rules);
+		atgc_rules* latest = publishedRules.load();
+		if (latest == rules)
+		{
+			break;
+		}
+		rules = latest;
 	}
+	return rules;
+}
 
-	if (isThreadDump)
+void pickUpReloadedRules(atgc_stream* stream)
+{
+	atgc_rules* rules = takeReloadedRules();
+	if (rules != NULL)
 	{
-		return INFO_LINE;
+		atgc_stream_set_rules(stream, rules);
 	}
+}
 
-	// is output from websphere?
-	if (
-			!isJBoss &&      // once app server type is determined, skip the check for subsequent lines
-			!isWebSphere &&
-			!isWebLogic &&
-			(
-				contains(trimmedLine, "WebSphere Platform") ||
-				contains(trimmedLine, "ATG starting on IBM WebSphere")
-			)
-		)
-	{
-		isWebSphere = true;
-	}
-	// or is it from jboss?
-	else if (
-				!isWebSphere &&
-				!isJBoss &&
-				!isWebLogic &&
-				(
-					contains(trimmedLine, "Starting JBoss") ||
-					contains(trimmedLine, " DEBUG [org.jboss") ||
-					contains(trimmedLine, "org.jboss.system") ||
-					contains(trimmedLine, "org.jboss.logging")
-				)
-			)
+// compiles the rule files again and publishes the result. a broken rule file keeps the old rules
+void reloadRules(const vector<const char*>& rulePaths, const char* cacheFileName, vector<atgc_rules*>& retired)
+{
+	char ruleError[512];
+	atgc_rules* rules = atgc_rules_load(rulePaths.empty() ? NULL : &rulePaths[0], rulePaths.size(), cacheFileName, ruleError, sizeof(ruleError));
+	if (rules == NULL)
 	{
-		isJBoss = true;
+		fprintf(stderr, "Rules not reloaded: %s\n", ruleError);
+		return;
 	}
-	else if (
-				!isWebSphere &&
-				!isJBoss &&
-				!isWebLogic &&
-				(
-						startsWith(trimmedLine, "WebLogic Server") ||
-						contains(trimmedLine, "WLS Kernel")
-				)
-			)
+	retired.push_back(publishedRules.exchange(rules));
+	fprintf(stderr, "Rules reloaded, %lu rules\n", (unsigned long) atgc_rules_count(rules));
+}
+
+// destroys the replaced rule sets the classifier thread doesn't use anymore
+void reclaimRules(vector<atgc_rules*>& retired)
+{
+	atgc_rules* active = activeRules.load();
+	for (size_t i = 0; i < retired.size(); )
 	{
-		isWebLogic=true;
+		if (retired[i] != active)
+		{
+			atgc_rules_destroy(retired[i]);
+			retired[i] = retired.back();
+			retired.pop_back();
+		}
+		else
+		{
+			i++;
+		}
 	}
+}
 
-	/*
-		// jbossObjectNameDump is a boolean representing whether the current line is the first
-		// in the example below. If so, subsequent lines should be colored debug to match, as
-		// they're really part of the same statement
-		2006-06-26 14:34:47,671 DEBUG [org.jboss.system.ServiceController] Creating dependent components for: jboss:service=proxyFactory,target=ClientUserTransaction dependents are: [ObjectName: jboss:service=ClientUserTransaction
-		State: CONFIGURED
-		I Depend On:
-			jboss:service=proxyFactory,target=ClientUserTransactionFactory
-			jboss:service=proxyFactory,target=ClientUserTransaction
-		]
-	*/
-	if (
-			!jbossObjectNameDump &&
-			contains(trimmedLine, "[ObjectName:") &&
-			contains(trimmedLine, " DEBUG [") &&
-			contains(trimmedLine, "jboss")
-		)
-	{
-		jbossObjectNameDump = true;
-	}
-	else if (
-				jbossObjectNameDump &&
-				endsWith(trimmedLine, "]") &&
-				!contains(trimmedLine, " INFO  [STDOUT]")
-			)
-	{
-		jbossObjectNameDump = false;
-		return DEBUG_LINE;
-	}
-	if (jbossObjectNameDump)
-	{
-		return DEBUG_LINE;
-	}
+/*
+	the reloader thread. waits for SIGHUP (through reloadPipe) or a line on the control fifo. the
+	only command on the fifo is "reload", eg. echo reload > /tmp/colorizer.ctl
+*/
+void reloader(vector<const char*> rulePaths, const char* cacheFileName, int control)
+{
+	vector<atgc_rules*> retired;
+	string command;
+	bool stopping = false;
+
+	while (!stopping || !retired.empty())
+	{
+		struct pollfd fds[2];
+		fds[0].fd = reloadPipe[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = control;
+		fds[1].events = POLLIN;
+		int ready = poll(fds, (control >= 0 && !stopping ? 2 : 1), (retired.empty() ? -1 : RECLAIM_INTERVAL_MS));
+		if (ready < 0 && errno != EINTR)
+		{
+			break;
+		}
 
-	/*
-		2007-04-11 16:59:02,474 DEBUG [org.jboss.services.binding.AttributeMappingDelegate] setAttribute, name='Properties', text=java.naming.factory.initial=org.jnp.interfaces.NamingContextFactory
-						java.naming.factory.url.pkgs=org.jboss.naming:org.jnp.interfaces
-						java.naming.provider.url=0.0.0.0:1200
-						jnp.disableDiscovery=false
-						jnp.partitionName=DefaultPartition
-						jnp.discoveryGroup=230.0.0.4
-						jnp.discoveryPort=1102
-						jnp.discoveryTTL=16
-						jnp.discoveryTimeout=5000
-						jnp.maxRetries=1, value={java.naming.factory.initial=org.jnp.interfaces.NamingContextFactory, jnp.partitionName=DefaultPartition, jnp.discoveryTimeout=5000, jnp.discoveryGroup=230.0.0.4, jnp.disableDiscovery=false, java.naming.provider.url=0.0.0.0:1200, java.naming.factory.url.pkgs=org.jboss.naming:org.jnp.interfaces, jnp.maxRetries=1, jnp.discoveryPort=1102, jnp.discoveryTTL=16}
-		2007-04-11 16:59:02,474 DEBUG [org.jboss.system.ServiceCreator] About to create bean: jboss.mq:service=ServerSessionPoolMBean,name=StdJMSPool with code: org.jboss.jms.asf.ServerSessionPoolLoader
-	*/
-	if (
-			!isJBossNamingFactory &&
-			isJBoss &&
-			endsWith(trimmedLine, "NamingContextFactory") &&
-			contains(trimmedLine, " DEBUG [")
-		)
-	{
-		isJBossNamingFactory = true;
+		bool reload = false;
+		char buffer[256];
+		if (ready > 0 && (fds[0].revents & POLLIN))
+		{
+			ssize_t bytesRead = read(reloadPipe[0], buffer, sizeof(buffer));
+			for (ssize_t i = 0; i < bytesRead; i++)
+			{
+				reload = reload || buffer[i] == RELOAD_REQUEST;
+				stopping = stopping || buffer[i] == STOP_REQUEST;
+			}
+		}
+		if (ready > 0 && control >= 0 && (fds[1].revents & POLLIN))
+		{
+			ssize_t bytesRead;
+			while ((bytesRead = read(control, buffer, sizeof(buffer))) > 0)
+			{
+				command.append(buffer, bytesRead);
+			}
+			size_t newline;
+			while ((newline = command.find('\n')) != string::npos)
+			{
+				string line = command.substr(0, newline);
+				command.erase(0, newline + 1);
+				if (line == "reload")
+				{
+					reload = true;
+				}
+				else if (!line.empty())
+				{
+					fprintf(stderr, "Unknown command on the control fifo: %s\n", line.c_str());
+				}
+			}
+		}
+
+		if (reload && !stopping)
+		{
+			reloadRules(rulePaths, cacheFileName, retired);
+		}
+		reclaimRules(retired);
 	}
-	else if (
-				isJBossNamingFactory &&
-				isJBoss &&
-				contains(trimmedLine, "[")
-			)
+}
+
+// what a line held back by the renderer adds to the next render
+size_t heldSize(const RenderedOutput& output)
+{
+	return (output.format == OUTPUT_HTML ? atgc_html_pending_size(output.html) : 0);
+}
+
+size_t maxRenderedSize(const RenderedOutput& output, size_t length)
+{
+	if (output.format == OUTPUT_NDJSON)
 	{
-		isJBossNamingFactory = false;
-		return DEBUG_LINE;
+		return atgc_json_max_rendered_size(length);
 	}
-	if (isJBossNamingFactory)
+	if (output.format == OUTPUT_HTML)
 	{
-		return DEBUG_LINE;
+		return atgc_html_max_rendered_size(length);
 	}
+	return output.prefix.size() + atgc_theme_max_rendered_size(colorTheme, length);
+}
 
-	if (
-			!jbossTableDebug &&
-			endsWith(trimmedLine, "(") &&
-			contains(trimmedLine, " DEBUG [") &&
-			contains(trimmedLine, "table") &&
-			contains(trimmedLine, "jboss")
-		)
-	{
-		jbossTableDebug = true;
-	}
-	else if (jbossTableDebug && startsWith(trimmedLine, ")"))
+// renders lines after what's already in the output, which has to have room for them
+void renderLines(RenderedOutput& output, const char* const* lines, const size_t* lengths, const int* types, size_t count)
+{
+	char* out = &output.bytes[output.used];
+	size_t capacity = output.bytes.size() - output.used;
+	if (output.format == OUTPUT_NDJSON)
 	{
-		jbossTableDebug = false;
-		return DEBUG_LINE;
+		output.used += atgc_json_render_batch(lines, lengths, types, count, output.serverType, out, capacity, NULL);
 	}
-
-	if (jbossTableDebug)
+	else if (output.format == OUTPUT_HTML)
 	{
-		return DEBUG_LINE;
+		output.used += atgc_html_render_batch(output.html, lines, lengths, types, count, out, capacity, NULL);
 	}
-
-	/*
-		2007-04-11 16:58:57,359 INFO  [org.jboss.cache.factories.InterceptorChainFactory] interceptor chain is:
-		class org.jboss.cache.interceptors.CallInterceptor
-		class org.jboss.cache.interceptors.PessimisticLockInterceptor
-		class org.jboss.cache.interceptors.UnlockInterceptor
-		class org.jboss.cache.interceptors.ReplicationInterceptor
-		class org.jboss.cache.interceptors.TxInterceptor
-		class org.jboss.cache.interceptors.CacheMgmtInterceptor
-	*/
-
-		if (
-				isJBoss &&
-				!isJBossInterceptorChain &&
-				(
-					endsWith(trimmedLine, "interceptor chain is:")
-				)
-		)
+	else if (output.prefix.empty())
 	{
-		isJBossInterceptorChain = true;
+		output.used += atgc_theme_render_batch(colorTheme, lines, lengths, types, count, out, capacity, NULL);
 	}
-	else if (
-				isJBoss &&
-				isJBossInterceptorChain &&
-				!startsWith(trimmedLine, "class org.")
-			)
+	else
 	{
-		isJBossInterceptorChain = false;
+		// the prefix goes in front of each line, outside of its color
+		for (size_t i = 0; i < count; i++)
+		{
+			memcpy(&output.bytes[output.used], output.prefix.data(), output.prefix.size());
+			output.used += output.prefix.size();
+			output.used += atgc_theme_render_batch(colorTheme, lines + i, lengths + i, types + i, 1, &output.bytes[output.used], output.bytes.size() - output.used, NULL);
+		}
 	}
+}
 
-	if (isJBossInterceptorChain)
+// colors a line let through by the trace folder
+void renderLine(void* context, const char* line, size_t length, int lineType)
+{
+	RenderedOutput* output = (RenderedOutput*) context;
+	size_t offsets[MAX_HIGHLIGHTS];
+	size_t lengths[MAX_HIGHLIGHTS];
+	size_t found = (output->highlight != NULL ? atgc_filter_find(output->highlight, line, length, offsets, lengths, MAX_HIGHLIGHTS) : 0);
+	size_t needed = output->used + maxRenderedSize(*output, length) + heldSize(*output) + atgc_theme_max_highlighted_size(colorTheme, 0, found);
+	if (output->bytes.size() < needed)
 	{
-		return INFO_LINE;
+		output->bytes.resize(needed * 2);
 	}
-	/*
-		[4/6/07 9:58:53:799 EDT] 0000000a SystemOut     O /atg/dynamo/security/AdminSqlRepository       SQL Statement Failed: [++SQLInsert++]
-		INSERT INTO das_account(account_name,type,description,lastpwdupdate)
-		VALUES(?,?,?,?)
-		-- Parameters --
-		p[1] = {pd} tools-integrations-privilege (java.lang.String)
-		p[2] = {pd: type} 4 (java.lang.Integer)
-		p[3] = {pd: description} Tools: Integrations (java.lang.String)
-		p[4] = {pd: lastPasswordUpdate} 2007-04-06 09:58:51.221 (java.sql.Timestamp)
-		[--SQLInsert--]
-	*/
-
-		if (
-				!isSQLDebug &&
-				(
-					contains(trimmedLine, "SQL Statement Failed: [++SQLInsert++]") ||
-					contains(trimmedLine, "SQL Statement Failed: [++SQLUpdate++]") ||
-					contains(trimmedLine, "SQL Statement Failed: [++SQLDelete++]") ||
-					contains(trimmedLine, "SQL Statement Failed: [++SQLSelect++]")
-				)
-		)
-	{
-		isSQLDebug = true;
-	}
-	else if (
-				isSQLDebug &&
-				(
-					contains(trimmedLine, "[--SQLInsert--]") ||
-					contains(trimmedLine, "[--SQLUpdate--]") ||
-					contains(trimmedLine, "[--SQLDelete--]") ||
-					contains(trimmedLine, "[--SQLSelect--]")
-				)
-			)
-	{
-		isSQLDebug = false;
-		return ERROR_LINE;
-	}
-
-	if (isSQLDebug)
-	{
-		return ERROR_LINE;
+	if (found > 0)
+	{
+		memcpy(&output->bytes[output->used], output->prefix.data(), output->prefix.size());
+		output->used += output->prefix.size();
+		output->used += atgc_theme_render_highlighted(colorTheme, line, length, lineType, offsets, lengths, found, &output->bytes[output->used], output->bytes.size() - output->used);
+		return;
 	}
+	renderLines(*output, &line, &length, &lineType, 1);
+}
 
-/*
-	2007-04-10 18:22:14,593 ERROR [com.primus.routing.RoutedServerRequestOnly] Request to server URL: http://localhost:6072/AEXmlService/ failed on the below soap request
-	. More details will follow. <?xml version="1.0"?><query version="4.0" responseNumberSettings="doc5,perDoc3,ans5,perAns1,f2,s5,d0,t5" minScore="300" sorting="SCORE" RQ
-	Text="ANSWER" exclusion="" client="AE Web Client" debug="false" QUID="123"><question>Are you there?</question><clustername></clustername><documentSets><and><or><set s
-	ubdirs="true">/</set></or><or><set subdirs="true">/</set></or></and></documentSets><parserOptions><context>company</context><context>computer</context><usageI>person<
-	/usageI><usageWe>person</usageWe><usageYou>person</usageYou><language>english</language></parserOptions></query>
-	2007-04-10 18:22:14,593 ERROR [com.primus.routing.api.RoutingServerEJBBean] Request for
-			Cluster: DefaultCluster
-			Group: 1
-			Server: 80, http://localhost:6072/AEXmlService/
-	failed on request (stack trace to follow):
-	<?xml version="1.0"?><query version="4.0" responseNumberSettings="doc5,perDoc3,ans5,perAns1,f2,s5,d0,t5" minScore="300" sorting="SCORE" RQText="ANSWER" exclusion="" c
-	lient="AE Web Client" debug="false" QUID="123"><question>Are you there?</question><clustername></clustername><documentSets><and><or><set subdirs="true">/</set></or><o
-	r><set subdirs="true">/</set></or></and></documentSets><parserOptions><context>company</context><context>computer</context><usageI>person</usageI><usageWe>person</usa
-	geWe><usageYou>person</usageYou><language>english</language></parserOptions></query>
-*/
-if (
-	!isWSError &&
-	(
-		endsWith(trimmedLine, "] Request for") &&
-		contains(trimmedLine, " ERROR [")
-	)
-		)
+void writeOutput(RenderedOutput& output)
+{
+	// nothing rendered yet, as with --report and --stats, and bytes may still be empty
+	if (output.used == 0)
 	{
-		isWSError = true;
+		return;
 	}
-	else if (
-				isWSError &&
-				(
-					contains(trimmedLine, "[") ||
-					contains(trimmedLine, "]")
-				)
-			)
+	ATGC_PROBE1(batch_flush, output.used);
+	if (output.sink != NULL)
 	{
-		isWSError = false;
+		output.sink->insert(output.sink->end(), output.bytes.begin(), output.bytes.begin() + output.used);
 	}
-
-	if (isWSError)
+	else
 	{
-		return ERROR_LINE;
+		fwrite(&output.bytes[0], 1, output.used, stdout);
 	}
+	output.used = 0;
+}
 
+// milliseconds from some fixed point, for the storm collapser
+unsigned long long monotonicMs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
 
-	/*
-		[4/9/07 11:22:23:683 EDT] 0000004c NucleusServle I atg.nucleus.servlet.NucleusServlet initBigEarNucleus CLASSPATH=
-
-			C:\IBM\WebSphere\AppServer\java\lib,
-			C:\IBM\WebSphere\AppServer\java\lib\dt.jar,
-			C:\IBM\WebSphere\AppServer\java\lib\htmlconverter.jar,
-			C:\IBM\WebSphere\AppServer\java\lib\tools.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\classes,
-			C:\IBM\WebSphere\AppServer\lib,
-			C:\IBM\WebSphere\AppServer\lib\AMJACCProvider.jar,
-			C:\IBM\WebSphere\AppServer\lib\DDParser5.jar,
-			C:\IBM\WebSphere\AppServer\lib\EJBCommandTarget.jar,
-			C:\IBM\WebSphere\AppServer\lib\IVTClient.jar,
-			C:\IBM\WebSphere\AppServer\lib\PDWASAuthzManager.jar,
-			C:\IBM\WebSphere\AppServer\lib\UDDICloudscapeCreate.jar,
-			C:\IBM\WebSphere\AppServer\lib\UDDIValueSetTools.jar,
-			C:\IBM\WebSphere\AppServer\lib\WebSealTAIwas6.jar,
-	*/
-	if (
-			!isClassPath &&
-			endsWith(trimmedLine, "CLASSPATH=") &&
-			(
-				startsWith(trimmedLine, "C:") ||
-				startsWith(trimmedLine, "D:") ||
-				startsWith(trimmedLine, "/") ||
-				startsWith(trimmedLine, "vfs=") ||
-				startsWith(trimmedLine, "ATG-Data") ||
-				startsWith(trimmedLine, "")
-			)
-		)
-	{
-		isClassPath = true;
-		return INFO_LINE;
-	}
-	else if (isClassPath)
-	{
-		if (
-				startsWith(trimmedLine, "C:") ||
-				startsWith(trimmedLine, "D:") ||
-				startsWith(trimmedLine, "/") ||
-				startsWith(trimmedLine, "vfs=") ||
-				startsWith(trimmedLine, "ATG-Data")
-			)
-		{
-			return INFO_LINE;
-		}
-		else
-		{
-			isClassPath = false;
-		}
-	}
+// the same in nanoseconds, for --latency and --metrics
+unsigned long long monotonicNs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 
+// the time stamp counter, or nanoseconds where there's none
+unsigned long long stageTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return monotonicNs();
+#endif
+}
 
-	/*
-		CONFIGPATH=
-
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DAS\config\config.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DAS\config\oca-ldap.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DAS-UI\config\uiconfig.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\targeting.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\oca-cms.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\oca-html.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\oca-xml.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\userprofiling.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\profile.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DSS\config\config.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DafEar\base\config\dafconfig.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DafEar\WebSphere\config\wsconfig.jar,
-			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\home\localconfig,
-			ATG-Data\localconfig
-	*/
-	if (!isConfigPath && endsWith(trimmedLine, "CONFIGPATH="))
-	{
-		isConfigPath = true;
-		return INFO_LINE;
-	}
-	else if (isConfigPath)
-	{
-		if (
-				startsWith(trimmedLine, "C:") ||
-				startsWith(trimmedLine, "D:") ||
-				startsWith(trimmedLine, "/") ||
-				startsWith(trimmedLine, "vfs=") ||
-				startsWith(trimmedLine, "ATG-Data")
-			)
-		{
-			return INFO_LINE;
-		}
-		else
-		{
-			isConfigPath = false;
-		}
-	}
+// true when the stage is timed on this read
+bool timedStage(const StageMeter* stages, int stage)
+{
+	return stages != NULL && (stages->sampling || stage == STAGE_READ || stage == STAGE_WRITE);
+}
 
+// when the stage starts, if it's timed
+unsigned long long beginStage(const StageMeter* stages, int stage)
+{
+	return (timedStage(stages, stage) ? stageTicks() : 0);
+}
 
-	if (
-				contains(trimmedLine, "Throwable while attempting to get a new connection") ||
-				contains(trimmedLine, "Exception destroying ManagedConnection") ||
-				contains(trimmedLine, "ConcurrentUpdateException caught updating an item during a commit") ||
-				contains(trimmedLine, "XAException: tx=") ||
-				contains(trimmedLine, "] Failed to connect to ") ||
-				contains(trimmedLine, "java.lang.NoClassDefFoundError") ||
-				contains(trimmedLine, "Error registering request") ||
-				contains(trimmedLine, "java.lang.NullPointerException") ||
-				contains(trimmedLine, "Illegal access: this web application instance has been stopped already.")
-		)
+void endStage(StageMeter* stages, int stage, unsigned long long since)
+{
+	if (timedStage(stages, stage))
 	{
-		return ERROR_LINE;
+		stages->ticks[stage] += stageTicks() - since;
 	}
-	else if (
-				contains(trimmedLine, "Nucleus running") ||
-				contains(trimmedLine, "Starting Nucleus") ||
-				contains(trimmedLine, "Invoking custom Nucleus") ||
-				contains(trimmedLine, "Nucleus shutting down") ||
-				contains(trimmedLine, "Nucleus shutdown complete") ||
-				contains(trimmedLine, "Nucleus not running")
-			)
+}
+
+// decides whether the next read is one of the sampled ones
+void sampleRead(StageMeter* stages)
+{
+	if (stages != NULL)
 	{
-		return NUCLEUS_LINE;
+		stages->sampling = (stages->reads++ % STAGE_SAMPLE_INTERVAL == 0);
+		stages->sampledReads += (stages->sampling ? 1 : 0);
 	}
+}
 
-	// DAS prefixes all lines with **** type
-	else if (contains(trimmedLine, "**** Error"))
+// a line the filter let through goes on to the trace folder or straight to the renderer
+void passFiltered(void* context, const char* line, size_t length, int lineType)
+{
+	Pipeline* pipeline = (Pipeline*) context;
+	pipeline->counters.filterOut += (pipeline->filter != NULL ? 1 : 0);
+	if (pipeline->folder != NULL)
 	{
-		return ERROR_LINE;
+		atgc_folder_add(pipeline->folder, line, length, lineType, renderLine, &pipeline->output);
 	}
-	else if (contains(trimmedLine, "**** info"))
+	else
 	{
-		return INFO_LINE;
+		renderLine(&pipeline->output, line, length, lineType);
 	}
-	else if (contains(trimmedLine, "**** debug"))
+}
+
+// a line the storm collapser let through, or one of its summaries, goes on to the filter when there is one
+void passCollapsed(void* context, const char* line, size_t length, int lineType)
+{
+	Pipeline* pipeline = (Pipeline*) context;
+	pipeline->output.serverType = atgc_server_type(pipeline->stream);
+	if (metricsFile != NULL)
 	{
-		return DEBUG_LINE;
+		pipeline->counters.types[lineType]++;
 	}
-	else if (contains(trimmedLine, "**** Debug"))
+	if (pipeline->filter != NULL)
 	{
-		return DEBUG_LINE;
+		pipeline->counters.filterIn++;
+		atgc_filter_add(pipeline->filter, line, length, lineType, passFiltered, pipeline);
 	}
-	else if (contains(trimmedLine, "**** Warning"))
+	else
 	{
-		return WARNING_LINE;
+		passFiltered(pipeline, line, length, lineType);
 	}
+}
 
-	// JBoss/log4j
-	// if running JBoss without log4j correctly confirgured, everything from ATG will come through INFO  [STDOUT]
-	else if (contains(trimmedLine, " INFO  [") && !contains(trimmedLine, "INFO  [STDOUT]"))
-	{
-		return INFO_LINE;
-	}
-	else if (contains(trimmedLine, " WARN  ["))
-	{
-		return WARNING_LINE;
-	}
-	else if (contains(trimmedLine, " ERROR ["))
+// colors lines after what's already in the output, through the filter and the trace folder when there are
+void renderBatch(Pipeline& pipeline, const char* const* lines, const size_t* lengths, const int* types, size_t count)
+{
+	RenderedOutput& output = pipeline.output;
+	if (pipeline.filter != NULL)
 	{
-		return ERROR_LINE;
+		pipeline.counters.filterIn += count;
+		atgc_filter_add_batch(pipeline.filter, lines, lengths, types, count, passFiltered, &pipeline);
+		return;
 	}
-	else if (contains(trimmedLine, " FATAL ["))
+	if (pipeline.folder != NULL)
 	{
-		return ERROR_LINE;
+		for (size_t i = 0; i < count; i++)
+		{
+			atgc_folder_add(pipeline.folder, lines[i], lengths[i], types[i], renderLine, &output);
+		}
+		return;
 	}
 
-
-	// 2007-02-26 15:37:18,723 DEBUG [org.jboss.mq.pm.jdbc2.PersistenceManager] Could not create table with SQL: CREATE CACHED TABLE JMS_MESSAGES ( MESSAGEID INTEGER NOT NULL, DESTINATION VARCHAR(255) NOT NULL, TXID INTEGER, TXOP CHAR(1), MESSAGEBLOB OBJECT, PRIMARY KEY (MESSAGEID, DESTINATION) )
-	else if (contains(trimmedLine, "Could not create table with SQL"))
+	size_t needed = output.used + heldSize(output);
+	for (size_t i = 0; i < count; i++)
 	{
-		return ERROR_LINE;
+		needed += maxRenderedSize(output, lengths[i]);
 	}
-	else if (contains(trimmedLine, " DEBUG ["))
+	if (output.bytes.size() < needed)
 	{
-		return DEBUG_LINE;
+		output.bytes.resize(needed);
 	}
+	renderLines(output, lines, lengths, types, count);
+}
 
-	// from tomcat
-	else if (contains(trimmedLine, "{INFO}"))
+// with --collapse-blocks, the line an ENVIRONMENT, CLASSPATH or CONFIGPATH dump is reduced to
+void closeBlock(Pipeline& pipeline)
+{
+	if (pipeline.openBlock == ATGC_BLOCK_NONE)
 	{
-		return INFO_LINE;
+		return;
 	}
-	else if (contains(trimmedLine, "{CONFIG}"))
+	char summary[64];
+	snprintf(summary, sizeof(summary), "\t... %lu %s entries", pipeline.blockEntries, BLOCK_NAMES[pipeline.openBlock]);
+	const char* line = summary;
+	size_t length = strlen(summary);
+	int lineType = ATGC_INFO_LINE;
+	renderBatch(pipeline, &line, &length, &lineType, 1);
+	pipeline.counters.blockEntries += pipeline.blockEntries;
+	pipeline.openBlock = ATGC_BLOCK_NONE;
+	pipeline.blockEntries = 0;
+}
+
+/*
+ *	colors the lines but for the entries of a dump, which are only counted. the dump can go on
+ *	in the next batch, so its summary line goes out with the first line that isn't one of them
+ */
+void collapseBlocks(Pipeline& pipeline, const char* const* lines, const size_t* lengths, const int* types, const int* blocks, size_t count)
+{
+	size_t run = 0; // first line not rendered yet
+	for (size_t i = 0; i < count; i++)
 	{
-		return INFO_LINE;
+		if (blocks[i] != ATGC_BLOCK_NONE && blocks[i] == pipeline.openBlock)
+		{
+			pipeline.blockEntries++;
+			run = i + 1;
+			continue;
+		}
+		closeBlock(pipeline);
+		if (blocks[i] != ATGC_BLOCK_NONE)
+		{
+			renderBatch(pipeline, lines + run, lengths + run, types + run, i - run);
+			pipeline.openBlock = blocks[i];
+			pipeline.blockEntries = 1;
+			run = i + 1;
+		}
 	}
-	else if (contains(trimmedLine, "{WARN}"))
-	{
-		return WARNING_LINE;
+	renderBatch(pipeline, lines + run, lengths + run, types + run, count - run);
+}
+
+// classifies and colors a batch of lines, then writes them out with a single fwrite
+void processLines(Pipeline& pipeline, const char** lines, size_t* lengths, size_t count)
+{
+	int types[MAX_BATCH_LINES];
+	int blocks[MAX_BATCH_LINES];
+	RenderedOutput& output = pipeline.output;
+	pipeline.lines += count;
+	StageMeter* stages = pipeline.stages;
+	if (stages != NULL)
+	{
+		stages->lines += count;
+		stages->sampledLines += (stages->sampling ? count : 0);
+	}
+	unsigned long long ticks = beginStage(stages, STAGE_CLASSIFY);
+	if (pipeline.storm != NULL)
+	{
+		atgc_storm_classify_batch(pipeline.storm, pipeline.stream, lines, lengths, count, monotonicMs(), passCollapsed, &pipeline);
+		endStage(stages, STAGE_CLASSIFY, ticks);
+		ticks = beginStage(stages, STAGE_WRITE);
+		writeOutput(output);
+		endStage(stages, STAGE_WRITE, ticks);
+		return;
 	}
-	else if (contains(trimmedLine, "{ERROR}"))
+	unsigned long long classifyStartNs = (metricsFile != NULL ? monotonicNs() : 0);
+	if (pipeline.collapseBlocks)
 	{
-		return ERROR_LINE;
+		atgc_classify_batch_blocks(pipeline.stream, lines, lengths, count, types, blocks);
 	}
-	else if (contains(trimmedLine, "{FATAL}"))
+	else
 	{
-		return ERROR_LINE;
+		atgc_classify_batch(pipeline.stream, lines, lengths, count, types);
 	}
-	else if (contains(trimmedLine, "{DEBUG}"))
+	output.serverType = atgc_server_type(pipeline.stream);
+	endStage(stages, STAGE_CLASSIFY, ticks);
+	ticks = beginStage(stages, STAGE_RENDER);
+	if (metricsFile != NULL)
 	{
-		return DEBUG_LINE;
+		pipeline.counters.classifyNs += monotonicNs() - classifyStartNs;
+		pipeline.counters.classified += count;
+		for (size_t i = 0; i < count; i++)
+		{
+			pipeline.counters.types[types[i]]++;
+		}
 	}
 
-	else if (contains(trimmedLine, "info]"))
+	if (pipeline.exceptions != NULL || pipeline.stats != NULL || pipeline.threadDumps != NULL || pipeline.failedSQL != NULL)
 	{
-		return INFO_LINE;
+		for (size_t i = 0; i < count && pipeline.exceptions != NULL; i++)
+		{
+			atgc_exceptions_add(pipeline.exceptions, lines[i], lengths[i], types[i]);
+		}
+		for (size_t i = 0; i < count && pipeline.stats != NULL; i++)
+		{
+			atgc_stats_add(pipeline.stats, lines[i], lengths[i], types[i]);
+		}
+		for (size_t i = 0; i < count && pipeline.threadDumps != NULL; i++)
+		{
+			atgc_thread_dumps_add(pipeline.threadDumps, lines[i], lengths[i]);
+		}
+		for (size_t i = 0; i < count && pipeline.failedSQL != NULL; i++)
+		{
+			atgc_failed_sql_add(pipeline.failedSQL, lines[i], lengths[i], types[i]);
+		}
+		endStage(stages, STAGE_RENDER, ticks);
+		return;
 	}
-	else if (contains(trimmedLine, "config]"))
+
+	if (pipeline.collapseBlocks)
 	{
-		return INFO_LINE;
+		collapseBlocks(pipeline, lines, lengths, types, blocks, count);
 	}
-	else if (contains(trimmedLine, "warn]"))
+	else
 	{
-		return WARNING_LINE;
+		renderBatch(pipeline, lines, lengths, types, count);
 	}
-	else if (contains(trimmedLine, "error]"))
+	endStage(stages, STAGE_RENDER, ticks);
+	ticks = beginStage(stages, STAGE_WRITE);
+	writeOutput(output);
+	endStage(stages, STAGE_WRITE, ticks);
+}
+
+// true when the trace folder or the renderer is holding lines back, a dump is being collapsed or repeats counted
+bool holdingLines(const Pipeline& pipeline)
+{
+	return (pipeline.folder != NULL && atgc_folder_pending(pipeline.folder)) || heldSize(pipeline.output) > 0
+		|| pipeline.openBlock != ATGC_BLOCK_NONE || (pipeline.storm != NULL && atgc_storm_pending(pipeline.storm));
+}
+
+// writes out the lines the trace folder and the renderer are holding back, and the count of the repeats of a storm
+void releaseHeldLines(Pipeline& pipeline)
+{
+	RenderedOutput& output = pipeline.output;
+	closeBlock(pipeline);
+	if (pipeline.storm != NULL)
 	{
-		return ERROR_LINE;
+		atgc_storm_flush(pipeline.storm, monotonicMs(), passCollapsed, &pipeline);
 	}
-	else if (contains(trimmedLine, "fatal]"))
+	if (pipeline.folder != NULL)
 	{
-		return ERROR_LINE;
+		atgc_folder_flush(pipeline.folder, renderLine, &output);
 	}
-	else if (contains(trimmedLine, "debug]"))
+	if (output.format == OUTPUT_HTML)
 	{
-		return DEBUG_LINE;
+		if (output.bytes.size() < output.used + heldSize(output))
+		{
+			output.bytes.resize(output.used + heldSize(output));
+		}
+		output.used += atgc_html_flush(output.html, &output.bytes[output.used], output.bytes.size() - output.used);
 	}
+	writeOutput(output);
+}
 
-
-
-	// weblogic
-	else if (contains(trimmedLine, "<Notice>"))
+// the start and the end of the page around the log
+void beginDocument(RenderedOutput& output)
+{
+	if (output.format == OUTPUT_HTML)
 	{
-		return INFO_LINE;
+		output.bytes.resize(max(output.bytes.size(), (size_t) ATGC_HTML_MAX_FRAME_SIZE));
+		output.used = atgc_html_begin(output.html, &output.bytes[0], output.bytes.size());
+		writeOutput(output);
 	}
-	else if (contains(trimmedLine, "<Info>"))
+}
+
+void endDocument(RenderedOutput& output)
+{
+	if (output.format == OUTPUT_HTML)
 	{
-		return INFO_LINE;
+		output.bytes.resize(max(output.bytes.size(), ATGC_HTML_MAX_FRAME_SIZE + heldSize(output)));
+		output.used = atgc_html_end(output.html, &output.bytes[0], output.bytes.size());
+		writeOutput(output);
 	}
-	else if (contains(trimmedLine, "<Alert>"))
+}
+
+// true when there's input to read, false when none came in for timeout milliseconds
+bool waitForInput(int fd, int timeout)
+{
+	struct pollfd input;
+	input.fd = fd;
+	input.events = POLLIN;
+	int ready;
+	while ((ready = poll(&input, 1, timeout)) < 0 && errno == EINTR)
 	{
-		return WARNING_LINE;
 	}
-	else if (contains(trimmedLine, "<Warning>"))
-	{
-		return WARNING_LINE;
+	return ready != 0;
+}
+
+/*
+ *	hands every complete line in input to the classifier, a batch at a time, and writes them out.
+ *	returns how many bytes were used up, the rest is the start of a line still being read. at the
+ *	end of the input, whatever is left is a last line that wasn't terminated by a newline, and
+ *	the lines held back are let through
+ */
+size_t processInput(Pipeline& pipeline, char* input, size_t filled, bool endOfInput)
+{
+	const char* lines[MAX_BATCH_LINES];
+	size_t lengths[MAX_BATCH_LINES];
+	size_t offset = 0;
+	size_t count = 0;
+	while (offset < filled)
+	{
+		char* newline = (char*) memchr(&input[offset], '\n', filled - offset);
+		if (newline == NULL && !endOfInput)
+		{
+			break;
+		}
+		size_t length = (newline != NULL ? newline - &input[offset] : filled - offset);
+		ATGC_PROBE1(line_read, length);
+		lines[count] = &input[offset];
+		lengths[count] = length;
+		count++;
+		offset += length + 1;
+		if (count == MAX_BATCH_LINES)
+		{
+			processLines(pipeline, lines, lengths, count);
+			count = 0;
+		}
 	}
-	else if (contains(trimmedLine, "<Error>"))
+	if (count > 0)
 	{
-		return ERROR_LINE;
+		processLines(pipeline, lines, lengths, count);
 	}
-	else if (contains(trimmedLine, "<Critical>"))
+	if (endOfInput)
 	{
-		return ERROR_LINE;
+		closeBlock(pipeline);
 	}
-	else if (contains(trimmedLine, "<Emergency>"))
+	if (endOfInput && pipeline.storm != NULL)
 	{
-		return ERROR_LINE;
+		atgc_storm_flush(pipeline.storm, monotonicMs(), passCollapsed, &pipeline);
 	}
-	else if (contains(trimmedLine, "<Debug>"))
+	if (endOfInput && pipeline.folder != NULL)
 	{
-		return DEBUG_LINE;
+		atgc_folder_flush(pipeline.folder, renderLine, &pipeline.output);
 	}
+	writeOutput(pipeline.output);
+	offset = (offset > filled ? filled : offset);
+	pipeline.counters.bytes += offset;
+	return offset;
+}
+
+// a rate of bytes per second, in MB/s
+double megabytesPerSecond(unsigned long long bytes, unsigned long long ns)
+{
+	return (ns > 0 ? bytes / 1e6 / (ns / 1e9) : 0.0);
+}
+
+// the --latency report, on stderr so it doesn't end up with the log
+void printLatency(const LatencyMeter& meter)
+{
+	const atgc_latency* histogram = meter.histogram;
+	unsigned long long elapsedNs = monotonicNs() - meter.startNs;
+	fprintf(stderr, "latency from read to written, %llu lines in %llu reads:\n", atgc_latency_count(histogram), meter.reads);
+	fprintf(stderr, "   p50     %10.3f ms\n", atgc_latency_percentile(histogram, 50.0) / 1e6);
+	fprintf(stderr, "   p99     %10.3f ms\n", atgc_latency_percentile(histogram, 99.0) / 1e6);
+	fprintf(stderr, "   p99.9   %10.3f ms\n", atgc_latency_percentile(histogram, 99.9) / 1e6);
+	fprintf(stderr, "   max     %10.3f ms\n", atgc_latency_max(histogram) / 1e6);
+	fprintf(stderr, "%llu bytes in %.2fs, %.1f MB/s; busy %.2fs of it, %.1f MB/s while busy\n", meter.bytesIn, elapsedNs / 1e9,
+		megabytesPerSecond(meter.bytesIn, elapsedNs), meter.busyNs / 1e9, megabytesPerSecond(meter.bytesIn, meter.busyNs));
+}
 
-	// sometimes jboss prints XML messages in the form
-	//	<mbean code="org.jboss.jms.asf.ServerSessionPoolLoader" name="jboss.mq:service=ServerSessionPoolMBean,name=StdJMSPool">
-	//		<depends optional-attribute-name="XidFactory">jboss:service=XidFactory</depends>
-	//		<attribute name="PoolName">StdJMSPool</attribute>
-	//		<attribute name="PoolFactoryClass">
-	//		   org.jboss.jms.asf.StdServerSessionPoolFactory
-	//		</attribute>
-	//   </mbean>
-	// this little else if prevents org.jboss.jms.asf.StdServerSessionPoolFactory and other similar lines from being colored red
-	else if (
-				(
-					startsWith (trimmedLine, "com.") ||
-					startsWith (trimmedLine, "org.") ||
-					startsWith (trimmedLine, "atg.") ||
-					startsWith (trimmedLine, "jrockit.") ||
-					startsWith (trimmedLine, "java.") ||
-					startsWith (trimmedLine, "javax.") ||
-					startsWith (trimmedLine, "webservices.") ||
-					startsWith (trimmedLine, "sun.") ||
-					startsWith (trimmedLine, "oracle.") ||
-					startsWith (trimmedLine, "weblogic.")
-				)
-		&& startsWith(trimmedPreviousLine, "<")
-		&& previousLineType == OTHER_LINE)
+// names of the ATGC_SERVER_ constants and of the ATGC_STATE_ bits, lowest bit first, as metric labels
+const char* const SERVER_NAMES[] = { "unknown", "jboss", "websphere", "weblogic" };
+const char* const STATE_NAMES[] = { "sql_debug", "thread_dump", "jboss_dump", "websphere_error", "block" };
+const int NUM_SERVER_TYPES = 4;
+const int NUM_STATES = 5;
+
+// adds the counters of a pipeline to total, with the lines it read and what its storm collapser and trace folder counted
+void addCounters(PipelineCounters& total, const Pipeline& pipeline)
+{
+	const PipelineCounters& counters = pipeline.counters;
+	total.lines += pipeline.lines;
+	total.bytes += counters.bytes;
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
+	{
+		total.types[type] += counters.types[type];
+	}
+	total.classifyNs += counters.classifyNs;
+	total.classified += counters.classified;
+	total.filterIn += counters.filterIn;
+	total.filterOut += counters.filterOut;
+	total.blockEntries += counters.blockEntries;
+	total.stormCollapsed += (pipeline.storm != NULL ? atgc_storm_collapsed(pipeline.storm) : 0);
+	total.foldedTraces += (pipeline.folder != NULL ? atgc_folder_folded(pipeline.folder) : 0);
+}
+
+// a --daemon stream or an --input log ended, what it counted stays in the metrics
+void retireCounters(const Pipeline& pipeline)
+{
+	if (metricsFile != NULL)
 	{
-		return OTHER_LINE;
+		addCounters(metricsFile->retired, pipeline);
 	}
+}
 
-	/*
-		2007-03-14 16:44:38,493 ERROR [org.apache.commons.modeler.Registry] Error registering jboss.web:type=RequestProcessor,worker=jk-8109,name=JkRequest248
-		java.lang.SecurityException: MBeanTrustPermission(register) not implied by protection domain of mbean class: org.apache.commons.modeler.BaseModelMBean, pd: Protection
-		Domain  (file:/export/nauuser/jboss-4.0.3SP1/server/node01/tmp/deploy/tmp62537commons-modeler.jar <no signer certificates>)
-		org.jboss.mx.loading.UnifiedClassLoader3@6127da{ url=file:/export/nauuser/jboss-4.0.3SP1/server/node01/deploy/jbossweb-tomcat55.sar/ ,addedOrder=10}
-		<no principals>
-	*/
-	else if (
-				(
-					startsWith (trimmedLine, "com.") ||
-					startsWith (trimmedLine, "org.") ||
-					startsWith (trimmedLine, "atg.") ||
-					startsWith (trimmedLine, "jrockit.") ||
-					startsWith (trimmedLine, "java.") ||
-					startsWith (trimmedLine, "javax.") ||
-					startsWith (trimmedLine, "sun.") ||
-					startsWith (trimmedLine, "webservices.") ||
-					startsWith (trimmedLine, "oracle.") ||
-					startsWith (trimmedLine, "weblogic.")
-				)
-		&& endsWith(trimmedPreviousLine, ">)")
-		&& previousLineType == ERROR_LINE)
-	{
-		return ERROR_LINE;
-	}
+bool metricsDue()
+{
+	return metricsFile != NULL && monotonicMs() >= metricsFile->nextMs;
+}
 
-	/*
-	 * Colors the http://xml.apache.org/axis/ line
-	 *			at org.apache.axis.client.Call.invoke(Call.java:2366)
-	 *			at org.apache.axis.client.Call.invoke(Call.java:1812)
-	 *			at com.atg.www.b2cblueprint.integrations.B2CBlueprintOMSIntegrationWS.B2CBlueprintOMSIntegrationWSBindingStub.orderSubmitToOMS(B2CBlueprintOMSIntegrationWSBindingStub.java:939)
-	 *			at atg.projects.b2cblueprint.integrations.webservices.B2CBlueprintOMSIntegrationWSClient.orderSubmitToOMS(B2CBlueprintOMSIntegrationWSClient.java:100)
-	 *			at atg.projects.b2cblueprint.integrations.order.B2CBlueprintOMSOrderSubmissionService.submitOrdersToOMS(B2CBlueprintOMSOrderSubmissionService.java:306)
-	 *			at atg.projects.b2cblueprint.integrations.order.B2CBlueprintOMSOrderSubmissionService.performScheduledTask(B2CBlueprintOMSOrderSubmissionService.java:420)
-	 *			at atg.service.scheduler.Scheduler$1handler.run(Scheduler.java:535)
-	 *			{http://xml.apache.org/axis/}hostname:PPUTAPPA
-	 *	09:41:52,093 INFO  [STDOUT] java.net.ConnectException: Connection timed out: connect
-	 *	09:41:52,093 INFO  [STDOUT]     at org.apache.axis.AxisFault.makeFault(AxisFault.java:101)
-	 *	09:41:52,093 INFO  [STDOUT]     at org.apache.axis.transport.http.HTTPSender.invoke(HTTPSender.java:154)
-	 *	09:41:52,093 INFO  [STDOUT]     at org.apache.axis.strategies.InvocationStrategy.visit(InvocationStrategy.java:32)
-	 */
-	else if (
-				(
-					startsWith (trimmedLine, "{http://xml.apache.org/axis/}hostname:")
-				)
-		&& previousLineType == ERROR_LINE)
+// how long a poll that would wait timeout milliseconds (-1 for ever) can wait for the metrics file to be written on time
+int metricsTimeout(int timeout)
+{
+	if (metricsFile == NULL)
 	{
-		return ERROR_LINE;
+		return timeout;
 	}
+	unsigned long long now = monotonicMs();
+	int due = (int) (now >= metricsFile->nextMs ? 0 : metricsFile->nextMs - now);
+	return (timeout < 0 ? due : min(timeout, due));
+}
 
-	/*
-		these next series of if else statements are to properly color the following:
-		2007-03-05 23:19:58,092 INFO  [atg.nucleus.servlet.NucleusServlet] ENVIRONMENT=
-			atg.dynamo.home=/export/nauuser/jboss-4.0.3SP1/server/node01/./deploy/nauCommerce.ear/atg_bootstrap.war/WEB-INF/ATG-INF/home,
-			atg.dynamo.root=/export/nauuser/jboss-4.0.3SP1/server/node01/./deploy/nauCommerce.ear/atg_bootstrap.war/WEB-INF/ATG-INF,
-			atg.dynamo.server.home=/export/nauuser/jboss-4.0.3SP1/server/node01/./deploy/nauCommerce.ear/atg_bootstrap.war/WEB-INF/ATG-INF/home/servers/node01,
-			atg.dynamo.versioninfo=ATGPlatform/2006.3,
-			atg.dynamo.liveconfig=on,
-			atg.dynamo.modules=nauCommerce,DafEar.Admin,DAS.WebServices,DCS.WebServices,DCS.AbandonedOrderServices,
-			atg.dynamo.platformversion=2006.3,
-			atg.dynamo.server.name=node01,
-			atg.dynamo.display=:0.0,
-			atg.license.read=true,
-			atg.dynamo.daf=true
-			dataDir=/export/nauuser/jboss-4.0.3SP1/bin/ATG-Data
-			servername=node01
-			standlone=true
-		2007-03-05 23:20:00,083 INFO  [nucleusNamespace.DPSLicense] DPS is licensed to NAU - Production
-	*/
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[0], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[1], "ENVIRONMENT=")  &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[2], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[3], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[4], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[5], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[6], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[7], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[8], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[9], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[10], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[11], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[12], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-	else if (
-				(
-					startsWith(trimmedLine, "atg.dynamo") ||
-					startsWith(trimmedLine, "atg.license") ||
-					startsWith(trimmedLine, "dataDir")  ||
-					startsWith(trimmedLine, "servername")  ||
-					startsWith(trimmedLine, "standlone")
-				) &&
-				endsWith(previousLinesTrimmed[13], "ENVIRONMENT=") &&
-				previousLineType == INFO_LINE
-			)
-	{
-		return INFO_LINE;
-	}
-
-	else if (startsWith(trimmedLine, "SQL Statement Failed"))
-	{
-		return ERROR_LINE;
-	}
+void appendMetric(string& text, const char* name, const char* type, const char* help)
+{
+	text += string("# HELP ") + name + " " + help + "\n";
+	text += string("# TYPE ") + name + " " + type + "\n";
+}
 
-	/*
-		2007-04-11 16:58:59,553 DEBUG [org.jboss.util.naming.Util] link: Reference Class Name: javax.naming.LinkRef
-		Type: LinkAddress
-		Content: jmx/invoker/RMIAdaptor
-	*/
-	else if (
-				(
-					startsWith(trimmedLine, "Type: ") ||
-					startsWith(trimmedLine, "Content: ")
-				) &&
-				(
-					contains(previousLinesTrimmed[0], " DEBUG [") ||
-					contains(previousLinesTrimmed[1], " DEBUG [")
-				)
-		)
-	{
-		return DEBUG_LINE;
+// a sample of a metric, with one label when label isn't NULL
+void appendSample(string& text, const char* name, const char* label, const char* labelValue, unsigned long long value)
+{
+	char sample[256];
+	if (label != NULL)
+	{
+		snprintf(sample, sizeof(sample), "%s{%s=\"%s\"} %llu\n", name, label, labelValue, value);
+	}
+	else
+	{
+		snprintf(sample, sizeof(sample), "%s %llu\n", name, value);
 	}
+	text += sample;
+}
 
-	/*
-		Designed to catch stack trace stuff, but ignore for instance the java.naming in the XML from JBoss below
-		2007-04-11 16:59:10,358 DEBUG [org.jboss.deployment.XSLSubDeployer] transformed into doc: <server>
-		<mbean code='org.jboss.jms.jndi.JMSProviderLoader' name='jboss.mq:service=JMSProviderLoader,name=HAJNDIJMSProvider'>
-		<attribute name='ProviderName'>DefaultJMSProvider</attribute>
-		<attribute name='ProviderAdapterClass'>
-			org.jboss.jms.jndi.JNDIProviderAdapter
-			</attribute>
-		<attribute name='FactoryRef'>XAConnectionFactory</attribute>
-		<attribute name='QueueFactoryRef'>XAConnectionFactory</attribute>
-		<attribute name='TopicFactoryRef'>XAConnectionFactory</attribute>
-		<attribute name='Properties'>
-			java.naming.factory.initial=org.jnp.interfaces.NamingContextFactory
-			java.naming.factory.url.pkgs=org.jboss.naming:org.jnp.interfaces
-			java.naming.provider.url=${jboss.bind.address:localhost}:1100
-			jnp.disableDiscovery=false
-			jnp.partitionName=${jboss.partition.name:DefaultPartition}
-			jnp.discoveryGroup=${jboss.partition.udpGroup:230.0.0.4}
-			jnp.discoveryPort=1102
-			jnp.discoveryTTL=16
-			jnp.discoveryTimeout=5000
-			jnp.maxRetries=1
-			</attribute>
-		</mbean>
-	*/
-	else if (
-				(
-					contains(trimmedLine, "[STDOUT]     at") ||
-					startsWith(trimmedLine, "at ") ||
-					startsWith(trimmedLine, "org.") ||
-					startsWith(trimmedLine, "(org.") ||
-					startsWith(trimmedLine, "sun.") ||
-					startsWith(trimmedLine, "(sun.") ||
-					startsWith(trimmedLine, "atg.") ||
-					startsWith(trimmedLine, "(atg.") ||
-					startsWith(trimmedLine, "com.") ||
-					startsWith(trimmedLine, "(com.") ||
-					startsWith(trimmedLine, "jrockit.") ||
-					startsWith(trimmedLine, "(jrockit.") ||
-					startsWith(trimmedLine, "webservices.") ||
-					startsWith(trimmedLine, "(webservices.") ||
-					startsWith(trimmedLine, "java.") ||
-					startsWith(trimmedLine, "(java.") ||
-					startsWith(trimmedLine, "javax.") ||
-					startsWith(trimmedLine, "(javax.") ||
-					startsWith(trimmedLine, "oracle.") ||
-					startsWith(trimmedLine, "(oracle.") ||
-					startsWith(trimmedLine, "weblogic.") ||
-					startsWith(trimmedLine, "(weblogic.") ||
-					startsWith(trimmedLine, "<no ") ||
-					startsWith(trimmedLine, "CAUSE:") ||
-					startsWith(trimmedLine, "Exception in") ||
-					startsWith(trimmedLine, "Caused by") ||
-					startsWith(trimmedLine, "Symbol") ||
-					startsWith(trimmedLine, "Location") ||
-					startsWith(trimmedLine, "...stack") ||
-					startsWith(trimmedLine, "... stack") ||
-					startsWith(trimmedLine, ".... ") ||
-					startsWith(trimmedLine, "....stack") ||
-					startsWith(trimmedLine, ".... stack") ||
-					startsWith(trimmedLine, "CAUGHT AT:") ||
-					startsWith(trimmedLine, "CONTAINER:") ||
-					startsWith(trimmedLine, "SOURCE EXCEPTION:") ||
-					contains(trimmedLine, "nested exception is:")
-				) && !contains(trimmedLine, "=")
-			)
-	{
-		return ERROR_LINE;
+/*
+ *	writes the --metrics file in the Prometheus text format: the counters of the pipelines still
+ *	running added to the ones of those that ended, and how many of them are in each state right
+ *	now. queuedBytes is what was read and not written out yet, the start of a line waiting for
+ *	the rest of it and colored lines a client hasn't taken
+ */
+void writeMetrics(const vector<const Pipeline*>& pipelines, unsigned long long queuedBytes)
+{
+	PipelineCounters total = metricsFile->retired;
+	unsigned long long servers[NUM_SERVER_TYPES] = { 0 };
+	unsigned long long states[NUM_STATES] = { 0 };
+	for (size_t i = 0; i < pipelines.size(); i++)
+	{
+		addCounters(total, *pipelines[i]);
+		servers[atgc_server_type(pipelines[i]->stream)]++;
+		unsigned int state = atgc_stream_state(pipelines[i]->stream);
+		for (int bit = 0; bit < NUM_STATES; bit++)
+		{
+			states[bit] += ((state >> bit) & 1);
+		}
 	}
 
-	/*
-        at atg.servlet.WrappingRequestDispatcher.include(WrappingRequestDispatcher.java:94)
-        at atg.taglib.dspjsp.IncludeTag.doEndTag(Unknown Source)
-        ... 213 more
-		SOURCE EXCEPTION:javax.servlet.ServletException: atg.adapter.gsa.GSARepository
-	*/
-	else if (contains(trimmedLine, "...") && contains(trimmedLine, "more"))
+	string text;
+	appendMetric(text, "atgcolorize_lines_total", "counter", "Lines read.");
+	appendSample(text, "atgcolorize_lines_total", NULL, NULL, total.lines);
+	appendMetric(text, "atgcolorize_bytes_total", "counter", "Bytes of the lines read, newlines included.");
+	appendSample(text, "atgcolorize_bytes_total", NULL, NULL, total.bytes);
+	appendMetric(text, "atgcolorize_classified_lines_total", "counter", "Lines by the type they were classified as. With --storm, the lines it let through.");
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
+	{
+		appendSample(text, "atgcolorize_classified_lines_total", "type", LINE_TYPE_NAMES[type], total.types[type]);
+	}
+	appendMetric(text, "atgcolorize_classify_ns_per_line", "gauge", "Nanoseconds classifying took per line, since the start. Not measured with --storm.");
+	char sample[128];
+	snprintf(sample, sizeof(sample), "atgcolorize_classify_ns_per_line %.1f\n", total.classified > 0 ? (double) total.classifyNs / total.classified : 0.0);
+	text += sample;
+	appendMetric(text, "atgcolorize_filtered_lines_total", "counter", "Lines --min-type, --only or --match didn't let through.");
+	appendSample(text, "atgcolorize_filtered_lines_total", NULL, NULL, total.filterIn - total.filterOut);
+	appendMetric(text, "atgcolorize_collapsed_lines_total", "counter", "Lines only counted, by --storm or --collapse-blocks.");
+	appendSample(text, "atgcolorize_collapsed_lines_total", "by", "storm", total.stormCollapsed);
+	appendSample(text, "atgcolorize_collapsed_lines_total", "by", "blocks", total.blockEntries);
+	appendMetric(text, "atgcolorize_folded_traces_total", "counter", "Stack traces --fold-traces printed as a reference.");
+	appendSample(text, "atgcolorize_folded_traces_total", NULL, NULL, total.foldedTraces);
+	appendMetric(text, "atgcolorize_queued_bytes", "gauge", "Bytes read and not written out yet.");
+	appendSample(text, "atgcolorize_queued_bytes", NULL, NULL, queuedBytes);
+	appendMetric(text, "atgcolorize_streams", "gauge", "Logs being colored.");
+	appendSample(text, "atgcolorize_streams", NULL, NULL, pipelines.size());
+	appendMetric(text, "atgcolorize_server", "gauge", "Logs being colored by the app server detected in them.");
+	for (int server = 0; server < NUM_SERVER_TYPES; server++)
+	{
+		appendSample(text, "atgcolorize_server", "server", SERVER_NAMES[server], servers[server]);
+	}
+	appendMetric(text, "atgcolorize_multiline_state", "gauge", "Logs being colored that are in the middle of this multi-line output.");
+	for (int bit = 0; bit < NUM_STATES; bit++)
+	{
+		appendSample(text, "atgcolorize_multiline_state", "state", STATE_NAMES[bit], states[bit]);
+	}
+
+	FILE* file = fopen(metricsFile->temporaryPath.c_str(), "w");
+	bool written = (file != NULL && fwrite(text.data(), 1, text.size(), file) == text.size());
+	written = (file != NULL && fclose(file) == 0 && written);
+	written = written && rename(metricsFile->temporaryPath.c_str(), metricsFile->path.c_str()) == 0;
+	if (!written && !metricsFile->failed)
+	{
+		fprintf(stderr, "Metrics file '%s' couldn't be written\n", metricsFile->path.c_str());
+	}
+	metricsFile->failed = !written;
+	metricsFile->nextMs = monotonicMs() + metricsFile->intervalMs;
+}
+
+// the metrics of a single log colored here
+void writePipelineMetrics(const Pipeline& pipeline, unsigned long long queuedBytes)
+{
+	vector<const Pipeline*> pipelines(1, &pipeline);
+	writeMetrics(pipelines, queuedBytes);
+}
+
+/*
+ *	the --stats=stages report, on stderr like --latency. ticks are turned into time with the ticks
+ *	per nanosecond seen since the start, and the sampled stages are scaled up to all the lines
+ */
+void printStages(const StageMeter& meter)
+{
+	unsigned long long elapsedNs = monotonicNs() - meter.startNs;
+	double ticksPerNs = (elapsedNs > 0 ? (double) (stageTicks() - meter.startTicks) / elapsedNs : 1.0);
+	double scale = (meter.sampledLines > 0 ? (double) meter.lines / meter.sampledLines : 0.0);
+	double ns[NUM_STAGES];
+	double total = 0;
+	for (int stage = 0; stage < NUM_STAGES; stage++)
 	{
-		return ERROR_LINE;
+		ns[stage] = meter.ticks[stage] / ticksPerNs * (stage == STAGE_READ || stage == STAGE_WRITE ? 1.0 : scale);
+		total += ns[stage];
 	}
-
-	// more stack trace stuff
-	// [4/6/07 16:23:13:093 EDT] 00000050 WorkSpaceMana E   WKSP0019E: Error getting repository adapter com.ibm.ws.management.configarchive.ConfigArchiveRepositoryAdapter -- java.lang.ClassNotFoundException: com.ibm.ws.management.configarchive.ConfigArchiveRepositoryAdapter
-	else if (
-				contains(trimmedLine, "Exception:") &&
-				(
-					contains(trimmedLine, "com.") ||
-					contains(trimmedLine, "org.") ||
-					contains(trimmedLine, "atg.") ||
-					contains(trimmedLine, "jrockit.") ||
-					contains(trimmedLine, "java.") ||
-					contains(trimmedLine, "oracle.") ||
-					contains(trimmedLine, "webservices.") ||
-					contains(trimmedLine, "javax.") ||
-					contains(trimmedLine, "sun.") ||
-					contains(trimmedLine, "weblogic.")
-				)
-		)
+	fprintf(stderr, "time per stage, %llu lines in %llu reads, %llu of them sampled:\n", meter.lines, meter.reads, meter.sampledReads);
+	fprintf(stderr, "   stage        share     ns/line\n");
+	for (int stage = 0; stage < NUM_STAGES; stage++)
 	{
-		return ERROR_LINE;
+		fprintf(stderr, "   %-10s %6.1f%% %11.1f\n", STAGE_NAMES[stage], total > 0 ? 100.0 * ns[stage] / total : 0.0,
+			meter.lines > 0 ? ns[stage] / meter.lines : 0.0);
 	}
+	fprintf(stderr, "%.2fs waiting for the input and %.2fs blocked on the output, of %.2fs\n", ns[STAGE_READ] / 1e9, ns[STAGE_WRITE] / 1e9, elapsedNs / 1e9);
+}
 
-	// [4/6/07 10:18:37:237 EDT] 00000021 ServletWrappe E   SRVE0068E: Could not invoke the service() method on servlet DynamoProxyServlet. Exception thrown : java.lang.NullPointerException
-	// INFO  [STDOUT]  at org.apache.jk.server.JkCoyoteHandler.invoke(JkCoyoteHandler.java:307)
-	else if (
-				contains(trimmedLine, "Exception thrown") &&
-				(
-					contains(trimmedLine, "com.") ||
-					contains(trimmedLine, "org.") ||
-					contains(trimmedLine, "atg.") ||
-					contains(trimmedLine, "jrockit.") ||
-					contains(trimmedLine, "webservices.") ||
-					contains(trimmedLine, "java.") ||
-					contains(trimmedLine, "sun.") ||
-					contains(trimmedLine, "oracle.") ||
-					contains(trimmedLine, "javax.") ||
-					contains(trimmedLine, "weblogic.")
-				)
-		)
+// --latency and --stats=stages, the ones asked for
+void printReports(const Pipeline& pipeline)
+{
+	fflush(stdout);
+	if (pipeline.latency != NULL)
 	{
-		return ERROR_LINE;
+		printLatency(*pipeline.latency);
 	}
-	else if (startsWith(trimmedLine, "C:") && previousLineType == ERROR_LINE && !isWebSphere)
+	if (pipeline.stages != NULL)
 	{
-		return ERROR_LINE;
+		printStages(*pipeline.stages);
 	}
-	else if (startsWith(trimmedLine, "D:") && previousLineType == ERROR_LINE && !isWebSphere)
+}
+
+/*
+ *	reads the log from fd until end of file. read() hands back whatever is in the pipe, so when
+ *	an app server is piped in its output still shows up as soon as it's written, while a log file
+ *	is colored a few thousand lines per write
+ */
+void colorize(int fd, Pipeline& pipeline)
+{
+	vector<char> input(READ_BUFFER_SIZE);
+	size_t filled = 0;
+	bool endOfInput = false;
+
+	while (!endOfInput)
 	{
-		return ERROR_LINE;
+		if (filled == input.size())
+		{
+			input.resize(input.size() * 2);
+		}
+		if (reportRequested)
+		{
+			reportRequested = 0;
+			printReports(pipeline);
+		}
+
+		if (metricsDue())
+		{
+			writePipelineMetrics(pipeline, filled);
+		}
+
+		// waiting for the app server is part of reading
+		sampleRead(pipeline.stages);
+		unsigned long long ticks = beginStage(pipeline.stages, STAGE_READ);
+
+		// a trace being held for folding or a storm's count shouldn't sit there while the app server is quiet
+		if (holdingLines(pipeline) && !waitForInput(fd, FOLD_IDLE_MS))
+		{
+			releaseHeldLines(pipeline);
+			fflush(stdout);
+		}
+
+		// nor should the metrics file stop being written
+		if (metricsFile != NULL && !waitForInput(fd, metricsTimeout(-1)))
+		{
+			continue;
+		}
+		ssize_t bytesRead = read(fd, &input[filled], input.size() - filled);
+		if (bytesRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (bytesRead <= 0)
+		{
+			endOfInput = true;
+			bytesRead = 0;
+		}
+		endStage(pipeline.stages, STAGE_READ, ticks);
+		ticks = beginStage(pipeline.stages, STAGE_STRIP);
+		unsigned long long readNs = (pipeline.latency != NULL ? monotonicNs() : 0);
+		unsigned long long linesBefore = pipeline.lines;
+		stripNullChars(&input[filled], bytesRead);
+		filled += bytesRead;
+		endStage(pipeline.stages, STAGE_STRIP, ticks);
+
+		pickUpReloadedRules(pipeline.stream);
+		size_t offset = processInput(pipeline, &input[0], filled, endOfInput);
+		ticks = beginStage(pipeline.stages, STAGE_WRITE);
+		fflush(stdout);
+		endStage(pipeline.stages, STAGE_WRITE, ticks);
+		memmove(&input[0], &input[offset], filled - offset);
+		filled -= offset;
+
+		// every line of the read waited as long as the whole batch took
+		if (pipeline.latency != NULL)
+		{
+			unsigned long long tookNs = monotonicNs() - readNs;
+			atgc_latency_record(pipeline.latency->histogram, tookNs, pipeline.lines - linesBefore);
+			pipeline.latency->busyNs += tookNs;
+			pipeline.latency->bytesIn += bytesRead;
+			pipeline.latency->reads++;
+		}
+	}
+}
+
+// the log files read through io_uring, and the line cut in two at the end of the last chunk
+struct FileBatch
+{
+	Pipeline* pipeline;
+	atgc_uring* uring;
+	vector<char> carry;
+	vector<char> output; // the sink of the pipeline, handed to the ring after every chunk
+};
+
+// colors a chunk of a log file, straight out of the buffer it was read into
+void colorizeChunk(void* context, size_t /*file*/, char* chunk, size_t length, int endOfFile)
+{
+	FileBatch& batch = *(FileBatch*) context;
+	Pipeline& pipeline = *batch.pipeline;
+	StageMeter* stages = pipeline.stages;
+
+	// the time since the last chunk was done with went on waiting for the ring
+	sampleRead(stages);
+	if (stages != NULL)
+	{
+		stages->ticks[STAGE_READ] += stageTicks() - stages->lastTicks;
+	}
+	unsigned long long ticks = beginStage(stages, STAGE_STRIP);
+	stripNullChars(chunk, length);
+	endStage(stages, STAGE_STRIP, ticks);
+	pickUpReloadedRules(pipeline.stream);
+
+	// only the line going on from the last chunk is copied, to put it back together
+	if (!batch.carry.empty())
+	{
+		char* newline = (char*) memchr(chunk, '\n', length);
+		size_t head = (newline != NULL ? newline + 1 - chunk : length);
+		batch.carry.insert(batch.carry.end(), chunk, chunk + head);
+		chunk += head;
+		length -= head;
+		if (newline == NULL && !endOfFile)
+		{
+			if (stages != NULL)
+			{
+				stages->lastTicks = stageTicks();
+			}
+			return;
+		}
+		processInput(pipeline, &batch.carry[0], batch.carry.size(), newline == NULL);
+		batch.carry.clear();
 	}
-	else if (startsWith(trimmedLine, "SEVERE:"))
+	size_t offset = processInput(pipeline, chunk, length, endOfFile != 0);
+	batch.carry.assign(chunk + offset, chunk + length);
+
+	ticks = beginStage(stages, STAGE_WRITE);
+	if (!batch.output.empty())
 	{
-		return ERROR_LINE;
+		atgc_uring_write(batch.uring, STDOUT_FILENO, &batch.output[0], batch.output.size());
+		batch.output.clear();
 	}
-	else if (startsWith(trimmedLine, "XML parsing error:"))
+	endStage(stages, STAGE_WRITE, ticks);
+	if (metricsDue())
 	{
-		return ERROR_LINE;
+		writePipelineMetrics(pipeline, batch.carry.size());
 	}
-
-	else if (startsWith(trimmedLine, ">") && previousLineType == ERROR_LINE)
+	if (reportRequested)
 	{
-		return ERROR_LINE;
+		reportRequested = 0;
+		printReports(pipeline);
 	}
-	else if (startsWith(trimmedLine, ")") && previousLineType == ERROR_LINE)
+	if (stages != NULL)
 	{
-		return ERROR_LINE;
+		stages->lastTicks = stageTicks();
 	}
+}
 
-	/*
-		C:\bea\user_projects\domains\atg\.\myserver\.wlnotdelete\extract\myserver_StoreApp_storeApp.war\jsp_servlet\_checkout\__shipping.java:648: setDefault(java.lang.String) in atg.taglib.dspjsp.InputTagBase cannot be applied to (boolean)
-				_dsp_input0.setDefault(true); //[ /checkout/shipping.jsp; Line: 42]
-							^
-		1 error
-	*/
-	else if (startsWith(trimmedLine, "^") && previousLineType == ERROR_LINE)
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				previousLineType == ERROR_LINE &&
-				(
-					contains(trimmedLine, ".java:") ||
-					contains(trimmedLine, "Line:") ||
-					contains(trimmedLine, "location:") ||
-					contains(trimmedLine, "symbol  :") ||
-					contains(trimmedLine, ".jsp;")
-				)
-			)
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				(
-					endsWith(trimmedLine, " error") ||
-					endsWith(trimmedLine, " errors")
-				) &&
-				previousLineType == ERROR_LINE)
-	{
-		return ERROR_LINE;
+/*
+ *	colors the log files one after the other. with io_uring the next chunks, of this file and the
+ *	next ones, are being read while one is colored and the colored lines are written while the
+ *	next chunk is. without it, or with --io blocking, each file is read like a single log file.
+ *	returns the index of the file that couldn't be read, paths.size() when they all were
+ */
+size_t colorizeFiles(const vector<const char*>& paths, Pipeline& pipeline, bool blockingIO)
+{
+	atgc_uring* uring = (blockingIO ? NULL : atgc_uring_create(0));
+	if (uring == NULL)
+	{
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			int fd = open(paths[i], O_RDONLY);
+			if (fd < 0)
+			{
+				return i;
+			}
+			colorize(fd, pipeline);
+			close(fd);
+		}
+		return paths.size();
 	}
 
-	/*
-		[3/26/07 11:32:32:231 EST] 0000001f SystemOut     O /atg/dynamo/security/AdminAccountManager    Failure trying to retrieve account scenarios-privilege  CONTAINER:atg.repository.RepositoryException; SOURCE:java.sql.SQLException: [IBM][SQLServer JDBC Driver][SQLServer]Invalid object name 'das_account'.
-	*/
-	else if (contains(trimmedLine, "CONTAINER:") && contains(trimmedLine, "SOURCE:"))
+	// the ring writes to the fd, what's still in stdout's buffer has to go out first
+	fflush(stdout);
+	FileBatch batch;
+	batch.pipeline = &pipeline;
+	batch.uring = uring;
+	pipeline.output.sink = &batch.output;
+	size_t failed = atgc_uring_read_files(uring, &paths[0], paths.size(), colorizeChunk, &batch);
+	if (!batch.output.empty())
 	{
-		return ERROR_LINE;
+		atgc_uring_write(uring, STDOUT_FILENO, &batch.output[0], batch.output.size());
 	}
+	atgc_uring_flush(uring);
+	pipeline.output.sink = NULL;
+	atgc_uring_destroy(uring);
+	return failed;
+}
 
-	/*
-		the next 9 if/else statements are for this condition:
-		2006-06-26 14:35:26,171 INFO  [STDOUT] **** Error
-		2006-06-26 14:35:26,171 INFO  [STDOUT]
-		2006-06-26 14:35:26,171 INFO  [STDOUT] Mon Jun 26 14:35:26 CDT 2006
-		2006-06-26 14:35:26,171 INFO  [STDOUT]
-		2006-06-26 14:35:26,171 INFO  [STDOUT] 1151350526171
-		2006-06-26 14:35:26,171 INFO  [STDOUT]
-		2006-06-26 14:35:26,171 INFO  [STDOUT] /
-		2006-06-26 14:35:26,171 INFO  [STDOUT]
-		2006-06-26 14:35:26,171 INFO  [STDOUT]  java.net.BindException: Address already in use: JVM_Bind
-	*/
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[2], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[3], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[4], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				(endsWith(trimmedLine, "INFO  [STDOUT] /") ||
-				endsWith(trimmedLine, "INFO  [STDOUT] ---")) &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[5], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				(endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] /") ||
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] ---")) &&
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[6], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				(endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] /") ||
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] ---")) &&
-				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[6], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[7], "[STDOUT] **** Error"))
-	{
-		return ERROR_LINE;
-	}
-
-
-   /*
-	*	the next 9 if/else statements are for this condition:
-	* 15:02:27,087 INFO  [STDOUT] **** Warning
-	* 15:02:27,087 INFO  [STDOUT]
-	* 15:02:27,087 INFO  [STDOUT] Tue Jan 22 15:02:27 CST 2008
-	* 15:02:27,087 INFO  [STDOUT]
-	* 15:02:27,087 INFO  [STDOUT] 1201035747087
-	* 15:02:27,087 INFO  [STDOUT]
-	* 15:02:27,087 INFO  [STDOUT] /
-	* 15:02:27,088 INFO  [STDOUT]
-	* 15:02:27,088 INFO  [STDOUT] PR#142511 HOTFIX: Created on 11/21/2007
-	*/
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[2], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[3], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[4], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				(endsWith(trimmedLine, "INFO  [STDOUT] /") ||
-				endsWith(trimmedLine, "INFO  [STDOUT] ---")) &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[5], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				endsWith(trimmedLine, "INFO  [STDOUT]") &&
-				(endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] /") ||
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] ---")) &&
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[6], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
-	}
-	else if (
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				(endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] /") ||
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] ---")) &&
-				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
-				contains(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[6], "INFO  [STDOUT]") &&
-				endsWith(previousLinesTrimmed[7], "[STDOUT] **** Warning"))
-	{
-		return WARNING_LINE;
+// adds the regular files of a directory to paths, in name order. false when it can't be read
+bool listDirectory(const char* directory, vector<string>& paths)
+{
+	DIR* dir = opendir(directory);
+	if (dir == NULL)
+	{
+		return false;
+	}
+	vector<string> files;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		string path = string(directory) + "/" + entry->d_name;
+		struct stat st;
+		if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+		{
+			files.push_back(path);
+		}
 	}
+	closedir(dir);
+	sort(files.begin(), files.end());
+	paths.insert(paths.end(), files.begin(), files.end());
+	return true;
+}
 
+// lists the most frequent exceptions, most frequent first
+void printExceptionReport(atgc_exception_report* report, size_t top)
+{
+	vector<atgc_exception_count> counts(top);
+	size_t found = atgc_exceptions_top(report, counts.data(), top);
 
-	/*
-		This else/if coveres the third line here
-		2006-06-26 14:35:25,906 INFO  [STDOUT] ---
-		2006-06-26 14:35:25,906 INFO  [STDOUT]
-		2006-06-26 14:35:25,906 INFO  [STDOUT] java.rmi.server.ExportException: Port already in use: 0; nested exception is:
-				java.net.BindException: Address already in use: JVM_Bind
-				at sun.rmi.transport.tcp.TCPTransport.listen(TCPTransport.java:243)
-				at sun.rmi.transport.tcp.TCPTransport.exportObject(TCPTransport.java:178)
-				at sun.rmi.transport.tcp.TCPEndpoint.exportObject(TCPEndpoint.java:382)
-				at sun.rmi.transport.LiveRef.exportObject(LiveRef.java:116)
-				at sun.rmi.server.UnicastServerRef.exportObject(UnicastServerRef.java:145)
-				at sun.rmi.server.UnicastServerRef.exportObject(UnicastServerRef.java:129)
-				at java.rmi.server.UnicastRemoteObject.exportObject(UnicastRemoteObject.java:275)
-				at java.rmi.server.UnicastRemoteObject.exportObject(UnicastRemoteObject.java:178)
-		....stack trace CROPPED after 10 lines.
-	*/
-	else if (
-				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] ---") &&
-				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
-				contains(trimmedLine, "INFO  [STDOUT]") &&
-				(
-					contains(trimmedLine, "com.") ||
-					contains(trimmedLine, "org.") ||
-					contains(trimmedLine, "atg.") ||
-					contains(trimmedLine, "jrockit.") ||
-					contains(trimmedLine, "java.") ||
-					contains(trimmedLine, "sun.") ||
-					contains(trimmedLine, "webservices.") ||
-					contains(trimmedLine, "oracle.") ||
-					contains(trimmedLine, "javax.") ||
-					contains(trimmedLine, "weblogic.")
-				)
-			)
-	{
-		return ERROR_LINE;
-	}
-
-	else if (
-				(
-					contains(trimmedLine, "com.") ||
-					contains(trimmedLine, "INFO  [STDOUT] org.") ||
-					contains(trimmedLine, "INFO  [STDOUT] atg.") ||
-					contains(trimmedLine, "INFO  [STDOUT] jrockit.") ||
-					contains(trimmedLine, "INFO  [STDOUT] sun.") ||
-					contains(trimmedLine, "INFO  [STDOUT] java.") ||
-					contains(trimmedLine, "INFO  [STDOUT] webservices.") ||
-					contains(trimmedLine, "INFO  [STDOUT] oracle.") ||
-					contains(trimmedLine, "INFO  [STDOUT] javax.") ||
-					contains(trimmedLine, "INFO  [STDOUT] weblogic.")
-				) &&
-				contains(trimmedLine, "Exception") &&
-				contains(trimmedLine, ":")
-			)
-	{
-		return ERROR_LINE;
-	}
-
-	else if (
-				contains(trimmedLine, "---- Begin backtrace for Nested Throwables") ||
-				// 2007-04-10 18:22:15,606 INFO  [STDOUT]  at sun.net.www.http.HttpClient.openServer(Unknown Source)
-				contains(trimmedLine, " INFO  [STDOUT] 	at ") ||
-				// 2007-04-10 18:22:52,217 DEBUG [org.jnp.interfaces.NamingContext] Failed to connect to t3:1099
-				contains(trimmedLine, "Invalid/unknown identity:")
-			)
-		{
-			return ERROR_LINE;
-		}
-
-	else if (
-				contains(trimmedLine, "recovered deployment status is either not from this server or does not match") ||
-				contains(trimmedLine, "Test this hotfix on a staging or other non-production environment") ||
-				contains(trimmedLine, " HOTFIX: DO NOT patch beyond ATG")
-			)
-	{
-		return WARNING_LINE;
+	setTextColor(INTRO_COLOR);
+	printf("\n");
+	printf("%llu exceptions, %lu different ones counted", atgc_exceptions_total(report), (unsigned long) atgc_exceptions_distinct(report));
+	printf("\n\n");
+	printf("%12s  %-26s %-26s %s\n", "count", "first seen", "last seen", "exception");
+	for (size_t i = 0; i < found; i++)
+	{
+		// an exception that took over another one's counter may be counted too high
+		char count[32];
+		if (counts[i].overcount > 0)
+		{
+			snprintf(count, sizeof(count), "<=%llu", counts[i].count);
+		}
+		else
+		{
+			snprintf(count, sizeof(count), "%llu", counts[i].count);
+		}
+		setTextColor(INTRO_COLOR);
+		printf("%12s  %-26s %-26s ", count, counts[i].firstSeen, counts[i].lastSeen);
+		setTextColor(ERROR_COLOR);
+		printf("%s\n", counts[i].exception);
 	}
+	setTextColor(ORIGINAL_COLOR);
+}
 
-	/*
-	 * Prevents the tyupe and content lines from showing up in yellow. they should be debug lines
-	 * 2007-04-11 16:58:00,193 DEBUG [org.jboss.util.naming.Util] link: Reference Class Name: javax.naming.LinkRef
-	 * Type: LinkAddress
-	 * Content: ConnectionFactory
-    /*
-
-	else if (
-				isJBoss &&
-				contains(previousLinesTrimmed[0], " DEBUG [") &&
-				(
-					startsWith(trimmedLine, "Type:") ||
-					startsWith(trimmedLine, "Content:")
-				)
-			)
-	{
-		return ERROR_LINE;
-	}
-	/*
-		2006-06-26 14:34:53,406 DEBUG [org.jboss.services.binding.ServiceBindingManager] applyServiceConfig, server:ports-lpa-base, serviceName:jboss.web:service=WebServer, config=ServiceConfig(name=jboss.web:service=WebServer), bindings=
-		ServiceBinding [name=;hostName=<ANY>;bindAddress=localhost/127.0.0.1;port=8280]
-	*/
-	else if (
-				isJBoss &&
-				endsWith(previousLinesTrimmed[0], "bindings=") &&
-				contains(previousLinesTrimmed[0], " DEBUG [") &&
-				startsWith(trimmedLine, "ServiceBinding")
-			)
+// for every thread dump: how many threads are in which state, deadlocks and the most contended monitors
+void printThreadDumpReport(atgc_thread_dumps* dumps)
+{
+	atgc_thread_dumps_finish(dumps);
+	setTextColor(INTRO_COLOR);
+	printf("\n");
+	if (atgc_thread_dumps_count(dumps) == 0)
 	{
-		return DEBUG_LINE;
+		printf("No thread dumps found\n");
 	}
-
-
-	/*
-	 *	16:22:36,275 INFO  [STDOUT] Error while handling scheduled job J2EE Archive Directory Agent
-	 *	16:22:36,285 INFO  [STDOUT]
-	 *	16:22:36,285 INFO  [STDOUT] java.lang.ThreadDeath
-	 *			at org.apache.catalina.loader.WebappClassLoader.loadClass(WebappClassLoader.java:1221)
-	 */
-	else if (
-				contains(trimmedLine, "Error while handling scheduled job J2EE Archive Directory Agent") ||
-				(
-					endsWith(trimmedLine, "INFO  [STDOUT]") &&
-					contains(previousLinesTrimmed[0], "Error while handling scheduled job J2EE Archive Directory Agent")
-				) ||
-				endsWith(trimmedLine, "java.lang.ThreadDeath")
-			)
+	for (size_t d = 0; d < atgc_thread_dumps_count(dumps); d++)
 	{
-		return ERROR_LINE;
-	}
+		atgc_thread_dump_summary summary;
+		atgc_thread_dumps_summary(dumps, d, &summary);
+		setTextColor(INFO_COLOR);
+		printf("Thread dump %lu%s%s%s, %lu threads\n", (unsigned long) (d + 1), (summary.time[0] != '\0' ? " (" : ""),
+			summary.time, (summary.time[0] != '\0' ? ")" : ""), (unsigned long) summary.threads);
+		setTextColor(INTRO_COLOR);
+		printf("  ");
+		for (int state = 0; state < ATGC_NUM_THREAD_STATES; state++)
+		{
+			if (summary.states[state] > 0)
+			{
+				printf(" %s %lu", atgc_thread_state_name(state), (unsigned long) summary.states[state]);
+			}
+		}
+		printf("\n");
 
+		for (size_t i = 0; i < summary.numDeadlocks; i++)
+		{
+			setTextColor(ERROR_COLOR);
+			printf("   deadlock:\n");
+			for (const char* line = summary.deadlocks[i]; *line != '\0'; )
+			{
+				const char* newline = strchr(line, '\n');
+				printf("      %.*s\n", (int) (newline - line), line);
+				line = newline + 1;
+			}
+		}
 
-	/*
-	 * There are 3466 SOPs in just the 2006.3 DAS module. All of the below come through as SOP's
-	 * in certain scenarios. Some are hard-coded error message and others are contained in
-	 * resource bundles. When printed, they often have no logging identifiers. I took all of the
-	 * SOP's from Table.java, TemplateParser.java and other important classes. There were many
-	 * SOP's that came from depricated code, so I just threw those out
-	 *
-	 * Yes I know this isn't the most elegant (messages may change, may have missed some), but
-	 * it's a start!
-	 *
-	 * Oh and I've ran a bunch of performance test (due to all of the parsing) and there wasn't
-	 * much of a memory or CPU hit at all
-	 */
-	else if (isSopErrorLine(trimmedLine))
-	{
-		return ERROR_LINE;
+		if (summary.numMonitors > 0)
+		{
+			setTextColor(INTRO_COLOR);
+			printf("   most contended monitors:\n");
+		}
+		for (size_t i = 0; i < summary.numMonitors; i++)
+		{
+			const atgc_contended_monitor& monitor = summary.monitors[i];
+			setTextColor(monitor.waiters > 1 ? WARNING_COLOR : INTRO_COLOR);
+			printf("   %6lu waiting for <%s>", (unsigned long) monitor.waiters, monitor.address);
+			if (monitor.className[0] != '\0')
+			{
+				printf(" (a %s)", monitor.className);
+			}
+			if (monitor.owner != NULL)
+			{
+				printf(", held by \"%s\"", monitor.owner);
+			}
+			printf("\n");
+		}
+		printf("\n");
 	}
+	setTextColor(ORIGINAL_COLOR);
+}
 
-	// more stuff that comes from SOP
-	else if (
-				contains(trimmedLine, "*** Checking in all assets.") ||
-				contains(trimmedLine, "exporting repository:") ||
-				contains(trimmedLine, "Done - Pausing, hit enter to exit")
-			)
-	{
-		return DEBUG_LINE;
+// the statement shapes that failed most, with the parameters of their last failure
+void printFailedSQLReport(atgc_failed_sql_report* report, size_t top)
+{
+	atgc_failed_sql_finish(report);
+	vector<atgc_failed_sql> statements(top);
+	size_t found = atgc_failed_sql_top(report, statements.data(), top);
+
+	setTextColor(INTRO_COLOR);
+	printf("\n");
+	printf("%llu failed statements, %lu different ones", atgc_failed_sql_total(report), (unsigned long) atgc_failed_sql_distinct(report));
+	printf("\n\n");
+	printf("%12s  %-26s %-26s %-7s %s\n", "count", "first seen", "last seen", "kind", "repository");
+	for (size_t i = 0; i < found; i++)
+	{
+		const atgc_failed_sql& statement = statements[i];
+		setTextColor(INTRO_COLOR);
+		printf("%12llu  %-26s %-26s %-7s %s\n", statement.count, statement.firstSeen, statement.lastSeen, statement.kind, statement.component);
+		setTextColor(ERROR_COLOR);
+		printf("              %s\n", statement.statement);
+		setTextColor(INTRO_COLOR);
+		for (const char* line = statement.parameters; *line != '\0'; )
+		{
+			const char* newline = strchr(line, '\n');
+			printf("                %.*s\n", (int) (newline - line), line);
+			line = newline + 1;
+		}
+		printf("\n");
 	}
+	setTextColor(ORIGINAL_COLOR);
+}
 
-	// more stuff that comes from SOP
-	else if (
-				startsWith(trimmedLine, "log4j:WARN") ||
-				contains(trimmedLine, "There was a problem sending an invalidation event") ||
-				contains(trimmedLine, "*** WARNING: Unqualified driver") ||
-				startsWith(trimmedLine, "Warning:") ||
-				contains(trimmedLine, "is not in the safe list") ||
-				contains(trimmedLine, "Found nullable timestamp column") ||
-				contains(trimmedLine, "was not found in the set of columns returned") ||
-				contains(trimmedLine, "Found non-null ManyToOneMultiProperty") ||
-				contains(trimmedLine, "Found unrecognized many-to-one relationship in table") ||
-				contains(trimmedLine, "Found one to one definition in versioned case with both sides using a primary table") ||
-				contains(trimmedLine, "Warning - table") ||
-				contains(trimmedLine, "Missing a src id property in item-descriptor") ||
-				contains(trimmedLine, "Missing a dst id property in item-descriptor") ||
-				contains(trimmedLine, "Missing a dst multi property in item-descriptor") ||
-				(contains(trimmedLine, "The property in item-descriptor") && contains(trimmedLine, "is read only.")) ||
-				contains(trimmedLine, "found more than one agent status : using most recent status : older Status") ||
-				contains(trimmedLine, "getConnection() should be used instead of this method") ||
-				contains(trimmedLine, "Connection.close() should be used instead of this method") ||
-				(contains(trimmedLine, "directory") && contains(trimmedLine, "could not be created")) ||
-				(contains(trimmedLine, "Encountered") && contains(trimmedLine, "expected one of")) ||
-				(contains(trimmedLine, "Class") && contains(trimmedLine, "does not have a property")) ||
-				(contains(trimmedLine, "Attempt to apply the") && contains(trimmedLine, "operator to a null value")) ||
-				(contains(trimmedLine, "Attempt to apply operator") && contains(trimmedLine, "to arguments of type")) ||
-				(contains(trimmedLine, "Attempt to apply operator") && contains(trimmedLine, "to null value")) ||
-				(contains(trimmedLine, "The function") && contains(trimmedLine, "requires") && contains(trimmedLine, "arguments but was passed")) ||
+// the busiest frames of the running threads across every thread dump
+void printStackProfile(atgc_profile* profile, size_t top)
+{
+	vector<atgc_profile_frame> frames(top);
+	size_t found = atgc_profile_top_frames(profile, frames.data(), top);
 
-				// from /atg/nucleus/servlet/NucleusServletResources.properties
-				contains(trimmedLine, "***** WARNING:  System property") ||
-				contains(trimmedLine, "***** WARNING: atg_bootstrap.war may not have started first") ||
-				contains(trimmedLine, "***** WARNING: Context name (context-root) of the atg_bootstrap.war was") ||
-				contains(trimmedLine, "WARNING: Unsupported application server") ||
-				contains(trimmedLine, "WARNING: Warning from ejbc") ||
-				startsWith(trimmedLine, "Warning:") ||
-				startsWith(trimmedLine, "log4j:WARN") ||
-				contains(trimmedLine, "WARNING:") ||
-				contains(trimmedLine, "ATG application EAR file launched in development mode")
-			)
+	setTextColor(INTRO_COLOR);
+	printf("\n");
+	printf("%llu running threads sampled", atgc_profile_samples(profile));
+	printf("\n\n");
+	printf("%12s %7s %12s %7s  %s\n", "self", "", "total", "", "frame");
+	for (size_t i = 0; i < found; i++)
 	{
-		return WARNING_LINE;
+		double samples = (double) atgc_profile_samples(profile);
+		setTextColor(INTRO_COLOR);
+		printf("%12llu %6.1f%% %12llu %6.1f%%  ", frames[i].self, 100.0 * frames[i].self / samples, frames[i].total, 100.0 * frames[i].total / samples);
+		setTextColor(frames[i].self > 0 ? WARNING_COLOR : INTRO_COLOR);
+		printf("%s\n", frames[i].frame);
 	}
+	setTextColor(ORIGINAL_COLOR);
+}
 
-	else if (
-				contains(trimmedLine, "Using default context-root") ||
-				contains(trimmedLine, "Component browsing disabled") ||
-				contains(trimmedLine, "Starting web app nucleus for application") ||
-				contains(trimmedLine, "ATG-Data localconfig for default server") ||
-				contains(trimmedLine, "Stopping Pointbase server...") ||
-				contains(trimmedLine, "Pointbase server stopped.") ||
-				startsWith(trimmedLine, "Shutdown complete") ||
-				startsWith(trimmedLine, "Halting VM") ||
-				contains(trimmedLine, "Configuration file read-only so engine configuration changes will not be saved") ||
-				contains(trimmedLine, "ATG-Data localconfig for server") ||
-				startsWith(trimmedLine, "Query: ") ||
-				startsWith(trimmedLine, "INFO: ")
-		)
-	{
-		return INFO_LINE;
-	}
+// one folded stack per line, as flamegraph.pl reads them
+void writeFoldedStack(void* /*context*/, const char* line, size_t length)
+{
+	fwrite(line, 1, length, stdout);
+	fputc('\n', stdout);
+}
 
-	// [4/5/07 18:09:14:972 CEST] 00000027 SystemOut     O /atg/portal/portletstandard/ATGContainerService PortletInvokerImpl.render() - Error while dispatching portlet. javax.portlet.PortletException
-	// 2007-03-05 20:55:08,998 INFO  [STDOUT]  at org.jboss.mx.server.Invocation.dispatch(Invocation.java:80)
-	else if (contains(trimmedLine, "Error while ") && previousLineType == ERROR_LINE)
+struct MoreLines
+{
+	bool operator()(const atgc_stats_row& a, const atgc_stats_row& b) const
 	{
-		return ERROR_LINE;
+		return a.total > b.total;
 	}
+};
 
-	else if (contains(trimmedLine, "specifies an invalid item-type environnement"))
+void printStatsRow(const char* name, int nameWidth, const atgc_stats_row& row)
+{
+	printf("%-*s", nameWidth, name);
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
 	{
-		return ERROR_LINE;
+		if (type != ATGC_BLANK_LINE)
+		{
+			printf(" %9llu", row.counts[type]);
+		}
 	}
+	printf(" %10llu\n", row.total);
+}
 
-	else if (startsWith(trimmedLine, "LIVECONFIG=false") && endsWith(trimmedLine, "LIVECONFIG=false"))
+void printStatsHeader(const char* name, int nameWidth)
+{
+	printf("%-*s", nameWidth, name);
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
 	{
-		return INFO_LINE;
+		if (type != ATGC_BLANK_LINE)
+		{
+			printf(" %9s", LINE_TYPE_NAMES[type]);
+		}
 	}
+	printf(" %10s\n", "total");
+}
 
-	else if (startsWith(trimmedLine, "LIVECONFIG=true") && endsWith(trimmedLine, "LIVECONFIG=true"))
+// line counts per time bucket, then for the categories with the most lines
+void printStatsTables(const atgc_stats* stats, size_t top)
+{
+	atgc_stats_row row;
+	int nameWidth = 16;
+	for (size_t i = 0; i < atgc_stats_count(stats, ATGC_STATS_BY_TIME); i++)
 	{
-		return INFO_LINE;
+		atgc_stats_get(stats, ATGC_STATS_BY_TIME, i, &row);
+		nameWidth = max(nameWidth, (int) strlen(row.time));
 	}
-
-	/*
-        this covers the period at the end of some stak traces
-		at com.ibm.ws.tcp.channel.impl.WorkQueueManager$Worker.run(WorkQueueManager.java:1039)
-        at com.ibm.ws.util.ThreadPool$Worker.run(ThreadPool.java(Compiled Code))
-		.
-	*/
-	else if (previousLineType == ERROR_LINE && trimmedLine.size() == 1 && startsWith(trimmedLine, ".") && endsWith(trimmedLine, "."))
+	setTextColor(INTRO_COLOR);
+	printf("\n");
+	printStatsHeader("time", nameWidth);
+	for (size_t i = 0; i < atgc_stats_count(stats, ATGC_STATS_BY_TIME); i++)
 	{
-		return ERROR_LINE;
+		atgc_stats_get(stats, ATGC_STATS_BY_TIME, i, &row);
+		printStatsRow(row.time, nameWidth, row);
 	}
 
-	// catches all websphere-specific messages. have a look at the below url:
-	// http://publib.boulder.ibm.com/infocenter/wasinfo/v5r1//index.jsp?topic=/com.ibm.websphere.base.doc/info/aes/ae/ctrb_readmsglogs.html
-	else if (
-				isWebSphere &&
-				(
-					contains(trimmedLine, " E ") ||
-					contains(trimmedLine, " F ") ||
-					contains(trimmedLine, " R ") ||
-					contains(trimmedLine, "     R 	") ||
-					contains(trimmedLine, "SystemErr")
-				)
-			)
+	vector<atgc_stats_row> categories(atgc_stats_count(stats, ATGC_STATS_BY_CATEGORY));
+	for (size_t i = 0; i < categories.size(); i++)
 	{
-		return ERROR_LINE;
+		atgc_stats_get(stats, ATGC_STATS_BY_CATEGORY, i, &categories[i]);
 	}
-	else if (
-				isWebSphere &&
-				(
-					contains(trimmedLine, " I ") ||
-					contains(trimmedLine, " A ") ||
-					contains(trimmedLine, " C ") ||
-					contains(trimmedLine, " D ")
-				)
-			)
+	top = (top < categories.size() ? top : categories.size());
+	partial_sort(categories.begin(), categories.begin() + top, categories.end(), MoreLines());
+	nameWidth = 16;
+	for (size_t i = 0; i < top; i++)
 	{
-		return INFO_LINE;
+		nameWidth = max(nameWidth, (int) strlen(categories[i].category));
 	}
-	else if (
-				isWebSphere &&
-				contains(trimmedLine, " W ")
-			)
+	printf("\n");
+	printStatsHeader("category", nameWidth);
+	for (size_t i = 0; i < top; i++)
 	{
-		return WARNING_LINE;
+		printStatsRow(categories[i].category, nameWidth, categories[i]);
 	}
-
-	// finally, if we can't determine the line type, return info. INFO  [STDOUT] usually means
-	// misconfigured ATG-specific output
-	else if (contains(trimmedLine, "INFO  [STDOUT]"))
+	if (categories.size() > top)
 	{
-		return INFO_LINE;
+		printf("(%lu more categories)\n", (unsigned long) (categories.size() - top));
 	}
-
-	// if we can't find out what this line is, just return other
-	return OTHER_LINE;
-}
-
-// this is called whenever ctrl + c is hit. it displays a message and resets the window text
-void ctrlcCatcher(int sig)
-{
-	printf("\n");
-	setTextColor(EXITING_COLOR);
-	printf("Ctrl + C detected\n");
-	printf("Exiting now...\n");
 	setTextColor(ORIGINAL_COLOR);
-	//SetConsoleTextAttribute(console, originalwindowAttributes);
-	printf("\n");
-	printf("\n");
-	(void) signal(SIGINT, SIG_DFL);
 }
 
-// called for each line of output being processed. it trims the line, finds the line type,
-// colors the line, and adds data to the arrays
-void processLine(string line)
+// a csv field, quoted when it has to be
+void printCsvField(const char* text)
 {
-	if (trim(line).empty())
+	if (strpbrk(text, ",\"\n") == NULL)
 	{
-		printf("\n");
+		fputs(text, stdout);
 		return;
 	}
-	int i=0;
-	int lineType = -1;
-	string trimmedLine = trim(line.c_str());
-	lineType = determineLineType(line, trimmedLine, previousLineTypes, previousLines, previousLinesTrimmed);
-
-	// after finding the line type, color the line
-	switch (lineType)
-	{
-		case INFO_LINE:
-			setTextColor(INFO_COLOR);
-			break;
-		case WARNING_LINE:
-			setTextColor(WARNING_COLOR);
-			break;
-		case DEBUG_LINE:
-			setTextColor(DEBUG_COLOR);
-			break;
-		case ERROR_LINE:
-			setTextColor(ERROR_COLOR);
-			break;
-		case NUCLEUS_LINE:
-			setTextColor(NUCLEUS_COLOR);
-			break;
-		case OTHER_LINE:
-			setTextColor(OTHER_COLOR);
-			break;
-	}
-	// printf writes out text to a console far faster than cout
-	printf("%s", line.c_str()); // write the line
-
-	cout << "\n"; // skip to next line
-
-	// push elements up and insert the current line at position 0
-	for (i = NUM_SAVED_LINES-1; i >= 0; i--)
+	putchar('"');
+	for (const char* c = text; *c != '\0'; c++)
 	{
-		if (i+1 <= NUM_SAVED_LINES-1)
+		if (*c == '"')
 		{
-			previousLines[i+1] = previousLines[i];
+			putchar('"');
 		}
+		putchar(*c);
 	}
-	previousLines[0] = line;
+	putchar('"');
+}
 
-	// push elements up and insert the current line at position 0
-	for (i = NUM_SAVED_LINES-1; i >= 0; i--)
+// every time bucket and category with lines in it, one row each
+void printStatsCsv(const atgc_stats* stats)
+{
+	printf("time,category");
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
 	{
-		if (i+1 <= NUM_SAVED_LINES-1)
+		if (type != ATGC_BLANK_LINE)
 		{
-			previousLinesTrimmed[i+1] = previousLinesTrimmed[i];
+			printf(",%s", LINE_TYPE_NAMES[type]);
 		}
 	}
-	previousLinesTrimmed[0] = trimmedLine;
+	printf(",total\n");
 
-	// push elements up and insert the current line at position 0
-	for (i = NUM_SAVED_LINES-1; i >= 0; i--)
+	atgc_stats_row row;
+	for (size_t i = 0; i < atgc_stats_count(stats, ATGC_STATS_BY_TIME_AND_CATEGORY); i++)
 	{
-		if (i+1 <= (NUM_SAVED_LINES-1))
+		atgc_stats_get(stats, ATGC_STATS_BY_TIME_AND_CATEGORY, i, &row);
+		printCsvField(row.time);
+		putchar(',');
+		printCsvField(row.category);
+		for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
 		{
-			previousLineTypes[i+1] = previousLineTypes[i];
+			if (type != ATGC_BLANK_LINE)
+			{
+				printf(",%llu", row.counts[type]);
+			}
 		}
+		printf(",%llu\n", row.total);
 	}
-	previousLineTypes[0] = lineType;
-
-	/*
-	 * this is important - after each line, set output color to yellow (other). why?
-	 * when you pipe input through this application (eg. startWebLogic.cmd | ATGLogColorizer.exe),
-	 * not all output is piped through. some startup scripts disobey the pipe and write directly
-	 * to the console. that means that this application can't color the output properly because
-	 * it doesn't know what it is! setting the output color to yellow (other) makes any output
-	 * of that type show up in yellow.
-	 */
-	setTextColor(ORIGINAL_COLOR);
 }
 
-int main(int argc, char* argv[])
+// displays help info
+void printHelp()
 {
-	// register the signal catcher - if ctrl + c is received, ctrlcCatcher() is called
-	(void) signal(SIGINT, ctrlcCatcher);
-
-	/*
-	 * without somehow loading the floating point library, the error
-	 * "runtime error R6002 - floating point not loaded" sometimes appears
-	 * i know this is a hack, but hey it gets the library loaded and no more
-	 * errors appear.
-	 */
-	float dummy;
-	dummy=1.1;
-
-    string line; // representing one line of input
-	ifstream inputFile; // represents file stream when reading in log files
-
-	// display introduction message
+	setTextColor(INTRO_COLOR);
+	printf("\n");
+	printf("This program is used to color-code application server output. ");
+	printf("ATGLogColorizer can properly color output for JBoss, WebLogic, DAS, WebSphere, or anything using log4j. ");
+	printf("\n");
+	printf("Logs are colored as follows: \n");
 	setTextColor(INFO_COLOR);
-	printf("ATG");
+	printf("Information");
+	setTextColor(INTRO_COLOR);
+	printf(" - ");
 	setTextColor(WARNING_COLOR);
-	printf("Log");
+	printf("Warning");
+	setTextColor(INTRO_COLOR);
+	printf(" - ");
+	setTextColor(DEBUG_COLOR);
+	printf("Debug");
+	setTextColor(INTRO_COLOR);
+	printf(" - ");
+	setTextColor(ERROR_COLOR);
+	printf("Error");
+	setTextColor(INTRO_COLOR);
+	printf(" - ");
+	setTextColor(NUCLEUS_COLOR);
+	printf("Nucleus");
+	setTextColor(INTRO_COLOR);
+	printf(" - ");
 	setTextColor(OTHER_COLOR);
-	printf("Colorizer");
+	printf("Other");
+
+	setTextColor(INTRO_COLOR);
+	printf("\n\nSample Usage: \n");
+	printf("   [appserver startup script] | ATGLogColorizer.exe\n");
+	printf("                   or\n");
+	printf("   ATGLogColorizer.exe [path to log file]\n");
+	printf("\n");
+	printf("Options: \n");
+	printf("   --rules [rule file]   also color lines matching the rules in this file. can be repeated\n");
+	printf("   --rules-cache [file]  keep the compiled rules in this file so the next run doesn't compile them again\n");
+	printf("   --fold-traces         print a stack trace that was already printed as a one line reference\n");
+	printf("   --collapse-blocks     print one line for the entries of an ENVIRONMENT, CLASSPATH or CONFIGPATH dump\n");
+	printf("   --storm               print the first few of a line logged over and over, then how many times it repeated\n");
+	printf("   --input [name=]path   color this log along with the other --input ones, each line with the name in front.\n");
+	printf("                         the path can be a named pipe, a file or /dev/fd/[n]. can be repeated\n");
+	printf("   [file] [file]...      several log files, or a directory of them, are colored one after the other\n");
+	printf("   --io [uring|blocking] read them with io_uring, several reads running ahead (the default, when the\n");
+	printf("                         kernel has it), or one read() after the other\n");
+	printf("   --index [file]        copy the log to stdout as it is, without colors, and write the byte ranges of each\n");
+	printf("                         line type to this file as \"offset length type\" lines\n");
+	printf("   --daemon [socket]     color the logs sent to this unix socket by other ATGLogColorizers, each on its own\n");
+	printf("   --connect [socket]    have the daemon listening on this socket color the log\n");
+	printf("   --name [name]         the name of the log in the daemon's counters, the file name or stdin otherwise\n");
+	printf("   --daemon-stats [socket] print the lines and bytes per second of the daemon and of each log it colors\n");
+	printf("   --theme [file]        the colors of each line type, from a theme file (see atgcolorize_ansi.h)\n");
+	printf("   --colors=[n]          none, 16, 256 or truecolor, instead of what NO_COLOR, TERM and COLORTERM say\n");
+	printf("   --min-type [type]     only print lines of this type or more important: debug, info, warning, error\n");
+	printf("   --only=[type,...]     only print lines of these types (info, warning, debug, error, other, nucleus, blank)\n");
+	printf("   --match [text]        only print lines containing this text, highlighted. can be given more than once\n");
+	printf("                         a stack trace or SQL block is printed whole when one of its lines is printed\n");
+	printf("   --report exceptions   instead of the log, list the exceptions that happened most and when\n");
+	printf("   --report threads      instead of the log, sum up every thread dump: states, deadlocks, contended monitors\n");
+	printf("   --report stacks       instead of the log, the frames the running threads of all thread dumps were busiest in\n");
+	printf("   --report folded       instead of the log, the stacks of the running threads as folded stacks for flamegraph.pl\n");
+	printf("   --report sql          instead of the log, list the SQL statements that failed most, with their last parameters\n");
+	printf("   --stats               instead of the log, count its lines by type per hour and per category or component\n");
+	printf("   --stats=csv           the same as csv, one row per hour and category\n");
+	printf("   --stats=stages        on stderr at the end or on SIGUSR1, the share of the time and the ns per line spent\n");
+	printf("                         reading, stripping, classifying, rendering and writing, and how long the input and\n");
+	printf("                         the output kept it waiting. can go with the other --stats\n");
+	printf("   --bucket [minutes]    count --stats lines per this many minutes instead of per hour\n");
+	printf("   --top [n]             how many exceptions, frames or statements --report and categories --stats list, 20 by default\n");
+	printf("   --output=html         write the log as a web page, stack traces folded away under their exception\n");
+	printf("   --output=ndjson       write every line as a JSON object with its type, time, level, category and thread\n");
+	printf("   --latency             on stderr at the end or on SIGUSR1 (kill -USR1 [pid]), how long lines took from being\n");
+	printf("                         read to being written, p50, p99, p99.9 and max, and the bytes per second\n");
+	printf("   --metrics [file]      every 10 seconds, write the lines and bytes colored, the lines of each type, the ns per\n");
+	printf("                         line classifying took and more to this file, for the node_exporter textfile collector\n");
+	printf("   --metrics-interval [s] write the --metrics file this many seconds apart instead\n");
+	printf("   --control [fifo]      reload the rule files when \"reload\" is written to this fifo\n");
+	printf("   rule files are also reloaded on SIGHUP (kill -HUP [pid])\n");
+	printf("\n");
+	printf("\n");
+
+	setTextColor(WARNING_COLOR);
+	printf("Warning: This can't be used with CYGWIN on Windows\n");
 	setTextColor(INTRO_COLOR);
-	printf(" v");
-	printf(RELEASE_NUMBER.c_str());
-	printf(". Copyleft 2007-2008 by Kelly Goetsch. http://atglogcolorizer.sourceforge.net\n");
+
+	printf("Bugs? Questions? Comments? Please email kgoetsch@atg.com\n");
 	setTextColor(ORIGINAL_COLOR);
+}
 
-	// if an argument was passed in to the app. should be either -? or a fil ename
-	if (argc > 1)
+// the line type with this name, -1 if there's none
+int lineTypeNamed(const char* name)
+{
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
 	{
-		char* arg1 = argv[1]; // the argument
-
-		// is this a call for help? if so, display help info
-		if (contains(arg1, "?") || contains(arg1, "--?") || contains(arg1, "--help"))
+		if (strcasecmp(name, LINE_TYPE_NAMES[type]) == 0)
 		{
-			setTextColor(INTRO_COLOR);
-			printf("\n");
-			printf("This program is used to color-code application server output. ");
-			printf("ATGLogColorizer can properly color output for JBoss, WebLogic, DAS, WebSphere, or anything using log4j. ");
-			printf("\n");
-			printf("Logs are colored as follows: \n");
-			setTextColor(INFO_COLOR);
-			printf("Information");
-			setTextColor(INTRO_COLOR);
-			printf(" - ");
-			setTextColor(WARNING_COLOR);
-			printf("Warning");
-			setTextColor(INTRO_COLOR);
-			printf(" - ");
-			setTextColor(DEBUG_COLOR);
-			printf("Debug");
-			setTextColor(INTRO_COLOR);
-			printf(" - ");
-			setTextColor(ERROR_COLOR);
-			printf("Error");
-			setTextColor(INTRO_COLOR);
-			printf(" - ");
-			setTextColor(NUCLEUS_COLOR);
-			printf("Nucleus");
-			setTextColor(INTRO_COLOR);
-			printf(" - ");
-			setTextColor(OTHER_COLOR);
-			printf("Other");
+			return type;
+		}
+	}
+	return -1;
+}
 
-			setTextColor(INTRO_COLOR);
-			printf("\n\nSample Usage: \n");
-			printf("   [appserver startup script] | ATGLogColorizer.exe\n");
-			printf("                   or\n");
-			printf("   ATGLogColorizer.exe [path to log file]\n");
-			printf("\n");
-			printf("\n");
+// the streams are done with their rules, lets the reloader free whatever it replaced and stop
+void stopReloader(thread& reloaderThread)
+{
+	if (reloaderThread.joinable())
+	{
+		(void) signal(SIGHUP, SIG_DFL);
+		activeRules.store(NULL);
+		char request = STOP_REQUEST;
+		(void) write(reloadPipe[1], &request, 1);
+		reloaderThread.join();
+	}
+}
 
-			setTextColor(WARNING_COLOR);
-			printf("Warning: This can't be used with CYGWIN on Windows\n");
-			setTextColor(INTRO_COLOR);
+// writes an error message in red, the way a log file that can't be read is reported
+void printError(const char* message)
+{
+	setTextColor(ERROR_COLOR);
+	printf("\n");
+	printf("\n");
+	printf("%s", message);
+	printf("\n");
+	printf("\n");
+	setTextColor(ORIGINAL_COLOR);
+}
+
+// what each stream of --daemon or --input is colored with
+struct StreamOptions
+{
+	bool foldTraces;
+	bool storm;
+	bool collapseBlocks;
+	unsigned int typeMask; // --min-type and --only, 0 for every type
+	vector<const char*> literals; // --match
+};
+
+// a pipeline of its own for a stream of --daemon or --input, writing into sink with prefix in front of every line
+void createStreamPipeline(Pipeline& pipeline, const StreamOptions& options, vector<char>* sink, const string& prefix)
+{
+	pipeline.stream = atgc_stream_create_with_rules(activeRules.load());
+	pipeline.filter = NULL;
+	if (options.typeMask != 0 || !options.literals.empty())
+	{
+		pipeline.filter = atgc_filter_create(options.typeMask != 0 ? options.typeMask : ~0u, options.literals.empty() ? NULL : &options.literals[0], options.literals.size());
+	}
+	pipeline.storm = (options.storm ? atgc_storm_create(0, 0) : NULL);
+	pipeline.folder = (options.foldTraces ? atgc_folder_create(0) : NULL);
+	pipeline.exceptions = NULL;
+	pipeline.stats = NULL;
+	pipeline.threadDumps = NULL;
+	pipeline.profile = NULL;
+	pipeline.failedSQL = NULL;
+	pipeline.collapseBlocks = options.collapseBlocks;
+	pipeline.openBlock = ATGC_BLOCK_NONE;
+	pipeline.blockEntries = 0;
+	pipeline.lines = 0;
+	pipeline.latency = NULL;
+	pipeline.stages = NULL;
+	memset(&pipeline.counters, 0, sizeof(pipeline.counters));
+	pipeline.output.used = 0;
+	pipeline.output.format = OUTPUT_ANSI;
+	pipeline.output.serverType = ATGC_SERVER_UNKNOWN;
+	pipeline.output.html = NULL;
+	pipeline.output.highlight = (!options.literals.empty() ? pipeline.filter : NULL);
+	pipeline.output.sink = sink;
+	pipeline.output.prefix = prefix;
+}
+
+void destroyStreamPipeline(Pipeline& pipeline)
+{
+	atgc_filter_destroy(pipeline.filter);
+	atgc_folder_destroy(pipeline.folder);
+	atgc_storm_destroy(pipeline.storm);
+	atgc_stream_destroy(pipeline.stream);
+}
+
+/*
+ *	--daemon. one process colors the logs of every app server on the box: the rules are compiled
+ *	once, and each client connected to the unix socket gets a stream with its own classifier
+ *	state. a client starts with a request line, "stream <name>" followed by its log, or "stats"
+ *	for the counters. a single epoll loop reads, colors and writes back every stream; a stream
+ *	whose client doesn't read its output fast enough isn't read from until it has caught up
+ */
+struct DaemonStream
+{
+	int fd;
+	unsigned int id;
+	string name; // from the request line
+	bool started; // the request line was read
+	bool endOfInput; // the client sent all of its log, or only wanted the counters
+	bool failed; // the client went away
+	unsigned int events; // what the stream is registered for with epoll
+	vector<char> input;
+	size_t filled;
+	vector<char> pending; // colored lines not written to the client yet
+	size_t written;
+	unsigned long long bytesIn;
+	unsigned long long bytesOut;
+	unsigned long long startMs;
+	unsigned long long lastInputMs;
+	Pipeline pipeline;
+};
+
+struct Daemon
+{
+	int epoll;
+	StreamOptions options;
+	vector<DaemonStream*> streams;
+	unsigned int nextId;
+	unsigned long long startMs;
+
+	// counters of the streams already closed
+	unsigned long long streamsServed;
+	unsigned long long lines;
+	unsigned long long bytesIn;
+	unsigned long long bytesOut;
+};
+
+// a unix socket listening at path. a socket file nobody is listening on any more is replaced
+int listenOnSocket(const char* path)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+	strcpy(address.sun_path, path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	if (bind(fd, (struct sockaddr*) &address, sizeof(address)) < 0 && errno == EADDRINUSE)
+	{
+		int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		bool stale = (probe >= 0 && connect(probe, (struct sockaddr*) &address, sizeof(address)) < 0 && errno == ECONNREFUSED);
+		if (probe >= 0)
+		{
+			close(probe);
+		}
+		if (!stale || unlink(path) < 0 || bind(fd, (struct sockaddr*) &address, sizeof(address)) < 0)
+		{
+			close(fd);
+			return -1;
+		}
+	}
+	if (listen(fd, SOMAXCONN) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// the socket of the daemon listening at path, -1 when there's none
+int connectToDaemon(const char* path)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+	strcpy(address.sun_path, path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd >= 0 && connect(fd, (struct sockaddr*) &address, sizeof(address)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// bytes, seconds and rates of a stream or of all of them, as name=value pairs
+void appendCounters(string& text, unsigned long long lines, unsigned long long bytesIn, unsigned long long bytesOut, unsigned long long elapsedMs)
+{
+	double seconds = (elapsedMs > 0 ? elapsedMs / 1000.0 : 0.001);
+	char counters[256];
+	snprintf(counters, sizeof(counters), " lines=%llu in=%llu out=%llu seconds=%.1f lines/s=%.0f bytes/s=%.0f\n",
+		lines, bytesIn, bytesOut, elapsedMs / 1000.0, lines / seconds, bytesIn / seconds);
+	text += counters;
+}
+
+// the answer to "stats": a line with the counters of all the streams since the daemon started, then one per open stream
+string daemonCounters(const Daemon& daemon)
+{
+	unsigned long long now = monotonicMs();
+	unsigned long long lines = daemon.lines;
+	unsigned long long bytesIn = daemon.bytesIn;
+	unsigned long long bytesOut = daemon.bytesOut;
+	size_t open = 0;
+	for (size_t i = 0; i < daemon.streams.size(); i++)
+	{
+		const DaemonStream& stream = *daemon.streams[i];
+		if (stream.started)
+		{
+			lines += stream.pipeline.lines;
+			bytesIn += stream.bytesIn;
+			bytesOut += stream.bytesOut;
+			open++;
+		}
+	}
+
+	char header[128];
+	snprintf(header, sizeof(header), "total streams=%llu open=%lu", daemon.streamsServed + open, (unsigned long) open);
+	string text = header;
+	appendCounters(text, lines, bytesIn, bytesOut, now - daemon.startMs);
+	for (size_t i = 0; i < daemon.streams.size(); i++)
+	{
+		const DaemonStream& stream = *daemon.streams[i];
+		if (stream.started)
+		{
+			snprintf(header, sizeof(header), "stream id=%u name=", stream.id);
+			text += header;
+			text += stream.name;
+			appendCounters(text, stream.pipeline.lines, stream.bytesIn, stream.bytesOut, now - stream.startMs);
+		}
+	}
+	return text;
+}
+
+// --metrics of every stream, what they read that isn't colored yet and what their clients didn't take yet queued
+void writeDaemonMetrics(const Daemon& daemon)
+{
+	vector<const Pipeline*> pipelines;
+	unsigned long long queuedBytes = 0;
+	for (size_t i = 0; i < daemon.streams.size(); i++)
+	{
+		const DaemonStream& stream = *daemon.streams[i];
+		if (stream.started)
+		{
+			pipelines.push_back(&stream.pipeline);
+			queuedBytes += stream.filled + stream.pending.size() - stream.written;
+		}
+	}
+	writeMetrics(pipelines, queuedBytes);
+}
+
+// registers the stream for reading while it's under MAX_PENDING_OUTPUT, and for writing while it has output waiting
+void updateEvents(Daemon& daemon, DaemonStream& stream)
+{
+	unsigned int events = 0;
+	if (!stream.endOfInput && stream.pending.size() - stream.written < MAX_PENDING_OUTPUT)
+	{
+		events |= EPOLLIN;
+	}
+	if (stream.written < stream.pending.size())
+	{
+		events |= EPOLLOUT;
+	}
+	if (((events ^ stream.events) & EPOLLIN) != 0 && !stream.endOfInput)
+	{
+		ATGC_PROBE3(backpressure, stream.id, stream.pending.size() - stream.written, (int) ((events & EPOLLIN) == 0));
+	}
+	if (events != stream.events)
+	{
+		struct epoll_event event;
+		event.events = events;
+		event.data.ptr = &stream;
+		epoll_ctl(daemon.epoll, EPOLL_CTL_MOD, stream.fd, &event);
+		stream.events = events;
+	}
+}
+
+// writes as much of the colored output as the client takes without blocking
+void writeStream(DaemonStream& stream)
+{
+	while (stream.written < stream.pending.size())
+	{
+		ssize_t sent = send(stream.fd, &stream.pending[stream.written], stream.pending.size() - stream.written, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (sent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (sent < 0)
+		{
+			stream.failed = (errno != EAGAIN && errno != EWOULDBLOCK);
+			return;
+		}
+		stream.written += sent;
+		stream.bytesOut += sent;
+	}
+	stream.pending.clear();
+	stream.written = 0;
+}
+
+// the request line, "stream <name>" or "stats". false when it isn't all there yet
+bool readRequest(Daemon& daemon, DaemonStream& stream)
+{
+	char* newline = (char*) memchr(&stream.input[0], '\n', stream.filled);
+	if (newline == NULL && !stream.endOfInput)
+	{
+		return false;
+	}
+	size_t length = (newline != NULL ? newline - &stream.input[0] : stream.filled);
+	string request(&stream.input[0], length);
+	if (!request.empty() && request[request.size() - 1] == '\r')
+	{
+		request.erase(request.size() - 1);
+	}
+	size_t used = (newline != NULL ? length + 1 : length);
+	memmove(&stream.input[0], &stream.input[used], stream.filled - used);
+	stream.filled -= used;
+	stream.bytesIn -= used;
+
+	if (request.compare(0, 7, "stream ") == 0 || request == "stream")
+	{
+		stream.name = (request.size() > 7 ? request.substr(7) : "-");
+		replace(stream.name.begin(), stream.name.end(), ' ', '_');
+		stream.started = true;
+		stream.startMs = monotonicMs();
+		createStreamPipeline(stream.pipeline, daemon.options, &stream.pending, string());
+	}
+	else
+	{
+		string answer = (request == "stats" ? daemonCounters(daemon) : "unknown request, send \"stream <name>\" and the log, or \"stats\"\n");
+		stream.pending.insert(stream.pending.end(), answer.begin(), answer.end());
+		stream.endOfInput = true;
+		stream.filled = 0;
+	}
+	return true;
+}
+
+/*
+ *	reads what the client sent and colors it into its output. only one read at a time: epoll keeps
+ *	reporting the stream as long as there's more, and the other streams get their turn in between
+ */
+void readStream(Daemon& daemon, DaemonStream& stream)
+{
+	if (stream.endOfInput || stream.pending.size() - stream.written >= MAX_PENDING_OUTPUT)
+	{
+		return;
+	}
+	if (stream.filled == stream.input.size())
+	{
+		stream.input.resize(stream.input.size() * 2);
+	}
+	ssize_t bytesRead = read(stream.fd, &stream.input[stream.filled], stream.input.size() - stream.filled);
+	if (bytesRead < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return;
+	}
+	if (bytesRead <= 0)
+	{
+		stream.endOfInput = true;
+		bytesRead = 0;
+	}
+	stripNullChars(&stream.input[stream.filled], bytesRead);
+	stream.filled += bytesRead;
+	stream.bytesIn += bytesRead;
+	stream.lastInputMs = monotonicMs();
+
+	if (!stream.started && !readRequest(daemon, stream))
+	{
+		return;
+	}
+	if (stream.started)
+	{
+		size_t offset = processInput(stream.pipeline, &stream.input[0], stream.filled, stream.endOfInput);
+		memmove(&stream.input[0], &stream.input[offset], stream.filled - offset);
+		stream.filled -= offset;
+	}
+	writeStream(stream);
+}
+
+void acceptStreams(Daemon& daemon, int listener)
+{
+	while (true)
+	{
+		int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (fd < 0)
+		{
+			return;
+		}
+		DaemonStream* stream = new DaemonStream();
+		stream->fd = fd;
+		stream->id = daemon.nextId++;
+		stream->started = false;
+		stream->endOfInput = false;
+		stream->failed = false;
+		stream->events = EPOLLIN;
+		stream->input.resize(READ_BUFFER_SIZE);
+		stream->filled = 0;
+		stream->written = 0;
+		stream->bytesIn = 0;
+		stream->bytesOut = 0;
+		stream->startMs = stream->lastInputMs = monotonicMs();
+
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = stream;
+		if (epoll_ctl(daemon.epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+		{
+			close(fd);
+			delete stream;
+			continue;
+		}
+		daemon.streams.push_back(stream);
+	}
+}
+
+void closeStream(Daemon& daemon, DaemonStream* stream)
+{
+	if (stream->started)
+	{
+		daemon.streamsServed++;
+		daemon.lines += stream->pipeline.lines;
+		daemon.bytesIn += stream->bytesIn;
+		daemon.bytesOut += stream->bytesOut;
+		retireCounters(stream->pipeline);
+		destroyStreamPipeline(stream->pipeline);
+	}
+	close(stream->fd);
+	daemon.streams.erase(find(daemon.streams.begin(), daemon.streams.end(), stream));
+	delete stream;
+}
+
+// serves streams on the socket at path until killed
+int serveDaemon(const char* path, const StreamOptions& options)
+{
+	int listener = listenOnSocket(path);
+	if (listener < 0)
+	{
+		string message = string("Can't listen on the socket '") + path + "'";
+		printError(message.c_str());
+		return 1;
+	}
+	Daemon daemon;
+	daemon.epoll = epoll_create1(EPOLL_CLOEXEC);
+	daemon.options = options;
+	daemon.nextId = 1;
+	daemon.startMs = monotonicMs();
+	daemon.streamsServed = 0;
+	daemon.lines = 0;
+	daemon.bytesIn = 0;
+	daemon.bytesOut = 0;
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = NULL; // the listening socket
+	epoll_ctl(daemon.epoll, EPOLL_CTL_ADD, listener, &event);
+	if (!plainOutput)
+	{
+		setTextColor(INTRO_COLOR);
+		printf("Listening on %s\n", path);
+		setTextColor(ORIGINAL_COLOR);
+		fflush(stdout);
+	}
+
+	struct epoll_event events[MAX_DAEMON_EVENTS];
+	while (true)
+	{
+		bool holding = false;
+		for (size_t i = 0; i < daemon.streams.size() && !holding; i++)
+		{
+			holding = daemon.streams[i]->started && holdingLines(daemon.streams[i]->pipeline);
+		}
+		int ready = epoll_wait(daemon.epoll, events, MAX_DAEMON_EVENTS, metricsTimeout(holding ? FOLD_IDLE_MS : -1));
+		if (ready < 0 && errno != EINTR)
+		{
+			break;
+		}
+
+		// every stream switches to reloaded rules at the same time, so the replaced set can be freed
+		atgc_rules* rules = takeReloadedRules();
+		for (size_t i = 0; i < daemon.streams.size() && rules != NULL; i++)
+		{
+			if (daemon.streams[i]->started)
+			{
+				atgc_stream_set_rules(daemon.streams[i]->pipeline.stream, rules);
+			}
+		}
+
+		vector<DaemonStream*> finished;
+		for (int i = 0; i < ready; i++)
+		{
+			if (events[i].data.ptr == NULL)
+			{
+				acceptStreams(daemon, listener);
+				continue;
+			}
+			DaemonStream& stream = *(DaemonStream*) events[i].data.ptr;
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			{
+				readStream(daemon, stream);
+			}
+			if (events[i].events & EPOLLOUT)
+			{
+				writeStream(stream);
+				readStream(daemon, stream); // it may have been waiting for its output to go out
+			}
+			if (stream.failed || (stream.endOfInput && stream.written == stream.pending.size()))
+			{
+				finished.push_back(&stream);
+			}
+			else
+			{
+				updateEvents(daemon, stream);
+			}
+		}
+
+		// a trace being held for folding shouldn't sit there while its app server is quiet
+		unsigned long long now = monotonicMs();
+		for (size_t i = 0; i < daemon.streams.size(); i++)
+		{
+			DaemonStream& stream = *daemon.streams[i];
+			if (stream.started && !stream.endOfInput && now - stream.lastInputMs >= (unsigned long long) FOLD_IDLE_MS && holdingLines(stream.pipeline))
+			{
+				releaseHeldLines(stream.pipeline);
+				writeStream(stream);
+				updateEvents(daemon, stream);
+			}
+		}
+		for (size_t i = 0; i < finished.size(); i++)
+		{
+			closeStream(daemon, finished[i]);
+		}
+		if (metricsDue())
+		{
+			writeDaemonMetrics(daemon);
+		}
+	}
+	close(daemon.epoll);
+	close(listener);
+	return 1;
+}
+
+/*
+ *	--input. the logs of several app servers read by one process, eg. the named pipes a cluster
+ *	start script writes the output of each managed server to. every input is a stream of its own,
+ *	its lines written out with its name in front. a single epoll loop reads them without blocking,
+ *	one read per input that has something each time around, so an input that writes a lot can't
+ *	keep the others waiting; the complete lines of all of them colored in a round go out together.
+ *	a regular file can't be waited on with epoll, it's read from every time around until it ends
+ */
+struct Input
+{
+	string name;
+	const char* path;
+	int fd; // -1 once the input has ended
+	bool opened;
+	bool polled; // registered with epoll, a regular file isn't
+	bool endOfInput;
+	vector<char> input;
+	size_t filled;
+	unsigned long long lastInputMs;
+	Pipeline pipeline;
+};
+
+// "[name]" padded to the longest name, in front of every line of the input
+string inputPrefix(const string& name, size_t width)
+{
+	string prefix = "[" + name + "]";
+	prefix.append(width + 3 - prefix.size(), ' ');
+	return prefix;
+}
+
+// reads what's there and colors it into the output of the round
+void readInput(Input& input)
+{
+	if (input.filled == input.input.size())
+	{
+		input.input.resize(input.input.size() * 2);
+	}
+	ssize_t bytesRead = read(input.fd, &input.input[input.filled], input.input.size() - input.filled);
+	if (bytesRead < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return;
+	}
+	if (bytesRead <= 0)
+	{
+		input.endOfInput = true;
+		bytesRead = 0;
+	}
+	stripNullChars(&input.input[input.filled], bytesRead);
+	input.filled += bytesRead;
+	input.lastInputMs = monotonicMs();
+
+	size_t offset = processInput(input.pipeline, &input.input[0], input.filled, input.endOfInput);
+	memmove(&input.input[0], &input.input[offset], input.filled - offset);
+	input.filled -= offset;
+	if (input.endOfInput)
+	{
+		retireCounters(input.pipeline);
+		close(input.fd); // which takes it out of epoll
+		input.fd = -1;
+	}
+}
+
+/*
+ *	"name=path" or a path, named after its file then. a path can be a named pipe, a file or
+ *	/dev/fd/<n> for a file descriptor the process was started with
+ */
+void parseInput(const char* arg, Input& input)
+{
+	const char* equals = strchr(arg, '=');
+	input.path = (equals != NULL ? equals + 1 : arg);
+	if (equals != NULL)
+	{
+		input.name.assign(arg, equals - arg);
+	}
+	else
+	{
+		const char* slash = strrchr(arg, '/');
+		input.name = (slash != NULL ? slash + 1 : arg);
+	}
+}
+
+// --metrics of the inputs that haven't ended, and the start of a line each of them is waiting for the rest of
+void writeInputMetrics(const vector<Input>& inputs)
+{
+	vector<const Pipeline*> pipelines;
+	unsigned long long queuedBytes = 0;
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		if (inputs[i].fd >= 0)
+		{
+			pipelines.push_back(&inputs[i].pipeline);
+			queuedBytes += inputs[i].filled;
+		}
+	}
+	writeMetrics(pipelines, queuedBytes);
+}
+
+// colors every input until they've all ended
+int colorizeInputs(vector<Input>& inputs, const StreamOptions& options)
+{
+	int epoll = epoll_create1(EPOLL_CLOEXEC);
+	vector<char> round; // the colored lines of all the inputs, written out together
+	size_t width = 0;
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		width = max(width, inputs[i].name.size());
+	}
+
+	// a named pipe is opened without waiting for its writer. epoll doesn't report it before a writer came
+	size_t open = 0;
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		Input& input = inputs[i];
+		input.fd = ::open(input.path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		input.opened = (input.fd >= 0);
+		if (!input.opened)
+		{
+			string message = string("Input '") + input.path + "' couldn't be read";
+			printError(message.c_str());
+			continue;
+		}
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = &input;
+		input.polled = (epoll_ctl(epoll, EPOLL_CTL_ADD, input.fd, &event) == 0);
+		input.endOfInput = false;
+		input.input.resize(READ_BUFFER_SIZE);
+		input.filled = 0;
+		input.lastInputMs = monotonicMs();
+		createStreamPipeline(input.pipeline, options, &round, inputPrefix(input.name, width));
+		open++;
+	}
+	fflush(stdout);
+
+	struct epoll_event events[MAX_DAEMON_EVENTS];
+	while (open > 0)
+	{
+		bool holding = false;
+		bool files = false;
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			if (inputs[i].fd >= 0)
+			{
+				holding = holding || holdingLines(inputs[i].pipeline);
+				files = files || !inputs[i].polled;
+			}
+		}
+		int ready = epoll_wait(epoll, events, MAX_DAEMON_EVENTS, files ? 0 : metricsTimeout(holding ? FOLD_IDLE_MS : -1));
+		if (ready < 0 && errno != EINTR)
+		{
+			break;
+		}
+
+		// all the inputs switch to reloaded rules at the same time, so the replaced set can be freed
+		atgc_rules* rules = takeReloadedRules();
+		for (size_t i = 0; i < inputs.size() && rules != NULL; i++)
+		{
+			if (inputs[i].opened)
+			{
+				atgc_stream_set_rules(inputs[i].pipeline.stream, rules);
+			}
+		}
+
+		for (int i = 0; i < ready; i++)
+		{
+			readInput(*(Input*) events[i].data.ptr);
+		}
+		unsigned long long now = monotonicMs();
+		open = 0;
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			Input& input = inputs[i];
+			if (input.fd >= 0 && !input.polled)
+			{
+				readInput(input);
+			}
+			else if (input.fd >= 0 && now - input.lastInputMs >= (unsigned long long) FOLD_IDLE_MS && holdingLines(input.pipeline))
+			{
+				// a trace being held for folding shouldn't sit there while its app server is quiet
+				releaseHeldLines(input.pipeline);
+			}
+			open += (input.fd >= 0 ? 1 : 0);
+		}
+
+		if (!round.empty())
+		{
+			fwrite(&round[0], 1, round.size(), stdout);
+			fflush(stdout);
+			round.clear();
+		}
+		if (metricsDue() || (metricsFile != NULL && open == 0))
+		{
+			writeInputMetrics(inputs);
+		}
+	}
+
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		if (inputs[i].fd >= 0)
+		{
+			close(inputs[i].fd);
+		}
+		if (inputs[i].opened)
+		{
+			destroyStreamPipeline(inputs[i].pipeline);
+		}
+	}
+	close(epoll);
+	return 1;
+}
+
+// false when fd doesn't take all of bytes
+bool writeAll(int fd, const char* bytes, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t written = write(fd, bytes, length);
+		if (written < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			return false;
+		}
+		bytes += written;
+		length -= written;
+	}
+	return true;
+}
+
+/*
+ *	moves everything from one file descriptor to the other until end of file. the bytes go through
+ *	a pipe with splice, so they never get copied into the process. when from can't be spliced, eg.
+ *	a terminal, they're read and written instead, and when to can't, the pipe is read out
+ */
+void copyBytes(int from, int to)
+{
+	vector<char> buffer(READ_BUFFER_SIZE);
+	int through[2];
+	if (pipe(through) == 0)
+	{
+		bool spliceOut = true;
+		ssize_t moved;
+		while (true)
+		{
+			moved = splice(from, NULL, through[1], NULL, READ_BUFFER_SIZE, SPLICE_F_MOVE | SPLICE_F_MORE);
+			if (moved < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (moved <= 0)
+			{
+				break;
+			}
+			while (moved > 0)
+			{
+				ssize_t out = -1;
+				if (spliceOut)
+				{
+					out = splice(through[0], NULL, to, NULL, moved, SPLICE_F_MOVE | SPLICE_F_MORE);
+					if (out < 0 && errno == EINTR)
+					{
+						continue;
+					}
+					spliceOut = !(out < 0 && errno == EINVAL);
+				}
+				if (!spliceOut)
+				{
+					out = read(through[0], &buffer[0], min(buffer.size(), (size_t) moved));
+					out = (out > 0 && writeAll(to, &buffer[0], out) ? out : -1);
+				}
+				if (out <= 0)
+				{
+					close(through[0]);
+					close(through[1]);
+					return;
+				}
+				moved -= out;
+			}
+		}
+		bool cantSplice = (moved < 0 && errno == EINVAL);
+		close(through[0]);
+		close(through[1]);
+		if (!cantSplice)
+		{
+			return;
+		}
+	}
+
+	while (true)
+	{
+		ssize_t bytesRead = read(from, &buffer[0], buffer.size());
+		if (bytesRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (bytesRead <= 0 || !writeAll(to, &buffer[0], bytesRead))
+		{
+			return;
+		}
+	}
+}
+
+void sendLog(int fd, int daemon)
+{
+	copyBytes(fd, daemon);
+	shutdown(daemon, SHUT_WR);
+}
+
+/*
+ *	--connect. hands the log to the daemon as a stream called name and writes out the colored
+ *	lines it sends back, or with stats the daemon's counters
+ */
+int runClient(const char* path, int fd, const char* name, bool stats)
+{
+	(void) signal(SIGPIPE, SIG_IGN);
+	int daemon = connectToDaemon(path);
+	if (daemon < 0)
+	{
+		string message = string("No daemon is listening on '") + path + "'";
+		printError(message.c_str());
+		return 1;
+	}
+	string request = (stats ? string("stats\n") : string("stream ") + name + "\n");
+	if (!writeAll(daemon, request.data(), request.size()))
+	{
+		close(daemon);
+		return 1;
+	}
+	thread sender;
+	if (stats)
+	{
+		shutdown(daemon, SHUT_WR);
+	}
+	else
+	{
+		sender = thread(sendLog, fd, daemon);
+	}
+	copyBytes(daemon, STDOUT_FILENO);
+	if (sender.joinable())
+	{
+		sender.join();
+	}
+	close(daemon);
+	return 0;
+}
+
+// --index. the log as it is in the output, and which byte ranges of it are of which line type
+struct LineIndex
+{
+	FILE* file;
+	atgc_stream* stream;
+	vector<char> input; // the copy of the log the lines are classified from
+	size_t filled;
+	unsigned long long runOffset; // the run of lines of one type being added to
+	unsigned long long runLength;
+	int runType; // -1 before the first line
+};
+
+void writeRun(LineIndex& index)
+{
+	if (index.runLength > 0)
+	{
+		fprintf(index.file, "%llu %llu %s\n", index.runOffset, index.runLength, LINE_TYPE_NAMES[index.runType]);
+	}
+}
+
+// a line of another type starts a new run. blank lines go with the run they're in, so a stack trace stays one run
+void addToRun(LineIndex& index, unsigned long long length, int lineType)
+{
+	if (lineType == index.runType || (lineType == ATGC_BLANK_LINE && index.runType >= 0))
+	{
+		index.runLength += length;
+		return;
+	}
+	writeRun(index);
+	index.runOffset += index.runLength;
+	index.runLength = length;
+	index.runType = lineType;
+}
+
+// classifies the complete lines of the copy, and at the end of the log a last one without a newline
+void indexLines(LineIndex& index, bool endOfInput)
+{
+	const char* lines[MAX_BATCH_LINES];
+	size_t lengths[MAX_BATCH_LINES];
+	int types[MAX_BATCH_LINES];
+	stripNullChars(&index.input[0], index.filled);
+	pickUpReloadedRules(index.stream);
+	size_t offset = 0;
+	while (true)
+	{
+		size_t count = 0;
+		while (count < MAX_BATCH_LINES && offset < index.filled)
+		{
+			char* newline = (char*) memchr(&index.input[offset], '\n', index.filled - offset);
+			if (newline == NULL && !endOfInput)
+			{
+				break;
+			}
+			lines[count] = &index.input[offset];
+			lengths[count] = (newline != NULL ? newline - &index.input[offset] : index.filled - offset);
+			offset += lengths[count] + (newline != NULL ? 1 : 0);
+			count++;
+		}
+		if (count == 0)
+		{
+			break;
+		}
+		atgc_classify_batch(index.stream, lines, lengths, count, types);
+		for (size_t i = 0; i < count; i++)
+		{
+			// the newline is part of the range, the runs cover every byte of the log
+			bool terminated = (lines[i] + lengths[i] < &index.input[0] + index.filled);
+			addToRun(index, lengths[i] + (terminated ? 1 : 0), types[i]);
+		}
+	}
+	memmove(&index.input[0], &index.input[offset], index.filled - offset);
+	index.filled -= offset;
+}
+
+// reads exactly length bytes from the pipe into the copy
+bool readIntoIndex(int fd, LineIndex& index, size_t length)
+{
+	if (index.input.size() < index.filled + length)
+	{
+		index.input.resize(max(index.input.size() * 2, index.filled + length));
+	}
+	while (length > 0)
+	{
+		ssize_t bytesRead = read(fd, &index.input[index.filled], length);
+		if (bytesRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (bytesRead <= 0)
+		{
+			return false;
+		}
+		index.filled += bytesRead;
+		length -= bytesRead;
+	}
+	return true;
+}
+
+bool spliceAll(int from, int to, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t moved = splice(from, NULL, to, NULL, length, SPLICE_F_MOVE | SPLICE_F_MORE);
+		if (moved < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (moved <= 0)
+		{
+			return false;
+		}
+		length -= moved;
+	}
+	return true;
+}
+
+/*
+ *	copies the log from fd to stdout unchanged, indexing it on the way. the bytes are spliced into
+ *	a pipe, teed into a second one and spliced on to stdout, so the log itself never comes up into
+ *	the process: only the teed copy is read, by the classifier. a terminal can't be spliced, from
+ *	or to; the log is read and written then
+ */
+void indexLog(int fd, LineIndex& index)
+{
+	int through[2] = { -1, -1 };
+	int teed[2] = { -1, -1 };
+	bool splicing = !isatty(fd) && !isatty(STDOUT_FILENO) && pipe(through) == 0 && pipe(teed) == 0;
+	if (splicing)
+	{
+		// the same size, so whatever one holds can be teed into the other
+		fcntl(through[1], F_SETPIPE_SZ, (int) INDEX_PIPE_SIZE);
+		fcntl(teed[1], F_SETPIPE_SZ, fcntl(through[1], F_GETPIPE_SZ));
+	}
+
+	bool spliced = false;
+	while (splicing)
+	{
+		ssize_t moved = splice(fd, NULL, through[1], NULL, INDEX_PIPE_SIZE, SPLICE_F_MOVE | SPLICE_F_MORE);
+		if (moved < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (moved <= 0)
+		{
+			// when fd is something splice doesn't know, nothing was moved yet and it can still be read
+			splicing = !(moved < 0 && errno == EINVAL && !spliced);
+			break;
+		}
+		spliced = true;
+		while (moved > 0)
+		{
+			ssize_t copied = tee(through[0], teed[1], moved, 0);
+			if (copied < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (copied <= 0 || !readIntoIndex(teed[0], index, copied) || !spliceAll(through[0], STDOUT_FILENO, copied))
+			{
+				moved = -1;
+				break;
+			}
+			moved -= copied;
+		}
+		if (moved < 0)
+		{
+			break;
+		}
+		indexLines(index, false);
+	}
+
+	while (!splicing)
+	{
+		if (index.input.size() < index.filled + READ_BUFFER_SIZE)
+		{
+			index.input.resize(index.filled + READ_BUFFER_SIZE);
+		}
+		ssize_t bytesRead = read(fd, &index.input[index.filled], READ_BUFFER_SIZE);
+		if (bytesRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (bytesRead <= 0 || !writeAll(STDOUT_FILENO, &index.input[index.filled], bytesRead))
+		{
+			break;
+		}
+		index.filled += bytesRead;
+		indexLines(index, false);
+	}
+
+	indexLines(index, true);
+	writeRun(index);
+	for (int i = 0; i < 2; i++)
+	{
+		if (through[i] >= 0)
+		{
+			close(through[i]);
+		}
+		if (teed[i] >= 0)
+		{
+			close(teed[i]);
+		}
+	}
+}
 
-			printf("Bugs? Questions? Comments? Please email kgoetsch@atg.com\n");
-			setTextColor(ORIGINAL_COLOR);
+int main(int argc, char* argv[])
+{
+	// register the signal catcher - if ctrl + c is received, ctrlcCatcher() is called
+	(void) signal(SIGINT, ctrlcCatcher);
+
+	/*
+	 * without somehow loading the floating point library, the error
+	 * "runtime error R6002 - floating point not loaded" sometimes appears
+	 * i know this is a hack, but hey it gets the library loaded and no more
+	 * errors appear.
+	 */
+	float dummy;
+	dummy=1.1;
+
+	int inputFile = STDIN_FILENO; // the log file, or stdin when the output is piped in
+	const char* inputFileName = NULL;
+	vector<const char*> logFiles; // the file names given, several or a directory are colored as one log
+	bool blockingIO = false; // --io blocking
+	vector<const char*> rulePaths;
+	const char* controlFileName = NULL;
+	const char* cacheFileName = NULL;
+	bool foldTraces = false;
+	bool collapseBlocks = false;
+	bool storm = false;
+	unsigned int typeMask = 0; // --min-type and --only, 0 for every type
+	vector<const char*> literals; // --match
+	bool reportExceptions = false;
+	bool reportThreads = false;
+	bool reportStacks = false;
+	bool reportFolded = false;
+	bool reportSQL = false;
+	size_t reportTop = DEFAULT_REPORT_TOP;
+	bool stats = false;
+	bool statsCsv = false;
+	unsigned int bucketMinutes = 0;
+	int outputFormat = OUTPUT_ANSI;
+	const char* daemonSocket = NULL; // --daemon
+	const char* clientSocket = NULL; // --connect or --daemon-stats
+	bool daemonStats = false;
+	const char* streamName = NULL;
+	vector<Input> inputs; // --input
+	const char* indexFileName = NULL; // --index
+	bool latency = false;
+	bool stageStats = false; // --stats=stages
+	const char* metricsFileName = NULL; // --metrics
+	unsigned long metricsInterval = DEFAULT_METRICS_INTERVAL;
+
+	// machine readable output and the colors have to be known before anything is printed
+	const char* themeFileName = NULL;
+	int colorDepth = atgc_ansi_detect_colors();
+	for (int i = 1; i < argc; i++)
+	{
+		plainOutput = plainOutput || (strcmp(argv[i], "--stats=csv") == 0) || (strcmp(argv[i], "--output=ndjson") == 0)
+			|| (strcmp(argv[i], "--output=html") == 0) || (strcmp(argv[i], "folded") == 0 && strcmp(argv[i - 1], "--report") == 0)
+			|| (strcmp(argv[i], "--connect") == 0) || (strcmp(argv[i], "--daemon-stats") == 0) || (strcmp(argv[i], "--index") == 0);
+		if (strcmp(argv[i], "--theme") == 0 && i + 1 < argc)
+		{
+			themeFileName = argv[i + 1];
+		}
+		else if (strncmp(argv[i], "--colors=", 9) == 0)
+		{
+			const char* depth = argv[i] + 9;
+			colorDepth = (strcmp(depth, "none") == 0 ? ATGC_COLORS_NONE : strcmp(depth, "256") == 0 ? ATGC_COLORS_256
+				: strcmp(depth, "truecolor") == 0 ? ATGC_COLORS_TRUECOLOR : ATGC_COLORS_16);
+		}
+	}
+	if (themeFileName != NULL || colorDepth != ATGC_COLORS_16)
+	{
+		char themeError[512];
+		colorTheme = atgc_theme_load(themeFileName, colorDepth, themeError, sizeof(themeError));
+		if (colorTheme == NULL)
+		{
+			printError(themeError);
 			return 1;
 		}
-		else // if the argument is not for help, assume it's a log file
+	}
+
+	// display introduction message
+	if (!plainOutput)
+	{
+		setTextColor(INFO_COLOR);
+		printf("ATG");
+		setTextColor(WARNING_COLOR);
+		printf("Log");
+		setTextColor(OTHER_COLOR);
+		printf("Colorizer");
+		setTextColor(INTRO_COLOR);
+		printf(" v");
+		printf(RELEASE_NUMBER.c_str());
+		printf(". Copyleft 2007-2008 by Kelly Goetsch. http://atglogcolorizer.sourceforge.net\n");
+		setTextColor(ORIGINAL_COLOR);
+	}
+
+	// arguments are options, -? for help or a file name
+	for (int i = 1; i < argc; i++)
+	{
+		char* arg = argv[i];
+
+		// is this a call for help? if so, display help info
+		if (strstr(arg, "?") != NULL || strstr(arg, "--help") != NULL)
 		{
-			setTextColor(INTRO_COLOR);
-			printf("Opening file ");
-			printf(arg1);
-			printf("\n");
-			inputFile.open(arg1); // open file for reading
-			if (inputFile.fail()) // did file fail?
+			printHelp();
+			return 1;
+		}
+		else if (strcmp(arg, "--rules") == 0 && i + 1 < argc)
+		{
+			rulePaths.push_back(argv[++i]);
+		}
+		else if (strcmp(arg, "--rules-cache") == 0 && i + 1 < argc)
+		{
+			cacheFileName = argv[++i];
+		}
+		else if (strcmp(arg, "--fold-traces") == 0)
+		{
+			foldTraces = true;
+		}
+		else if (strcmp(arg, "--collapse-blocks") == 0)
+		{
+			collapseBlocks = true;
+		}
+		else if (strcmp(arg, "--storm") == 0)
+		{
+			storm = true;
+		}
+		else if (strcmp(arg, "--min-type") == 0 && i + 1 < argc)
+		{
+			int minType = lineTypeNamed(argv[++i]);
+			if (minType < 0)
+			{
+				printError("Unknown line type for --min-type, the types are info, warning, debug, error, other, nucleus and blank");
+				return 1;
+			}
+			for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
+			{
+				if (LINE_TYPE_RANKS[type] >= LINE_TYPE_RANKS[minType])
+				{
+					typeMask |= ATGC_TYPE_BIT(type);
+				}
+			}
+		}
+		else if (strncmp(arg, "--only=", 7) == 0)
+		{
+			// a comma separated list of types
+			string types = arg + 7;
+			size_t begin = 0;
+			while (begin <= types.size())
+			{
+				size_t comma = types.find(',', begin);
+				string name = types.substr(begin, comma == string::npos ? string::npos : comma - begin);
+				int type = lineTypeNamed(name.c_str());
+				if (type < 0)
+				{
+					string message = string("Unknown line type '") + name + "' for --only, the types are info, warning, debug, error, other, nucleus and blank";
+					printError(message.c_str());
+					return 1;
+				}
+				typeMask |= ATGC_TYPE_BIT(type);
+				begin = (comma == string::npos ? types.size() + 1 : comma + 1);
+			}
+		}
+		else if (strcmp(arg, "--match") == 0 && i + 1 < argc)
+		{
+			literals.push_back(argv[++i]);
+		}
+		else if (strcmp(arg, "--report") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "exceptions") == 0)
+			{
+				reportExceptions = true;
+			}
+			else if (strcmp(argv[i], "threads") == 0)
+			{
+				reportThreads = true;
+			}
+			else if (strcmp(argv[i], "stacks") == 0)
+			{
+				reportStacks = true;
+			}
+			else if (strcmp(argv[i], "folded") == 0)
+			{
+				reportFolded = true;
+			}
+			else if (strcmp(argv[i], "sql") == 0)
+			{
+				reportSQL = true;
+			}
+			else
+			{
+				string message = string("Unknown report '") + argv[i] + "', the reports are exceptions, threads, stacks, folded and sql";
+				printError(message.c_str());
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--stats=stages") == 0)
+		{
+			stageStats = true;
+		}
+		else if (strcmp(arg, "--stats") == 0 || strcmp(arg, "--stats=csv") == 0)
+		{
+			stats = true;
+			statsCsv = (strcmp(arg, "--stats=csv") == 0);
+		}
+		else if (strcmp(arg, "--bucket") == 0 && i + 1 < argc)
+		{
+			bucketMinutes = (unsigned int) strtoul(argv[++i], NULL, 10);
+		}
+		else if (strcmp(arg, "--top") == 0 && i + 1 < argc)
+		{
+			reportTop = (size_t) strtoul(argv[++i], NULL, 10);
+		}
+		else if (strcmp(arg, "--output=ndjson") == 0)
+		{
+			outputFormat = OUTPUT_NDJSON;
+		}
+		else if (strcmp(arg, "--output=html") == 0)
+		{
+			outputFormat = OUTPUT_HTML;
+		}
+		else if (strcmp(arg, "--control") == 0 && i + 1 < argc)
+		{
+			controlFileName = argv[++i];
+		}
+		else if (strcmp(arg, "--daemon") == 0 && i + 1 < argc)
+		{
+			daemonSocket = argv[++i];
+		}
+		else if (strcmp(arg, "--connect") == 0 && i + 1 < argc)
+		{
+			clientSocket = argv[++i];
+		}
+		else if (strcmp(arg, "--daemon-stats") == 0 && i + 1 < argc)
+		{
+			clientSocket = argv[++i];
+			daemonStats = true;
+		}
+		else if (strcmp(arg, "--input") == 0 && i + 1 < argc)
+		{
+			inputs.push_back(Input());
+			parseInput(argv[++i], inputs.back());
+		}
+		else if (strcmp(arg, "--name") == 0 && i + 1 < argc)
+		{
+			streamName = argv[++i];
+		}
+		else if (strcmp(arg, "--theme") == 0 && i + 1 < argc)
+		{
+			i++; // loaded before the introduction message, like --colors
+		}
+		else if (strncmp(arg, "--colors=", 9) == 0)
+		{
+			continue;
+		}
+		else if (strcmp(arg, "--latency") == 0)
+		{
+			latency = true;
+		}
+		else if (strcmp(arg, "--metrics") == 0 && i + 1 < argc)
+		{
+			metricsFileName = argv[++i];
+		}
+		else if (strcmp(arg, "--metrics-interval") == 0 && i + 1 < argc)
+		{
+			metricsInterval = strtoul(argv[++i], NULL, 10);
+			if (metricsInterval == 0)
+			{
+				printError("--metrics-interval is how many seconds apart the metrics file is written");
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--index") == 0 && i + 1 < argc)
+		{
+			indexFileName = argv[++i];
+		}
+		else if (strcmp(arg, "--io") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "blocking") == 0 || strcmp(argv[i], "uring") == 0)
+			{
+				blockingIO = (strcmp(argv[i], "blocking") == 0);
+			}
+			else
+			{
+				printError("Unknown --io, it's uring or blocking");
+				return 1;
+			}
+		}
+		else // if the argument is not an option, assume it's a log file
+		{
+			logFiles.push_back(arg);
+		}
+	}
+
+	// a directory stands for the files in it
+	vector<string> batchPaths;
+	for (size_t i = 0; i < logFiles.size(); i++)
+	{
+		struct stat st;
+		if (stat(logFiles[i], &st) == 0 && S_ISDIR(st.st_mode))
+		{
+			if (!listDirectory(logFiles[i], batchPaths))
 			{
-				// file failed, couldn't be read. write error message and abort
-				setTextColor(ERROR_COLOR);
-				printf("\n");
-				printf("\n");
-				printf("File '");
-				printf(arg1);
-				printf("' couldn't be read");
-				printf("\n");
-				printf("\n");
-				setTextColor(ORIGINAL_COLOR);
+				string message = string("Directory '") + logFiles[i] + "' couldn't be read";
+				printError(message.c_str());
 				return 1;
 			}
 		}
+		else
+		{
+			batchPaths.push_back(logFiles[i]);
+		}
+	}
+	if (logFiles.size() == 1 && batchPaths.size() == 1 && batchPaths[0] == logFiles[0])
+	{
+		inputFileName = logFiles[0];
+		batchPaths.clear();
+	}
+	else if (!logFiles.empty() && batchPaths.empty())
+	{
+		printError("There are no log files in the directory");
+		return 1;
+	}
+
+	if (storm && collapseBlocks)
+	{
+		printError("--storm and --collapse-blocks can't be used together");
+		return 1;
+	}
+	bool reporting = (reportExceptions || reportThreads || reportStacks || reportFolded || reportSQL || stats);
+	if (daemonSocket != NULL && (reporting || outputFormat != OUTPUT_ANSI || !logFiles.empty() || !inputs.empty()))
+	{
+		printError("--daemon colors the streams sent to it with --connect, it can't read a log itself, report or write anything but colors");
+		return 1;
+	}
+	if (!inputs.empty() && (reporting || outputFormat != OUTPUT_ANSI || !logFiles.empty() || clientSocket != NULL))
+	{
+		printError("--input can't be used with a log file, --connect, a report or an --output format");
+		return 1;
+	}
+	if (clientSocket != NULL && !batchPaths.empty())
+	{
+		printError("--connect sends the daemon one log file");
+		return 1;
+	}
+	if (latency && (daemonSocket != NULL || clientSocket != NULL || !inputs.empty() || indexFileName != NULL))
+	{
+		printError("--latency measures the log being colored here, it can't be used with --daemon, --connect, --input or --index");
+		return 1;
+	}
+	if (stageStats && (daemonSocket != NULL || clientSocket != NULL || !inputs.empty() || indexFileName != NULL))
+	{
+		printError("--stats=stages times the log being colored here, it can't be used with --daemon, --connect, --input or --index");
+		return 1;
+	}
+	if (metricsFileName != NULL && (clientSocket != NULL || indexFileName != NULL))
+	{
+		printError("--metrics counts the lines colored here, it can't be used with --connect, --daemon-stats or --index");
+		return 1;
+	}
+	if (indexFileName != NULL && (reporting || outputFormat != OUTPUT_ANSI || foldTraces || storm || collapseBlocks || typeMask != 0
+		|| !literals.empty() || !batchPaths.empty() || !inputs.empty() || daemonSocket != NULL || clientSocket != NULL))
+	{
+		printError("--index copies one log as it is, it can't be used with anything that changes or reports on the lines");
+		return 1;
+	}
+
+	// the streams of --daemon and --input are each colored on their own the same way
+	StreamOptions streamOptions;
+	streamOptions.foldTraces = foldTraces;
+	streamOptions.storm = storm;
+	streamOptions.collapseBlocks = collapseBlocks;
+	streamOptions.typeMask = typeMask;
+	streamOptions.literals = literals;
+
+	if (!batchPaths.empty() && !plainOutput)
+	{
+		setTextColor(INTRO_COLOR);
+		printf("Opening %lu files\n", (unsigned long) batchPaths.size());
+	}
+	if (inputFileName != NULL)
+	{
+		if (!plainOutput)
+		{
+			setTextColor(INTRO_COLOR);
+			printf("Opening file ");
+			printf("%s", inputFileName);
+			printf("\n");
+		}
+		inputFile = open(inputFileName, O_RDONLY); // open file for reading
+		if (inputFile < 0) // did file fail?
+		{
+			// file failed, couldn't be read. write error message and abort
+			string message = string("File '") + inputFileName + "' couldn't be read";
+			printError(message.c_str());
+			return 1;
+		}
+	}
+
+	// with --connect, the daemon does the coloring
+	if (clientSocket != NULL)
+	{
+		return runClient(clientSocket, inputFile, streamName != NULL ? streamName : (inputFileName != NULL ? inputFileName : "stdin"), daemonStats);
+	}
+
+	// user rules are compiled once here, together with the built-in ones, or mapped in from the cache
+	char ruleError[512];
+	atgc_rules* rules = atgc_rules_load(rulePaths.empty() ? NULL : &rulePaths[0], rulePaths.size(), cacheFileName, ruleError, sizeof(ruleError));
+	if (rules == NULL)
+	{
+		printError(ruleError);
+		return 1;
+	}
+
+	atgc_stream* stream = atgc_stream_create_with_rules(rules);
+	if (stream == NULL)
+	{
+		return 1;
+	}
+	publishedRules.store(rules);
+	activeRules.store(rules);
+
+	/*
+	 * with rule files or a control fifo, start the reloader thread. the fifo is opened read-write
+	 * so it doesn't report end of file every time a writer closes it
+	 */
+	int control = -1;
+	thread reloaderThread;
+	if (controlFileName != NULL)
+	{
+		control = open(controlFileName, O_RDWR | O_NONBLOCK);
+		if (control < 0)
+		{
+			string message = string("Control fifo '") + controlFileName + "' couldn't be opened";
+			printError(message.c_str());
+			return 1;
+		}
+	}
+	if ((!rulePaths.empty() || control >= 0) && pipe(reloadPipe) == 0)
+	{
+		fcntl(reloadPipe[1], F_SETFL, O_NONBLOCK);
+		reloaderThread = thread(reloader, rulePaths, cacheFileName, control);
+
+		struct sigaction hangup;
+		memset(&hangup, 0, sizeof(hangup));
+		hangup.sa_handler = hangupCatcher;
+		hangup.sa_flags = SA_RESTART;
+		sigaction(SIGHUP, &hangup, NULL);
+	}
+
+	MetricsFile metrics;
+	if (metricsFileName != NULL)
+	{
+		metrics.path = metricsFileName;
+		metrics.temporaryPath = metrics.path + ".tmp";
+		metrics.intervalMs = metricsInterval * 1000;
+		metrics.nextMs = monotonicMs() + metrics.intervalMs;
+		memset(&metrics.retired, 0, sizeof(metrics.retired));
+		metrics.failed = false;
+		metricsFile = &metrics;
 	}
 
-	// if reading a log file, open it and process each line, one at a time
-	if (argc > 1)
+	if (!inputs.empty())
 	{
-		while(getline(inputFile,line)) // read line one at a time
+		atgc_stream_destroy(stream); // every input gets its own
+		int status = colorizeInputs(inputs, streamOptions);
+		stopReloader(reloaderThread);
+		if (control >= 0)
 		{
-			processLine(stripNullChars(line)); // strip line of null characters and process it
+			close(control);
 		}
-		inputFile.close(); // close file
+		atgc_rules_destroy(publishedRules.load());
+		setTextColor(ORIGINAL_COLOR);
+		return status;
 	}
-	else // otherwise, read in each line from cin
+	if (indexFileName != NULL)
 	{
-		while(getline(cin,line)) // read line one at a time
+		LineIndex index;
+		index.file = fopen(indexFileName, "w");
+		if (index.file == NULL)
+		{
+			string message = string("Index file '") + indexFileName + "' couldn't be written";
+			printError(message.c_str());
+			return 1;
+		}
+		index.stream = stream;
+		index.filled = 0;
+		index.runOffset = 0;
+		index.runLength = 0;
+		index.runType = -1;
+		indexLog(inputFile, index);
+		fclose(index.file);
+		stopReloader(reloaderThread);
+		if (control >= 0)
+		{
+			close(control);
+		}
+		atgc_stream_destroy(stream);
+		atgc_rules_destroy(publishedRules.load());
+		return 0;
+	}
+	if (daemonSocket != NULL)
+	{
+		atgc_stream_destroy(stream); // every stream gets its own
+		int status = serveDaemon(daemonSocket, streamOptions);
+		stopReloader(reloaderThread);
+		atgc_rules_destroy(publishedRules.load());
+		return status;
+	}
+
+	Pipeline pipeline;
+	pipeline.stream = stream;
+	pipeline.folder = (foldTraces ? atgc_folder_create(0) : NULL);
+	pipeline.filter = NULL;
+	if (typeMask != 0 || !literals.empty())
+	{
+		pipeline.filter = atgc_filter_create(typeMask != 0 ? typeMask : ~0u, literals.empty() ? NULL : &literals[0], literals.size());
+	}
+	pipeline.exceptions = (reportExceptions ? atgc_exceptions_create(0) : NULL);
+	pipeline.stats = (stats ? atgc_stats_create(bucketMinutes) : NULL);
+	pipeline.threadDumps = (reportThreads || reportStacks || reportFolded ? atgc_thread_dumps_create() : NULL);
+	pipeline.profile = (reportStacks || reportFolded ? atgc_profile_create() : NULL);
+	pipeline.failedSQL = (reportSQL ? atgc_failed_sql_create() : NULL);
+	pipeline.collapseBlocks = collapseBlocks;
+
+	// reports need every line, the storm collapser is only for lines that are written out
+	pipeline.storm = (storm && !reporting ? atgc_storm_create(0, 0) : NULL);
+	pipeline.openBlock = ATGC_BLOCK_NONE;
+	pipeline.blockEntries = 0;
+	pipeline.lines = 0;
+	pipeline.latency = NULL;
+	pipeline.stages = NULL;
+	memset(&pipeline.counters, 0, sizeof(pipeline.counters));
+	LatencyMeter latencyMeter;
+	if (latency)
+	{
+		latencyMeter.histogram = atgc_latency_create();
+		latencyMeter.startNs = monotonicNs();
+		latencyMeter.busyNs = 0;
+		latencyMeter.bytesIn = 0;
+		latencyMeter.reads = 0;
+		pipeline.latency = &latencyMeter;
+	}
+	StageMeter stageMeter;
+	if (stageStats)
+	{
+		memset(&stageMeter, 0, sizeof(stageMeter));
+		stageMeter.startNs = monotonicNs();
+		stageMeter.startTicks = stageTicks();
+		stageMeter.lastTicks = stageMeter.startTicks;
+		pipeline.stages = &stageMeter;
+	}
+	if (latency || stageStats)
+	{
+		// no SA_RESTART, a read waiting for the app server returns so the report comes out right away
+		struct sigaction report;
+		memset(&report, 0, sizeof(report));
+		report.sa_handler = reportCatcher;
+		sigaction(SIGUSR1, &report, NULL);
+	}
+	if (pipeline.profile != NULL)
+	{
+		atgc_thread_dumps_on_thread(pipeline.threadDumps, atgc_profile_add_thread, pipeline.profile);
+	}
+	pipeline.output.used = 0;
+	pipeline.output.format = outputFormat;
+	pipeline.output.serverType = ATGC_SERVER_UNKNOWN;
+	pipeline.output.html = (outputFormat == OUTPUT_HTML ? atgc_html_create(inputFileName != NULL ? inputFileName : "ATGLogColorizer") : NULL);
+	pipeline.output.highlight = (outputFormat == OUTPUT_ANSI && !literals.empty() ? pipeline.filter : NULL);
+	pipeline.output.sink = NULL;
+
+	// read the log file or stdin, coloring a batch of lines at a time
+	beginDocument(pipeline.output);
+	size_t unreadFile = batchPaths.size();
+	if (!batchPaths.empty())
+	{
+		vector<const char*> paths;
+		for (size_t i = 0; i < batchPaths.size(); i++)
 		{
-			processLine(stripNullChars(line)); // strip line of null characters and process it
+			paths.push_back(batchPaths[i].c_str());
 		}
+		unreadFile = colorizeFiles(paths, pipeline, blockingIO);
+	}
+	else
+	{
+		colorize(inputFile, pipeline);
+	}
+	endDocument(pipeline.output);
+	if (metricsFile != NULL)
+	{
+		writePipelineMetrics(pipeline, 0);
+	}
+	printReports(pipeline);
+	if (pipeline.latency != NULL)
+	{
+		atgc_latency_destroy(latencyMeter.histogram);
+	}
+	if (unreadFile < batchPaths.size())
+	{
+		string message = string("File '") + batchPaths[unreadFile] + "' couldn't be read";
+		printError(message.c_str());
+	}
+	if (pipeline.exceptions != NULL)
+	{
+		printExceptionReport(pipeline.exceptions, reportTop);
+	}
+	if (pipeline.failedSQL != NULL)
+	{
+		printFailedSQLReport(pipeline.failedSQL, reportTop);
+	}
+	if (pipeline.threadDumps != NULL)
+	{
+		atgc_thread_dumps_finish(pipeline.threadDumps); // the last thread of the last dump goes to the profile
+	}
+	if (pipeline.threadDumps != NULL && reportThreads)
+	{
+		printThreadDumpReport(pipeline.threadDumps);
+	}
+	if (pipeline.profile != NULL && reportFolded)
+	{
+		atgc_profile_folded(pipeline.profile, writeFoldedStack, NULL);
+	}
+	if (pipeline.profile != NULL && reportStacks)
+	{
+		printStackProfile(pipeline.profile, reportTop);
+	}
+	if (pipeline.stats != NULL && statsCsv)
+	{
+		printStatsCsv(pipeline.stats);
+	}
+	else if (pipeline.stats != NULL)
+	{
+		printStatsTables(pipeline.stats, reportTop);
+	}
+	if (inputFile != STDIN_FILENO)
+	{
+		close(inputFile); // close file
+	}
+
+	stopReloader(reloaderThread);
+	if (control >= 0)
+	{
+		close(control);
 	}
+	atgc_html_destroy(pipeline.output.html);
+	atgc_failed_sql_destroy(pipeline.failedSQL);
+	atgc_profile_destroy(pipeline.profile);
+	atgc_thread_dumps_destroy(pipeline.threadDumps);
+	atgc_stats_destroy(pipeline.stats);
+	atgc_exceptions_destroy(pipeline.exceptions);
+	atgc_folder_destroy(pipeline.folder);
+	atgc_storm_destroy(pipeline.storm);
+	atgc_filter_destroy(pipeline.filter);
+	atgc_stream_destroy(stream);
+	atgc_rules_destroy(publishedRules.load());
 
 	// after we're done (this only gets called when reading file logs), reset the window colors
 	setTextColor(ORIGINAL_COLOR);
@@ -0,0 +1,2498 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * the classifier behind ATGLogColorizer. everything that used to be global in the colorizer
+ * (previous lines, detected app server, multi-line block flags) now lives in an atgc_stream
+ * so several logs can be classified side by side in the same process. see atgcolorize.h
+ */
+
+#include "atgcolorize_internal.h"
+#include "atgcolorize_builtin.h"
+#include "atgcolorize_probes.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+ATGC_PROBE_SEMAPHORE(classify);
+ATGC_PROBE_SEMAPHORE(state_change);
+
+const char NULL_CHARACTER = '\0';
+
+// how many previous lines of output are held in saved?
+const int NUM_SAVED_LINES = 20;
+
+/*
+	int determineLineType is the function responsible for determining a single output line's type.
+	it returns one of the six constants
+*/
+const int INFO_LINE = ATGC_INFO_LINE;
+const int WARNING_LINE = ATGC_WARNING_LINE;
+const int DEBUG_LINE = ATGC_DEBUG_LINE;
+const int ERROR_LINE = ATGC_ERROR_LINE;
+const int OTHER_LINE = ATGC_OTHER_LINE;
+const int NUCLEUS_LINE = ATGC_NUCLEUS_LINE;
+
+bool contains(const string& haystack, const string& needle)
+{
+	return (haystack.find(needle) != string::npos);
+}
+
+bool startsWith(const string& haystack, const string& needle)
+{
+	return haystack.compare(0, needle.size(), needle) == 0;
+}
+
+bool endsWith(const string& a, const string& b)
+{
+	if (a.size() < b.size())
+	{
+		return false;
+	}
+	return a.compare(a.size()-b.size(), b.size(), b) == 0;
+}
+
+/*
+ *	the same three for string literals, which is what nearly every check below passes. the length
+ *	is known at compile time and no std::string gets built around the literal on every call
+ */
+template <size_t N> inline bool contains(const string& haystack, const char (&needle)[N])
+{
+	return (haystack.find(needle, 0, N - 1) != string::npos);
+}
+
+template <size_t N> inline bool startsWith(const string& haystack, const char (&needle)[N])
+{
+	return haystack.compare(0, N - 1, needle, N - 1) == 0;
+}
+
+template <size_t N> inline bool endsWith(const string& a, const char (&b)[N])
+{
+	if (a.size() < N - 1)
+	{
+		return false;
+	}
+	return a.compare(a.size() - (N - 1), N - 1, b, N - 1) == 0;
+}
+
+/*
+ *	messages that come through as SOP's with no logging identifier and mean something went wrong.
+ *	these are compiled into the same automaton as user rules (see atgcolorize_rules.cpp), so
+ *	checking all of them costs one pass over the line
+ */
+constexpr BuiltinRule SOP_ERROR_RULES[] =
+{
+	{ MATCH_CONTAINS, "Ids cannot be null", NULL },
+	{ MATCH_CONTAINS, "Ids cannot be empty", NULL },
+	{ MATCH_CONTAINS, "Attempt to add a NULL item to the repository", NULL },
+	{ MATCH_CONTAINS, "Attempt to add an item to the repository without specifying", NULL },
+	{ MATCH_CONTAINS, "Invalid data type name:", NULL },
+	{ MATCH_CONTAINS, "Invalid item class name", NULL },
+	{ MATCH_CONTAINS, "Invalid item descriptor name", NULL },
+	{ MATCH_CONTAINS, "No property named", "could be found in the item descriptor" },
+	{ MATCH_CONTAINS, "No item with ID", "could be found in item descriptor" },
+	{ MATCH_CONTAINS, "is not queryable and thus cannot be used in this query", NULL },
+	{ MATCH_CONTAINS, "Error initializing id generator", NULL },
+	{ MATCH_CONTAINS, "Error reading list or array index from the database", NULL },
+	{ MATCH_CONTAINS, "Attempt to create a sub-property query expression for the property", NULL },
+	{ MATCH_CONTAINS, "Attempt to create a query using transient property", NULL },
+	{ MATCH_CONTAINS, "Attempt to create a case-insenstive query with no SQL", NULL },
+	{ MATCH_CONTAINS, "does not appear to be defined correctly in the database", NULL },
+	{ MATCH_CONTAINS, "Query or QueryExpression object that is null or was not created by this repository", NULL },
+	{ MATCH_CONTAINS, "invalid array of Query objects", NULL },
+	{ MATCH_CONTAINS, "The argument", "cannot be null" },
+	{ MATCH_CONTAINS, "Multi-valued properties may not be used", NULL },
+	{ MATCH_CONTAINS, "using QueryExpressions that cannot be compared", NULL },
+	{ MATCH_CONTAINS, "No default properties are defained", NULL },
+	{ MATCH_CONTAINS, "The query operator", "is invalid" },
+	{ MATCH_CONTAINS, "Attempt to execute a query with pQueryOptions = null", NULL },
+	{ MATCH_CONTAINS, "SQL Repository not configured with DatabaseTableInfos", NULL },
+	{ MATCH_CONTAINS, "Could not remove entry or entries for item descriptor", NULL },
+	{ MATCH_CONTAINS, "An SQL error was encountered", NULL },
+	{ MATCH_CONTAINS, "An SQL error was encountered", NULL },
+	{ MATCH_CONTAINS, "Unable to decode composite ID", NULL },
+	{ MATCH_CONTAINS, "has incorrectly configured IdSpaces", NULL },
+	{ MATCH_CONTAINS, "Id values must match Id column count", NULL },
+	{ MATCH_CONTAINS, "Unable to set Id values of table", NULL },
+	{ MATCH_CONTAINS, "Attempt to execute or build a text comparison query", NULL },
+	{ MATCH_CONTAINS, "Unable to convert ID", "to type" },
+	{ MATCH_CONTAINS, "Unable to convert composite ID element", NULL },
+	{ MATCH_CONTAINS, "Unable to initialize stored procedure helper", NULL },
+	{ MATCH_CONTAINS, "Arguments were provided for the query", "which does not contain parameters" },
+	{ MATCH_CONTAINS, "Invalid parameter type passed to query", NULL },
+	{ MATCH_CONTAINS, "Unable to rebuild this expression.", NULL },
+	{ MATCH_CONTAINS, "No arguments supplied for the parameter query", NULL },
+	{ MATCH_CONTAINS, "Wrong number of arguments supplied for parameter query", NULL },
+	{ MATCH_CONTAINS, "Null return property specified for query", NULL },
+	{ MATCH_CONTAINS, "is not readable, and cannot be specified ", NULL },
+	{ MATCH_CONTAINS, "is not a GSA property, and cannot be specified", NULL },
+	{ MATCH_CONTAINS, "is transient, and cannot be a return property", NULL },
+	{ MATCH_CONTAINS, "is multi-valued, and cannot be a return property", NULL },
+	{ MATCH_CONTAINS, "Null dependent property specified", NULL },
+	{ MATCH_CONTAINS, "Null or blank sql string argument entered for DirectSqlQuery", NULL },
+	{ MATCH_CONTAINS, "Unable to create a DirectSqlQuery against a transient item descriptor", NULL },
+	{ MATCH_CONTAINS, "Unable to load class", "for input parameter at index" },
+	{ MATCH_CONTAINS, "Invalid parameter type at index", NULL },
+	{ MATCH_CONTAINS, "Error initializing sql query", NULL },
+	{ MATCH_CONTAINS, "Error parsing template", NULL },
+	{ MATCH_CONTAINS, "No template files defined, be sure the property", NULL },
+	{ MATCH_CONTAINS, "Unable to read template file", NULL },
+	{ MATCH_CONTAINS, "No XML parser could be found", NULL },
+	{ MATCH_CONTAINS, "Unable to find the id space", NULL },
+	{ MATCH_CONTAINS, "Invalid protocol magic number read", NULL },
+	{ MATCH_CONTAINS, "Exception while reading events from data input stream", NULL },
+	{ MATCH_CONTAINS, "No current transaction for getPropertyValue()", NULL },
+	{ MATCH_CONTAINS, "Error setting the RQL filter string", NULL },
+	{ MATCH_CONTAINS, "Unable to load database meta data for columns in table", NULL },
+	{ MATCH_CONTAINS, "Attempt to perform a Sybase full text search query on property", NULL },
+	{ MATCH_CONTAINS, "Attempt to perform a DB2 full text search query on property", NULL },
+	{ MATCH_CONTAINS, "Attempt to set value of property", NULL },
+	{ MATCH_CONTAINS, "An error occurred processing an invalidate cache entry", NULL },
+
+	{ MATCH_CONTAINS, "*** failed to clone super-type", NULL },
+	{ MATCH_CONTAINS, "can't read properties", NULL },
+	{ MATCH_CONTAINS, "unkown bean:", NULL },
+	{ MATCH_CONTAINS, "can't introspect property:", NULL },
+	{ MATCH_CONTAINS, "unkown property:", NULL },
+	{ MATCH_CONTAINS, "can't set property:", NULL },
+	{ MATCH_CONTAINS, "Naming Exception caught", NULL },
+	{ MATCH_CONTAINS, "Error: caught exception", NULL },
+
+	{ MATCH_CONTAINS, "no getter for:", NULL },
+	{ MATCH_CONTAINS, "NumberFormatException reading schema info cache", NULL },
+	{ MATCH_CONTAINS, "does not exist in a table space accessible by the data source", NULL },
+	{ MATCH_CONTAINS, "Found a one-to-many shared table definition in versioned case with one side using", NULL },
+	{ MATCH_CONTAINS, "Found shared table definition in versioned case with only one asset version column", NULL },
+
+	// from /atg/deployment/common/Resources.properties
+	{ MATCH_CONTAINS, "Error parsing file", NULL },
+	{ MATCH_CONTAINS, "deployment topology failed to load properly", NULL },
+	{ MATCH_CONTAINS, "no JNDI name defined for JNDI transport of agent", NULL },
+	{ MATCH_CONTAINS, "no transport found for JNDI name", NULL },
+	{ MATCH_CONTAINS, "error looking up transport", NULL },
+	{ MATCH_CONTAINS, "no targets defined in topology definition file", NULL },
+	{ MATCH_CONTAINS, "no transport defined for agent", NULL },
+	{ MATCH_CONTAINS, "no transport type defined for agent", NULL },
+	{ MATCH_CONTAINS, "unknown transport type", NULL },
+	{ MATCH_CONTAINS, "no URI defined for RMI transport of agent", NULL },
+	{ MATCH_CONTAINS, "could not instantiate RMI server-side agent transport with URI", NULL },
+	{ MATCH_CONTAINS, "to an indeterminate snapshot due to an interruption in the committed apply phase", NULL },
+	{ MATCH_CONTAINS, "Simulating failure : DeploymentAgent.debugApplyFailIndex is set to", NULL },
+	{ MATCH_CONTAINS, "Manifest application aborted at server request", NULL },
+	{ MATCH_CONTAINS, "An error was encountered applying manifest data before any data was committed", NULL },
+	{ MATCH_CONTAINS, "Data store switch preparation aborted at server request", NULL },
+	{ MATCH_CONTAINS, "is either not configured or failed to start up properly", NULL },
+	{ MATCH_CONTAINS, "The version manager is either not configured or failed to start up properly", NULL },
+	{ MATCH_CONTAINS, "The manifest manager is either not configured or failed to start up properly", NULL },
+	{ MATCH_CONTAINS, "The transaction manager is either not configured or failed to start up properly", NULL },
+	{ MATCH_CONTAINS, "The rmi server is either not configured or failed to start up properly", NULL },
+	{ MATCH_CONTAINS, "The topology manager is either not configured or failed to start up properly", NULL },
+	{ MATCH_CONTAINS, "The deployment server failed to start-up properly", NULL },
+	{ MATCH_CONTAINS, "received unknown deployment command", NULL },
+	{ MATCH_CONTAINS, "forcing initialization of snapshot from", NULL },
+	{ MATCH_CONTAINS, "cannot initialize snapshot, the agent is either active or already has an snapshot", NULL },
+	{ MATCH_CONTAINS, "because the agent is inaccessible", NULL },
+	{ MATCH_CONTAINS, "agent is locked by a different deployment", NULL },
+	{ MATCH_CONTAINS, "deployment server system version does not match this agent", NULL },
+	{ MATCH_CONTAINS, "attempt to resume or rollback a deployment on this agent but the agent has been changed by another deployment", NULL },
+	{ MATCH_CONTAINS, "only full deployments are allowed when the agent snapshot is uninitialized", NULL },
+	{ MATCH_CONTAINS, "was not found on the local agent", NULL },
+	{ MATCH_CONTAINS, "cannot enter phase", "from phase" },
+	{ MATCH_CONTAINS, "could not get manifest stream for writing manifest", NULL },
+	{ MATCH_CONTAINS, "manifest stream is null for install of manifest", NULL },
+	{ MATCH_CONTAINS, "error closing manifest stream : stream is being ignored", NULL },
+	{ MATCH_CONTAINS, "A maintained Status object could not be cloned to create a safe copy to return", NULL },
+	{ MATCH_CONTAINS, "A maintained Status could not write to file", NULL },
+	{ MATCH_CONTAINS, "could not delete Status file", NULL },
+	{ MATCH_CONTAINS, "error encountered reading in persisted status", NULL },
+	{ MATCH_CONTAINS, "cannot interrupt a deployment in state", NULL },
+	{ MATCH_CONTAINS, "A system error was encountered trying to lookup the RMI URI", NULL },
+	{ MATCH_CONTAINS, "transport error from agent", NULL },
+	{ MATCH_CONTAINS, "transport failed to start or is otherwise uninitialized", NULL },
+	{ MATCH_CONTAINS, "could not send manifest to agent", NULL },
+	{ MATCH_CONTAINS, "error reading manifest stream", NULL },
+	{ MATCH_CONTAINS, "transport error installing manifest on agent", NULL },
+	{ MATCH_CONTAINS, "error closing manifest stream", NULL },
+	{ MATCH_CONTAINS, "deployment server is starting up with an uninitialized topology", NULL },
+	{ MATCH_CONTAINS, "no topology XML configured", NULL },
+	{ MATCH_CONTAINS, "could not remove completed deployment", NULL },
+	{ MATCH_CONTAINS, "topology cannot reinit due to deployment", NULL },
+	{ MATCH_CONTAINS, "error closing agent transport for target", NULL },
+	{ MATCH_CONTAINS, "recovered deployment status is either not from this server", NULL },
+	{ MATCH_CONTAINS, "there is a target with no name : each target must be named", NULL },
+	{ MATCH_CONTAINS, "no agents were given deployment responsibilities in target", NULL },
+	{ MATCH_CONTAINS, "no agents defined in target", NULL },
+	{ MATCH_CONTAINS, "there is an agent with no name in target", NULL },
+	{ MATCH_CONTAINS, "due to error from transport", NULL },
+	{ MATCH_CONTAINS, "suggesting an unclean shutdown", NULL },
+	{ MATCH_CONTAINS, "hard reset requested from user", NULL },
+	{ MATCH_CONTAINS, "mis-match in live data store name of switchable data stores", NULL },
+	{ MATCH_CONTAINS, "error encountered reverting deployment switch", NULL },
+	{ MATCH_CONTAINS, "error encountered preparing switchable for switch", NULL },
+	{ MATCH_CONTAINS, "all files not deleted from", NULL },
+	{ MATCH_CONTAINS, "cannot initialize snapshot on target", NULL },
+	{ MATCH_CONTAINS, "forcing initialization of snapshot on target", NULL },
+	{ MATCH_CONTAINS, "due to error from agent", NULL },
+	{ MATCH_CONTAINS, "could not discern snapshot due to error from target", NULL },
+	{ MATCH_CONTAINS, "error mismatch in snapshot on target", NULL },
+	{ MATCH_CONTAINS, "has a current deployment that cannot be removed", NULL },
+	{ MATCH_CONTAINS, "error recovering deployment from status", NULL },
+	{ MATCH_CONTAINS, "cannot be instantiated because the deployment target", NULL },
+	{ MATCH_CONTAINS, "An unidentified deployment cannot be instantiated due to errors", NULL },
+	{ MATCH_CONTAINS, "cannot be instantiated due to errors accessing the repository", NULL },
+	{ MATCH_CONTAINS, "An error occurred attempting to move deployment", NULL },
+	{ MATCH_CONTAINS, "a repository level error occurred during deployment initialization", NULL },
+	{ MATCH_CONTAINS, "An error occurred attempting to delete deployment", NULL },
+	{ MATCH_CONTAINS, "A transaction-level error occurred while trying to delete deployment", NULL },
+	{ MATCH_CONTAINS, "encountered a transaction-level error while preparing Target", NULL },
+	{ MATCH_CONTAINS, "cannot be started because there is already a current deployment", NULL },
+	{ MATCH_CONTAINS, "could not be made the current deployment in order to start it", NULL },
+	{ MATCH_CONTAINS, "the deployment is flagged as a revert but has more than one project", NULL },
+	{ MATCH_CONTAINS, "the target has no initial snapshot", NULL },
+	{ MATCH_CONTAINS, "should have a Snapshot by now but does not", NULL },
+	{ MATCH_CONTAINS, "encountered a versioning error building the manifest", NULL },
+	{ MATCH_CONTAINS, "encountered a system level deployment error during data transfer", NULL },
+	{ MATCH_CONTAINS, "No destination repositories or virtual file systems were configured for this deployment", NULL },
+	{ MATCH_CONTAINS, "could not be resolved as a Nucleus component", NULL },
+	{ MATCH_CONTAINS, "The source virtual file system could not be found for the following file asset", NULL },
+	{ MATCH_CONTAINS, "encountered an error with manifest", NULL },
+	{ MATCH_CONTAINS, "A call to the current deployment running remotely on another deployment server", NULL },
+	{ MATCH_CONTAINS, "is no longer the current deployment and thus could not be called", NULL },
+	{ MATCH_CONTAINS, "An RMI error encountered calling remote current deployment", NULL },
+	{ MATCH_CONTAINS, "suggesting an unclean shutdown", NULL },
+	{ MATCH_CONTAINS, "but could find no such manifest", NULL },
+	{ MATCH_CONTAINS, "cannot be started, either it was previously started or the deployment queue is running and this deployment is not next in the queue.", NULL },
+	{ MATCH_CONTAINS, "cannot stop a deployment that is in a non-active or non-error state", NULL },
+	{ MATCH_CONTAINS, "since the deployment has not stopped due to an error", NULL },
+	{ MATCH_CONTAINS, "the deployment has started and must either complete successfully or be stopped in order to be deleted", NULL },
+	{ MATCH_CONTAINS, "unrecognized deployment type", NULL },
+	{ MATCH_CONTAINS, "cannot be found in the VersionManager : full deployment is required", NULL },
+	{ MATCH_CONTAINS, "cannot perform an online deployment on target", NULL },
+	{ MATCH_CONTAINS, "cannot perform an incremental deployment on target", NULL },
+	{ MATCH_CONTAINS, "error communicating with target:agent", NULL },
+	{ MATCH_CONTAINS, "could not lock target:agent", NULL },
+	{ MATCH_CONTAINS, "error preparing target:agent", NULL },
+	{ MATCH_CONTAINS, "error loading manifest on target:agent", NULL },
+	{ MATCH_CONTAINS, "error installing manifest on target:agent", NULL },
+	{ MATCH_CONTAINS, "error applying manifest on target:agent", NULL },
+	{ MATCH_CONTAINS, "error activating deployment on target:agent", NULL },
+	{ MATCH_CONTAINS, "event interrupt on target:agent", NULL },
+	{ MATCH_CONTAINS, "error from target:agent", NULL },
+	{ MATCH_CONTAINS, "Unexpected error occured. See log for details.", NULL },
+	{ MATCH_CONTAINS, "do not have the same live data store : ", NULL },
+	{ MATCH_CONTAINS, "Cannot deploy to target", NULL },
+	{ MATCH_CONTAINS, "does not match current target snapshot : ", NULL },
+	{ MATCH_CONTAINS, "unexpected state returned telling target:agent", NULL },
+	{ MATCH_CONTAINS, "transport error unlocking target:agent", NULL },
+	{ MATCH_CONTAINS, "error stopping deployment on target:agent", NULL },
+	{ MATCH_CONTAINS, "agent errors encountered while stopping deployment", NULL },
+	{ MATCH_CONTAINS, "error deleting manifest", NULL },
+	{ MATCH_CONTAINS, "agent errors encountered while deleting manifests", NULL },
+	{ MATCH_CONTAINS, "Deployment manifests could not be deleted from the agent", NULL },
+	{ MATCH_CONTAINS, "encountered an exception while loading", NULL },
+	{ MATCH_CONTAINS, "An exception was encountered while installing Manifest", NULL },
+	{ MATCH_CONTAINS, "An exception was encountered switching data stores", NULL },
+	{ MATCH_CONTAINS, "An exception was encountered sending update events to affected VirtualFileSystems", NULL },
+	{ MATCH_CONTAINS, "runtime exception caught from event listener", NULL },
+	{ MATCH_CONTAINS, "Failed to connect to agent ", NULL },
+	{ MATCH_CONTAINS, "This agent not allowed to be absent for a deployment", NULL },
+	{ MATCH_CONTAINS, "error resolving CMS catalog for deployment checks", NULL },
+	{ MATCH_CONTAINS, "error updating foreign repository references", NULL },
+	{ MATCH_CONTAINS, "Running deployment cannot be changed", NULL },
+	{ MATCH_CONTAINS, "error resetting shadow", NULL },
+	{ MATCH_CONTAINS, "Target is already initialized with a snapshot", NULL },
+	{ MATCH_CONTAINS, "has pending or current deployment. It cannot be deleted or updated", NULL },
+	{ MATCH_CONTAINS, "The name was given as a branch from which to initialize the new target branch", NULL },
+	{ MATCH_CONTAINS, "When creating a new target the source target to initialize from is required", NULL },
+	{ MATCH_CONTAINS, "cannot be deleted.  It is choosen to act as an initialization source", NULL },
+	{ MATCH_CONTAINS, "Target preparation failed because the one-time server-side target initialization encountered an error", NULL },
+	{ MATCH_CONTAINS, "due to lower level errors", NULL },
+	{ MATCH_CONTAINS, "could not be found in the version manager for rollback", NULL },
+	{ MATCH_CONTAINS, "because the Project is not checked in and does not have locked assets", NULL },
+	{ MATCH_CONTAINS, "as a new Project because the Project has already been deployed to the target", NULL },
+	{ MATCH_CONTAINS, "A system level error ", NULL },
+	{ MATCH_CONTAINS, "could not be found in the Publishing repository.", NULL },
+	{ MATCH_CONTAINS, "A transaction-level error occurring while trying to create a", NULL },
+	{ MATCH_CONTAINS, "cannot be back-deployed to Project", NULL },
+	{ MATCH_CONTAINS, "cannot revert a null Project", NULL },
+	{ MATCH_CONTAINS, "cannot revert Project ID", NULL },
+	{ MATCH_CONTAINS, "Exception encountered while trying to revert Project", NULL },
+	{ MATCH_CONTAINS, "A transaction-level error occurring while trying to revert Project", NULL },
+	{ MATCH_CONTAINS, "but there is no merge workspace associated with the project", NULL },
+	{ MATCH_CONTAINS, "is marked as completed but the workspace, for the workspace name associated with it", NULL },
+	{ MATCH_CONTAINS, "cannot be started : Target site", NULL },
+	{ MATCH_CONTAINS, "cannot be reverted from deployment target site", NULL },
+	{ MATCH_CONTAINS, "A transaction-level error occurring while trying to initialize Target site", NULL },
+	{ MATCH_CONTAINS, "could not find snapshot", NULL },
+	{ MATCH_CONTAINS, "internal error: unexpected diff from version manager", NULL },
+	{ MATCH_CONTAINS, "must have exactly two underlying data sources to be used for deployment", NULL },
+	{ MATCH_CONTAINS, "not a GSARepository. Instead it is of type:", NULL },
+	{ MATCH_CONTAINS, "error creating shadow for:", NULL },
+	{ MATCH_CONTAINS, "not a VirtualFileSystem. Instead it is of type:", NULL },
+	{ MATCH_CONTAINS, "cannot create temp file:", NULL },
+	{ MATCH_CONTAINS, "no manifest manager at", NULL },
+	{ MATCH_CONTAINS, "no transaction manager at", NULL },
+	{ MATCH_CONTAINS, "no version manager at", NULL },
+	{ MATCH_CONTAINS, "no repository registry a", NULL },
+	{ MATCH_CONTAINS, "no repository at ", NULL },
+	{ MATCH_CONTAINS, "invalid starting index:", NULL },
+	{ MATCH_CONTAINS, "invalid ending index:", NULL },
+	{ MATCH_CONTAINS, "batch size must be either -1 or a postive integer", NULL },
+	{ MATCH_CONTAINS, "unrecognized argument: ", NULL },
+	{ MATCH_CONTAINS, "you must specify a data file", NULL },
+	{ MATCH_CONTAINS, "you must specifiy at least one repository or -all for exports", NULL },
+	{ MATCH_CONTAINS, "does not appear to be valid data file", NULL },
+	{ MATCH_CONTAINS, "internal error reserving the id for the repository item", NULL },
+	{ MATCH_CONTAINS, "attempt to export the versioned repository", NULL },
+	{ MATCH_CONTAINS, "I/O error creating deferred update store", NULL },
+	{ MATCH_CONTAINS, "I/O error writing int value", NULL },
+	{ MATCH_CONTAINS, "could not find repository service", NULL },
+	{ MATCH_CONTAINS, "could not find item descriptor", NULL },
+	{ MATCH_CONTAINS, "could not find virtual file system", NULL },
+	{ MATCH_CONTAINS, "no snapshot diff returned for", NULL },
+	{ MATCH_CONTAINS, "internal error: unrecognized deployment type:", NULL },
+	{ MATCH_CONTAINS, "A deployment cannot be created without a project.", NULL },
+	{ MATCH_CONTAINS, "Cannot revert project", NULL },
+	{ MATCH_CONTAINS, "An error occurred while importing topology", NULL },
+	{ MATCH_CONTAINS, "Error occurred while invalidating the destination repository caches.", NULL },
+	{ MATCH_CONTAINS, "No target repository mapping defined for", NULL },
+	{ MATCH_CONTAINS, "state change", "received event interrupted from" },
+	{ MATCH_CONTAINS, "data file", "does not exist" },
+	{ MATCH_CONTAINS, "invalid value", "for argument:" },
+	{ MATCH_CONTAINS, "The deploy time of Deployment", "could not be changed to" },
+	{ MATCH_CONTAINS, "for target", "cannot be started twice" },
+	{ MATCH_CONTAINS, "Snapshot", "could not be retrieved for Project" },
+	{ MATCH_CONTAINS, "Project with ID", "is required to deploy Project(s)" },
+	{ MATCH_CONTAINS, "requested destination", "not found" },
+	{ MATCH_CONTAINS, "data source for repository:", "is not a switching data source" },
+	{ MATCH_CONTAINS, "data file", "is not readable" },
+	{ MATCH_CONTAINS, "data file", "is not writable" },
+	{ MATCH_CONTAINS, "The connection pool failed to initialize propertly", NULL },
+	{ MATCH_CONTAINS, "The suppplied DataSource JNDI name", "did not resolve to a DataSource" },
+	{ MATCH_CONTAINS, "No Transaction could be found or created for the current thread", NULL },
+	{ MATCH_CONTAINS, "failed to obtain the current Transaction from the TransactionManager", NULL },
+	{ MATCH_CONTAINS, "transaction demarcation should be controled through JTA interfaces", NULL },
+	{ MATCH_CONTAINS, "the currentDataSource property is NULL", NULL },
+	{ MATCH_CONTAINS, "the dataSources property is NULL or contains no data sources", NULL },
+	{ MATCH_CONTAINS, "is not recognized as the name of one of the data sources configured for this SwitchingDataSource", NULL },
+	{ MATCH_CONTAINS, "mis-match between Transaction and Connection : FakeXA forces", NULL },
+	{ MATCH_CONTAINS, "attempting to use a closed connection", NULL },
+	{ MATCH_CONTAINS, "error reclaiming resource", NULL },
+	{ MATCH_CONTAINS, "Synchronization detected probable missing Connection.close()", NULL },
+
+	// /atg/adapter/gsa/xml/ParserResources.properties
+	{ MATCH_CONTAINS, " has parsing errors.", NULL },
+	{ MATCH_CONTAINS, "Fatal error parsing file", NULL },
+	{ MATCH_CONTAINS, "Warning parsing file ", NULL },
+	{ MATCH_CONTAINS, "File contains duplicate definition of item-descriptor ", NULL },
+	{ MATCH_CONTAINS, "You must supply an item-descriptor attribute for the print-item tag", NULL },
+	{ MATCH_CONTAINS, "You supplied an invalid item-descriptor", NULL },
+	{ MATCH_CONTAINS, "should not have both super-type and copy-from attributes", NULL },
+	{ MATCH_CONTAINS, "has an invalid item-descriptor for the super-type attribute", NULL },
+	{ MATCH_CONTAINS, "has an invalid item-descriptor for the copy-from attribute", NULL },
+	{ MATCH_CONTAINS, "must specify a valid property name for the sub-type-property attribute", NULL },
+	{ MATCH_CONTAINS, "must specify a property for the sub-type-property", NULL },
+	{ MATCH_CONTAINS, "must specify a valid property for the display-property attribute", NULL },
+	{ MATCH_CONTAINS, "must specify a valid property for the version-property attribute", NULL },
+	{ MATCH_CONTAINS, "must specify valid properties for the text-search-properties attribute", NULL },
+	{ MATCH_CONTAINS, "must specify a valid integer for the cache-size attribute", NULL },
+	{ MATCH_CONTAINS, "must specify a valid integer for the cache-timeout attribute", NULL },
+	{ MATCH_CONTAINS, "must have a table tag with type=", NULL },
+	{ MATCH_CONTAINS, "cannot have the sub-type-property attribute on it", NULL },
+	{ MATCH_CONTAINS, "but is missing at least one of content-property, folder-id-property, or one of content-name-property", NULL },
+	{ MATCH_CONTAINS, "but is missing at least one of folder-id-property, or one of content-name-property, content-path-property", NULL },
+	{ MATCH_CONTAINS, "has a version-property which is not a number type.", NULL },
+	{ MATCH_CONTAINS, "Your attribute ", "refers to a non-existent property" },
+	{ MATCH_CONTAINS, "refers to a property that is not a repository property descriptor", NULL },
+	{ MATCH_CONTAINS, "must have type attribute of primary, auxiliary, or multi.  You have", NULL },
+	{ MATCH_CONTAINS, "which is not a sub-class of GSAPropertyDescriptor.", NULL },
+	{ MATCH_CONTAINS, "has a property whose data-type is not valid for a multi table:", NULL },
+	{ MATCH_CONTAINS, "is missing an item-descriptor.", NULL },
+	{ MATCH_CONTAINS, "is missing an id-column-name attribute.", NULL },
+	{ MATCH_CONTAINS, "specifies an invalid foreign repository name", NULL },
+	{ MATCH_CONTAINS, "only specify one of the attributes item-type or data-type(s), not both", NULL },
+	{ MATCH_CONTAINS, "specifies both component-item-type and component-data-type attributes", NULL },
+	{ MATCH_CONTAINS, "specifies a repository attribute which is only valid for properties with", NULL },
+	{ MATCH_CONTAINS, "has an invalid property-type", NULL },
+	{ MATCH_CONTAINS, "has an invalid data type ", NULL },
+	{ MATCH_CONTAINS, "is missing one of the component-data-type", NULL },
+	{ MATCH_CONTAINS, "specifies an invalid item-descriptor", NULL },
+	{ MATCH_CONTAINS, "specifies a value for both component-data-type and", NULL },
+	{ MATCH_CONTAINS, "specifies an invalid value for the component-data-type attribute", NULL },
+	{ MATCH_CONTAINS, "specifies an invalid item-type", NULL },
+	{ MATCH_CONTAINS, "is improperly defined according to", NULL },
+	{ MATCH_CONTAINS, ".  Using default property editor.", NULL },
+	{ MATCH_CONTAINS, "insert,update,delete", "but does not refer to another item." },
+	{ MATCH_CONTAINS, "insert,update,delete", "but does not refer to another item." },
+	{ MATCH_CONTAINS, "delete,insert", "and refers to a item which has a property that refers back" },
+	{ MATCH_CONTAINS, "All entries should be insert,update or delete.", NULL },
+	{ MATCH_CONTAINS, "specifies a column-name property but is not inside of a table tag.", NULL },
+	{ MATCH_CONTAINS, "specifies the group attribute but is not defined inside of a table tag", NULL },
+	{ MATCH_CONTAINS, "specifies the default attribute but is not a scalar property.", NULL },
+	{ MATCH_CONTAINS, "is a scalar property but is defined in a table tag with type=", NULL },
+	{ MATCH_CONTAINS, "is a set but also specifies a multi-column-name", NULL },
+	{ MATCH_CONTAINS, " is missing the multi-column-name attribute.", NULL },
+	{ MATCH_CONTAINS, " must have either a component-item-type or component-data-type attribute.", NULL },
+	{ MATCH_CONTAINS, "is a multi-valued property defined in a table that does not have type=", NULL },
+	{ MATCH_CONTAINS, "sets a cache-mode that is not supported on property tags", NULL },
+	{ MATCH_CONTAINS, "has some option tags which set the code value and others which do not set it explicitly", NULL },
+	{ MATCH_CONTAINS, "specifies a code value which is not a valid integer.", NULL },
+	{ MATCH_CONTAINS, "specifies an option code or value more than once:", NULL },
+	{ MATCH_CONTAINS, "already has an attribute tag with name", NULL },
+	{ MATCH_CONTAINS, "specifies an invalid data-type for an attribute tag", NULL },
+	{ MATCH_CONTAINS, "specifies an invalid value for an attribute tag.", NULL },
+	{ MATCH_CONTAINS, "Detailed error: ", NULL },
+	{ MATCH_CONTAINS, "is not a valid data-type.", NULL },
+	{ MATCH_CONTAINS, " could not be converted to the type ", NULL },
+	{ MATCH_CONTAINS, "attribute with an invalid bean attribute.", NULL },
+	{ MATCH_CONTAINS, "has an attribute with a null bean value ", NULL },
+	{ MATCH_CONTAINS, "item-descriptor tag does not have a valid name:", NULL },
+	{ MATCH_CONTAINS, "You have two item-descriptor tags with default=", NULL },
+	{ MATCH_CONTAINS, "in item-descriptor", "You have two properties called " },
+	{ MATCH_CONTAINS, "Error trying to set an id generator high water mark:", NULL },
+	{ MATCH_CONTAINS, " is an illegal value for the sub-type-property.", NULL },
+	{ MATCH_CONTAINS, " has two id properties specified.", NULL },
+	{ MATCH_CONTAINS, "Specify either value or bean, but not both.", NULL },
+	{ MATCH_CONTAINS, "so the data-type attribute is not meaningful when ", NULL },
+	{ MATCH_CONTAINS, "Invalid tag value: ", NULL },
+	{ MATCH_CONTAINS, "Invalid composite format for repository ID:", NULL },
+	{ MATCH_CONTAINS, "This item type does not support composite repository IDs:", NULL },
+	{ MATCH_CONTAINS, "You specified both attributes id-column-name and id-column-names for table", NULL },
+	{ MATCH_CONTAINS, "You must specify either id-column-name or id-column-names for table element", NULL },
+	{ MATCH_CONTAINS, "You specified both attributes id-space-name and id-space-names for descriptor", NULL },
+	{ MATCH_CONTAINS, "The parsed ID has values that do not correspond to the configured id-space-names:", NULL },
+	{ MATCH_CONTAINS, "was specified with multiple columns. It will be treated as a read-only property", NULL },
+	{ MATCH_CONTAINS, "was specified with multiple columns. It must either share all or none of", NULL },
+	{ MATCH_CONTAINS, "Failed to add item to repository:", NULL },
+	{ MATCH_CONTAINS, "must both be versioning.", "Your item-descriptor definitions for" },
+	{ MATCH_CONTAINS, "Please specify the desired range when calling", NULL },
+	{ MATCH_CONTAINS, "This repository may not yet be properly initialized.", NULL },
+
+	{ MATCH_CONTAINS, "You must specify an XML configuration template file", NULL },
+	{ MATCH_CONTAINS, "You must specify a repository", NULL },
+	{ MATCH_CONTAINS, "You must specify an XMLTools object", NULL },
+	{ MATCH_CONTAINS, "Secured repository failed to start", NULL },
+	{ MATCH_CONTAINS, "There are no secured-repository-template elements", NULL },
+	{ MATCH_CONTAINS, "Invalid/unknown identity:", NULL },
+	{ MATCH_CONTAINS, "Invalid/unknown access right:", NULL },
+	{ MATCH_CONTAINS, "Invalid/unknown owner identity:", NULL },
+	{ MATCH_CONTAINS, "Invalid access control list:", NULL },
+	{ MATCH_CONTAINS, "An item descriptor name must be specified", NULL },
+	{ MATCH_CONTAINS, "is not a configured item descriptor of the repository", NULL },
+	{ MATCH_CONTAINS, "A property name must be specified", NULL },
+	{ MATCH_CONTAINS, "is not a configured property of the repository item", NULL },
+	{ MATCH_CONTAINS, "An error occurred while evaluating function", NULL },
+	{ MATCH_CONTAINS, "No function is mapped to the name", NULL },
+	{ MATCH_CONTAINS, "An error occurred while parsing custom action attribute", NULL },
+	{ MATCH_CONTAINS, "No such implicit object", NULL },
+	{ MATCH_CONTAINS, "An exception occurred while trying to compare a value of", NULL },
+	{ MATCH_CONTAINS, "An error occurred obtaining the indexed property value of an", NULL },
+	{ MATCH_CONTAINS, "Unable to find a value for name", NULL },
+	{ MATCH_CONTAINS, "An error occurred calling equals() on an object of type", NULL },
+	{ MATCH_CONTAINS, "An error occurred applying operator", NULL },
+	{ MATCH_CONTAINS, "Unable to parse value ", NULL },
+	{ MATCH_CONTAINS, "but there is no PropertyEditor for that type", NULL },
+	{ MATCH_CONTAINS, "An exception occurred trying to convert String", NULL },
+	{ MATCH_CONTAINS, "Attempt to coerce ", NULL },
+	{ MATCH_CONTAINS, "threw an exception in its toString()", NULL },
+	{ MATCH_CONTAINS, "Unable to find a value for", NULL },
+	{ MATCH_CONTAINS, "An exception occurred while trying to ", NULL },
+	{ MATCH_CONTAINS, "that value cannot be converted to an integer.", NULL },
+	{ MATCH_CONTAINS, "operator may not be null", NULL },
+	{ MATCH_CONTAINS, "Attempt to apply a null index to the", NULL },
+	{ MATCH_CONTAINS, "An error occurred while getting property", NULL },
+	{ MATCH_CONTAINS, "does not have a public getter method", NULL },
+	{ MATCH_CONTAINS, "Attempt to get property", NULL },
+	{ MATCH_CONTAINS, "A null expression string may not be passed to the", NULL },
+	{ MATCH_CONTAINS, "An Exception occurred getting the BeanInfo for class", NULL },
+	{ MATCH_CONTAINS, "An attempt was made to register two Home", NULL },
+	{ MATCH_CONTAINS, "Failed to delete file", NULL },
+	{ MATCH_CONTAINS, "Did not successfully copy file", NULL },
+	{ MATCH_CONTAINS, "IOException received while copying or checking file", NULL },
+	{ MATCH_CONTAINS, "Error received while performing operation", NULL },
+	{ MATCH_CONTAINS, "Unable to extract data from cache data file", NULL },
+	{ MATCH_CONTAINS, "IOException received while operating on cache data file", NULL },
+	{ MATCH_CONTAINS, "Incorrect format for checksum file cache line", NULL },
+	{ MATCH_CONTAINS, "Checksum cache file nonexistent during load.  If you see this warning repeatedly", NULL },
+	{ MATCH_CONTAINS, "Null file passed to checksum cache", NULL },
+	{ MATCH_CONTAINS, "File System is immutable. Cannot create new file.", NULL },
+	{ MATCH_CONTAINS, "Invalidate transAttribute value", NULL },
+	{ MATCH_CONTAINS, "Registry is Not Defined", NULL },
+	{ MATCH_CONTAINS, "Missing the Security Configuration", NULL },
+	{ MATCH_CONTAINS, "Missing Default Access Control List", NULL },
+	{ MATCH_CONTAINS, "unknown JDBC types for property", NULL },
+
+	// from /atg/nucleus/servlet/NucleusServletResources.properties
+	{ MATCH_CONTAINS, "***** ERROR:  Could not get ServletContext for atg_bootstrap.war", NULL },
+	{ MATCH_CONTAINS, "Failing NucleusServlet startup", NULL },
+	{ MATCH_CONTAINS, "Nucleus was not properly initialized", NULL },
+	{ MATCH_CONTAINS, "RuntimeException caught by proxy servlet", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: Could not load class", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: Could not instantiate class", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: IllegalAccessException while invoking initializer", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: NoSuchMethodException while invoking initializer", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: InvocationTargetException while invoking initializer", NULL },
+	{ MATCH_CONTAINS, "Cannot determine Nucleus configpath root.", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: can't set init properties", NULL },
+	{ MATCH_CONTAINS, "ERROR: no system nucleus after launching", NULL },
+	{ MATCH_CONTAINS, "NucleusServlet: can't set init properties", NULL },
+	{ MATCH_CONTAINS, "Nucleus failed to start", NULL },
+	{ MATCH_CONTAINS, "Error spawning a local nucleus for context", NULL },
+	{ MATCH_CONTAINS, "Error stopping nucleus", NULL },
+	{ MATCH_CONTAINS, "Could not get the class for the JBoss TransactionManagerFactory", NULL },
+	{ MATCH_CONTAINS, "does not have a method named", NULL },
+	{ MATCH_CONTAINS, "Could not get the class for the IBM TransactionManagerFactory", NULL },
+	{ MATCH_CONTAINS, "Error encountered while initializing Nucleus servlet", NULL },
+
+	{ MATCH_CONTAINS, "adding form exception:", NULL },
+	{ MATCH_CONTAINS, "SystemErr     R 	at ", NULL },
+
+	{ MATCH_CONTAINS, "An error occurred at line:", NULL },
+	{ MATCH_CONTAINS, "Generated servlet error:", NULL },
+	{ MATCH_CONTAINS, "could not be found. Please ensure that the JNDI name in the weblogic-ejb-jar.xml", NULL },
+	{ MATCH_PREFIX, "Caught exception in ", NULL },
+	{ MATCH_CONTAINS, "Marking this deployment as FAILED", NULL },
+	{ MATCH_CONTAINS, "Invalid object name '", NULL },
+	{ MATCH_CONTAINS, "Can't find element with id=", NULL },
+	{ MATCH_CONTAINS, "*** unable to find GSARepository component:", NULL },
+	{ MATCH_CONTAINS, "Nested exception is:", NULL },
+	{ MATCH_CONTAINS, "OutOfMemoryException", NULL },
+	{ MATCH_SUFFIX, " cannot be resolved", NULL },
+	{ MATCH_PREFIX, "Error:", NULL },
+	{ MATCH_PREFIX, "log4j:ERROR", NULL },
+	{ MATCH_CONTAINS, "ERROR:", NULL },
+	{ MATCH_PREFIX, "Nested Exception is", NULL },
+	{ MATCH_CONTAINS, "message = Deployment Failed time", NULL },
+	{ MATCH_CONTAINS, "atg.deployment.DeploymentFailure@", NULL },
+	{ MATCH_CONTAINS, "has more than one primary table defined", NULL },
+	{ MATCH_CONTAINS, "specifies a component-item-type or component-data-type attribute for a single value property", NULL },
+	{ MATCH_CONTAINS, "has super-type product but no sub-type attribute", NULL },
+	{ MATCH_PREFIX, "Stacktrace:", NULL },
+	{ MATCH_CONTAINS, "Ensure that the first WebLogic Server is completely shutdown and restart the server", NULL },
+	{ MATCH_CONTAINS, "The WebLogic Server did not start up properly.", NULL },
+	{ MATCH_CONTAINS, "[STDOUT] java.lang.OutOfMemoryError", NULL },
+	{ MATCH_CONTAINS, "[STDOUT] AxisFault", NULL },
+	{ MATCH_PREFIX, "faultCode:", NULL },
+	{ MATCH_SUFFIX, "faultSubcode:", NULL },
+	{ MATCH_SUFFIX, "faultActor:", NULL },
+	{ MATCH_PREFIX, "faultString:", NULL },
+	{ MATCH_PREFIX, "AxisFault", NULL },
+	{ MATCH_PREFIX, "Fault occurred in processing", NULL },
+	{ MATCH_SUFFIX, "faultNode:", NULL },
+	{ MATCH_SUFFIX, "faultDetail:", NULL },
+};
+
+constexpr size_t NUM_SOP_ERROR_RULES = sizeof(SOP_ERROR_RULES) / sizeof(SOP_ERROR_RULES[0]);
+
+// the rules above as a compiled rule set, built while this file compiles (see atgcolorize_builtin.h)
+constexpr uint32_t NUM_SOP_ERROR_TERMS = builtinTermCount(SOP_ERROR_RULES, NUM_SOP_ERROR_RULES);
+constexpr uint32_t MAX_SOP_ERROR_STATES = builtinTermBytes(SOP_ERROR_RULES, NUM_SOP_ERROR_RULES) + 1;
+constexpr BuiltinTrie<MAX_SOP_ERROR_STATES, NUM_SOP_ERROR_TERMS> SOP_ERROR_TRIE = buildBuiltinTrie<MAX_SOP_ERROR_STATES, NUM_SOP_ERROR_TERMS>(SOP_ERROR_RULES, NUM_SOP_ERROR_RULES);
+
+constexpr uint32_t NUM_SOP_ERROR_STATES = SOP_ERROR_TRIE.numStates;
+constexpr uint32_t NUM_SOP_ERROR_LITERALS = SOP_ERROR_TRIE.numLiterals;
+constexpr uint32_t SOP_ERROR_POOL_SIZE = SOP_ERROR_TRIE.poolSize;
+constexpr BuiltinTables<NUM_SOP_ERROR_STATES, NUM_SOP_ERROR_LITERALS, NUM_SOP_ERROR_RULES, NUM_SOP_ERROR_TERMS, SOP_ERROR_POOL_SIZE> SOP_ERROR_TABLES =
+	buildBuiltinTables<NUM_SOP_ERROR_STATES, NUM_SOP_ERROR_LITERALS, NUM_SOP_ERROR_RULES, NUM_SOP_ERROR_TERMS, SOP_ERROR_POOL_SIZE>(SOP_ERROR_RULES, SOP_ERROR_TRIE);
+
+constexpr atgc_rules BUILTIN_RULES =
+{
+	{
+		SOP_ERROR_TABLES.states, SOP_ERROR_TABLES.edges, SOP_ERROR_TABLES.rootNext,
+		SOP_ERROR_TABLES.literals, SOP_ERROR_TABLES.literalRules, SOP_ERROR_TABLES.rules,
+		SOP_ERROR_TABLES.terms, nullptr, SOP_ERROR_TABLES.textPool, nullptr,
+		NUM_SOP_ERROR_STATES, NUM_SOP_ERROR_STATES - 1, NUM_SOP_ERROR_LITERALS, NUM_SOP_ERROR_RULES,
+		NUM_SOP_ERROR_RULES, NUM_SOP_ERROR_TERMS, 0, SOP_ERROR_POOL_SIZE, 0
+	},
+	nullptr, // no regexes
+	NUM_SOP_ERROR_RULES,
+	false,
+	nullptr,
+	nullptr,
+	0
+};
+
+const atgc_rules* builtinRules()
+{
+	return &BUILTIN_RULES;
+}
+
+// where a thread dump starts and ends, for the classifier and the thread dump analyzer
+const char THREAD_DUMP_START[] = "Full thread dump Java HotSpot";
+const char* const THREAD_DUMP_ENDS[] = { "VM Periodic Task Thread", "Suspend Checker Thread" };
+
+bool isThreadDumpStart(const char* trimmedLine, size_t length)
+{
+	return length >= sizeof(THREAD_DUMP_START) - 1 && memcmp(trimmedLine, THREAD_DUMP_START, sizeof(THREAD_DUMP_START) - 1) == 0;
+}
+
+// the thread HotSpot lists last
+bool isThreadDumpEnd(const char* trimmedLine, size_t length)
+{
+	for (size_t i = 0; i < sizeof(THREAD_DUMP_ENDS) / sizeof(THREAD_DUMP_ENDS[0]); i++)
+	{
+		const char* end = THREAD_DUMP_ENDS[i] + strlen(THREAD_DUMP_ENDS[i]);
+		if (search(trimmedLine, trimmedLine + length, THREAD_DUMP_ENDS[i], end) != trimmedLine + length)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// the blocks a repository writes when a statement fails, for the classifier and the failed SQL report
+const char FAILED_SQL_START[] = "SQL Statement Failed: [++SQL";
+const char FAILED_SQL_END[] = "[--SQL";
+const char* const FAILED_SQL_KINDS[] = { "Insert", "Update", "Delete", "Select" };
+
+// the kind of statement text starts with, followed by closing ("++]" or "--]"), -1 for none
+static int failedSQLKind(const char* text, const char* end, const char* closing)
+{
+	for (int kind = 0; kind < (int) (sizeof(FAILED_SQL_KINDS) / sizeof(FAILED_SQL_KINDS[0])); kind++)
+	{
+		size_t kindLength = strlen(FAILED_SQL_KINDS[kind]);
+		if ((size_t) (end - text) >= kindLength + 3 && memcmp(text, FAILED_SQL_KINDS[kind], kindLength) == 0
+			&& memcmp(text + kindLength, closing, 3) == 0)
+		{
+			return kind;
+		}
+	}
+	return -1;
+}
+
+/*
+	"SQL Statement Failed: [++SQLInsert++]" anywhere in the line, the kind of statement or -1.
+	marker, when not NULL, is set to where the "SQL Statement Failed" is
+*/
+int failedSQLStart(const char* line, size_t length, const char** marker)
+{
+	const char* end = line + length;
+	for (const char* found = line; (found = findText(found, end - found, FAILED_SQL_START, sizeof(FAILED_SQL_START) - 1)) != NULL; found++)
+	{
+		int kind = failedSQLKind(found + sizeof(FAILED_SQL_START) - 1, end, "++]");
+		if (kind >= 0)
+		{
+			if (marker != NULL)
+			{
+				*marker = found;
+			}
+			return kind;
+		}
+	}
+	return -1;
+}
+
+// "[--SQLInsert--]" anywhere in the line
+bool isFailedSQLEnd(const char* line, size_t length)
+{
+	const char* end = line + length;
+	for (const char* found = line; (found = findText(found, end - found, FAILED_SQL_END, sizeof(FAILED_SQL_END) - 1)) != NULL; found++)
+	{
+		if (failedSQLKind(found + sizeof(FAILED_SQL_END) - 1, end, "--]") >= 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* failedSQLKindName(int kind)
+{
+	return FAILED_SQL_KINDS[kind];
+}
+
+// the entries of an ENVIRONMENT= dump
+static bool isEnvironmentLine(const string& trimmedLine)
+{
+	return startsWith(trimmedLine, "atg.dynamo") ||
+		startsWith(trimmedLine, "atg.license") ||
+		startsWith(trimmedLine, "dataDir") ||
+		startsWith(trimmedLine, "servername") ||
+		startsWith(trimmedLine, "standlone");
+}
+
+/*
+ *	these booleans are for specific conditions that often happen in log files. for instance,
+ *	you may see the following in a log:
+ *		[4/6/07 9:58:53:799 EDT] 0000000a SystemOut     O /atg/dynamo/security/AdminSqlRepository       SQL Statement Failed: [++SQLInsert++]
+ *		INSERT INTO das_account(account_name,type,description,lastpwdupdate)
+ *		VALUES(?,?,?,?)
+ *		-- Parameters --
+ *		p[1] = {pd} tools-integrations-privilege (java.lang.String)
+ *		p[2] = {pd: type} 4 (java.lang.Integer)
+ *		p[3] = {pd: description} Tools: Integrations (java.lang.String)
+ *		p[4] = {pd: lastPasswordUpdate} 2007-04-06 09:58:51.221 (java.sql.Timestamp)
+ *		[--SQLInsert--]
+ *	Everything past the first line is printed to the screen via SOP. If the below method encounters
+ *	"-- Parameters --" it's a dead give-away that we've hit this scenario. In that instance,
+ *	isSQLDebug is set to true and the subsequent lines are colored red until "--SQLInsert--"
+ *	is encountered, which signals the end of that condition. Had this logic not been there, those
+ *	SOP's would have been colored as "other" lines. jbossObjectNameDump and the rest of the booleans
+ *	are for similar logic. it sure would be nice if each line were prefixed with the appropriate line type
+ */
+
+struct atgc_stream
+{
+	/*
+		here we keep three arrays: previous line types, previous trimmed lines, and previous lines.
+		this is done so that we can look through the previous lines to determine what type they are,
+		which helps determine the current line. for instance, some stack traces are followed by a
+		). looking back on the past line types, we can determine this is part of an error and it is
+		colored appropriately
+	*/
+	int previousLineTypes[NUM_SAVED_LINES];
+	string previousLines[NUM_SAVED_LINES];
+	string previousLinesTrimmed[NUM_SAVED_LINES];
+
+	bool jbossObjectNameDump;
+	bool jbossTableDebug;
+	bool isWebSphere;
+	bool isJBoss;
+	bool isWebLogic;
+	bool isSQLDebug;
+	bool isEnvironment;
+	bool isClassPath;
+	bool isConfigPath;
+	bool isJBossInterceptorChain;
+	bool isJBossNamingFactory;
+	bool isWSError;
+	bool isThreadDump;
+
+	// the ATGC_BLOCK_ the line being classified is an entry of
+	int lineBlock;
+
+	// scratch strings reused for every line so classifying doesn't allocate once warmed up
+	string currentLine;
+	string currentLineTrimmed;
+
+	// built-in and user rules. the automaton runs at most once per line, the first time a rule is needed
+	const atgc_rules* rules;
+	RuleScanner ruleScanner;
+	RuleMatch ruleMatch;
+	bool rulesScanned;
+	uint32_t decidingRule; // the rule the line being classified got its type from, NO_RULE when none did
+
+	atgc_stream(const atgc_rules* rules) : rules(rules) { reset(); }
+
+	void reset();
+	int classify(const char* text, size_t length);
+	int classifyLine(const char* text, size_t length);
+	void rememberLine(int lineType);
+	const RuleMatch& matchRules(const string& trimmedLine);
+	int determineLineType(const string& line, const string& trimmedLine);
+};
+
+void atgc_stream::reset()
+{
+	for (int i = 0; i < NUM_SAVED_LINES; i++)
+	{
+		previousLineTypes[i] = 0;
+		previousLines[i].clear();
+		previousLinesTrimmed[i].clear();
+	}
+	jbossObjectNameDump = false;
+	jbossTableDebug = false;
+	isWebSphere = false;
+	isJBoss = false;
+	isWebLogic = false;
+	isSQLDebug = false;
+	isEnvironment = false;
+	isClassPath = false;
+	isConfigPath = false;
+	isJBossInterceptorChain = false;
+	isJBossNamingFactory = false;
+	isWSError = false;
+	isThreadDump = false;
+	lineBlock = ATGC_BLOCK_NONE;
+}
+
+/*
+ *	given a specific line in a log file along with arrays containing previous lines and their
+ *  types, this method returns its type. there isn't any magic to this. i've poured over
+ *  hundreds of thousands of log files from JBoss, DAS, WebSphere, and WebLogic to determine
+ *  their individual patterns. unfortunately, not everybody uses log4j and even when log4j is
+ *  used, it's often mis-configured or there are weird SOP's and that kind of thing. this
+ *  method is pretty much a whole bunch of if/else's. it returns one of six line types:
+ *  INFO_LINE, WARNING_LINE, DEBUG_LINE, ERROR_LINE, OTHER_LINE, and NUCLEUS_LINE
+ */
+int atgc_stream::determineLineType(const string& line, const string& trimmedLine)
+{
+	// most recent items are in the first positions of the array
+	int previousLineType = previousLineTypes[0];
+	const string& trimmedPreviousLine = previousLinesTrimmed[0];
+
+	// an ENVIRONMENT= dump (see below) goes on for as long as its lines are entries
+	bool isEnvironmentEntry = isEnvironment && isEnvironmentLine(trimmedLine);
+	isEnvironment = isEnvironmentEntry || endsWith(trimmedLine, "ENVIRONMENT=");
+
+	// I'm assuming here that this is always the last thread in the dump. If so, break out of loop
+	if (isThreadDumpEnd(trimmedLine.data(), trimmedLine.size()))
+	{
+		isThreadDump=false;
+		return INFO_LINE;
+	}
+
+	if (isThreadDumpStart(trimmedLine.data(), trimmedLine.size()))
+	{
+		isThreadDump=true;
+	}
+
+	if (isThreadDump)
+	{
+		return INFO_LINE;
+	}
+
+	// is output from websphere?
+	if (
+			!isJBoss &&      // once app server type is determined, skip the check for subsequent lines
+			!isWebSphere &&
+			!isWebLogic &&
+			(
+				contains(trimmedLine, "WebSphere Platform") ||
+				contains(trimmedLine, "ATG starting on IBM WebSphere")
+			)
+		)
+	{
+		isWebSphere = true;
+	}
+	// or is it from jboss?
+	else if (
+				!isWebSphere &&
+				!isJBoss &&
+				!isWebLogic &&
+				(
+					contains(trimmedLine, "Starting JBoss") ||
+					contains(trimmedLine, " DEBUG [org.jboss") ||
+					contains(trimmedLine, "org.jboss.system") ||
+					contains(trimmedLine, "org.jboss.logging")
+				)
+			)
+	{
+		isJBoss = true;
+	}
+	else if (
+				!isWebSphere &&
+				!isJBoss &&
+				!isWebLogic &&
+				(
+						startsWith(trimmedLine, "WebLogic Server") ||
+						contains(trimmedLine, "WLS Kernel")
+				)
+			)
+	{
+		isWebLogic=true;
+	}
+
+	/*
+		// jbossObjectNameDump is a boolean representing whether the current line is the first
+		// in the example below. If so, subsequent lines should be colored debug to match, as
+		// they're really part of the same statement
+		2006-06-26 14:34:47,671 DEBUG [org.jboss.system.ServiceController] Creating dependent components for: jboss:service=proxyFactory,target=ClientUserTransaction dependents are: [ObjectName: jboss:service=ClientUserTransaction
+		State: CONFIGURED
+		I Depend On:
+			jboss:service=proxyFactory,target=ClientUserTransactionFactory
+			jboss:service=proxyFactory,target=ClientUserTransaction
+		]
+	*/
+	if (
+			!jbossObjectNameDump &&
+			contains(trimmedLine, "[ObjectName:") &&
+			contains(trimmedLine, " DEBUG [") &&
+			contains(trimmedLine, "jboss")
+		)
+	{
+		jbossObjectNameDump = true;
+	}
+	else if (
+				jbossObjectNameDump &&
+				endsWith(trimmedLine, "]") &&
+				!contains(trimmedLine, " INFO  [STDOUT]")
+			)
+	{
+		jbossObjectNameDump = false;
+		return DEBUG_LINE;
+	}
+	if (jbossObjectNameDump)
+	{
+		return DEBUG_LINE;
+	}
+
+	/*
+		2007-04-11 16:59:02,474 DEBUG [org.jboss.services.binding.AttributeMappingDelegate] setAttribute, name='Properties', text=java.naming.factory.initial=org.jnp.interfaces.NamingContextFactory
+						java.naming.factory.url.pkgs=org.jboss.naming:org.jnp.interfaces
+						java.naming.provider.url=0.0.0.0:1200
+						jnp.disableDiscovery=false
+						jnp.partitionName=DefaultPartition
+						jnp.discoveryGroup=230.0.0.4
+						jnp.discoveryPort=1102
+						jnp.discoveryTTL=16
+						jnp.discoveryTimeout=5000
+						jnp.maxRetries=1, value={java.naming.factory.initial=org.jnp.interfaces.NamingContextFactory, jnp.partitionName=DefaultPartition, jnp.discoveryTimeout=5000, jnp.discoveryGroup=230.0.0.4, jnp.disableDiscovery=false, java.naming.provider.url=0.0.0.0:1200, java.naming.factory.url.pkgs=org.jboss.naming:org.jnp.interfaces, jnp.maxRetries=1, jnp.discoveryPort=1102, jnp.discoveryTTL=16}
+		2007-04-11 16:59:02,474 DEBUG [org.jboss.system.ServiceCreator] About to create bean: jboss.mq:service=ServerSessionPoolMBean,name=StdJMSPool with code: org.jboss.jms.asf.ServerSessionPoolLoader
+	*/
+	if (
+			!isJBossNamingFactory &&
+			isJBoss &&
+			endsWith(trimmedLine, "NamingContextFactory") &&
+			contains(trimmedLine, " DEBUG [")
+		)
+	{
+		isJBossNamingFactory = true;
+	}
+	else if (
+				isJBossNamingFactory &&
+				isJBoss &&
+				contains(trimmedLine, "[")
+			)
+	{
+		isJBossNamingFactory = false;
+		return DEBUG_LINE;
+	}
+	if (isJBossNamingFactory)
+	{
+		return DEBUG_LINE;
+	}
+
+	if (
+			!jbossTableDebug &&
+			endsWith(trimmedLine, "(") &&
+			contains(trimmedLine, " DEBUG [") &&
+			contains(trimmedLine, "table") &&
+			contains(trimmedLine, "jboss")
+		)
+	{
+		jbossTableDebug = true;
+	}
+	else if (jbossTableDebug && startsWith(trimmedLine, ")"))
+	{
+		jbossTableDebug = false;
+		return DEBUG_LINE;
+	}
+
+	if (jbossTableDebug)
+	{
+		return DEBUG_LINE;
+	}
+
+	/*
+		2007-04-11 16:58:57,359 INFO  [org.jboss.cache.factories.InterceptorChainFactory] interceptor chain is:
+		class org.jboss.cache.interceptors.CallInterceptor
+		class org.jboss.cache.interceptors.PessimisticLockInterceptor
+		class org.jboss.cache.interceptors.UnlockInterceptor
+		class org.jboss.cache.interceptors.ReplicationInterceptor
+		class org.jboss.cache.interceptors.TxInterceptor
+		class org.jboss.cache.interceptors.CacheMgmtInterceptor
+	*/
+
+		if (
+				isJBoss &&
+				!isJBossInterceptorChain &&
+				(
+					endsWith(trimmedLine, "interceptor chain is:")
+				)
+		)
+	{
+		isJBossInterceptorChain = true;
+	}
+	else if (
+				isJBoss &&
+				isJBossInterceptorChain &&
+				!startsWith(trimmedLine, "class org.")
+			)
+	{
+		isJBossInterceptorChain = false;
+	}
+
+	if (isJBossInterceptorChain)
+	{
+		return INFO_LINE;
+	}
+	/*
+		[4/6/07 9:58:53:799 EDT] 0000000a SystemOut     O /atg/dynamo/security/AdminSqlRepository       SQL Statement Failed: [++SQLInsert++]
+		INSERT INTO das_account(account_name,type,description,lastpwdupdate)
+		VALUES(?,?,?,?)
+		-- Parameters --
+		p[1] = {pd} tools-integrations-privilege (java.lang.String)
+		p[2] = {pd: type} 4 (java.lang.Integer)
+		p[3] = {pd: description} Tools: Integrations (java.lang.String)
+		p[4] = {pd: lastPasswordUpdate} 2007-04-06 09:58:51.221 (java.sql.Timestamp)
+		[--SQLInsert--]
+	*/
+
+	if (!isSQLDebug && failedSQLStart(trimmedLine.data(), trimmedLine.size(), NULL) >= 0)
+	{
+		isSQLDebug = true;
+	}
+	else if (isSQLDebug && isFailedSQLEnd(trimmedLine.data(), trimmedLine.size()))
+	{
+		isSQLDebug = false;
+		return ERROR_LINE;
+	}
+
+	if (isSQLDebug)
+	{
+		return ERROR_LINE;
+	}
+
+/*
+	2007-04-10 18:22:14,593 ERROR [com.primus.routing.RoutedServerRequestOnly] Request to server URL: http://localhost:6072/AEXmlService/ failed on the below soap request
+	. More details will follow. <?xml version="1.0"?><query version="4.0" responseNumberSettings="doc5,perDoc3,ans5,perAns1,f2,s5,d0,t5" minScore="300" sorting="SCORE" RQ
+	Text="ANSWER" exclusion="" client="AE Web Client" debug="false" QUID="123"><question>Are you there?</question><clustername></clustername><documentSets><and><or><set s
+	ubdirs="true">/</set></or><or><set subdirs="true">/</set></or></and></documentSets><parserOptions><context>company</context><context>computer</context><usageI>person<
+	/usageI><usageWe>person</usageWe><usageYou>person</usageYou><language>english</language></parserOptions></query>
+	2007-04-10 18:22:14,593 ERROR [com.primus.routing.api.RoutingServerEJBBean] Request for
+			Cluster: DefaultCluster
+			Group: 1
+			Server: 80, http://localhost:6072/AEXmlService/
+	failed on request (stack trace to follow):
+	<?xml version="1.0"?><query version="4.0" responseNumberSettings="doc5,perDoc3,ans5,perAns1,f2,s5,d0,t5" minScore="300" sorting="SCORE" RQText="ANSWER" exclusion="" c
+	lient="AE Web Client" debug="false" QUID="123"><question>Are you there?</question><clustername></clustername><documentSets><and><or><set subdirs="true">/</set></or><o
+	r><set subdirs="true">/</set></or></and></documentSets><parserOptions><context>company</context><context>computer</context><usageI>person</usageI><usageWe>person</usa
+	geWe><usageYou>person</usageYou><language>english</language></parserOptions></query>
+*/
+if (
+	!isWSError &&
+	(
+		endsWith(trimmedLine, "] Request for") &&
+		contains(trimmedLine, " ERROR [")
+	)
+		)
+	{
+		isWSError = true;
+	}
+	else if (
+				isWSError &&
+				(
+					contains(trimmedLine, "[") ||
+					contains(trimmedLine, "]")
+				)
+			)
+	{
+		isWSError = false;
+	}
+
+	if (isWSError)
+	{
+		return ERROR_LINE;
+	}
+
+
+	/*
+		[4/9/07 11:22:23:683 EDT] 0000004c NucleusServle I atg.nucleus.servlet.NucleusServlet initBigEarNucleus CLASSPATH=
+
+			C:\IBM\WebSphere\AppServer\java\lib,
+			C:\IBM\WebSphere\AppServer\java\lib\dt.jar,
+			C:\IBM\WebSphere\AppServer\java\lib\htmlconverter.jar,
+			C:\IBM\WebSphere\AppServer\java\lib\tools.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\classes,
+			C:\IBM\WebSphere\AppServer\lib,
+			C:\IBM\WebSphere\AppServer\lib\AMJACCProvider.jar,
+			C:\IBM\WebSphere\AppServer\lib\DDParser5.jar,
+			C:\IBM\WebSphere\AppServer\lib\EJBCommandTarget.jar,
+			C:\IBM\WebSphere\AppServer\lib\IVTClient.jar,
+			C:\IBM\WebSphere\AppServer\lib\PDWASAuthzManager.jar,
+			C:\IBM\WebSphere\AppServer\lib\UDDICloudscapeCreate.jar,
+			C:\IBM\WebSphere\AppServer\lib\UDDIValueSetTools.jar,
+			C:\IBM\WebSphere\AppServer\lib\WebSealTAIwas6.jar,
+	*/
+	if (
+			!isClassPath &&
+			endsWith(trimmedLine, "CLASSPATH=") &&
+			(
+				startsWith(trimmedLine, "C:") ||
+				startsWith(trimmedLine, "D:") ||
+				startsWith(trimmedLine, "/") ||
+				startsWith(trimmedLine, "vfs=") ||
+				startsWith(trimmedLine, "ATG-Data") ||
+				startsWith(trimmedLine, "")
+			)
+		)
+	{
+		isClassPath = true;
+		return INFO_LINE;
+	}
+	else if (isClassPath)
+	{
+		if (
+				startsWith(trimmedLine, "C:") ||
+				startsWith(trimmedLine, "D:") ||
+				startsWith(trimmedLine, "/") ||
+				startsWith(trimmedLine, "vfs=") ||
+				startsWith(trimmedLine, "ATG-Data")
+			)
+		{
+			lineBlock = ATGC_BLOCK_CLASSPATH;
+			return INFO_LINE;
+		}
+		else
+		{
+			isClassPath = false;
+		}
+	}
+
+
+	/*
+		CONFIGPATH=
+
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DAS\config\config.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DAS\config\oca-ldap.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DAS-UI\config\uiconfig.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\targeting.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\oca-cms.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\oca-html.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\oca-xml.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\userprofiling.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DPS\config\profile.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DSS\config\config.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DafEar\base\config\dafconfig.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\DafEar\WebSphere\config\wsconfig.jar,
+			C:\IBM\WebSphere\AppServer\profiles\20063\installedApps\gopricahpNode01Cell\ATGApp.ear\atg_bootstrap.war\WEB-INF\ATG-INF\home\localconfig,
+			ATG-Data\localconfig
+	*/
+	if (!isConfigPath && endsWith(trimmedLine, "CONFIGPATH="))
+	{
+		isConfigPath = true;
+		return INFO_LINE;
+	}
+	else if (isConfigPath)
+	{
+		if (
+				startsWith(trimmedLine, "C:") ||
+				startsWith(trimmedLine, "D:") ||
+				startsWith(trimmedLine, "/") ||
+				startsWith(trimmedLine, "vfs=") ||
+				startsWith(trimmedLine, "ATG-Data")
+			)
+		{
+			lineBlock = ATGC_BLOCK_CONFIGPATH;
+			return INFO_LINE;
+		}
+		else
+		{
+			isConfigPath = false;
+		}
+	}
+
+	// user rules with a positive priority win over all of the single line checks below
+	if (rules->hasPositiveRules && matchRules(trimmedLine).positive != NO_RULE)
+	{
+		decidingRule = ruleMatch.positive;
+		return rules->tables.rules[ruleMatch.positive].lineType;
+	}
+
+	if (
+				contains(trimmedLine, "Throwable while attempting to get a new connection") ||
+				contains(trimmedLine, "Exception destroying ManagedConnection") ||
+				contains(trimmedLine, "ConcurrentUpdateException caught updating an item during a commit") ||
+				contains(trimmedLine, "XAException: tx=") ||
+				contains(trimmedLine, "] Failed to connect to ") ||
+				contains(trimmedLine, "java.lang.NoClassDefFoundError") ||
+				contains(trimmedLine, "Error registering request") ||
+				contains(trimmedLine, "java.lang.NullPointerException") ||
+				contains(trimmedLine, "Illegal access: this web application instance has been stopped already.")
+		)
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				contains(trimmedLine, "Nucleus running") ||
+				contains(trimmedLine, "Starting Nucleus") ||
+				contains(trimmedLine, "Invoking custom Nucleus") ||
+				contains(trimmedLine, "Nucleus shutting down") ||
+				contains(trimmedLine, "Nucleus shutdown complete") ||
+				contains(trimmedLine, "Nucleus not running")
+			)
+	{
+		return NUCLEUS_LINE;
+	}
+
+	// DAS prefixes all lines with **** type
+	else if (contains(trimmedLine, "**** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "**** info"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "**** debug"))
+	{
+		return DEBUG_LINE;
+	}
+	else if (contains(trimmedLine, "**** Debug"))
+	{
+		return DEBUG_LINE;
+	}
+	else if (contains(trimmedLine, "**** Warning"))
+	{
+		return WARNING_LINE;
+	}
+
+	// JBoss/log4j
+	// if running JBoss without log4j correctly confirgured, everything from ATG will come through INFO  [STDOUT]
+	else if (contains(trimmedLine, " INFO  [") && !contains(trimmedLine, "INFO  [STDOUT]"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, " WARN  ["))
+	{
+		return WARNING_LINE;
+	}
+	else if (contains(trimmedLine, " ERROR ["))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, " FATAL ["))
+	{
+		return ERROR_LINE;
+	}
+
+
+	// 2007-02-26 15:37:18,723 DEBUG [org.jboss.mq.pm.jdbc2.PersistenceManager] Could not create table with SQL: CREATE CACHED TABLE JMS_MESSAGES ( MESSAGEID INTEGER NOT NULL, DESTINATION VARCHAR(255) NOT NULL, TXID INTEGER, TXOP CHAR(1), MESSAGEBLOB OBJECT, PRIMARY KEY (MESSAGEID, DESTINATION) )
+	else if (contains(trimmedLine, "Could not create table with SQL"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, " DEBUG ["))
+	{
+		return DEBUG_LINE;
+	}
+
+	// from tomcat
+	else if (contains(trimmedLine, "{INFO}"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "{CONFIG}"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "{WARN}"))
+	{
+		return WARNING_LINE;
+	}
+	else if (contains(trimmedLine, "{ERROR}"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "{FATAL}"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "{DEBUG}"))
+	{
+		return DEBUG_LINE;
+	}
+
+	else if (contains(trimmedLine, "info]"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "config]"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "warn]"))
+	{
+		return WARNING_LINE;
+	}
+	else if (contains(trimmedLine, "error]"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "fatal]"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "debug]"))
+	{
+		return DEBUG_LINE;
+	}
+
+
+
+	// weblogic
+	else if (contains(trimmedLine, "<Notice>"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "<Info>"))
+	{
+		return INFO_LINE;
+	}
+	else if (contains(trimmedLine, "<Alert>"))
+	{
+		return WARNING_LINE;
+	}
+	else if (contains(trimmedLine, "<Warning>"))
+	{
+		return WARNING_LINE;
+	}
+	else if (contains(trimmedLine, "<Error>"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "<Critical>"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "<Emergency>"))
+	{
+		return ERROR_LINE;
+	}
+	else if (contains(trimmedLine, "<Debug>"))
+	{
+		return DEBUG_LINE;
+	}
+
+	// sometimes jboss prints XML messages in the form
+	//	<mbean code="org.jboss.jms.asf.ServerSessionPoolLoader" name="jboss.mq:service=ServerSessionPoolMBean,name=StdJMSPool">
+	//		<depends optional-attribute-name="XidFactory">jboss:service=XidFactory</depends>
+	//		<attribute name="PoolName">StdJMSPool</attribute>
+	//		<attribute name="PoolFactoryClass">
+	//		   org.jboss.jms.asf.StdServerSessionPoolFactory
+	//		</attribute>
+	//   </mbean>
+	// this little else if prevents org.jboss.jms.asf.StdServerSessionPoolFactory and other similar lines from being colored red
+	else if (
+				(
+					startsWith (trimmedLine, "com.") ||
+					startsWith (trimmedLine, "org.") ||
+					startsWith (trimmedLine, "atg.") ||
+					startsWith (trimmedLine, "jrockit.") ||
+					startsWith (trimmedLine, "java.") ||
+					startsWith (trimmedLine, "javax.") ||
+					startsWith (trimmedLine, "webservices.") ||
+					startsWith (trimmedLine, "sun.") ||
+					startsWith (trimmedLine, "oracle.") ||
+					startsWith (trimmedLine, "weblogic.")
+				)
+		&& startsWith(trimmedPreviousLine, "<")
+		&& previousLineType == OTHER_LINE)
+	{
+		return OTHER_LINE;
+	}
+
+	/*
+		2007-03-14 16:44:38,493 ERROR [org.apache.commons.modeler.Registry] Error registering jboss.web:type=RequestProcessor,worker=jk-8109,name=JkRequest248
+		java.lang.SecurityException: MBeanTrustPermission(register) not implied by protection domain of mbean class: org.apache.commons.modeler.BaseModelMBean, pd: Protection
+		Domain  (file:/export/nauuser/jboss-4.0.3SP1/server/node01/tmp/deploy/tmp62537commons-modeler.jar <no signer certificates>)
+		org.jboss.mx.loading.UnifiedClassLoader3@6127da{ url=file:/export/nauuser/jboss-4.0.3SP1/server/node01/deploy/jbossweb-tomcat55.sar/ ,addedOrder=10}
+		<no principals>
+	*/
+	else if (
+				(
+					startsWith (trimmedLine, "com.") ||
+					startsWith (trimmedLine, "org.") ||
+					startsWith (trimmedLine, "atg.") ||
+					startsWith (trimmedLine, "jrockit.") ||
+					startsWith (trimmedLine, "java.") ||
+					startsWith (trimmedLine, "javax.") ||
+					startsWith (trimmedLine, "sun.") ||
+					startsWith (trimmedLine, "webservices.") ||
+					startsWith (trimmedLine, "oracle.") ||
+					startsWith (trimmedLine, "weblogic.")
+				)
+		&& endsWith(trimmedPreviousLine, ">)")
+		&& previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+	 * Colors the http://xml.apache.org/axis/ line
+	 *			at org.apache.axis.client.Call.invoke(Call.java:2366)
+	 *			at org.apache.axis.client.Call.invoke(Call.java:1812)
+	 *			at com.atg.www.b2cblueprint.integrations.B2CBlueprintOMSIntegrationWS.B2CBlueprintOMSIntegrationWSBindingStub.orderSubmitToOMS(B2CBlueprintOMSIntegrationWSBindingStub.java:939)
+	 *			at atg.projects.b2cblueprint.integrations.webservices.B2CBlueprintOMSIntegrationWSClient.orderSubmitToOMS(B2CBlueprintOMSIntegrationWSClient.java:100)
+	 *			at atg.projects.b2cblueprint.integrations.order.B2CBlueprintOMSOrderSubmissionService.submitOrdersToOMS(B2CBlueprintOMSOrderSubmissionService.java:306)
+	 *			at atg.projects.b2cblueprint.integrations.order.B2CBlueprintOMSOrderSubmissionService.performScheduledTask(B2CBlueprintOMSOrderSubmissionService.java:420)
+	 *			at atg.service.scheduler.Scheduler$1handler.run(Scheduler.java:535)
+	 *			{http://xml.apache.org/axis/}hostname:PPUTAPPA
+	 *	09:41:52,093 INFO  [STDOUT] java.net.ConnectException: Connection timed out: connect
+	 *	09:41:52,093 INFO  [STDOUT]     at org.apache.axis.AxisFault.makeFault(AxisFault.java:101)
+	 *	09:41:52,093 INFO  [STDOUT]     at org.apache.axis.transport.http.HTTPSender.invoke(HTTPSender.java:154)
+	 *	09:41:52,093 INFO  [STDOUT]     at org.apache.axis.strategies.InvocationStrategy.visit(InvocationStrategy.java:32)
+	 */
+	else if (
+				(
+					startsWith (trimmedLine, "{http://xml.apache.org/axis/}hostname:")
+				)
+		&& previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+		these next series of if else statements are to properly color the following:
+		2007-03-05 23:19:58,092 INFO  [atg.nucleus.servlet.NucleusServlet] ENVIRONMENT=
+			atg.dynamo.home=/export/nauuser/jboss-4.0.3SP1/server/node01/./deploy/nauCommerce.ear/atg_bootstrap.war/WEB-INF/ATG-INF/home,
+			atg.dynamo.root=/export/nauuser/jboss-4.0.3SP1/server/node01/./deploy/nauCommerce.ear/atg_bootstrap.war/WEB-INF/ATG-INF,
+			atg.dynamo.server.home=/export/nauuser/jboss-4.0.3SP1/server/node01/./deploy/nauCommerce.ear/atg_bootstrap.war/WEB-INF/ATG-INF/home/servers/node01,
+			atg.dynamo.versioninfo=ATGPlatform/2006.3,
+			atg.dynamo.liveconfig=on,
+			atg.dynamo.modules=nauCommerce,DafEar.Admin,DAS.WebServices,DCS.WebServices,DCS.AbandonedOrderServices,
+			atg.dynamo.platformversion=2006.3,
+			atg.dynamo.server.name=node01,
+			atg.dynamo.display=:0.0,
+			atg.license.read=true,
+			atg.dynamo.daf=true
+			dataDir=/export/nauuser/jboss-4.0.3SP1/bin/ATG-Data
+			servername=node01
+			standlone=true
+		2007-03-05 23:20:00,083 INFO  [nucleusNamespace.DPSLicense] DPS is licensed to NAU - Production
+	*/
+	else if (isEnvironmentEntry && previousLineType == INFO_LINE)
+	{
+		lineBlock = ATGC_BLOCK_ENVIRONMENT;
+		return INFO_LINE;
+	}
+
+	else if (startsWith(trimmedLine, "SQL Statement Failed"))
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+		2007-04-11 16:58:59,553 DEBUG [org.jboss.util.naming.Util] link: Reference Class Name: javax.naming.LinkRef
+		Type: LinkAddress
+		Content: jmx/invoker/RMIAdaptor
+	*/
+	else if (
+				(
+					startsWith(trimmedLine, "Type: ") ||
+					startsWith(trimmedLine, "Content: ")
+				) &&
+				(
+					contains(previousLinesTrimmed[0], " DEBUG [") ||
+					contains(previousLinesTrimmed[1], " DEBUG [")
+				)
+		)
+	{
+		return DEBUG_LINE;
+	}
+
+	/*
+		Designed to catch stack trace stuff, but ignore for instance the java.naming in the XML from JBoss below
+		2007-04-11 16:59:10,358 DEBUG [org.jboss.deployment.XSLSubDeployer] transformed into doc: <server>
+		<mbean code='org.jboss.jms.jndi.JMSProviderLoader' name='jboss.mq:service=JMSProviderLoader,name=HAJNDIJMSProvider'>
+		<attribute name='ProviderName'>DefaultJMSProvider</attribute>
+		<attribute name='ProviderAdapterClass'>
+			org.jboss.jms.jndi.JNDIProviderAdapter
+			</attribute>
+		<attribute name='FactoryRef'>XAConnectionFactory</attribute>
+		<attribute name='QueueFactoryRef'>XAConnectionFactory</attribute>
+		<attribute name='TopicFactoryRef'>XAConnectionFactory</attribute>
+		<attribute name='Properties'>
+			java.naming.factory.initial=org.jnp.interfaces.NamingContextFactory
+			java.naming.factory.url.pkgs=org.jboss.naming:org.jnp.interfaces
+			java.naming.provider.url=${jboss.bind.address:localhost}:1100
+			jnp.disableDiscovery=false
+			jnp.partitionName=${jboss.partition.name:DefaultPartition}
+			jnp.discoveryGroup=${jboss.partition.udpGroup:230.0.0.4}
+			jnp.discoveryPort=1102
+			jnp.discoveryTTL=16
+			jnp.discoveryTimeout=5000
+			jnp.maxRetries=1
+			</attribute>
+		</mbean>
+	*/
+	else if (
+				(
+					contains(trimmedLine, "[STDOUT]     at") ||
+					startsWith(trimmedLine, "at ") ||
+					startsWith(trimmedLine, "org.") ||
+					startsWith(trimmedLine, "(org.") ||
+					startsWith(trimmedLine, "sun.") ||
+					startsWith(trimmedLine, "(sun.") ||
+					startsWith(trimmedLine, "atg.") ||
+					startsWith(trimmedLine, "(atg.") ||
+					startsWith(trimmedLine, "com.") ||
+					startsWith(trimmedLine, "(com.") ||
+					startsWith(trimmedLine, "jrockit.") ||
+					startsWith(trimmedLine, "(jrockit.") ||
+					startsWith(trimmedLine, "webservices.") ||
+					startsWith(trimmedLine, "(webservices.") ||
+					startsWith(trimmedLine, "java.") ||
+					startsWith(trimmedLine, "(java.") ||
+					startsWith(trimmedLine, "javax.") ||
+					startsWith(trimmedLine, "(javax.") ||
+					startsWith(trimmedLine, "oracle.") ||
+					startsWith(trimmedLine, "(oracle.") ||
+					startsWith(trimmedLine, "weblogic.") ||
+					startsWith(trimmedLine, "(weblogic.") ||
+					startsWith(trimmedLine, "<no ") ||
+					startsWith(trimmedLine, "CAUSE:") ||
+					startsWith(trimmedLine, "Exception in") ||
+					startsWith(trimmedLine, "Caused by") ||
+					startsWith(trimmedLine, "Symbol") ||
+					startsWith(trimmedLine, "Location") ||
+					startsWith(trimmedLine, "...stack") ||
+					startsWith(trimmedLine, "... stack") ||
+					startsWith(trimmedLine, ".... ") ||
+					startsWith(trimmedLine, "....stack") ||
+					startsWith(trimmedLine, ".... stack") ||
+					startsWith(trimmedLine, "CAUGHT AT:") ||
+					startsWith(trimmedLine, "CONTAINER:") ||
+					startsWith(trimmedLine, "SOURCE EXCEPTION:") ||
+					contains(trimmedLine, "nested exception is:")
+				) && !contains(trimmedLine, "=")
+			)
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+        at atg.servlet.WrappingRequestDispatcher.include(WrappingRequestDispatcher.java:94)
+        at atg.taglib.dspjsp.IncludeTag.doEndTag(Unknown Source)
+        ... 213 more
+		SOURCE EXCEPTION:javax.servlet.ServletException: atg.adapter.gsa.GSARepository
+	*/
+	else if (contains(trimmedLine, "...") && contains(trimmedLine, "more"))
+	{
+		return ERROR_LINE;
+	}
+
+	// more stack trace stuff
+	// [4/6/07 16:23:13:093 EDT] 00000050 WorkSpaceMana E   WKSP0019E: Error getting repository adapter com.ibm.ws.management.configarchive.ConfigArchiveRepositoryAdapter -- java.lang.ClassNotFoundException: com.ibm.ws.management.configarchive.ConfigArchiveRepositoryAdapter
+	else if (
+				contains(trimmedLine, "Exception:") &&
+				(
+					contains(trimmedLine, "com.") ||
+					contains(trimmedLine, "org.") ||
+					contains(trimmedLine, "atg.") ||
+					contains(trimmedLine, "jrockit.") ||
+					contains(trimmedLine, "java.") ||
+					contains(trimmedLine, "oracle.") ||
+					contains(trimmedLine, "webservices.") ||
+					contains(trimmedLine, "javax.") ||
+					contains(trimmedLine, "sun.") ||
+					contains(trimmedLine, "weblogic.")
+				)
+		)
+	{
+		return ERROR_LINE;
+	}
+
+	// [4/6/07 10:18:37:237 EDT] 00000021 ServletWrappe E   SRVE0068E: Could not invoke the service() method on servlet DynamoProxyServlet. Exception thrown : java.lang.NullPointerException
+	// INFO  [STDOUT]  at org.apache.jk.server.JkCoyoteHandler.invoke(JkCoyoteHandler.java:307)
+	else if (
+				contains(trimmedLine, "Exception thrown") &&
+				(
+					contains(trimmedLine, "com.") ||
+					contains(trimmedLine, "org.") ||
+					contains(trimmedLine, "atg.") ||
+					contains(trimmedLine, "jrockit.") ||
+					contains(trimmedLine, "webservices.") ||
+					contains(trimmedLine, "java.") ||
+					contains(trimmedLine, "sun.") ||
+					contains(trimmedLine, "oracle.") ||
+					contains(trimmedLine, "javax.") ||
+					contains(trimmedLine, "weblogic.")
+				)
+		)
+	{
+		return ERROR_LINE;
+	}
+	else if (startsWith(trimmedLine, "C:") && previousLineType == ERROR_LINE && !isWebSphere)
+	{
+		return ERROR_LINE;
+	}
+	else if (startsWith(trimmedLine, "D:") && previousLineType == ERROR_LINE && !isWebSphere)
+	{
+		return ERROR_LINE;
+	}
+	else if (startsWith(trimmedLine, "SEVERE:"))
+	{
+		return ERROR_LINE;
+	}
+	else if (startsWith(trimmedLine, "XML parsing error:"))
+	{
+		return ERROR_LINE;
+	}
+
+	else if (startsWith(trimmedLine, ">") && previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+	else if (startsWith(trimmedLine, ")") && previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+		C:\bea\user_projects\domains\atg\.\myserver\.wlnotdelete\extract\myserver_StoreApp_storeApp.war\jsp_servlet\_checkout\__shipping.java:648: setDefault(java.lang.String) in atg.taglib.dspjsp.InputTagBase cannot be applied to (boolean)
+				_dsp_input0.setDefault(true); //[ /checkout/shipping.jsp; Line: 42]
+							^
+		1 error
+	*/
+	else if (startsWith(trimmedLine, "^") && previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				previousLineType == ERROR_LINE &&
+				(
+					contains(trimmedLine, ".java:") ||
+					contains(trimmedLine, "Line:") ||
+					contains(trimmedLine, "location:") ||
+					contains(trimmedLine, "symbol  :") ||
+					contains(trimmedLine, ".jsp;")
+				)
+			)
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				(
+					endsWith(trimmedLine, " error") ||
+					endsWith(trimmedLine, " errors")
+				) &&
+				previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+		[3/26/07 11:32:32:231 EST] 0000001f SystemOut     O /atg/dynamo/security/AdminAccountManager    Failure trying to retrieve account scenarios-privilege  CONTAINER:atg.repository.RepositoryException; SOURCE:java.sql.SQLException: [IBM][SQLServer JDBC Driver][SQLServer]Invalid object name 'das_account'.
+	*/
+	else if (contains(trimmedLine, "CONTAINER:") && contains(trimmedLine, "SOURCE:"))
+	{
+		return ERROR_LINE;
+	}
+
+	/*
+		the next 9 if/else statements are for this condition:
+		2006-06-26 14:35:26,171 INFO  [STDOUT] **** Error
+		2006-06-26 14:35:26,171 INFO  [STDOUT]
+		2006-06-26 14:35:26,171 INFO  [STDOUT] Mon Jun 26 14:35:26 CDT 2006
+		2006-06-26 14:35:26,171 INFO  [STDOUT]
+		2006-06-26 14:35:26,171 INFO  [STDOUT] 1151350526171
+		2006-06-26 14:35:26,171 INFO  [STDOUT]
+		2006-06-26 14:35:26,171 INFO  [STDOUT] /
+		2006-06-26 14:35:26,171 INFO  [STDOUT]
+		2006-06-26 14:35:26,171 INFO  [STDOUT]  java.net.BindException: Address already in use: JVM_Bind
+	*/
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[2], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[3], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[4], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				(endsWith(trimmedLine, "INFO  [STDOUT] /") ||
+				endsWith(trimmedLine, "INFO  [STDOUT] ---")) &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[5], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				(endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] /") ||
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] ---")) &&
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[6], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				(endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] /") ||
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] ---")) &&
+				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[6], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[7], "[STDOUT] **** Error"))
+	{
+		return ERROR_LINE;
+	}
+
+
+   /*
+	*	the next 9 if/else statements are for this condition:
+	* 15:02:27,087 INFO  [STDOUT] **** Warning
+	* 15:02:27,087 INFO  [STDOUT]
+	* 15:02:27,087 INFO  [STDOUT] Tue Jan 22 15:02:27 CST 2008
+	* 15:02:27,087 INFO  [STDOUT]
+	* 15:02:27,087 INFO  [STDOUT] 1201035747087
+	* 15:02:27,087 INFO  [STDOUT]
+	* 15:02:27,087 INFO  [STDOUT] /
+	* 15:02:27,088 INFO  [STDOUT]
+	* 15:02:27,088 INFO  [STDOUT] PR#142511 HOTFIX: Created on 11/21/2007
+	*/
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[2], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[3], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[4], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				(endsWith(trimmedLine, "INFO  [STDOUT] /") ||
+				endsWith(trimmedLine, "INFO  [STDOUT] ---")) &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[5], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				endsWith(trimmedLine, "INFO  [STDOUT]") &&
+				(endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] /") ||
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT] ---")) &&
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[6], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+	else if (
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				(endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] /") ||
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] ---")) &&
+				endsWith(previousLinesTrimmed[2], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[3], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[4], "INFO  [STDOUT]") &&
+				contains(previousLinesTrimmed[5], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[6], "INFO  [STDOUT]") &&
+				endsWith(previousLinesTrimmed[7], "[STDOUT] **** Warning"))
+	{
+		return WARNING_LINE;
+	}
+
+
+	/*
+		This else/if coveres the third line here
+		2006-06-26 14:35:25,906 INFO  [STDOUT] ---
+		2006-06-26 14:35:25,906 INFO  [STDOUT]
+		2006-06-26 14:35:25,906 INFO  [STDOUT] java.rmi.server.ExportException: Port already in use: 0; nested exception is:
+				java.net.BindException: Address already in use: JVM_Bind
+				at sun.rmi.transport.tcp.TCPTransport.listen(TCPTransport.java:243)
+				at sun.rmi.transport.tcp.TCPTransport.exportObject(TCPTransport.java:178)
+				at sun.rmi.transport.tcp.TCPEndpoint.exportObject(TCPEndpoint.java:382)
+				at sun.rmi.transport.LiveRef.exportObject(LiveRef.java:116)
+				at sun.rmi.server.UnicastServerRef.exportObject(UnicastServerRef.java:145)
+				at sun.rmi.server.UnicastServerRef.exportObject(UnicastServerRef.java:129)
+				at java.rmi.server.UnicastRemoteObject.exportObject(UnicastRemoteObject.java:275)
+				at java.rmi.server.UnicastRemoteObject.exportObject(UnicastRemoteObject.java:178)
+		....stack trace CROPPED after 10 lines.
+	*/
+	else if (
+				endsWith(previousLinesTrimmed[1], "INFO  [STDOUT] ---") &&
+				endsWith(previousLinesTrimmed[0], "INFO  [STDOUT]") &&
+				contains(trimmedLine, "INFO  [STDOUT]") &&
+				(
+					contains(trimmedLine, "com.") ||
+					contains(trimmedLine, "org.") ||
+					contains(trimmedLine, "atg.") ||
+					contains(trimmedLine, "jrockit.") ||
+					contains(trimmedLine, "java.") ||
+					contains(trimmedLine, "sun.") ||
+					contains(trimmedLine, "webservices.") ||
+					contains(trimmedLine, "oracle.") ||
+					contains(trimmedLine, "javax.") ||
+					contains(trimmedLine, "weblogic.")
+				)
+			)
+	{
+		return ERROR_LINE;
+	}
+
+	else if (
+				(
+					contains(trimmedLine, "com.") ||
+					contains(trimmedLine, "INFO  [STDOUT] org.") ||
+					contains(trimmedLine, "INFO  [STDOUT] atg.") ||
+					contains(trimmedLine, "INFO  [STDOUT] jrockit.") ||
+					contains(trimmedLine, "INFO  [STDOUT] sun.") ||
+					contains(trimmedLine, "INFO  [STDOUT] java.") ||
+					contains(trimmedLine, "INFO  [STDOUT] webservices.") ||
+					contains(trimmedLine, "INFO  [STDOUT] oracle.") ||
+					contains(trimmedLine, "INFO  [STDOUT] javax.") ||
+					contains(trimmedLine, "INFO  [STDOUT] weblogic.")
+				) &&
+				contains(trimmedLine, "Exception") &&
+				contains(trimmedLine, ":")
+			)
+	{
+		return ERROR_LINE;
+	}
+
+	else if (
+				contains(trimmedLine, "---- Begin backtrace for Nested Throwables") ||
+				// 2007-04-10 18:22:15,606 INFO  [STDOUT]  at sun.net.www.http.HttpClient.openServer(Unknown Source)
+				contains(trimmedLine, " INFO  [STDOUT] 	at ") ||
+				// 2007-04-10 18:22:52,217 DEBUG [org.jnp.interfaces.NamingContext] Failed to connect to t3:1099
+				contains(trimmedLine, "Invalid/unknown identity:")
+			)
+		{
+			return ERROR_LINE;
+		}
+
+	else if (
+				contains(trimmedLine, "recovered deployment status is either not from this server or does not match") ||
+				contains(trimmedLine, "Test this hotfix on a staging or other non-production environment") ||
+				contains(trimmedLine, " HOTFIX: DO NOT patch beyond ATG")
+			)
+	{
+		return WARNING_LINE;
+	}
+
+	/*
+	 * Prevents the tyupe and content lines from showing up in yellow. they should be debug lines
+	 * 2007-04-11 16:58:00,193 DEBUG [org.jboss.util.naming.Util] link: Reference Class Name: javax.naming.LinkRef
+	 * Type: LinkAddress
+	 * Content: ConnectionFactory
+    /*
+
+	else if (
+				isJBoss &&
+				contains(previousLinesTrimmed[0], " DEBUG [") &&
+				(
+					startsWith(trimmedLine, "Type:") ||
+					startsWith(trimmedLine, "Content:")
+				)
+			)
+	{
+		return ERROR_LINE;
+	}
+	/*
+		2006-06-26 14:34:53,406 DEBUG [org.jboss.services.binding.ServiceBindingManager] applyServiceConfig, server:ports-lpa-base, serviceName:jboss.web:service=WebServer, config=ServiceConfig(name=jboss.web:service=WebServer), bindings=
+		ServiceBinding [name=;hostName=<ANY>;bindAddress=localhost/127.0.0.1;port=8280]
+	*/
+	else if (
+				isJBoss &&
+				endsWith(previousLinesTrimmed[0], "bindings=") &&
+				contains(previousLinesTrimmed[0], " DEBUG [") &&
+				startsWith(trimmedLine, "ServiceBinding")
+			)
+	{
+		return DEBUG_LINE;
+	}
+
+
+	/*
+	 *	16:22:36,275 INFO  [STDOUT] Error while handling scheduled job J2EE Archive Directory Agent
+	 *	16:22:36,285 INFO  [STDOUT]
+	 *	16:22:36,285 INFO  [STDOUT] java.lang.ThreadDeath
+	 *			at org.apache.catalina.loader.WebappClassLoader.loadClass(WebappClassLoader.java:1221)
+	 */
+	else if (
+				contains(trimmedLine, "Error while handling scheduled job J2EE Archive Directory Agent") ||
+				(
+					endsWith(trimmedLine, "INFO  [STDOUT]") &&
+					contains(previousLinesTrimmed[0], "Error while handling scheduled job J2EE Archive Directory Agent")
+				) ||
+				endsWith(trimmedLine, "java.lang.ThreadDeath")
+			)
+	{
+		return ERROR_LINE;
+	}
+
+
+	/*
+	 * There are 3466 SOPs in just the 2006.3 DAS module. All of the below come through as SOP's
+	 * in certain scenarios. Some are hard-coded error message and others are contained in
+	 * resource bundles. When printed, they often have no logging identifiers. I took all of the
+	 * SOP's from Table.java, TemplateParser.java and other important classes. There were many
+	 * SOP's that came from depricated code, so I just threw those out
+	 *
+	 * Yes I know this isn't the most elegant (messages may change, may have missed some), but
+	 * it's a start!
+	 *
+	 * Oh and I've ran a bunch of performance test (due to all of the parsing) and there wasn't
+	 * much of a memory or CPU hit at all
+	 *
+	 * these are the SOP_ERROR_RULES above, checked along with user rules of priority 0
+	 */
+	else if (matchRules(trimmedLine).zero != NO_RULE)
+	{
+		decidingRule = ruleMatch.zero;
+		return rules->tables.rules[ruleMatch.zero].lineType;
+	}
+
+	// more stuff that comes from SOP
+	else if (
+				contains(trimmedLine, "*** Checking in all assets.") ||
+				contains(trimmedLine, "exporting repository:") ||
+				contains(trimmedLine, "Done - Pausing, hit enter to exit")
+			)
+	{
+		return DEBUG_LINE;
+	}
+
+	// more stuff that comes from SOP
+	else if (
+				startsWith(trimmedLine, "log4j:WARN") ||
+				contains(trimmedLine, "There was a problem sending an invalidation event") ||
+				contains(trimmedLine, "*** WARNING: Unqualified driver") ||
+				startsWith(trimmedLine, "Warning:") ||
+				contains(trimmedLine, "is not in the safe list") ||
+				contains(trimmedLine, "Found nullable timestamp column") ||
+				contains(trimmedLine, "was not found in the set of columns returned") ||
+				contains(trimmedLine, "Found non-null ManyToOneMultiProperty") ||
+				contains(trimmedLine, "Found unrecognized many-to-one relationship in table") ||
+				contains(trimmedLine, "Found one to one definition in versioned case with both sides using a primary table") ||
+				contains(trimmedLine, "Warning - table") ||
+				contains(trimmedLine, "Missing a src id property in item-descriptor") ||
+				contains(trimmedLine, "Missing a dst id property in item-descriptor") ||
+				contains(trimmedLine, "Missing a dst multi property in item-descriptor") ||
+				(contains(trimmedLine, "The property in item-descriptor") && contains(trimmedLine, "is read only.")) ||
+				contains(trimmedLine, "found more than one agent status : using most recent status : older Status") ||
+				contains(trimmedLine, "getConnection() should be used instead of this method") ||
+				contains(trimmedLine, "Connection.close() should be used instead of this method") ||
+				(contains(trimmedLine, "directory") && contains(trimmedLine, "could not be created")) ||
+				(contains(trimmedLine, "Encountered") && contains(trimmedLine, "expected one of")) ||
+				(contains(trimmedLine, "Class") && contains(trimmedLine, "does not have a property")) ||
+				(contains(trimmedLine, "Attempt to apply the") && contains(trimmedLine, "operator to a null value")) ||
+				(contains(trimmedLine, "Attempt to apply operator") && contains(trimmedLine, "to arguments of type")) ||
+				(contains(trimmedLine, "Attempt to apply operator") && contains(trimmedLine, "to null value")) ||
+				(contains(trimmedLine, "The function") && contains(trimmedLine, "requires") && contains(trimmedLine, "arguments but was passed")) ||
+
+				// from /atg/nucleus/servlet/NucleusServletResources.properties
+				contains(trimmedLine, "***** WARNING:  System property") ||
+				contains(trimmedLine, "***** WARNING: atg_bootstrap.war may not have started first") ||
+				contains(trimmedLine, "***** WARNING: Context name (context-root) of the atg_bootstrap.war was") ||
+				contains(trimmedLine, "WARNING: Unsupported application server") ||
+				contains(trimmedLine, "WARNING: Warning from ejbc") ||
+				startsWith(trimmedLine, "Warning:") ||
+				startsWith(trimmedLine, "log4j:WARN") ||
+				contains(trimmedLine, "WARNING:") ||
+				contains(trimmedLine, "ATG application EAR file launched in development mode")
+			)
+	{
+		return WARNING_LINE;
+	}
+
+	else if (
+				contains(trimmedLine, "Using default context-root") ||
+				contains(trimmedLine, "Component browsing disabled") ||
+				contains(trimmedLine, "Starting web app nucleus for application") ||
+				contains(trimmedLine, "ATG-Data localconfig for default server") ||
+				contains(trimmedLine, "Stopping Pointbase server...") ||
+				contains(trimmedLine, "Pointbase server stopped.") ||
+				startsWith(trimmedLine, "Shutdown complete") ||
+				startsWith(trimmedLine, "Halting VM") ||
+				contains(trimmedLine, "Configuration file read-only so engine configuration changes will not be saved") ||
+				contains(trimmedLine, "ATG-Data localconfig for server") ||
+				startsWith(trimmedLine, "Query: ") ||
+				startsWith(trimmedLine, "INFO: ")
+		)
+	{
+		return INFO_LINE;
+	}
+
+	// [4/5/07 18:09:14:972 CEST] 00000027 SystemOut     O /atg/portal/portletstandard/ATGContainerService PortletInvokerImpl.render() - Error while dispatching portlet. javax.portlet.PortletException
+	// 2007-03-05 20:55:08,998 INFO  [STDOUT]  at org.jboss.mx.server.Invocation.dispatch(Invocation.java:80)
+	else if (contains(trimmedLine, "Error while ") && previousLineType == ERROR_LINE)
+	{
+		return ERROR_LINE;
+	}
+
+	else if (contains(trimmedLine, "specifies an invalid item-type environnement"))
+	{
+		return ERROR_LINE;
+	}
+
+	else if (startsWith(trimmedLine, "LIVECONFIG=false") && endsWith(trimmedLine, "LIVECONFIG=false"))
+	{
+		return INFO_LINE;
+	}
+
+	else if (startsWith(trimmedLine, "LIVECONFIG=true") && endsWith(trimmedLine, "LIVECONFIG=true"))
+	{
+		return INFO_LINE;
+	}
+
+	/*
+        this covers the period at the end of some stak traces
+		at com.ibm.ws.tcp.channel.impl.WorkQueueManager$Worker.run(WorkQueueManager.java:1039)
+        at com.ibm.ws.util.ThreadPool$Worker.run(ThreadPool.java(Compiled Code))
+		.
+	*/
+	else if (previousLineType == ERROR_LINE && trimmedLine.size() == 1 && startsWith(trimmedLine, ".") && endsWith(trimmedLine, "."))
+	{
+		return ERROR_LINE;
+	}
+
+	// catches all websphere-specific messages. have a look at the below url:
+	// http://publib.boulder.ibm.com/infocenter/wasinfo/v5r1//index.jsp?topic=/com.ibm.websphere.base.doc/info/aes/ae/ctrb_readmsglogs.html
+	else if (
+				isWebSphere &&
+				(
+					contains(trimmedLine, " E ") ||
+					contains(trimmedLine, " F ") ||
+					contains(trimmedLine, " R ") ||
+					contains(trimmedLine, "     R 	") ||
+					contains(trimmedLine, "SystemErr")
+				)
+			)
+	{
+		return ERROR_LINE;
+	}
+	else if (
+				isWebSphere &&
+				(
+					contains(trimmedLine, " I ") ||
+					contains(trimmedLine, " A ") ||
+					contains(trimmedLine, " C ") ||
+					contains(trimmedLine, " D ")
+				)
+			)
+	{
+		return INFO_LINE;
+	}
+	else if (
+				isWebSphere &&
+				contains(trimmedLine, " W ")
+			)
+	{
+		return WARNING_LINE;
+	}
+
+	// finally, if we can't determine the line type, return info. INFO  [STDOUT] usually means
+	// misconfigured ATG-specific output
+	else if (contains(trimmedLine, "INFO  [STDOUT]"))
+	{
+		return INFO_LINE;
+	}
+
+	// user rules with a negative priority only get a say when nothing else recognized the line
+	else if (matchRules(trimmedLine).negative != NO_RULE)
+	{
+		decidingRule = ruleMatch.negative;
+		return rules->tables.rules[ruleMatch.negative].lineType;
+	}
+
+	// if we can't find out what this line is, just return other
+	return OTHER_LINE;
+}
+
+// push elements up and insert the current line at position 0. swapping instead of copying
+// means the oldest string's buffer gets recycled for the newest line
+void atgc_stream::rememberLine(int lineType)
+{
+	for (int i = NUM_SAVED_LINES-1; i > 0; i--)
+	{
+		previousLines[i].swap(previousLines[i-1]);
+		previousLinesTrimmed[i].swap(previousLinesTrimmed[i-1]);
+		previousLineTypes[i] = previousLineTypes[i-1];
+	}
+	previousLines[0].swap(currentLine);
+	previousLinesTrimmed[0].swap(currentLineTrimmed);
+	previousLineTypes[0] = lineType;
+}
+
+// runs the rule automaton over the line the first time it's called for that line
+const RuleMatch& atgc_stream::matchRules(const string& trimmedLine)
+{
+	if (!rulesScanned)
+	{
+		ruleMatch = ruleScanner.scan(*rules, trimmedLine, previousLineTypes[0]);
+		rulesScanned = true;
+	}
+	return ruleMatch;
+}
+
+// called for each line being classified. scripts like startDynamoOnJBOSS.bat stick null
+// characters in their output, those are treated as spaces the same way the colorizer prints them
+int atgc_stream::classifyLine(const char* text, size_t length)
+{
+	currentLine.assign(text, length);
+	for (char* c = (char*) memchr(&currentLine[0], NULL_CHARACTER, length); c != NULL; c = (char*) memchr(c, NULL_CHARACTER, &currentLine[0] + length - c))
+	{
+		*c = ' ';
+	}
+
+	size_t start = 0;
+	while (start < length && isspace((unsigned char) currentLine[start]))
+	{
+		start++;
+	}
+	size_t end = length;
+	while (end > start && isspace((unsigned char) currentLine[end-1]))
+	{
+		end--;
+	}
+	lineBlock = ATGC_BLOCK_NONE;
+	if (start == end)
+	{
+		return ATGC_BLANK_LINE;
+	}
+	currentLineTrimmed.assign(currentLine, start, end - start);
+	rulesScanned = false;
+	decidingRule = NO_RULE;
+
+	int lineType = determineLineType(currentLine, currentLineTrimmed);
+	rememberLine(lineType);
+	return lineType;
+}
+
+// classifyLine, timed and watched for state changes while a tracer is attached to the probes
+int atgc_stream::classify(const char* text, size_t length)
+{
+	if (!ATGC_PROBE_ENABLED(classify) && !ATGC_PROBE_ENABLED(state_change))
+	{
+		return classifyLine(text, length);
+	}
+	unsigned int stateBefore = atgc_stream_state(this);
+	unsigned long long startNs = atgc_probe_ns();
+	int lineType = classifyLine(text, length);
+	unsigned long long ns = atgc_probe_ns() - startNs;
+	int rule = (lineType == ATGC_BLANK_LINE || decidingRule == NO_RULE ? -1 : (int) decidingRule);
+	ATGC_PROBE3(classify, lineType, rule, ns);
+	unsigned int stateAfter = atgc_stream_state(this);
+	if (stateAfter != stateBefore)
+	{
+		ATGC_PROBE2(state_change, stateBefore, stateAfter);
+	}
+	return lineType;
+}
+
+const char* atgc_version(void)
+{
+	return ATGC_VERSION;
+}
+
+atgc_stream* atgc_stream_create(void)
+{
+	return atgc_stream_create_with_rules(builtinRules());
+}
+
+atgc_stream* atgc_stream_create_with_rules(const atgc_rules* rules)
+{
+	if (rules == NULL)
+	{
+		return NULL;
+	}
+
+	// the saved lines are allocated by the constructor, nothrow only covers the stream itself
+	try
+	{
+		return new atgc_stream(rules);
+	}
+	catch (const bad_alloc&)
+	{
+		return NULL;
+	}
+}
+
+void atgc_stream_destroy(atgc_stream* stream)
+{
+	delete stream;
+}
+
+void atgc_stream_set_rules(atgc_stream* stream, const atgc_rules* rules)
+{
+	if (rules != NULL)
+	{
+		stream->rules = rules;
+		stream->rulesScanned = false;
+	}
+}
+
+void atgc_stream_reset(atgc_stream* stream)
+{
+	stream->reset();
+}
+
+// the lines from first on couldn't be classified. they're given a type anyway, for callers that don't look at the count
+static void unclassified(int* types, int* blocks, size_t first, size_t count)
+{
+	for (size_t i = first; i < count; i++)
+	{
+		types[i] = ATGC_OTHER_LINE;
+		if (blocks != NULL)
+		{
+			blocks[i] = ATGC_BLOCK_NONE;
+		}
+	}
+}
+
+int atgc_classify_line(atgc_stream* stream, const char* line, size_t length)
+{
+	try
+	{
+		return stream->classify(line, length);
+	}
+	catch (const bad_alloc&)
+	{
+		return ATGC_NO_MEMORY;
+	}
+}
+
+size_t atgc_classify_batch(atgc_stream* stream, const char* const* lines, const size_t* lengths, size_t count, int* types)
+{
+	size_t i = 0;
+	try
+	{
+		for (; i < count; i++)
+		{
+			types[i] = stream->classify(lines[i], lengths[i]);
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		unclassified(types, NULL, i, count);
+	}
+	return i;
+}
+
+size_t atgc_classify_batch_blocks(atgc_stream* stream, const char* const* lines, const size_t* lengths, size_t count, int* types, int* blocks)
+{
+	size_t i = 0;
+	try
+	{
+		for (; i < count; i++)
+		{
+			types[i] = stream->classify(lines[i], lengths[i]);
+			blocks[i] = stream->lineBlock;
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		unclassified(types, blocks, i, count);
+	}
+	return i;
+}
+
+size_t atgc_classify_buffer(atgc_stream* stream, const char* buffer, size_t length, int* types, size_t maxLines, size_t* consumed)
+{
+	size_t numLines = 0;
+	size_t offset = 0;
+	try
+	{
+		while (numLines < maxLines && offset < length)
+		{
+			const char* newline = (const char*) memchr(buffer + offset, '\n', length - offset);
+			if (newline == NULL)
+			{
+				break;
+			}
+			size_t lineLength = newline - (buffer + offset);
+			types[numLines] = stream->classify(buffer + offset, lineLength);
+			numLines++;
+			offset += lineLength + 1;
+		}
+	}
+	catch (const bad_alloc&)
+	{
+	}
+	if (consumed != NULL)
+	{
+		*consumed = offset;
+	}
+	return numLines;
+}
+
+int atgc_server_type(const atgc_stream* stream)
+{
+	if (stream->isJBoss)
+	{
+		return ATGC_SERVER_JBOSS;
+	}
+	else if (stream->isWebSphere)
+	{
+		return ATGC_SERVER_WEBSPHERE;
+	}
+	else if (stream->isWebLogic)
+	{
+		return ATGC_SERVER_WEBLOGIC;
+	}
+	return ATGC_SERVER_UNKNOWN;
+}
+
+unsigned int atgc_stream_state(const atgc_stream* stream)
+{
+	unsigned int state = 0;
+	if (stream->isSQLDebug)
+	{
+		state |= ATGC_STATE_SQL_DEBUG;
+	}
+	if (stream->isThreadDump)
+	{
+		state |= ATGC_STATE_THREAD_DUMP;
+	}
+	if (stream->jbossObjectNameDump || stream->jbossTableDebug || stream->isJBossInterceptorChain || stream->isJBossNamingFactory)
+	{
+		state |= ATGC_STATE_JBOSS_DUMP;
+	}
+	if (stream->isWSError)
+	{
+		state |= ATGC_STATE_WEBSPHERE_ERROR;
+	}
+	if (stream->isEnvironment || stream->isClassPath || stream->isConfigPath)
+	{
+		state |= ATGC_STATE_BLOCK;
+	}
+	return state;
+}
+
+atgc_rules* atgc_rules_compile(const char* const* paths, size_t numPaths, char* error, size_t errorLength)
+{
+	// the built-in rules on their own are already compiled. destroying them does nothing
+	if (numPaths == 0)
+	{
+		return const_cast<atgc_rules*>(builtinRules());
+	}
+
+	string message;
+	atgc_rules* rules = NULL;
+	bool outOfMemory = false;
+	try
+	{
+		vector<RuleDefinition> definitions;
+		builtinDefinitions(definitions);
+
+		bool parsed = true;
+		for (size_t i = 0; i < numPaths && parsed; i++)
+		{
+			parsed = parseRuleFile(paths[i], definitions, message);
+		}
+		if (parsed)
+		{
+			rules = compileRules(definitions, message);
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		// the message can't be allocated either
+		rules = NULL;
+		outOfMemory = true;
+	}
+	if (rules == NULL && error != NULL && errorLength > 0)
+	{
+		strncpy(error, outOfMemory ? "out of memory compiling the rules" : message.c_str(), errorLength - 1);
+		error[errorLength - 1] = NULL_CHARACTER;
+	}
+	return rules;
+}
+
+void atgc_rules_destroy(atgc_rules* rules)
+{
+	destroyRules(rules);
+}
+
+size_t atgc_rules_count(const atgc_rules* rules)
+{
+	return rules->tables.numRules;
+}
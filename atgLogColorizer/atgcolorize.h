@@ -0,0 +1,184 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * libatgcolorize is the line classifier behind ATGLogColorizer, usable from any C or C++
+ * program without going through a pipe. a caller creates one stream per log it is reading
+ * (the classifier remembers previous lines, the detected app server and multi-line blocks
+ * like SQL debug output or thread dumps) and hands it lines, one or many at a time.
+ *
+ * building:
+ *		static:	g++ -O2 -pthread -c atgcolorize*.cpp && ar rcs libatgcolorize.a atgcolorize*.o
+ *		shared:	g++ -O2 -pthread -shared -fPIC -fvisibility=hidden -DATGC_SHARED -DATGC_BUILDING -o libatgcolorize.so atgcolorize*.cpp
+ *
+ * the renderers (atgcolorize_ansi.h, _json.h, _html.h) and the other atgcolorize_*.h modules are
+ * built into the same library, each only needed by callers that use it. only what is marked
+ * ATGC_API is exported, everything else stays inside the library
+ */
+
+#ifndef ATGCOLORIZE_H
+#define ATGCOLORIZE_H
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(ATGC_SHARED)
+	#ifdef ATGC_BUILDING
+		#define ATGC_API __declspec(dllexport)
+	#else
+		#define ATGC_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define ATGC_API __attribute__((visibility("default")))
+#else
+	#define ATGC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATGC_VERSION "1.3"
+
+/*
+	line types returned by the classifier. the values are stable and can be stored by callers.
+	ATGC_BLANK_LINE is returned for lines that are empty or only whitespace; those lines are
+	not remembered by the stream, the same way the colorizer always skipped them
+*/
+#define ATGC_INFO_LINE 0
+#define ATGC_WARNING_LINE 1
+#define ATGC_DEBUG_LINE 2
+#define ATGC_ERROR_LINE 3
+#define ATGC_OTHER_LINE 4
+#define ATGC_NUCLEUS_LINE 5
+#define ATGC_BLANK_LINE 6
+#define ATGC_NUM_LINE_TYPES 7
+
+/*
+	returned by atgc_classify_line instead of a line type when the stream ran out of memory. the
+	line isn't remembered and the stream should be reset before it's used again. no exception ever
+	leaves the library: a call that runs out of memory returns NULL, this, or what it got done
+	before it ran out. the modules that take lines one at a time leave the line out of what they
+	count, or let it through as it is, see their headers
+*/
+#define ATGC_NO_MEMORY -1
+
+// app server detected from the output. once detected, it doesn't change for the stream
+#define ATGC_SERVER_UNKNOWN 0
+#define ATGC_SERVER_JBOSS 1
+#define ATGC_SERVER_WEBSPHERE 2
+#define ATGC_SERVER_WEBLOGIC 3
+
+/*
+	the multi-line dumps an app server writes at startup, one entry per line. see
+	atgc_classify_batch_blocks
+*/
+#define ATGC_BLOCK_NONE 0
+#define ATGC_BLOCK_ENVIRONMENT 1
+#define ATGC_BLOCK_CLASSPATH 2
+#define ATGC_BLOCK_CONFIGPATH 3
+
+/*
+	the multi-line output a stream is in the middle of, as bits. the lines that follow are colored
+	as part of it until it ends. see atgc_stream_state
+*/
+#define ATGC_STATE_SQL_DEBUG 0x01 // the parameters of a SQL statement
+#define ATGC_STATE_THREAD_DUMP 0x02
+#define ATGC_STATE_JBOSS_DUMP 0x04 // an object name, table, interceptor chain or naming factory dump of JBoss
+#define ATGC_STATE_WEBSPHERE_ERROR 0x08
+#define ATGC_STATE_BLOCK 0x10 // an ENVIRONMENT, CLASSPATH or CONFIGPATH dump
+
+typedef struct atgc_stream atgc_stream;
+typedef struct atgc_rules atgc_rules;
+
+ATGC_API const char* atgc_version(void);
+
+/*
+	compiles the built-in rules plus the rules of numPaths rule files (format described in
+	atgcolorize_rules.cpp) into a rule set any number of streams can share. returns NULL and
+	writes a message into error when a file can't be read, has a mistake in it or memory ran out. with no rule
+	files, the built-in rule set is returned; it is compiled into the library and costs nothing
+*/
+ATGC_API atgc_rules* atgc_rules_compile(const char* const* paths, size_t numPaths, char* error, size_t errorLength);
+
+/*
+	like atgc_rules_compile, going through a cache file. when cachePath holds a rule set compiled
+	from the same rule files (same contents, same library version) it is mapped in as is instead of
+	being compiled. otherwise the rules are compiled and cachePath is rewritten; not being able to
+	write it isn't an error. cachePath may be NULL
+*/
+ATGC_API atgc_rules* atgc_rules_load(const char* const* paths, size_t numPaths, const char* cachePath, char* error, size_t errorLength);
+ATGC_API void atgc_rules_destroy(atgc_rules* rules);
+
+// how many rules, built-in ones included, are in the set
+ATGC_API size_t atgc_rules_count(const atgc_rules* rules);
+
+// returns NULL if the stream couldn't be allocated. the stream uses the built-in rules only
+ATGC_API atgc_stream* atgc_stream_create(void);
+
+// like atgc_stream_create, with a rule set from atgc_rules_compile. rules must outlive the stream
+ATGC_API atgc_stream* atgc_stream_create_with_rules(const atgc_rules* rules);
+
+ATGC_API void atgc_stream_destroy(atgc_stream* stream);
+
+/*
+	switches the stream to another rule set, starting with the next line classified. everything
+	else the stream knows (previous lines, app server, open multi-line blocks) is kept. the old
+	rule set can be destroyed as soon as this returns, provided no other call on the stream is
+	still running
+*/
+ATGC_API void atgc_stream_set_rules(atgc_stream* stream, const atgc_rules* rules);
+
+// forgets previous lines, the detected app server and any open multi-line block
+ATGC_API void atgc_stream_reset(atgc_stream* stream);
+
+// classifies a single line. the line must not contain the trailing newline. see ATGC_NO_MEMORY
+ATGC_API int atgc_classify_line(atgc_stream* stream, const char* line, size_t length);
+
+/*
+	classifies count lines in order, writing one line type per line into types. lines[i] is
+	lengths[i] bytes long and must not contain the trailing newline. returns count, or the number of
+	lines classified before the stream ran out of memory (see ATGC_NO_MEMORY); the lines after
+	them are given ATGC_OTHER_LINE
+*/
+ATGC_API size_t atgc_classify_batch(atgc_stream* stream, const char* const* lines, const size_t* lengths, size_t count, int* types);
+
+/*
+	like atgc_classify_batch, also writing into blocks the ATGC_BLOCK_ each line is an entry of,
+	ATGC_BLOCK_NONE for every other line, the header of the dump included
+*/
+ATGC_API size_t atgc_classify_batch_blocks(atgc_stream* stream, const char* const* lines, const size_t* lengths, size_t count, int* types, int* blocks);
+
+/*
+	classifies the newline-terminated lines at the start of buffer, at most maxLines of them.
+	a last line without a newline is left alone so the caller can complete it with its next
+	read. *consumed is set to the number of bytes covered by the classified lines (newlines
+	included). returns the number of lines written into types, which stops short if the stream runs
+	out of memory
+*/
+ATGC_API size_t atgc_classify_buffer(atgc_stream* stream, const char* buffer, size_t length, int* types, size_t maxLines, size_t* consumed);
+
+// one of the ATGC_SERVER_* constants
+ATGC_API int atgc_server_type(const atgc_stream* stream);
+
+// the ATGC_STATE_ bits of the multi-line output the stream is in, 0 when it's in none
+ATGC_API unsigned int atgc_stream_state(const atgc_stream* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_H
@@ -0,0 +1,657 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * ANSI escape sequence renderer for libatgcolorize. see atgcolorize_ansi.h
+ *
+ * a theme file is read into a style per line type: attributes, a foreground and a background
+ * color as the file gave them. compiling a style for a terminal turns it into a single SGR
+ * sequence, the attributes first, then the background and the foreground, with every color the
+ * terminal doesn't have replaced by the closest one it does: #rrggbb by the nearest entry of the
+ * xterm 256 color palette or of the 16 basic colors, a palette index by one of the 16
+ */
+
+#include "atgcolorize_ansi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <new>
+
+using namespace std;
+
+// room for a reset, four attributes and two truecolor colors, with plenty to spare
+static const size_t MAX_SEQUENCE_LENGTH = 96;
+
+// the built-in theme. the windows console doesn't understand these, see ATGLogColorizer_Windows.cpp
+static const char BUILTIN_THEME[] =
+	"info bold green\n"
+	"warning bold cyan\n"
+	"debug bold white\n"
+	"error bold red\n"
+	"other bold yellow\n"
+	"nucleus bold magenta on black\n" // purple
+	"highlight reverse\n";
+
+static const char RESET[] = "\033[0m";
+
+// around a highlighted range when it's only in reverse video. turning that off leaves the line color as it was
+static const char REVERSE_ON[] = "\033[7m";
+static const char REVERSE_OFF[] = "\033[27m";
+
+// what a theme line can name, in line type order with the highlight after them
+static const char* const THEME_TARGETS[] = { "info", "warning", "debug", "error", "other", "nucleus" };
+static const int HIGHLIGHT_TARGET = ATGC_NUM_LINE_TYPES;
+
+static const char* const COLOR_NAMES[] = { "black", "red", "green", "yellow", "blue", "magenta", "cyan", "white" };
+
+// the 16 basic colors the way xterm shows them, to find the closest one to a color
+static const unsigned char BASIC_COLORS[16][3] =
+{
+	{ 0, 0, 0 }, { 205, 0, 0 }, { 0, 205, 0 }, { 205, 205, 0 }, { 0, 0, 238 }, { 205, 0, 205 }, { 0, 205, 205 }, { 229, 229, 229 },
+	{ 127, 127, 127 }, { 255, 0, 0 }, { 0, 255, 0 }, { 255, 255, 0 }, { 92, 92, 255 }, { 255, 0, 255 }, { 0, 255, 255 }, { 255, 255, 255 }
+};
+
+// the levels of each component in the 6x6x6 color cube of the 256 color palette
+static const int CUBE_LEVELS[6] = { 0, 95, 135, 175, 215, 255 };
+
+static const int COLOR_DEFAULT = 0; // the terminal's own
+static const int COLOR_BASIC = 1; // one of the 16, in index
+static const int COLOR_PALETTE = 2; // one of the 256, in index
+static const int COLOR_RGB = 3;
+
+struct ThemeColor
+{
+	int kind;
+	int index;
+	int rgb[3];
+};
+
+// a theme line, before it's compiled for a terminal
+struct ThemeStyle
+{
+	bool bold;
+	bool italic;
+	bool underline;
+	bool reverse;
+	ThemeColor foreground;
+	ThemeColor background;
+};
+
+struct ThemeSequence
+{
+	char bytes[MAX_SEQUENCE_LENGTH + 1]; // '\0' terminated for atgc_theme_color
+	size_t length;
+};
+
+struct atgc_theme
+{
+	ThemeSequence colors[ATGC_NUM_LINE_TYPES]; // the reset for ATGC_BLANK_LINE
+	ThemeSequence highlightOn;
+	ThemeSequence highlightOff[ATGC_NUM_LINE_TYPES]; // back to the color of the line
+	size_t maxColorLength;
+	size_t maxHighlightOffLength;
+};
+
+static bool parseColor(const string& word, ThemeColor& color)
+{
+	color.kind = COLOR_DEFAULT;
+	if (word == "default")
+	{
+		return true;
+	}
+	string name = word;
+	color.index = 0;
+	if (name.compare(0, 7, "bright-") == 0)
+	{
+		name = name.substr(7);
+		color.index = 8;
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		if (name == COLOR_NAMES[i])
+		{
+			color.kind = COLOR_BASIC;
+			color.index += i;
+			return true;
+		}
+	}
+	if (word.size() == 7 && word[0] == '#' && word.find_first_not_of("0123456789abcdefABCDEF", 1) == string::npos)
+	{
+		unsigned long rgb = strtoul(word.c_str() + 1, NULL, 16);
+		color.kind = COLOR_RGB;
+		color.rgb[0] = (int) ((rgb >> 16) & 0xff);
+		color.rgb[1] = (int) ((rgb >> 8) & 0xff);
+		color.rgb[2] = (int) (rgb & 0xff);
+		return true;
+	}
+	if (!word.empty() && word.size() <= 3 && word.find_first_not_of("0123456789") == string::npos && atoi(word.c_str()) <= 255)
+	{
+		color.kind = COLOR_PALETTE;
+		color.index = atoi(word.c_str());
+		return true;
+	}
+	return false;
+}
+
+// one line of a theme: the target it's for and its style
+static bool parseThemeLine(const string& line, ThemeStyle* styles, string& error)
+{
+	istringstream words(line);
+	string word;
+	if (!(words >> word))
+	{
+		return true;
+	}
+	int target = -1;
+	for (int i = 0; i < ATGC_NUM_LINE_TYPES - 1; i++)
+	{
+		if (word == THEME_TARGETS[i])
+		{
+			target = i;
+		}
+	}
+	if (word == "highlight")
+	{
+		target = HIGHLIGHT_TARGET;
+	}
+	if (target < 0)
+	{
+		error = "unknown line type '" + word + "'";
+		return false;
+	}
+
+	ThemeStyle style;
+	memset(&style, 0, sizeof(style));
+	bool foreground = false;
+	while (words >> word)
+	{
+		if (word == "bold")
+		{
+			style.bold = true;
+		}
+		else if (word == "italic")
+		{
+			style.italic = true;
+		}
+		else if (word == "underline")
+		{
+			style.underline = true;
+		}
+		else if (word == "reverse")
+		{
+			style.reverse = true;
+		}
+		else if (word == "on")
+		{
+			if (!(words >> word) || !parseColor(word, style.background))
+			{
+				error = "a color has to follow 'on'";
+				return false;
+			}
+		}
+		else if (foreground)
+		{
+			error = "'" + word + "' is a second color, the background one goes after 'on'";
+			return false;
+		}
+		else if (!parseColor(word, style.foreground))
+		{
+			error = "unknown color '" + word + "'";
+			return false;
+		}
+		else
+		{
+			foreground = true;
+		}
+	}
+	styles[target] = style;
+	return true;
+}
+
+static bool parseTheme(istream& theme, const char* path, ThemeStyle* styles, string& error)
+{
+	string line;
+	int lineNumber = 0;
+	while (getline(theme, line))
+	{
+		lineNumber++;
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start == string::npos || line[start] == '#')
+		{
+			continue;
+		}
+		string lineError;
+		if (!parseThemeLine(line, styles, lineError))
+		{
+			ostringstream message;
+			message << path << ":" << lineNumber << ": " << lineError;
+			error = message.str();
+			return false;
+		}
+	}
+	return true;
+}
+
+static int distance(const int* rgb, int r, int g, int b)
+{
+	return (rgb[0] - r) * (rgb[0] - r) + (rgb[1] - g) * (rgb[1] - g) + (rgb[2] - b) * (rgb[2] - b);
+}
+
+static void paletteRgb(int index, int* rgb)
+{
+	if (index < 16)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			rgb[c] = BASIC_COLORS[index][c];
+		}
+	}
+	else if (index < 232)
+	{
+		rgb[0] = CUBE_LEVELS[(index - 16) / 36];
+		rgb[1] = CUBE_LEVELS[(index - 16) / 6 % 6];
+		rgb[2] = CUBE_LEVELS[(index - 16) % 6];
+	}
+	else
+	{
+		rgb[0] = rgb[1] = rgb[2] = 8 + (index - 232) * 10;
+	}
+}
+
+static int closestBasic(const int* rgb)
+{
+	int best = 0;
+	for (int i = 1; i < 16; i++)
+	{
+		if (distance(rgb, BASIC_COLORS[i][0], BASIC_COLORS[i][1], BASIC_COLORS[i][2]) < distance(rgb, BASIC_COLORS[best][0], BASIC_COLORS[best][1], BASIC_COLORS[best][2]))
+		{
+			best = i;
+		}
+	}
+	return best;
+}
+
+// the closest entry of the color cube or of the gray ramp
+static int closestPalette(const int* rgb)
+{
+	int cube[3];
+	int cubeIndex[3];
+	for (int c = 0; c < 3; c++)
+	{
+		cubeIndex[c] = (rgb[c] < 48 ? 0 : rgb[c] < 115 ? 1 : (rgb[c] - 35) / 40);
+		cube[c] = CUBE_LEVELS[cubeIndex[c]];
+	}
+	int gray = (rgb[0] + rgb[1] + rgb[2]) / 3;
+	int grayIndex = (gray < 8 ? 0 : gray > 238 ? 23 : (gray - 3) / 10);
+	int grayLevel = 8 + grayIndex * 10;
+	if (distance(rgb, grayLevel, grayLevel, grayLevel) < distance(rgb, cube[0], cube[1], cube[2]))
+	{
+		return 232 + grayIndex;
+	}
+	return 16 + cubeIndex[0] * 36 + cubeIndex[1] * 6 + cubeIndex[2];
+}
+
+// the SGR parameters of a color, as it's best shown with depth colors
+static void appendColor(string& codes, const ThemeColor& color, bool background, int depth)
+{
+	if (color.kind == COLOR_DEFAULT)
+	{
+		return;
+	}
+	int rgb[3];
+	int basic = color.index;
+	if (color.kind == COLOR_RGB)
+	{
+		memcpy(rgb, color.rgb, sizeof(rgb));
+	}
+	else if (color.kind == COLOR_PALETTE)
+	{
+		paletteRgb(color.index, rgb);
+	}
+
+	char code[32];
+	if (color.kind == COLOR_RGB && depth == ATGC_COLORS_TRUECOLOR)
+	{
+		snprintf(code, sizeof(code), "%d;2;%d;%d;%d", background ? 48 : 38, rgb[0], rgb[1], rgb[2]);
+	}
+	else if (color.kind != COLOR_BASIC && depth >= ATGC_COLORS_256)
+	{
+		snprintf(code, sizeof(code), "%d;5;%d", background ? 48 : 38, color.kind == COLOR_PALETTE ? color.index : closestPalette(rgb));
+	}
+	else
+	{
+		if ((color.kind == COLOR_PALETTE && color.index >= 16) || color.kind == COLOR_RGB)
+		{
+			basic = closestBasic(rgb);
+		}
+		snprintf(code, sizeof(code), "%d", basic < 8 ? (background ? 40 : 30) + basic : (background ? 100 : 90) + basic - 8);
+	}
+	if (!codes.empty())
+	{
+		codes += ';';
+	}
+	codes += code;
+}
+
+static string compileStyle(const ThemeStyle& style, int depth)
+{
+	string codes;
+	const char* attributes[] = { style.bold ? "1" : NULL, style.italic ? "3" : NULL, style.underline ? "4" : NULL, style.reverse ? "7" : NULL };
+	for (size_t i = 0; i < sizeof(attributes) / sizeof(attributes[0]); i++)
+	{
+		if (attributes[i] != NULL)
+		{
+			codes += (codes.empty() ? "" : ";");
+			codes += attributes[i];
+		}
+	}
+	appendColor(codes, style.background, true, depth);
+	appendColor(codes, style.foreground, false, depth);
+	return "\033[" + (codes.empty() ? string("0") : codes) + "m";
+}
+
+static void setSequence(ThemeSequence& sequence, const string& bytes)
+{
+	sequence.length = bytes.size();
+	memcpy(sequence.bytes, bytes.data(), bytes.size());
+	sequence.bytes[bytes.size()] = '\0';
+}
+
+static void compileTheme(atgc_theme* theme, const ThemeStyle* styles, int depth)
+{
+	const ThemeStyle& highlight = styles[HIGHLIGHT_TARGET];
+	bool reverseOnly = highlight.reverse && !highlight.bold && !highlight.italic && !highlight.underline
+		&& highlight.foreground.kind == COLOR_DEFAULT && highlight.background.kind == COLOR_DEFAULT;
+	bool colors = (depth != ATGC_COLORS_NONE);
+
+	setSequence(theme->colors[ATGC_BLANK_LINE], colors ? RESET : "");
+	setSequence(theme->highlightOn, !colors ? "" : reverseOnly ? REVERSE_ON : compileStyle(highlight, depth));
+	setSequence(theme->highlightOff[ATGC_BLANK_LINE], "");
+	theme->maxColorLength = 0;
+	theme->maxHighlightOffLength = 0;
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
+	{
+		if (type != ATGC_BLANK_LINE)
+		{
+			string color = (colors ? compileStyle(styles[type], depth) : "");
+			setSequence(theme->colors[type], color);
+			// anything but reverse video can only be undone by a reset, and the line color back on
+			setSequence(theme->highlightOff[type], !colors ? "" : reverseOnly ? REVERSE_OFF : RESET + color);
+		}
+		theme->maxColorLength = max(theme->maxColorLength, theme->colors[type].length);
+		theme->maxHighlightOffLength = max(theme->maxHighlightOffLength, theme->highlightOff[type].length);
+	}
+}
+
+static atgc_theme compileBuiltinTheme()
+{
+	ThemeStyle styles[ATGC_NUM_LINE_TYPES + 1];
+	istringstream builtin(BUILTIN_THEME);
+	string error;
+	parseTheme(builtin, "built-in", styles, error);
+	atgc_theme theme;
+	compileTheme(&theme, styles, ATGC_COLORS_16);
+	return theme;
+}
+
+static const atgc_theme* builtinTheme()
+{
+	static const atgc_theme builtin = compileBuiltinTheme();
+	return &builtin;
+}
+
+static void setError(const char* message, char* error, size_t errorLength)
+{
+	if (error != NULL && errorLength > 0)
+	{
+		strncpy(error, message, errorLength - 1);
+		error[errorLength - 1] = '\0';
+	}
+}
+
+static atgc_theme* loadTheme(const char* path, int depth, char* error, size_t errorLength)
+{
+	// what the file leaves out keeps its built-in style
+	ThemeStyle styles[ATGC_NUM_LINE_TYPES + 1];
+	istringstream builtin(BUILTIN_THEME);
+	string message;
+	parseTheme(builtin, "built-in", styles, message);
+	if (path != NULL)
+	{
+		ifstream file(path);
+		if (file.fail())
+		{
+			message = string(path) + ": couldn't be read";
+		}
+		if (file.fail() || !parseTheme(file, path, styles, message))
+		{
+			setError(message.c_str(), error, errorLength);
+			return NULL;
+		}
+	}
+	atgc_theme* theme = new (nothrow) atgc_theme();
+	if (theme != NULL)
+	{
+		try
+		{
+			compileTheme(theme, styles, depth);
+		}
+		catch (const bad_alloc&)
+		{
+			delete theme;
+			throw;
+		}
+	}
+	return theme;
+}
+
+atgc_theme* atgc_theme_load(const char* path, int depth, char* error, size_t errorLength)
+{
+	try
+	{
+		return loadTheme(path, depth, error, errorLength);
+	}
+	catch (const bad_alloc&)
+	{
+		setError("out of memory", error, errorLength);
+		return NULL;
+	}
+}
+
+void atgc_theme_destroy(atgc_theme* theme)
+{
+	delete theme;
+}
+
+int atgc_ansi_detect_colors(void)
+{
+	// see no-color.org, set to anything but an empty string
+	const char* noColor = getenv("NO_COLOR");
+	const char* term = getenv("TERM");
+	const char* colorTerm = getenv("COLORTERM");
+	if ((noColor != NULL && noColor[0] != '\0') || (term != NULL && strcmp(term, "dumb") == 0))
+	{
+		return ATGC_COLORS_NONE;
+	}
+	if (colorTerm != NULL && (strcmp(colorTerm, "truecolor") == 0 || strcmp(colorTerm, "24bit") == 0))
+	{
+		return ATGC_COLORS_TRUECOLOR;
+	}
+	if (term != NULL && strstr(term, "256color") != NULL)
+	{
+		return ATGC_COLORS_256;
+	}
+	return ATGC_COLORS_16;
+}
+
+const char* atgc_theme_color(const atgc_theme* theme, int lineType)
+{
+	if (theme == NULL)
+	{
+		theme = builtinTheme();
+	}
+	return (lineType >= 0 && lineType < ATGC_NUM_LINE_TYPES ? theme->colors[lineType].bytes : theme->colors[ATGC_BLANK_LINE].bytes);
+}
+
+const char* atgc_ansi_color(int lineType)
+{
+	return atgc_theme_color(NULL, lineType);
+}
+
+const char* atgc_theme_reset(const atgc_theme* theme)
+{
+	return atgc_theme_color(theme, ATGC_BLANK_LINE);
+}
+
+const char* atgc_ansi_reset(void)
+{
+	return atgc_theme_reset(NULL);
+}
+
+size_t atgc_theme_max_rendered_size(const atgc_theme* theme, size_t length)
+{
+	if (theme == NULL)
+	{
+		theme = builtinTheme();
+	}
+	return theme->maxColorLength + length + 1 + theme->colors[ATGC_BLANK_LINE].length;
+}
+
+size_t atgc_ansi_max_rendered_size(size_t length)
+{
+	return atgc_theme_max_rendered_size(NULL, length);
+}
+
+size_t atgc_theme_render_batch(const atgc_theme* theme, const char* const* lines, const size_t* lengths, const int* types, size_t count, char* out, size_t capacity, size_t* rendered)
+{
+	if (theme == NULL)
+	{
+		theme = builtinTheme();
+	}
+	const ThemeSequence& reset = theme->colors[ATGC_BLANK_LINE];
+	size_t used = 0;
+	size_t i = 0;
+	for (; i < count; i++)
+	{
+		if (types[i] == ATGC_BLANK_LINE)
+		{
+			if (used + 1 > capacity)
+			{
+				break;
+			}
+			out[used++] = '\n';
+			continue;
+		}
+
+		const ThemeSequence& color = theme->colors[types[i]];
+		if (used + color.length + lengths[i] + 1 + reset.length > capacity)
+		{
+			break;
+		}
+		memcpy(out + used, color.bytes, color.length);
+		used += color.length;
+		memcpy(out + used, lines[i], lengths[i]);
+		used += lengths[i];
+		out[used++] = '\n';
+
+		/*
+		 * this is important - after each line, reset the output color. why?
+		 * when you pipe input through this application (eg. startWebLogic.cmd | ATGLogColorizer.exe),
+		 * not all output is piped through. some startup scripts disobey the pipe and write directly
+		 * to the console. that means that this application can't color the output properly because
+		 * it doesn't know what it is!
+		 */
+		memcpy(out + used, reset.bytes, reset.length);
+		used += reset.length;
+	}
+	if (rendered != NULL)
+	{
+		*rendered = i;
+	}
+	return used;
+}
+
+size_t atgc_ansi_render_batch(const char* const* lines, const size_t* lengths, const int* types, size_t count, char* out, size_t capacity, size_t* rendered)
+{
+	return atgc_theme_render_batch(NULL, lines, lengths, types, count, out, capacity, rendered);
+}
+
+size_t atgc_theme_max_highlighted_size(const atgc_theme* theme, size_t length, size_t numHighlights)
+{
+	if (theme == NULL)
+	{
+		theme = builtinTheme();
+	}
+	return atgc_theme_max_rendered_size(theme, length) + numHighlights * (theme->highlightOn.length + theme->maxHighlightOffLength);
+}
+
+size_t atgc_ansi_max_highlighted_size(size_t length, size_t numHighlights)
+{
+	return atgc_theme_max_highlighted_size(NULL, length, numHighlights);
+}
+
+size_t atgc_theme_render_highlighted(const atgc_theme* theme, const char* line, size_t length, int lineType, const size_t* offsets, const size_t* lengths, size_t numHighlights, char* out, size_t capacity)
+{
+	if (theme == NULL)
+	{
+		theme = builtinTheme();
+	}
+	if (numHighlights == 0 || lineType == ATGC_BLANK_LINE)
+	{
+		return atgc_theme_render_batch(theme, &line, &length, &lineType, 1, out, capacity, NULL);
+	}
+	if (atgc_theme_max_highlighted_size(theme, length, numHighlights) > capacity)
+	{
+		return 0;
+	}
+
+	const ThemeSequence& color = theme->colors[lineType];
+	const ThemeSequence& on = theme->highlightOn;
+	const ThemeSequence& off = theme->highlightOff[lineType];
+	const ThemeSequence& reset = theme->colors[ATGC_BLANK_LINE];
+	memcpy(out, color.bytes, color.length);
+	size_t used = color.length;
+	size_t copied = 0;
+	for (size_t i = 0; i < numHighlights; i++)
+	{
+		memcpy(out + used, line + copied, offsets[i] - copied);
+		used += offsets[i] - copied;
+		memcpy(out + used, on.bytes, on.length);
+		used += on.length;
+		memcpy(out + used, line + offsets[i], lengths[i]);
+		used += lengths[i];
+		memcpy(out + used, off.bytes, off.length);
+		used += off.length;
+		copied = offsets[i] + lengths[i];
+	}
+	memcpy(out + used, line + copied, length - copied);
+	used += length - copied;
+	out[used++] = '\n';
+	memcpy(out + used, reset.bytes, reset.length);
+	used += reset.length;
+	return used;
+}
+
+size_t atgc_ansi_render_highlighted(const char* line, size_t length, int lineType, const size_t* offsets, const size_t* lengths, size_t numHighlights, char* out, size_t capacity)
+{
+	return atgc_theme_render_highlighted(NULL, line, length, lineType, offsets, lengths, numHighlights, out, capacity);
+}
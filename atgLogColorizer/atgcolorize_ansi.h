@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * optional ANSI renderer for libatgcolorize. takes lines along with the types returned by
+ * the classifier and writes them, escape sequences included, into a caller-provided buffer
+ * so a whole batch goes out with a single write. callers that only need line types don't
+ * have to link this in.
+ *
+ * the colors come from a theme, compiled once into the escape sequences for the terminal so each
+ * one is a single memcpy while rendering. a theme file has one line per line type, a line
+ * starting with # is a comment:
+ *
+ *		<type> [bold] [italic] [underline] [reverse] [<color>] [on <color>]
+ *
+ *		error bold red
+ *		warning #b58900
+ *		debug 245
+ *		nucleus magenta on black
+ *		highlight reverse
+ *
+ * <type> is info, warning, debug, error, nucleus, other or highlight, the text --match found.
+ * <color> is black, red, green, yellow, blue, magenta, cyan or white, bright- in front of any of
+ * those, default for the terminal's own color, a palette index from 0 to 255 or #rrggbb. a type
+ * the file leaves out keeps its built-in color. on a terminal with fewer colors than the theme
+ * asks for, each color becomes the closest one it has
+ */
+
+#ifndef ATGCOLORIZE_ANSI_H
+#define ATGCOLORIZE_ANSI_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// how many colors a terminal shows, which is what a theme is compiled for
+#define ATGC_COLORS_NONE 0 // no escape sequences at all
+#define ATGC_COLORS_16 1
+#define ATGC_COLORS_256 2
+#define ATGC_COLORS_TRUECOLOR 3
+
+typedef struct atgc_theme atgc_theme;
+
+/*
+	compiles the theme file at path for a terminal showing depth colors, one of the ATGC_COLORS_
+	constants. path NULL gives the built-in colors. returns NULL and writes a message into error
+	when the file can't be read or has a mistake in it, or memory runs out
+*/
+ATGC_API atgc_theme* atgc_theme_load(const char* path, int depth, char* error, size_t errorLength);
+ATGC_API void atgc_theme_destroy(atgc_theme* theme);
+
+/*
+	the colors the terminal shows, going by the environment: none with NO_COLOR set or TERM=dumb,
+	truecolor when COLORTERM says so, 256 for a TERM with 256color in it and 16 otherwise
+*/
+ATGC_API int atgc_ansi_detect_colors(void);
+
+/*
+	the functions below take the theme to render with. NULL is the built-in colors, which the
+	atgc_ansi_ functions without a theme always use
+*/
+
+// the escape sequence (ESC included) used for a line type, or the reset sequence for ATGC_BLANK_LINE
+ATGC_API const char* atgc_ansi_color(int lineType);
+ATGC_API const char* atgc_theme_color(const atgc_theme* theme, int lineType);
+
+// resets the terminal to its original colors
+ATGC_API const char* atgc_ansi_reset(void);
+ATGC_API const char* atgc_theme_reset(const atgc_theme* theme);
+
+/*
+	renders lines[0..count) into out. each line is written as its color, the line, a newline
+	and a color reset; blank lines are written as a bare newline. rendering stops before the
+	first line that doesn't fit in capacity. *rendered is set to the number of lines written
+	and the number of bytes written is returned
+*/
+ATGC_API size_t atgc_ansi_render_batch(const char* const* lines, const size_t* lengths, const int* types, size_t count, char* out, size_t capacity, size_t* rendered);
+ATGC_API size_t atgc_theme_render_batch(const atgc_theme* theme, const char* const* lines, const size_t* lengths, const int* types, size_t count, char* out, size_t capacity, size_t* rendered);
+
+// the most bytes atgc_ansi_render_batch can need for a single line of the given length
+ATGC_API size_t atgc_ansi_max_rendered_size(size_t length);
+ATGC_API size_t atgc_theme_max_rendered_size(const atgc_theme* theme, size_t length);
+
+/*
+	renders a single line the way atgc_ansi_render_batch does, with the numHighlights ranges
+	starting at offsets[i], lengths[i] bytes long, shown in reverse video. the ranges have to be
+	in order and not overlap. returns the number of bytes written, 0 if the line doesn't fit
+*/
+ATGC_API size_t atgc_ansi_render_highlighted(const char* line, size_t length, int lineType, const size_t* offsets, const size_t* lengths, size_t numHighlights, char* out, size_t capacity);
+ATGC_API size_t atgc_theme_render_highlighted(const atgc_theme* theme, const char* line, size_t length, int lineType, const size_t* offsets, const size_t* lengths, size_t numHighlights, char* out, size_t capacity);
+
+// the most bytes atgc_ansi_render_highlighted can need
+ATGC_API size_t atgc_ansi_max_highlighted_size(size_t length, size_t numHighlights);
+ATGC_API size_t atgc_theme_max_highlighted_size(const atgc_theme* theme, size_t length, size_t numHighlights);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_ANSI_H
@@ -0,0 +1,302 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * the built-in rule set, compiled by the compiler. the SOP messages never change at runtime, so
+ * instead of running compileRules on them at startup the constexpr functions below build the
+ * automaton, literal and rule tables while atgcolorize.cpp is being compiled and the tables end
+ * up in the read-only data of the binary.
+ *
+ * the steps are the ones compileRules (atgcolorize_rules.cpp) goes through for the output of
+ * builtinDefinitions: literals numbered in the order they first show up, rules keyed on their
+ * longest literal, states numbered in the order the literals are added, edges sorted by byte and
+ * fail links worked out breadth first. the tables come out the same, so a rule cache or a rule
+ * set with user rules in it behaves the same as the built-in one on its own
+ *
+ * needs C++14 or later
+ */
+
+#ifndef ATGCOLORIZE_BUILTIN_H
+#define ATGCOLORIZE_BUILTIN_H
+
+#include "atgcolorize_internal.h"
+
+// number of bytes in a literal, without the terminating '\0'
+constexpr uint32_t builtinLength(const char* text)
+{
+	uint32_t length = 0;
+	while (text[length] != '\0')
+	{
+		length++;
+	}
+	return length;
+}
+
+// a built-in rule has one term, two when it also has to contain alsoContains
+constexpr uint32_t builtinTermCount(const BuiltinRule* rules, size_t numRules)
+{
+	uint32_t count = 0;
+	for (size_t r = 0; r < numRules; r++)
+	{
+		count += (rules[r].alsoContains != nullptr ? 2 : 1);
+	}
+	return count;
+}
+
+constexpr const char* builtinTermText(const BuiltinRule& rule, uint32_t term)
+{
+	return (term == 0 ? rule.text : rule.alsoContains);
+}
+
+// every byte of every term, an upper bound on the number of states past the start state
+constexpr uint32_t builtinTermBytes(const BuiltinRule* rules, size_t numRules)
+{
+	uint32_t bytes = 0;
+	for (size_t r = 0; r < numRules; r++)
+	{
+		bytes += builtinLength(rules[r].text);
+		if (rules[r].alsoContains != nullptr)
+		{
+			bytes += builtinLength(rules[r].alsoContains);
+		}
+	}
+	return bytes;
+}
+
+/*
+	the trie, fail links and literal numbering, in a form that's easy to build one byte at a time.
+	children of a state are a list sorted by byte; 0 ends a list since the start state is never a
+	child. MaxStates only has to be big enough, the real number of states is numStates
+*/
+template <uint32_t MaxStates, uint32_t NumTerms>
+struct BuiltinTrie
+{
+	uint32_t firstChild[MaxStates];
+	uint32_t nextSibling[MaxStates];
+	uint8_t byte[MaxStates];
+	uint32_t stateLiteral[MaxStates];
+	uint32_t fail[MaxStates];
+	uint32_t outputLink[MaxStates];
+	uint32_t numStates;
+
+	uint32_t termLiteral[NumTerms];
+	uint32_t literalState[NumTerms]; // where each literal ends, to read its text back off the terms
+	const char* literalText[NumTerms];
+	uint32_t numLiterals;
+	uint32_t poolSize;
+};
+
+template <uint32_t MaxStates, uint32_t NumTerms>
+constexpr uint32_t builtinChild(const BuiltinTrie<MaxStates, NumTerms>& trie, uint32_t state, uint8_t c)
+{
+	for (uint32_t child = trie.firstChild[state]; child != 0 && trie.byte[child] <= c; child = trie.nextSibling[child])
+	{
+		if (trie.byte[child] == c)
+		{
+			return child;
+		}
+	}
+	return 0;
+}
+
+// the child of state on c, added in its place in the sorted list when there isn't one yet
+template <uint32_t MaxStates, uint32_t NumTerms>
+constexpr uint32_t builtinAddChild(BuiltinTrie<MaxStates, NumTerms>& trie, uint32_t state, uint8_t c)
+{
+	uint32_t child = builtinChild(trie, state, c);
+	if (child != 0)
+	{
+		return child;
+	}
+	child = trie.numStates++;
+	trie.byte[child] = c;
+	trie.stateLiteral[child] = NO_LITERAL;
+	if (trie.firstChild[state] == 0 || trie.byte[trie.firstChild[state]] > c)
+	{
+		trie.nextSibling[child] = trie.firstChild[state];
+		trie.firstChild[state] = child;
+		return child;
+	}
+	uint32_t previous = trie.firstChild[state];
+	while (trie.nextSibling[previous] != 0 && trie.byte[trie.nextSibling[previous]] < c)
+	{
+		previous = trie.nextSibling[previous];
+	}
+	trie.nextSibling[child] = trie.nextSibling[previous];
+	trie.nextSibling[previous] = child;
+	return child;
+}
+
+template <uint32_t MaxStates, uint32_t NumTerms>
+constexpr BuiltinTrie<MaxStates, NumTerms> buildBuiltinTrie(const BuiltinRule* rules, size_t numRules)
+{
+	BuiltinTrie<MaxStates, NumTerms> trie {};
+	trie.numStates = 1;
+	trie.stateLiteral[0] = NO_LITERAL;
+
+	// a literal seen for the first time gets the next id, in term order
+	uint32_t term = 0;
+	for (size_t r = 0; r < numRules; r++)
+	{
+		for (uint32_t t = 0; t < (rules[r].alsoContains != nullptr ? 2u : 1u); t++)
+		{
+			const char* text = builtinTermText(rules[r], t);
+			uint32_t state = 0;
+			for (uint32_t i = 0; text[i] != '\0'; i++)
+			{
+				state = builtinAddChild(trie, state, (uint8_t) text[i]);
+			}
+			if (trie.stateLiteral[state] == NO_LITERAL)
+			{
+				trie.stateLiteral[state] = trie.numLiterals;
+				trie.literalState[trie.numLiterals] = state;
+				trie.literalText[trie.numLiterals] = text;
+				trie.numLiterals++;
+				trie.poolSize += builtinLength(text) + 1;
+			}
+			trie.termLiteral[term++] = trie.stateLiteral[state];
+		}
+	}
+
+	// fail and output links, breadth first
+	uint32_t queue[MaxStates] {};
+	uint32_t queueEnd = 0;
+	for (uint32_t child = trie.firstChild[0]; child != 0; child = trie.nextSibling[child])
+	{
+		queue[queueEnd++] = child;
+	}
+	for (uint32_t q = 0; q < queueEnd; q++)
+	{
+		uint32_t state = queue[q];
+		for (uint32_t child = trie.firstChild[state]; child != 0; child = trie.nextSibling[child])
+		{
+			uint32_t target = trie.fail[state];
+			while (true)
+			{
+				uint32_t next = builtinChild(trie, target, trie.byte[child]);
+				if (next != 0)
+				{
+					target = next;
+					break;
+				}
+				if (target == 0)
+				{
+					break;
+				}
+				target = trie.fail[target];
+			}
+			trie.fail[child] = target;
+			trie.outputLink[child] = (trie.stateLiteral[target] != NO_LITERAL ? target : trie.outputLink[target]);
+			queue[queueEnd++] = child;
+		}
+	}
+	return trie;
+}
+
+// the flat tables RuleTables points at, sized exactly
+template <uint32_t NumStates, uint32_t NumLiterals, uint32_t NumRules, uint32_t NumTerms, uint32_t PoolSize>
+struct BuiltinTables
+{
+	CompiledState states[NumStates + 1];
+	uint32_t edges[NumStates - 1]; // every state but the start state is the target of exactly one edge
+	uint32_t rootNext[256];
+	CompiledLiteral literals[NumLiterals + 1];
+	uint32_t literalRules[NumRules];
+	CompiledRule rules[NumRules];
+	CompiledTerm terms[NumTerms];
+	char textPool[PoolSize];
+};
+
+template <uint32_t NumStates, uint32_t NumLiterals, uint32_t NumRules, uint32_t NumTerms, uint32_t PoolSize, class Trie>
+constexpr BuiltinTables<NumStates, NumLiterals, NumRules, NumTerms, PoolSize> buildBuiltinTables(const BuiltinRule* rules, const Trie& trie)
+{
+	BuiltinTables<NumStates, NumLiterals, NumRules, NumTerms, PoolSize> tables {};
+
+	// rules and their terms, each rule keyed on its longest literal (the first one on a tie)
+	uint32_t keyLiteral[NumRules] {};
+	uint32_t rulesPerLiteral[NumLiterals + 1] {};
+	uint32_t term = 0;
+	for (uint32_t r = 0; r < NumRules; r++)
+	{
+		CompiledRule& rule = tables.rules[r];
+		rule.lineType = ATGC_ERROR_LINE;
+		rule.previousLineType = ANY_LINE_TYPE;
+		rule.priority = 0;
+		rule.termBegin = term;
+		keyLiteral[r] = NO_LITERAL;
+		for (uint32_t t = 0; t < (rules[r].alsoContains != nullptr ? 2u : 1u); t++)
+		{
+			CompiledTerm& compiled = tables.terms[term];
+			compiled.literal = trie.termLiteral[term];
+			compiled.regex = NO_REGEX;
+			compiled.match = (t == 0 ? rules[r].match : MATCH_CONTAINS);
+			if (keyLiteral[r] == NO_LITERAL || builtinLength(builtinTermText(rules[r], t)) > builtinLength(trie.literalText[keyLiteral[r]]))
+			{
+				keyLiteral[r] = compiled.literal;
+			}
+			term++;
+		}
+		rule.termEnd = term;
+		rulesPerLiteral[keyLiteral[r]]++;
+	}
+
+	// literals, their text and the rules keyed on each of them, in rule order
+	uint32_t ruleBegin = 0;
+	uint32_t textOffset = 0;
+	for (uint32_t l = 0; l < NumLiterals; l++)
+	{
+		CompiledLiteral& literal = tables.literals[l];
+		literal.length = builtinLength(trie.literalText[l]);
+		literal.textOffset = textOffset;
+		literal.ruleBegin = ruleBegin;
+		for (uint32_t i = 0; i <= literal.length; i++)
+		{
+			tables.textPool[textOffset++] = trie.literalText[l][i];
+		}
+		ruleBegin += rulesPerLiteral[l];
+		rulesPerLiteral[l] = literal.ruleBegin; // from here on, where the next rule of l goes
+	}
+	tables.literals[NumLiterals].ruleBegin = ruleBegin;
+	for (uint32_t r = 0; r < NumRules; r++)
+	{
+		tables.literalRules[rulesPerLiteral[keyLiteral[r]]++] = r;
+	}
+
+	// the automaton
+	for (uint32_t child = trie.firstChild[0]; child != 0; child = trie.nextSibling[child])
+	{
+		tables.rootNext[trie.byte[child]] = child;
+	}
+	uint32_t edge = 0;
+	for (uint32_t s = 0; s < NumStates; s++)
+	{
+		CompiledState& state = tables.states[s];
+		state.edgeBegin = edge;
+		state.fail = trie.fail[s];
+		state.literal = trie.stateLiteral[s];
+		state.outputLink = trie.outputLink[s];
+		for (uint32_t child = trie.firstChild[s]; child != 0; child = trie.nextSibling[child])
+		{
+			tables.edges[edge++] = (child << 8) | trie.byte[child];
+		}
+	}
+	tables.states[NumStates].edgeBegin = edge;
+	tables.states[NumStates].literal = NO_LITERAL;
+	return tables;
+}
+
+#endif // ATGCOLORIZE_BUILTIN_H
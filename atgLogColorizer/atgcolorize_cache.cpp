@@ -0,0 +1,421 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * the rule cache. compiling a few thousand rules into the automaton takes a while, so a
+ * compiled rule set can be written to a file and mapped back in by the next run instead of
+ * being compiled again. the file is the tables of the rule set as they are in memory, one
+ * after the other, behind a header:
+ *
+ *		header		magic, format version, byte order, source hash, body checksum, table sizes
+ *		states		CompiledState, sentinel included
+ *		edges		uint32_t
+ *		rootNext	uint32_t, 256 of them
+ *		literals	CompiledLiteral, sentinel included
+ *		literalRules	uint32_t
+ *		rules		CompiledRule
+ *		terms		CompiledTerm
+ *		alwaysCheckedRules	uint32_t
+ *		regexSourceOffsets	uint32_t
+ *		textPool	char
+ *
+ *	every table starts on an 8 byte boundary and only holds offsets and indexes, never pointers,
+ *	so the scanner reads straight out of the mapping wherever it ends up. the source hash covers
+ *	the library version, the built-in rules and the contents of the rule files: when any of them
+ *	changes, or the file was written by another version or on a machine with another byte order,
+ *	the cache is ignored and rewritten
+ */
+
+#include "atgcolorize_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#ifdef _WIN32
+	#include <process.h>
+	#define getpid _getpid
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+const char CACHE_MAGIC[8] = { 'A', 'T', 'G', 'C', 'R', 'U', 'L', 'E' };
+
+// bump whenever the layout of the file or of one of the compiled structs changes
+const uint32_t CACHE_FORMAT_VERSION = 1;
+
+// reads back as something else on a machine with the other byte order
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+const size_t SECTION_ALIGNMENT = 8;
+
+
+struct CacheHeader
+{
+	char magic[8];
+	uint32_t formatVersion;
+	uint32_t byteOrderMark;
+	uint64_t sourceHash;
+	uint64_t bodyChecksum; // of everything after the header
+
+	uint32_t numStates;
+	uint32_t numEdges;
+	uint32_t numLiterals;
+	uint32_t numLiteralRules;
+	uint32_t numRules;
+	uint32_t numTerms;
+	uint32_t numAlwaysCheckedRules;
+	uint32_t textPoolSize;
+	uint32_t numRegexes;
+	uint32_t numBuiltinRules;
+	uint32_t hasPositiveRules;
+	uint32_t unused;
+};
+
+enum CacheSection
+{
+	STATES_SECTION,
+	EDGES_SECTION,
+	ROOT_NEXT_SECTION,
+	LITERALS_SECTION,
+	LITERAL_RULES_SECTION,
+	RULES_SECTION,
+	TERMS_SECTION,
+	ALWAYS_CHECKED_SECTION,
+	REGEX_SOURCES_SECTION,
+	TEXT_POOL_SECTION,
+	NUM_SECTIONS
+};
+
+static uint64_t hashString(uint64_t hash, const char* text)
+{
+	// the terminating '\0' goes in too, so "ab" + "c" and "a" + "bc" hash differently
+	return (text == NULL ? hashBytes(hash, "", 1) : hashBytes(hash, text, strlen(text) + 1));
+}
+
+static size_t align(size_t offset)
+{
+	return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// where each table starts in the file. returns the size of the whole file
+static size_t layout(const CacheHeader& header, size_t offsets[NUM_SECTIONS])
+{
+	size_t sizes[NUM_SECTIONS];
+	sizes[STATES_SECTION] = ((size_t) header.numStates + 1) * sizeof(CompiledState);
+	sizes[EDGES_SECTION] = (size_t) header.numEdges * sizeof(uint32_t);
+	sizes[ROOT_NEXT_SECTION] = 256 * sizeof(uint32_t);
+	sizes[LITERALS_SECTION] = ((size_t) header.numLiterals + 1) * sizeof(CompiledLiteral);
+	sizes[LITERAL_RULES_SECTION] = (size_t) header.numLiteralRules * sizeof(uint32_t);
+	sizes[RULES_SECTION] = (size_t) header.numRules * sizeof(CompiledRule);
+	sizes[TERMS_SECTION] = (size_t) header.numTerms * sizeof(CompiledTerm);
+	sizes[ALWAYS_CHECKED_SECTION] = (size_t) header.numAlwaysCheckedRules * sizeof(uint32_t);
+	sizes[REGEX_SOURCES_SECTION] = (size_t) header.numRegexes * sizeof(uint32_t);
+	sizes[TEXT_POOL_SECTION] = header.textPoolSize;
+
+	size_t offset = align(sizeof(CacheHeader));
+	for (int s = 0; s < NUM_SECTIONS; s++)
+	{
+		offsets[s] = offset;
+		offset = align(offset + sizes[s]);
+	}
+	return offset;
+}
+
+uint64_t ruleSourceHash(const char* const* paths, size_t numPaths, bool& readable)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	hash = hashString(hash, ATGC_VERSION);
+	hash = hashBytes(hash, &CACHE_FORMAT_VERSION, sizeof(CACHE_FORMAT_VERSION));
+	for (size_t r = 0; r < NUM_SOP_ERROR_RULES; r++)
+	{
+		hash = hashBytes(hash, &SOP_ERROR_RULES[r].match, sizeof(SOP_ERROR_RULES[r].match));
+		hash = hashString(hash, SOP_ERROR_RULES[r].text);
+		hash = hashString(hash, SOP_ERROR_RULES[r].alsoContains);
+	}
+
+	readable = true;
+	hash = hashBytes(hash, &numPaths, sizeof(numPaths));
+	for (size_t i = 0; i < numPaths && readable; i++)
+	{
+		FILE* file = fopen(paths[i], "rb");
+		if (file == NULL)
+		{
+			readable = false;
+			break;
+		}
+		char buffer[16 * 1024];
+		size_t bytesRead;
+		uint64_t length = 0;
+		while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			hash = hashBytes(hash, buffer, bytesRead);
+			length += bytesRead;
+		}
+		readable = !ferror(file);
+		fclose(file);
+		hash = hashBytes(hash, &length, sizeof(length));
+	}
+	return hash;
+}
+
+bool saveRuleCache(const atgc_rules* rules, const char* cachePath, uint64_t sourceHash)
+{
+	const RuleTables& tables = rules->tables;
+
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.formatVersion = CACHE_FORMAT_VERSION;
+	header.byteOrderMark = BYTE_ORDER_MARK;
+	header.sourceHash = sourceHash;
+	header.numStates = tables.numStates;
+	header.numEdges = tables.numEdges;
+	header.numLiterals = tables.numLiterals;
+	header.numLiteralRules = tables.numLiteralRules;
+	header.numRules = tables.numRules;
+	header.numTerms = tables.numTerms;
+	header.numAlwaysCheckedRules = tables.numAlwaysCheckedRules;
+	header.textPoolSize = tables.textPoolSize;
+	header.numRegexes = tables.numRegexes;
+	header.numBuiltinRules = rules->numBuiltinRules;
+	header.hasPositiveRules = rules->hasPositiveRules;
+
+	size_t offsets[NUM_SECTIONS];
+	vector<char> image(layout(header, offsets), 0);
+	memcpy(&image[offsets[STATES_SECTION]], tables.states, ((size_t) tables.numStates + 1) * sizeof(CompiledState));
+	memcpy(&image[offsets[EDGES_SECTION]], tables.edges, (size_t) tables.numEdges * sizeof(uint32_t));
+	memcpy(&image[offsets[ROOT_NEXT_SECTION]], tables.rootNext, 256 * sizeof(uint32_t));
+	memcpy(&image[offsets[LITERALS_SECTION]], tables.literals, ((size_t) tables.numLiterals + 1) * sizeof(CompiledLiteral));
+	memcpy(&image[offsets[LITERAL_RULES_SECTION]], tables.literalRules, (size_t) tables.numLiteralRules * sizeof(uint32_t));
+	memcpy(&image[offsets[RULES_SECTION]], tables.rules, (size_t) tables.numRules * sizeof(CompiledRule));
+	memcpy(&image[offsets[TERMS_SECTION]], tables.terms, (size_t) tables.numTerms * sizeof(CompiledTerm));
+	memcpy(&image[offsets[ALWAYS_CHECKED_SECTION]], tables.alwaysCheckedRules, (size_t) tables.numAlwaysCheckedRules * sizeof(uint32_t));
+	memcpy(&image[offsets[REGEX_SOURCES_SECTION]], tables.regexSourceOffsets, (size_t) tables.numRegexes * sizeof(uint32_t));
+	memcpy(&image[offsets[TEXT_POOL_SECTION]], tables.textPool, tables.textPoolSize);
+
+	header.bodyChecksum = hashBytes(FNV_OFFSET_BASIS, &image[sizeof(header)], image.size() - sizeof(header));
+	memcpy(&image[0], &header, sizeof(header));
+
+	// written next to the cache and renamed over it, so a reader never maps half a file
+	char temporaryPath[4096];
+	snprintf(temporaryPath, sizeof(temporaryPath), "%s.%d.tmp", cachePath, (int) getpid());
+	FILE* file = fopen(temporaryPath, "wb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	bool written = (fwrite(&image[0], 1, image.size(), file) == image.size());
+	written = (fclose(file) == 0) && written;
+#ifdef _WIN32
+	remove(cachePath);
+#endif
+	if (!written || rename(temporaryPath, cachePath) != 0)
+	{
+		remove(temporaryPath);
+		return false;
+	}
+	return true;
+}
+
+// maps the whole file read-only. on windows the file is simply read into memory
+static void* mapFile(const char* path, size_t& length)
+{
+#ifdef _WIN32
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	void* data = (size > 0 ? malloc(size) : NULL);
+	if (data != NULL && fread(data, 1, size, file) != (size_t) size)
+	{
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	length = (size_t) size;
+	return data;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	struct stat status;
+	void* data = NULL;
+	if (fstat(fd, &status) == 0 && status.st_size > 0)
+	{
+		length = (size_t) status.st_size;
+		data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		data = (data == MAP_FAILED ? NULL : data);
+	}
+	close(fd);
+	return data;
+#endif
+}
+
+static void unmapFile(void* data, size_t length)
+{
+#ifdef _WIN32
+	free(data);
+#else
+	munmap(data, length);
+#endif
+}
+
+void unmapRuleCache(atgc_rules* rules)
+{
+	unmapFile(rules->mapping, rules->mappingLength);
+	rules->mapping = NULL;
+}
+
+atgc_rules* loadRuleCache(const char* cachePath, uint64_t sourceHash)
+{
+	size_t length = 0;
+	char* data = (char*) mapFile(cachePath, length);
+	if (data == NULL)
+	{
+		return NULL;
+	}
+
+	CacheHeader header;
+	size_t offsets[NUM_SECTIONS];
+	bool valid = (length >= sizeof(header));
+	if (valid)
+	{
+		memcpy(&header, data, sizeof(header));
+		valid = memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0
+			&& header.formatVersion == CACHE_FORMAT_VERSION
+			&& header.byteOrderMark == BYTE_ORDER_MARK
+			&& header.sourceHash == sourceHash
+			&& layout(header, offsets) == length
+			&& header.bodyChecksum == hashBytes(FNV_OFFSET_BASIS, data + sizeof(header), length - sizeof(header));
+	}
+	if (!valid)
+	{
+		unmapFile(data, length);
+		return NULL;
+	}
+
+	// the storage only ends up holding the regexes
+	atgc_rules* rules = NULL;
+	try
+	{
+		rules = createRules();
+	}
+	catch (const bad_alloc&)
+	{
+		unmapFile(data, length);
+		throw;
+	}
+	rules->mapping = data;
+	rules->mappingLength = length;
+	rules->numBuiltinRules = header.numBuiltinRules;
+	rules->hasPositiveRules = (header.hasPositiveRules != 0);
+
+	RuleTables& tables = rules->tables;
+	tables.states = (const CompiledState*) (data + offsets[STATES_SECTION]);
+	tables.edges = (const uint32_t*) (data + offsets[EDGES_SECTION]);
+	tables.rootNext = (const uint32_t*) (data + offsets[ROOT_NEXT_SECTION]);
+	tables.literals = (const CompiledLiteral*) (data + offsets[LITERALS_SECTION]);
+	tables.literalRules = (const uint32_t*) (data + offsets[LITERAL_RULES_SECTION]);
+	tables.rules = (const CompiledRule*) (data + offsets[RULES_SECTION]);
+	tables.terms = (const CompiledTerm*) (data + offsets[TERMS_SECTION]);
+	tables.alwaysCheckedRules = (const uint32_t*) (data + offsets[ALWAYS_CHECKED_SECTION]);
+	tables.regexSourceOffsets = (const uint32_t*) (data + offsets[REGEX_SOURCES_SECTION]);
+	tables.textPool = data + offsets[TEXT_POOL_SECTION];
+	tables.numStates = header.numStates;
+	tables.numEdges = header.numEdges;
+	tables.numLiterals = header.numLiterals;
+	tables.numLiteralRules = header.numLiteralRules;
+	tables.numRules = header.numRules;
+	tables.numTerms = header.numTerms;
+	tables.numAlwaysCheckedRules = header.numAlwaysCheckedRules;
+	tables.textPoolSize = header.textPoolSize;
+	tables.numRegexes = header.numRegexes;
+
+	// the checksum only says the file is what was written. the sentinels say the tables agree with each other
+	try
+	{
+		valid = tables.states[tables.numStates].edgeBegin == tables.numEdges
+			&& tables.literals[tables.numLiterals].ruleBegin == tables.numLiteralRules
+			&& (tables.textPoolSize == 0 || tables.textPool[tables.textPoolSize - 1] == '\0')
+			&& compileRegexes(rules);
+	}
+	catch (const bad_alloc&)
+	{
+		destroyRules(rules);
+		throw;
+	}
+	if (!valid)
+	{
+		destroyRules(rules);
+		return NULL;
+	}
+	return rules;
+}
+
+atgc_rules* atgc_rules_load(const char* const* paths, size_t numPaths, const char* cachePath, char* error, size_t errorLength)
+{
+	bool readable = false;
+	uint64_t sourceHash = 0;
+	try
+	{
+		if (cachePath != NULL && numPaths > 0)
+		{
+			sourceHash = ruleSourceHash(paths, numPaths, readable);
+		}
+		if (readable)
+		{
+			atgc_rules* rules = loadRuleCache(cachePath, sourceHash);
+			if (rules != NULL)
+			{
+				return rules;
+			}
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		// compiling them next will most likely run out too, and say so
+		readable = false;
+	}
+
+	// no cache, a stale one or a rule file that can't be read (compiling reports that one)
+	atgc_rules* rules = atgc_rules_compile(paths, numPaths, error, errorLength);
+	if (rules != NULL && readable)
+	{
+		try
+		{
+			saveRuleCache(rules, cachePath, sourceHash);
+		}
+		catch (const bad_alloc&)
+		{
+			// the cache is only a shortcut
+		}
+	}
+	return rules;
+}
@@ -0,0 +1,490 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * line filter. see atgcolorize_filter.h
+ *
+ * the literals are compiled into an automaton by compileRules, the same Aho-Corasick automaton
+ * the classifier's rules use, so a line is scanned once whatever the number of literals and the
+ * scan stops at the first one found. highlighting runs the same scan to the end of the line and
+ * keeps, for each position a match can still start at, the longest literal starting there. a
+ * position is settled once the scan is a longest literal past it, so the ranges come out left to
+ * right without being sorted.
+ *
+ * in front of the automaton, a prefilter looks for the places a literal can start at by its
+ * first two bytes, 16 positions at a time where SSE2 is there. the automaton only runs from
+ * there on, and skips ahead again whenever it's back in its start state, so most of a line
+ * that holds no literal is never walked a byte at a time. with more literals than the
+ * prefilter takes, the automaton walks every byte.
+ *
+ * a line that doesn't get through is kept aside in case it heads a block one of whose lines
+ * does; a line that gets through leaves the filter in a state where the rest of its block follows
+ * it out without being looked at. lines are kept aside as they were handed in, by pointer, and
+ * only copied when the call that handed them in returns with them still kept aside
+ */
+
+#include "atgcolorize_filter.h"
+#include "atgcolorize_internal.h"
+
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// first byte pairs the prefilter compares each position with. past this it costs more than it saves
+const size_t MAX_PREFILTER_PAIRS = 8;
+
+// a block longer than this that nothing got through in is dropped, and its lines looked at on their own
+const size_t MAX_HELD_LINES = 4096;
+const size_t MAX_HELD_BYTES = 1024 * 1024;
+
+// where the filter is with the lines it was handed
+const int PASSING = 0; // not in a block, nothing held
+const int LINE_HELD = 1; // holding a line that didn't get through, which may head a trace
+const int TRACE_HELD = 2; // holding a trace none of whose lines got through so far
+const int SQL_HELD = 3; // same for a failed SQL statement block
+const int TRACE_KEPT = 4; // a line got through, the trace that may follow it goes through too
+const int SQL_KEPT = 5; // a line of a SQL block got through, the rest of it goes through too
+
+// a line kept aside: where it was handed in, or where its copy is in copies when line is NULL
+struct HeldLine
+{
+	const char* line;
+	size_t offset;
+	size_t length;
+	int lineType;
+};
+
+struct atgc_filter
+{
+	unsigned int typeMask;
+	atgc_rules* literals; // NULL without literals
+	size_t longestLiteral;
+
+	// the first two bytes of the literals, for the prefilter. numPairs is 0 when there are too many
+	size_t numPairs;
+	uint8_t pairFirst[MAX_PREFILTER_PAIRS];
+	uint8_t pairSecond[MAX_PREFILTER_PAIRS];
+	bool pairSingle[MAX_PREFILTER_PAIRS]; // a one byte literal, the second byte can be anything
+	int state;
+	size_t blockLines; // lines of the SQL block so far
+
+	vector<HeldLine> held;
+	size_t heldBytes;
+	string copies; // of the held lines whose call returned
+
+	vector<uint32_t> longestAt; // scratch for atgc_filter_find, by start position modulo longestLiteral
+};
+
+// the first position from i on a literal can start at, going by its first two bytes. length if there's none
+static size_t nextCandidate(const atgc_filter* filter, const char* line, size_t length, size_t i)
+{
+	if (filter->numPairs == 0)
+	{
+		return i;
+	}
+#ifdef __SSE2__
+	// the second load reads one byte further, so it has to stay inside the line too
+	for (; i + 17 <= length; i += 16)
+	{
+		__m128i first = _mm_loadu_si128((const __m128i*) (line + i));
+		__m128i second = _mm_loadu_si128((const __m128i*) (line + i + 1));
+		__m128i starts = _mm_setzero_si128();
+		for (size_t p = 0; p < filter->numPairs; p++)
+		{
+			__m128i pair = _mm_cmpeq_epi8(first, _mm_set1_epi8((char) filter->pairFirst[p]));
+			if (!filter->pairSingle[p])
+			{
+				pair = _mm_and_si128(pair, _mm_cmpeq_epi8(second, _mm_set1_epi8((char) filter->pairSecond[p])));
+			}
+			starts = _mm_or_si128(starts, pair);
+		}
+		unsigned int mask = (unsigned int) _mm_movemask_epi8(starts);
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+	for (; i < length; i++)
+	{
+		for (size_t p = 0; p < filter->numPairs; p++)
+		{
+			if ((uint8_t) line[i] == filter->pairFirst[p] && (filter->pairSingle[p] || (i + 1 < length && (uint8_t) line[i + 1] == filter->pairSecond[p])))
+			{
+				return i;
+			}
+		}
+	}
+	return length;
+}
+
+static bool isSelected(const atgc_filter* filter, const char* line, size_t length, int lineType)
+{
+	if ((filter->typeMask & ATGC_TYPE_BIT(lineType)) == 0)
+	{
+		return false;
+	}
+	if (filter->literals == NULL)
+	{
+		return true;
+	}
+	const RuleTables& tables = filter->literals->tables;
+	uint32_t state = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		// nothing half matched, on to where the next literal can start
+		if (state == 0 && (i = nextCandidate(filter, line, length, i)) == length)
+		{
+			break;
+		}
+		state = nextState(tables, state, (uint8_t) line[i]);
+		if (tables.states[state].literal != NO_LITERAL || tables.states[state].outputLink != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// a line with a timestamp isn't part of a SQL block
+static bool isOtherLogLine(const char* line, size_t length)
+{
+	size_t timestampLength = 0;
+	return findTimestamp(line, length, timestampLength) != NULL;
+}
+
+// keeps a line aside, where it was handed in
+static void hold(atgc_filter* filter, const char* line, size_t length, int lineType)
+{
+	HeldLine held = { line, 0, length, lineType };
+	filter->held.push_back(held);
+	filter->heldBytes += length;
+}
+
+static void dropHeld(atgc_filter* filter)
+{
+	filter->held.clear();
+	filter->heldBytes = 0;
+	filter->copies.clear();
+}
+
+static void releaseHeld(atgc_filter* filter, atgc_filter_emit emit, void* context)
+{
+	for (size_t i = 0; i < filter->held.size(); i++)
+	{
+		const HeldLine& held = filter->held[i];
+		emit(context, held.line != NULL ? held.line : filter->copies.data() + held.offset, held.length, held.lineType);
+	}
+	dropHeld(filter);
+}
+
+// the lines handed in are about to go away, the ones still held are copied
+static void copyHeld(atgc_filter* filter)
+{
+	size_t i = filter->held.size();
+	while (i > 0 && filter->held[i - 1].line != NULL)
+	{
+		i--;
+	}
+	for (; i < filter->held.size(); i++)
+	{
+		HeldLine& held = filter->held[i];
+		held.offset = filter->copies.size();
+		filter->copies.append(held.line, held.length);
+		held.line = NULL;
+	}
+}
+
+// adds the first two bytes of a literal to the prefilter's, unless a pair already there covers them. false when there's no room
+static bool addPair(atgc_filter* filter, const char* literal, size_t length)
+{
+	uint8_t first = (uint8_t) literal[0];
+	uint8_t second = (length > 1 ? (uint8_t) literal[1] : 0);
+	for (size_t p = 0; p < filter->numPairs; p++)
+	{
+		if (filter->pairFirst[p] == first && (filter->pairSingle[p] || (length > 1 && filter->pairSecond[p] == second)))
+		{
+			return true;
+		}
+	}
+	if (filter->numPairs == MAX_PREFILTER_PAIRS)
+	{
+		return false;
+	}
+	filter->pairFirst[filter->numPairs] = first;
+	filter->pairSecond[filter->numPairs] = second;
+	filter->pairSingle[filter->numPairs] = (length == 1);
+	filter->numPairs++;
+	return true;
+}
+
+atgc_filter* atgc_filter_create(unsigned int typeMask, const char* const* literals, size_t numLiterals)
+{
+	atgc_filter* filter = new (nothrow) atgc_filter();
+	if (filter == NULL)
+	{
+		return NULL;
+	}
+	filter->typeMask = typeMask;
+	filter->literals = NULL;
+	filter->longestLiteral = 0;
+	filter->numPairs = 0;
+	filter->state = PASSING;
+	filter->blockLines = 0;
+	filter->heldBytes = 0;
+
+	// one rule per literal, only the automaton is used
+	try
+	{
+		vector<RuleDefinition> definitions;
+		bool prefiltered = true;
+		for (size_t i = 0; i < numLiterals; i++)
+		{
+			size_t length = strlen(literals[i]);
+			if (length == 0)
+			{
+				continue;
+			}
+			RuleDefinition definition;
+			definition.lineType = ATGC_OTHER_LINE;
+			definition.previousLineType = ANY_LINE_TYPE;
+			definition.priority = 0;
+			definition.matches.push_back(MATCH_CONTAINS);
+			definition.texts.push_back(literals[i]);
+			definition.source = "--match";
+			definitions.push_back(definition);
+			filter->longestLiteral = max(filter->longestLiteral, length);
+			prefiltered = prefiltered && addPair(filter, literals[i], length);
+		}
+		if (!prefiltered)
+		{
+			filter->numPairs = 0;
+		}
+		string error;
+		if (!definitions.empty() && (filter->literals = compileRules(definitions, error)) == NULL)
+		{
+			delete filter;
+			return NULL;
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		delete filter;
+		return NULL;
+	}
+	return filter;
+}
+
+void atgc_filter_destroy(atgc_filter* filter)
+{
+	if (filter != NULL)
+	{
+		destroyRules(filter->literals);
+	}
+	delete filter;
+}
+
+static void addLine(atgc_filter* filter, const char* line, size_t length, int lineType, atgc_filter_emit emit, void* context)
+{
+	// a SQL block runs up to its end marker, unless the log goes on with other lines first
+	if ((filter->state == SQL_KEPT || filter->state == SQL_HELD) && isOtherLogLine(line, length))
+	{
+		dropHeld(filter);
+		filter->state = PASSING;
+	}
+
+	// the rest of a block that got through
+	if (filter->state == SQL_KEPT)
+	{
+		emit(context, line, length, lineType);
+		if (isFailedSQLEnd(line, length) || ++filter->blockLines > MAX_HELD_LINES)
+		{
+			filter->state = PASSING;
+		}
+		return;
+	}
+	if (filter->state == TRACE_KEPT && lineType != ATGC_BLANK_LINE && (isTraceLine(line, length) || isMonitorLine(line, length)))
+	{
+		emit(context, line, length, lineType);
+		return;
+	}
+
+	// the exception line under a log line that got through, its trace follows. it names the exception in full, "Error" alone is a log level
+	size_t classLength = 0;
+	const char* exceptionClass = (filter->state == TRACE_KEPT && lineType == ATGC_ERROR_LINE && !isOtherLogLine(line, length) ? findExceptionClass(line, length, classLength) : NULL);
+	if (exceptionClass != NULL && memchr(exceptionClass, '.', classLength) != NULL)
+	{
+		emit(context, line, length, lineType);
+		return;
+	}
+
+	// a block nothing got through in so far
+	bool selected = isSelected(filter, line, length, lineType);
+	bool inBlock = (filter->state == SQL_HELD)
+		|| ((filter->state == LINE_HELD || filter->state == TRACE_HELD) && lineType != ATGC_BLANK_LINE && isTraceLine(line, length))
+		|| (filter->state == TRACE_HELD && lineType != ATGC_BLANK_LINE && isMonitorLine(line, length));
+	if (inBlock && selected)
+	{
+		releaseHeld(filter, emit, context);
+		emit(context, line, length, lineType);
+		filter->state = (filter->state == SQL_HELD && !isFailedSQLEnd(line, length) ? SQL_KEPT : TRACE_KEPT);
+		return;
+	}
+	if (inBlock)
+	{
+		hold(filter, line, length, lineType);
+		if (filter->state == LINE_HELD)
+		{
+			filter->state = TRACE_HELD;
+		}
+		if ((filter->state == SQL_HELD && isFailedSQLEnd(line, length))
+			|| filter->held.size() >= MAX_HELD_LINES || filter->heldBytes >= MAX_HELD_BYTES)
+		{
+			dropHeld(filter);
+			filter->state = PASSING;
+		}
+		return;
+	}
+
+	// a line on its own, or the first line of a block
+	dropHeld(filter);
+	bool startsSQL = (lineType == ATGC_ERROR_LINE && failedSQLStart(line, length, NULL) >= 0);
+	bool monitor = (!startsSQL && lineType != ATGC_BLANK_LINE && isMonitorLine(line, length));
+	filter->blockLines = 0;
+	if (selected)
+	{
+		emit(context, line, length, lineType);
+		filter->state = (startsSQL ? SQL_KEPT : (monitor ? PASSING : TRACE_KEPT));
+	}
+	else if (lineType != ATGC_BLANK_LINE && !monitor)
+	{
+		hold(filter, line, length, lineType);
+		filter->state = (startsSQL ? SQL_HELD : LINE_HELD);
+	}
+	else
+	{
+		filter->state = PASSING;
+	}
+}
+
+// when memory runs out holding a line, the block being held is dropped and the filter starts over
+static void addOrDrop(atgc_filter* filter, const char* line, size_t length, int lineType, atgc_filter_emit emit, void* context)
+{
+	try
+	{
+		addLine(filter, line, length, lineType, emit, context);
+	}
+	catch (const bad_alloc&)
+	{
+		dropHeld(filter);
+		filter->state = PASSING;
+	}
+}
+
+static void copyOrDrop(atgc_filter* filter)
+{
+	try
+	{
+		copyHeld(filter);
+	}
+	catch (const bad_alloc&)
+	{
+		dropHeld(filter);
+		filter->state = PASSING;
+	}
+}
+
+void atgc_filter_add(atgc_filter* filter, const char* line, size_t length, int lineType, atgc_filter_emit emit, void* context)
+{
+	addOrDrop(filter, line, length, lineType, emit, context);
+	copyOrDrop(filter);
+}
+
+void atgc_filter_add_batch(atgc_filter* filter, const char* const* lines, const size_t* lengths, const int* types, size_t count, atgc_filter_emit emit, void* context)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		addOrDrop(filter, lines[i], lengths[i], types[i], emit, context);
+	}
+	copyOrDrop(filter);
+}
+
+size_t atgc_filter_find(atgc_filter* filter, const char* line, size_t length, size_t* offsets, size_t* lengths, size_t max)
+{
+	if (filter->literals == NULL)
+	{
+		return 0;
+	}
+	const RuleTables& tables = filter->literals->tables;
+	const size_t window = filter->longestLiteral;
+	vector<uint32_t>& longestAt = filter->longestAt;
+	try
+	{
+		longestAt.assign(window, 0);
+	}
+	catch (const bad_alloc&)
+	{
+		return 0;
+	}
+
+	// left to right, the longest where several start at the same place, skipping overlaps. nothing starts before start
+	size_t start = nextCandidate(filter, line, length, 0);
+	size_t count = 0;
+	size_t end = 0;
+	uint32_t state = 0;
+	for (size_t i = start; i < length + window - 1 && count < max; i++)
+	{
+		if (i < length)
+		{
+			state = nextState(tables, state, (uint8_t) line[i]);
+			for (uint32_t output = (tables.states[state].literal != NO_LITERAL ? state : tables.states[state].outputLink); output != 0; output = tables.states[output].outputLink)
+			{
+				uint32_t literalLength = tables.literals[tables.states[output].literal].length;
+				uint32_t& longest = longestAt[(i + 1 - literalLength) % window];
+				if (literalLength > longest)
+				{
+					longest = literalLength;
+				}
+			}
+		}
+
+		// nothing found from here on can start at or before settled
+		if (i + 1 < window)
+		{
+			continue;
+		}
+		size_t settled = i + 1 - window;
+		uint32_t& longest = longestAt[settled % window];
+		if (longest != 0 && settled >= end)
+		{
+			offsets[count] = settled;
+			lengths[count] = longest;
+			count++;
+			end = settled + longest;
+		}
+		longest = 0;
+	}
+	return count;
+}
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * line filter for libatgcolorize, so a log can be cut down to its errors, or to the lines naming
+ * a component, without piping the colored output through grep. a line gets through when its
+ * type is one of the types asked for and, if there are literals, it contains one of them.
+ *
+ * a stack trace or a failed SQL statement block goes through whole as soon as one of its lines
+ * does: the exception line in front of the frames, or the first line of the SQL block, is kept
+ * aside until it's known whether the rest of the block gets through. lines that don't get through
+ * never reach the renderer. the "- locked <0x...>" lines of a thread dump are part of the stack
+ * they're in, but don't start a trace of their own
+ */
+
+#ifndef ATGCOLORIZE_FILTER_H
+#define ATGCOLORIZE_FILTER_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_filter atgc_filter;
+
+// the bit a line type has in a type mask
+#define ATGC_TYPE_BIT(lineType) (1u << (lineType))
+
+// called for every line that gets through, in order. the line is only valid during the call
+typedef void (*atgc_filter_emit)(void* context, const char* line, size_t length, int lineType);
+
+/*
+	typeMask has ATGC_TYPE_BIT set for the types that get through. with numLiterals > 0 a line has
+	to contain at least one of the literals as well, case sensitive. the literals are copied
+*/
+ATGC_API atgc_filter* atgc_filter_create(unsigned int typeMask, const char* const* literals, size_t numLiterals);
+ATGC_API void atgc_filter_destroy(atgc_filter* filter);
+
+/*
+	hands the filter the next line along with the type the classifier gave it. a line that's kept
+	aside when this returns is copied. when memory runs out the lines kept aside are dropped
+*/
+ATGC_API void atgc_filter_add(atgc_filter* filter, const char* line, size_t length, int lineType, atgc_filter_emit emit, void* context);
+
+/*
+	like atgc_filter_add for count lines. the lines are only kept aside by pointer while it runs, so
+	only a block still open at the end of the batch gets copied
+*/
+ATGC_API void atgc_filter_add_batch(atgc_filter* filter, const char* const* lines, const size_t* lengths, const int* types, size_t count, atgc_filter_emit emit, void* context);
+
+/*
+	where the literals are in line, for highlighting them: writes up to max ranges into offsets and
+	lengths, left to right and not overlapping, and returns how many were written
+*/
+ATGC_API size_t atgc_filter_find(atgc_filter* filter, const char* line, size_t length, size_t* offsets, size_t* lengths, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_FILTER_H
@@ -0,0 +1,492 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * stack trace folding. see atgcolorize_fold.h
+ *
+ * a trace looks like one of these, with or without an app server prefix in front of each line:
+ *
+ *		java.lang.NullPointerException: order is null
+ *			at atg.commerce.order.OrderManager.loadOrder(OrderManager.java:1280)
+ *			at atg.commerce.order.OrderLookup.service(OrderLookup.java:212)
+ *		Caused by: atg.repository.RepositoryException: no such item
+ *			at atg.adapter.gsa.GSARepository.getItem(GSARepository.java:512)
+ *			... 23 more
+ *
+ *		10:05:01,320 ERROR [STDERR] java.lang.NullPointerException
+ *		10:05:01,320 ERROR [STDERR] 	at atg.commerce.order.OrderManager.loadOrder(OrderManager.java:1280)
+ *
+ *	the exception line is only known to start a trace once the next line turns out to be a frame,
+ *	so a line naming an exception is held for one line. the fingerprint covers the exception
+ *	class, every frame and the class of every "Caused by", not the messages, which tend to have
+ *	order ids and such in them
+ */
+
+#include "atgcolorize_fold.h"
+#include "atgcolorize_internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <new>
+
+using namespace std;
+
+const size_t DEFAULT_MAX_TRACES = 4096;
+const size_t MAX_MAX_TRACES = 1 << 24;
+
+// slots looked at for a fingerprint. when none of them matches, the oldest one is replaced
+const size_t PROBE_LENGTH = 8;
+
+// a trace longer than this is let through as it is, the rest of it without being held
+const size_t MAX_TRACE_LINES = 4096;
+const size_t MAX_TRACE_BYTES = 1024 * 1024;
+
+
+// where the folder is with the lines it was handed
+const int PASSING = 0; // not in a trace, nothing held
+const int HEADER_HELD = 1; // holding a line naming an exception, waiting to see if a frame follows
+const int IN_TRACE = 2; // holding a trace
+const int OVERSIZED_TRACE = 3; // in a trace too long to hold, letting its lines through
+
+struct FoldedTrace
+{
+	uint64_t fingerprint; // 0 for an empty slot
+	uint64_t lastSeen;
+	uint32_t id;
+	uint32_t count;
+};
+
+struct atgc_folder
+{
+	vector<FoldedTrace> table;
+	size_t mask;
+	uint32_t nextId;
+	uint64_t sequence; // counts traces, to tell which one was seen the longest time ago
+	size_t folded;
+
+	int state;
+	uint64_t fingerprint;
+
+	// the held lines, one after the other in held
+	string held;
+	vector<size_t> heldEnds;
+	vector<int> heldTypes;
+
+	string scratch; // the first line of a trace with its reference added
+};
+
+// characters of a class or method name, the way they show up in a trace
+static bool isNameChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '$' || c == '<' || c == '>' || c == '/';
+}
+
+static size_t trimmedLength(const char* line, size_t length)
+{
+	while (length > 0 && isSpace(line[length - 1]))
+	{
+		length--;
+	}
+	return length;
+}
+
+const char* findText(const char* line, size_t length, const char* text, size_t textLength)
+{
+	if (textLength == 0 || textLength > length)
+	{
+		return NULL;
+	}
+	const char* last = line + length - textLength;
+	for (const char* c = line; c <= last && (c = (const char*) memchr(c, text[0], last - c + 1)) != NULL; c++)
+	{
+		if (memcmp(c, text, textLength) == 0)
+		{
+			return c;
+		}
+	}
+	return NULL;
+}
+
+/*
+ *	finds the frame in a line like "	at atg.commerce.order.OrderManager.loadOrder(OrderManager.java:1280)",
+ *	whatever comes before the "at". returns NULL if the line isn't a frame
+ */
+const char* findFrame(const char* line, size_t length, size_t& frameLength)
+{
+	length = trimmedLength(line, length);
+	if (length < 5 || line[length - 1] != ')')
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i + 3 < length; i++)
+	{
+		if (line[i] != 'a' || line[i + 1] != 't' || line[i + 2] != ' ' || (i > 0 && !isSpace(line[i - 1]) && line[i - 1] != ']'))
+		{
+			continue;
+		}
+		size_t name = i + 3;
+		size_t end = name;
+		while (end < length && isNameChar(line[end]))
+		{
+			end++;
+		}
+		if (end > name && end < length && line[end] == '(')
+		{
+			frameLength = length - i;
+			return line + i;
+		}
+	}
+	return NULL;
+}
+
+/*
+ *	finds the name of the exception in a line, preferring a fully qualified one. "**** Error ...
+ *	CONTAINER:atg.service.pipeline.RunProcessException: ..." gives atg.service.pipeline.RunProcessException
+ */
+const char* findExceptionClass(const char* line, size_t length, size_t& classLength)
+{
+	const char* found = NULL;
+	for (size_t i = 0; i < length; )
+	{
+		if (!isNameChar(line[i]))
+		{
+			i++;
+			continue;
+		}
+		size_t end = i;
+		while (end < length && isNameChar(line[end]))
+		{
+			end++;
+		}
+		const char* word = line + i;
+		size_t wordLength = end - i;
+		if (findText(word, wordLength, "Exception", 9) != NULL || findText(word, wordLength, "Error", 5) != NULL || findText(word, wordLength, "Throwable", 9) != NULL)
+		{
+			bool qualified = (memchr(word, '.', wordLength) != NULL);
+			if (found == NULL || qualified)
+			{
+				found = word;
+				classLength = wordLength;
+			}
+			if (qualified)
+			{
+				break;
+			}
+		}
+		i = end;
+	}
+	return found;
+}
+
+// "... 23 more"
+bool isMoreLine(const char* line, size_t length)
+{
+	length = trimmedLength(line, length);
+	const char* dots = findText(line, length, "... ", 4);
+	if (dots == NULL || length < 5 || memcmp(line + length - 5, " more", 5) != 0)
+	{
+		return false;
+	}
+	for (const char* c = dots + 4; c < line + length - 5; c++)
+	{
+		if (*c < '0' || *c > '9')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void hold(atgc_folder* folder, const char* line, size_t length, int lineType)
+{
+	folder->held.append(line, length);
+	folder->heldEnds.push_back(folder->held.size());
+	folder->heldTypes.push_back(lineType);
+}
+
+static void startHolding(atgc_folder* folder, int state)
+{
+	folder->state = state;
+	folder->fingerprint = FNV_OFFSET_BASIS;
+	folder->held.clear();
+	folder->heldEnds.clear();
+	folder->heldTypes.clear();
+}
+
+// lets the held lines through, the first one with suffix (if not NULL) added to it
+static void releaseHeld(atgc_folder* folder, const char* suffix, atgc_fold_emit emit, void* context)
+{
+	size_t begin = 0;
+	for (size_t i = 0; i < folder->heldEnds.size(); i++)
+	{
+		const char* line = folder->held.data() + begin;
+		size_t length = folder->heldEnds[i] - begin;
+		if (i == 0 && suffix != NULL)
+		{
+			folder->scratch.assign(line, length);
+			folder->scratch += suffix;
+			emit(context, folder->scratch.data(), folder->scratch.size(), folder->heldTypes[i]);
+		}
+		else
+		{
+			emit(context, line, length, folder->heldTypes[i]);
+		}
+		begin = folder->heldEnds[i];
+	}
+	folder->held.clear();
+	folder->heldEnds.clear();
+	folder->heldTypes.clear();
+}
+
+/*
+ *	looks the trace up and counts it, remembering it when it's new. a new trace goes into the first
+ *	empty slot of its probe window or else replaces the one in there seen the longest time ago.
+ *	slots are never emptied, so the lookup can stop at the first empty one
+ */
+static FoldedTrace* rememberTrace(atgc_folder* folder, uint64_t fingerprint, bool& seenBefore)
+{
+	FoldedTrace* replaced = NULL;
+	folder->sequence++;
+	for (size_t probe = 0; probe < PROBE_LENGTH; probe++)
+	{
+		FoldedTrace& slot = folder->table[(fingerprint + probe) & folder->mask];
+		if (slot.fingerprint == fingerprint)
+		{
+			slot.count++;
+			slot.lastSeen = folder->sequence;
+			seenBefore = true;
+			return &slot;
+		}
+		if (slot.fingerprint == 0)
+		{
+			replaced = &slot;
+			break;
+		}
+		if (replaced == NULL || slot.lastSeen < replaced->lastSeen)
+		{
+			replaced = &slot;
+		}
+	}
+	replaced->fingerprint = fingerprint;
+	replaced->lastSeen = folder->sequence;
+	replaced->id = ++folder->nextId;
+	replaced->count = 1;
+	seenBefore = false;
+	return replaced;
+}
+
+static void finishTrace(atgc_folder* folder, atgc_fold_emit emit, void* context)
+{
+	// 0 marks an empty slot
+	uint64_t fingerprint = (folder->fingerprint == 0 ? 1 : folder->fingerprint);
+	bool seenBefore = false;
+	FoldedTrace* trace = rememberTrace(folder, fingerprint, seenBefore);
+
+	char reference[128];
+	if (!seenBefore)
+	{
+		snprintf(reference, sizeof(reference), "  [stack trace #%u]", trace->id);
+		releaseHeld(folder, reference, emit, context);
+		return;
+	}
+
+	// only the exception line goes out, the rest is folded into the reference
+	snprintf(reference, sizeof(reference), "  [same stack trace as #%u, seen %u times, %lu lines folded]",
+		trace->id, trace->count, (unsigned long) folder->heldEnds.size() - 1);
+	folder->scratch.assign(folder->held.data(), folder->heldEnds[0]);
+	folder->scratch += reference;
+	emit(context, folder->scratch.data(), folder->scratch.size(), folder->heldTypes[0]);
+	folder->held.clear();
+	folder->heldEnds.clear();
+	folder->heldTypes.clear();
+	folder->folded++;
+}
+
+atgc_folder* atgc_folder_create(size_t maxTraces)
+{
+	atgc_folder* folder = new (nothrow) atgc_folder();
+	if (folder == NULL)
+	{
+		return NULL;
+	}
+	maxTraces = (maxTraces == 0 ? DEFAULT_MAX_TRACES : min(maxTraces, MAX_MAX_TRACES));
+	size_t size = 16;
+	while (size < maxTraces)
+	{
+		size *= 2;
+	}
+	try
+	{
+		FoldedTrace empty = { 0, 0, 0, 0 };
+		folder->table.assign(size, empty);
+	}
+	catch (const bad_alloc&)
+	{
+		delete folder;
+		return NULL;
+	}
+	folder->mask = size - 1;
+	folder->nextId = 0;
+	folder->sequence = 0;
+	folder->folded = 0;
+	folder->state = PASSING;
+	folder->fingerprint = FNV_OFFSET_BASIS;
+	return folder;
+}
+
+void atgc_folder_destroy(atgc_folder* folder)
+{
+	delete folder;
+}
+
+static void addLine(atgc_folder* folder, const char* line, size_t length, int lineType, atgc_fold_emit emit, void* context)
+{
+	size_t frameLength = 0;
+	const char* frame = findFrame(line, length, frameLength);
+
+	if (folder->state == IN_TRACE || folder->state == OVERSIZED_TRACE)
+	{
+		const char* cause = (frame == NULL ? findText(line, length, "Caused by: ", 11) : NULL);
+		const char* monitor = (frame == NULL && cause == NULL && lineType != ATGC_BLANK_LINE && isMonitorLine(line, length) ? line : NULL);
+		if (frame != NULL || cause != NULL || monitor != NULL || isMoreLine(line, length))
+		{
+			if (folder->state == OVERSIZED_TRACE)
+			{
+				emit(context, line, length, lineType);
+				return;
+			}
+			if (frame != NULL)
+			{
+				folder->fingerprint = hashBytes(folder->fingerprint, frame, frameLength);
+			}
+			else if (cause != NULL)
+			{
+				size_t classLength = 0;
+				const char* causeClass = findExceptionClass(cause + 11, length - (cause + 11 - line), classLength);
+				folder->fingerprint = hashBytes(folder->fingerprint, "Caused by", 9);
+				if (causeClass != NULL)
+				{
+					folder->fingerprint = hashBytes(folder->fingerprint, causeClass, classLength);
+				}
+			}
+			else if (monitor != NULL)
+			{
+				// "- locked", "- waiting on"... the address after them changes from one run to the next
+				const char* open = (const char*) memchr(line, '<', length);
+				folder->fingerprint = hashBytes(folder->fingerprint, line, open - line);
+			}
+			hold(folder, line, length, lineType);
+			if (folder->heldEnds.size() >= MAX_TRACE_LINES || folder->held.size() >= MAX_TRACE_BYTES)
+			{
+				releaseHeld(folder, NULL, emit, context);
+				folder->state = OVERSIZED_TRACE;
+			}
+			return;
+		}
+		if (folder->state == IN_TRACE)
+		{
+			finishTrace(folder, emit, context);
+		}
+		folder->state = PASSING;
+	}
+	else if (folder->state == HEADER_HELD)
+	{
+		if (frame != NULL)
+		{
+			folder->fingerprint = hashBytes(folder->fingerprint, frame, frameLength);
+			hold(folder, line, length, lineType);
+			folder->state = IN_TRACE;
+			return;
+		}
+		releaseHeld(folder, NULL, emit, context);
+		folder->state = PASSING;
+	}
+
+	// not in a trace. this line may start one
+	size_t classLength = 0;
+	const char* exceptionClass = (frame == NULL && lineType != ATGC_BLANK_LINE ? findExceptionClass(line, length, classLength) : NULL);
+	if (exceptionClass != NULL)
+	{
+		startHolding(folder, HEADER_HELD);
+		folder->fingerprint = hashBytes(folder->fingerprint, exceptionClass, classLength);
+		hold(folder, line, length, lineType);
+	}
+	else
+	{
+		// frames with no exception line in front of them, like the stacks of a thread dump, aren't folded
+		emit(context, line, length, lineType);
+	}
+}
+
+/*
+ *	out of memory while holding a trace or writing its reference. a line is only part of the
+ *	trace once its end and type are both in, so the ones that are go through unfolded and the
+ *	folder starts over
+ */
+static void releaseUnfolded(atgc_folder* folder, atgc_fold_emit emit, void* context)
+{
+	folder->heldEnds.resize(min(folder->heldEnds.size(), folder->heldTypes.size()));
+	releaseHeld(folder, NULL, emit, context);
+	folder->state = PASSING;
+}
+
+void atgc_folder_add(atgc_folder* folder, const char* line, size_t length, int lineType, atgc_fold_emit emit, void* context)
+{
+	try
+	{
+		addLine(folder, line, length, lineType, emit, context);
+	}
+	catch (const bad_alloc&)
+	{
+		releaseUnfolded(folder, emit, context);
+		emit(context, line, length, lineType);
+	}
+}
+
+int atgc_folder_pending(const atgc_folder* folder)
+{
+	return (folder->state == HEADER_HELD || folder->state == IN_TRACE);
+}
+
+void atgc_folder_flush(atgc_folder* folder, atgc_fold_emit emit, void* context)
+{
+	if (folder->state == IN_TRACE)
+	{
+		try
+		{
+			finishTrace(folder, emit, context);
+		}
+		catch (const bad_alloc&)
+		{
+			releaseUnfolded(folder, emit, context);
+		}
+	}
+	else if (folder->state == HEADER_HELD)
+	{
+		releaseHeld(folder, NULL, emit, context);
+	}
+	folder->state = PASSING;
+}
+
+size_t atgc_folder_folded(const atgc_folder* folder)
+{
+	return folder->folded;
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * stack trace folding for libatgcolorize. a request that keeps failing the same way prints
+ * the same 150 line stack trace over and over. the folder sits between the classifier and
+ * whatever writes the lines out: it puts each trace back together (the exception line, its
+ * "at" frames, "Caused by" and "... n more" lines), fingerprints it and lets it through the
+ * first time, tagged with a number. when the same trace comes back, only its exception line
+ * goes out, followed by a reference to the number and how many times it was seen. frames with
+ * no exception line in front of them, such as the stacks of a thread dump, go through untouched.
+ *
+ * traces are remembered in a fixed size table; when it's full the trace seen the longest time
+ * ago is forgotten, so memory stays the same however long the log is
+ */
+
+#ifndef ATGCOLORIZE_FOLD_H
+#define ATGCOLORIZE_FOLD_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_folder atgc_folder;
+
+/*
+	called for every line the folder lets through, in order. the line has no trailing newline
+	and is only valid during the call. a folded trace comes through as a single line
+*/
+typedef void (*atgc_fold_emit)(void* context, const char* line, size_t length, int lineType);
+
+// maxTraces is how many different traces are remembered, 0 for the default (4096). at most 16M are
+ATGC_API atgc_folder* atgc_folder_create(size_t maxTraces);
+ATGC_API void atgc_folder_destroy(atgc_folder* folder);
+
+/*
+	hands the folder the next line along with the type the classifier gave it. lines that may be
+	part of a trace are held until the trace is complete, everything else goes straight to emit.
+	when memory runs out, what's held and the line go to emit unfolded
+*/
+ATGC_API void atgc_folder_add(atgc_folder* folder, const char* line, size_t length, int lineType, atgc_fold_emit emit, void* context);
+
+// non-zero when lines are being held, waiting for the rest of a trace
+ATGC_API int atgc_folder_pending(const atgc_folder* folder);
+
+// takes whatever is held as a complete trace, eg. when the input goes quiet or ends
+ATGC_API void atgc_folder_flush(atgc_folder* folder, atgc_fold_emit emit, void* context);
+
+// how many traces were folded away so far
+ATGC_API size_t atgc_folder_folded(const atgc_folder* folder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_FOLD_H
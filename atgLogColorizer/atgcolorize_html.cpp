@@ -0,0 +1,352 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * HTML renderer for libatgcolorize. see atgcolorize_html.h
+ *
+ * a line is a span with the class of its type, inside a block that keeps the newlines. a trace is
+ * a details element with the exception line as its summary, and a block only ends between traces
+ * so a trace is never split. like the NDJSON renderer, escaping looks at 16 bytes at a time where
+ * SSE2 is there and only slows down for the bytes that have to be written as entities
+ */
+
+#include "atgcolorize_html.h"
+#include "atgcolorize_internal.h"
+
+#include <string.h>
+#include <new>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// lines per block. the browser skips laying out the blocks that aren't on the screen
+static const size_t BLOCK_LINES = 500;
+
+static const size_t MAX_TITLE_LENGTH = 200;
+
+// an escaped byte takes at most 5 (&amp;)
+static const size_t MAX_ESCAPED_LENGTH = 5;
+
+// escaping may write this many bytes past the end of what it escapes
+static const size_t ESCAPE_SLACK = 16;
+
+// the markup around a line: opening or closing a trace, a block and the span
+static const size_t MAX_LINE_OVERHEAD = 128;
+
+static const char PAGE_HEAD[] =
+	"<!DOCTYPE html>\n"
+	"<html>\n"
+	"<head>\n"
+	"<meta charset=\"utf-8\">\n"
+	"<title>";
+
+// colors as in the terminal
+static const char PAGE_STYLE[] =
+	"</title>\n"
+	"<style>\n"
+	"body { background: #000000; color: #c0c0c0; margin: 8px; font: 13px monospace; }\n"
+	".c { white-space: pre; content-visibility: auto; contain-intrinsic-size: auto 8000px; }\n"
+	".i { color: #55ff55; }\n"
+	".w { color: #55ffff; }\n"
+	".d { color: #ffffff; }\n"
+	".e { color: #ff5555; }\n"
+	".o { color: #ffff55; }\n"
+	".n { color: #ff55ff; background: #000000; }\n"
+	"details > summary { cursor: pointer; }\n"
+	"details > summary:hover { background: #202020; }\n"
+	"</style>\n"
+	"</head>\n"
+	"<body>\n"
+	"<div class=\"c\">";
+
+static const char PAGE_TAIL[] = "</div>\n</body>\n</html>\n";
+static const char NEXT_BLOCK[] = "</div>\n<div class=\"c\">";
+static const char TRACE_OPEN[] = "<details><summary class=\"";
+static const char TRACE_CLOSE[] = "</details>";
+
+struct atgc_html
+{
+	vector<char> title; // escaped
+	vector<char> held; // the escaped exception line that may start a trace
+	size_t heldLength;
+	int heldType;
+	bool holding;
+	bool inTrace;
+	size_t blockLines;
+};
+
+static const char* lineClass(int lineType)
+{
+	switch (lineType)
+	{
+		case ATGC_INFO_LINE:
+			return "i";
+		case ATGC_WARNING_LINE:
+			return "w";
+		case ATGC_DEBUG_LINE:
+			return "d";
+		case ATGC_ERROR_LINE:
+			return "e";
+		case ATGC_NUCLEUS_LINE:
+			return "n";
+	}
+	return "o";
+}
+
+static char* append(char* out, const char* text, size_t length)
+{
+	memcpy(out, text, length);
+	return out + length;
+}
+
+static char* escapeByte(char* out, char c)
+{
+	switch (c)
+	{
+		case '&':
+			return append(out, "&amp;", 5);
+		case '<':
+			return append(out, "&lt;", 4);
+		case '>':
+			return append(out, "&gt;", 4);
+	}
+	*out++ = c;
+	return out;
+}
+
+// writes text as HTML text, may write up to ESCAPE_SLACK bytes past what it returns
+static char* escape(char* out, const char* text, size_t length)
+{
+	const char* end = text + length;
+#ifdef __SSE2__
+	const __m128i ampersand = _mm_set1_epi8('&');
+	const __m128i lessThan = _mm_set1_epi8('<');
+	const __m128i greaterThan = _mm_set1_epi8('>');
+	while (end - text >= 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*) text);
+		_mm_storeu_si128((__m128i*) out, bytes);
+		__m128i special = _mm_or_si128(_mm_cmpeq_epi8(bytes, ampersand), _mm_or_si128(_mm_cmpeq_epi8(bytes, lessThan), _mm_cmpeq_epi8(bytes, greaterThan)));
+		unsigned int mask = (unsigned int) _mm_movemask_epi8(special);
+		if (mask == 0)
+		{
+			text += 16;
+			out += 16;
+			continue;
+		}
+		unsigned int plain = (unsigned int) __builtin_ctz(mask);
+		text += plain;
+		out += plain;
+		out = escapeByte(out, *text++);
+	}
+#endif
+	for (; text < end; text++)
+	{
+		out = escapeByte(out, *text);
+	}
+	return out;
+}
+
+static char* writeLine(char* out, const char* escaped, size_t length, int lineType)
+{
+	if (lineType == ATGC_BLANK_LINE)
+	{
+		*out++ = '\n';
+		return out;
+	}
+	out = append(out, "<span class=\"", 13);
+	*out++ = *lineClass(lineType);
+	out = append(out, "\">", 2);
+	out = append(out, escaped, length);
+	return append(out, "</span>\n", 8);
+}
+
+static char* writeHeld(atgc_html* html, char* out)
+{
+	if (html->holding)
+	{
+		out = writeLine(out, &html->held[0], html->heldLength, html->heldType);
+		html->holding = false;
+	}
+	return out;
+}
+
+// room to hold an escaped line of length bytes. false when memory ran out, the line is then written as it comes
+static bool makeHeldRoom(atgc_html* html, size_t length)
+{
+	try
+	{
+		if (html->held.size() < length * MAX_ESCAPED_LENGTH + ESCAPE_SLACK)
+		{
+			html->held.resize(length * MAX_ESCAPED_LENGTH + ESCAPE_SLACK);
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		return false;
+	}
+	return true;
+}
+
+atgc_html* atgc_html_create(const char* title)
+{
+	atgc_html* html = new (nothrow) atgc_html();
+	if (html == NULL)
+	{
+		return NULL;
+	}
+	size_t titleLength = strlen(title);
+	titleLength = (titleLength < MAX_TITLE_LENGTH ? titleLength : MAX_TITLE_LENGTH);
+	try
+	{
+		html->title.resize(titleLength * MAX_ESCAPED_LENGTH + ESCAPE_SLACK);
+	}
+	catch (const bad_alloc&)
+	{
+		delete html;
+		return NULL;
+	}
+	html->title.resize(escape(&html->title[0], title, titleLength) - &html->title[0]);
+	html->heldLength = 0;
+	html->heldType = ATGC_BLANK_LINE;
+	html->holding = false;
+	html->inTrace = false;
+	html->blockLines = 0;
+	return html;
+}
+
+void atgc_html_destroy(atgc_html* html)
+{
+	delete html;
+}
+
+size_t atgc_html_begin(atgc_html* html, char* out, size_t capacity)
+{
+	if (capacity < ATGC_HTML_MAX_FRAME_SIZE)
+	{
+		return 0;
+	}
+	char* next = append(out, PAGE_HEAD, sizeof(PAGE_HEAD) - 1);
+	next = append(next, html->title.data(), html->title.size());
+	next = append(next, PAGE_STYLE, sizeof(PAGE_STYLE) - 1);
+	return next - out;
+}
+
+size_t atgc_html_max_rendered_size(size_t length)
+{
+	return MAX_LINE_OVERHEAD + length * MAX_ESCAPED_LENGTH + ESCAPE_SLACK;
+}
+
+size_t atgc_html_pending_size(const atgc_html* html)
+{
+	return (html->holding ? MAX_LINE_OVERHEAD + html->heldLength : 0);
+}
+
+size_t atgc_html_render_batch(atgc_html* html, const char* const* lines, const size_t* lengths, const int* types, size_t count, char* out, size_t capacity, size_t* rendered)
+{
+	char* next = out;
+	size_t i = 0;
+	for (; i < count; i++)
+	{
+		if ((size_t) (next - out) + atgc_html_max_rendered_size(lengths[i]) + atgc_html_pending_size(html) > capacity)
+		{
+			break;
+		}
+		const char* line = lines[i];
+		size_t length = lengths[i];
+		size_t frameLength = 0;
+		// only looked at when it matters, most lines aren't near a trace
+		bool partOfTrace = (html->holding || html->inTrace)
+			&& (findFrame(line, length, frameLength) != NULL || isMoreLine(line, length) || findText(line, length, "Caused by: ", 11) != NULL);
+
+		// the held exception line becomes the summary of a trace when one follows it
+		if (html->holding && partOfTrace)
+		{
+			next = append(next, TRACE_OPEN, sizeof(TRACE_OPEN) - 1);
+			next = append(next, lineClass(html->heldType), 1);
+			next = append(next, "\">", 2);
+			next = append(next, &html->held[0], html->heldLength);
+			next = append(next, "</summary>", 10);
+			html->holding = false;
+			html->inTrace = true;
+		}
+		next = writeHeld(html, next);
+		if (html->inTrace && !partOfTrace)
+		{
+			next = append(next, TRACE_CLOSE, sizeof(TRACE_CLOSE) - 1);
+			html->inTrace = false;
+		}
+		if (!html->inTrace && html->blockLines >= BLOCK_LINES)
+		{
+			next = append(next, NEXT_BLOCK, sizeof(NEXT_BLOCK) - 1);
+			html->blockLines = 0;
+		}
+		html->blockLines++;
+
+		size_t classLength = 0;
+		if (!partOfTrace && types[i] == ATGC_ERROR_LINE && findExceptionClass(line, length, classLength) != NULL && makeHeldRoom(html, length))
+		{
+			html->heldLength = escape(&html->held[0], line, length) - &html->held[0];
+			html->heldType = types[i];
+			html->holding = true;
+			continue;
+		}
+		if (types[i] == ATGC_BLANK_LINE)
+		{
+			*next++ = '\n';
+			continue;
+		}
+		next = append(next, "<span class=\"", 13);
+		*next++ = *lineClass(types[i]);
+		next = append(next, "\">", 2);
+		next = escape(next, line, length);
+		next = append(next, "</span>\n", 8);
+	}
+	if (rendered != NULL)
+	{
+		*rendered = i;
+	}
+	return next - out;
+}
+
+size_t atgc_html_flush(atgc_html* html, char* out, size_t capacity)
+{
+	if (capacity < atgc_html_pending_size(html))
+	{
+		return 0;
+	}
+	return writeHeld(html, out) - out;
+}
+
+size_t atgc_html_end(atgc_html* html, char* out, size_t capacity)
+{
+	if (capacity < ATGC_HTML_MAX_FRAME_SIZE + atgc_html_pending_size(html))
+	{
+		return 0;
+	}
+	char* next = writeHeld(html, out);
+	if (html->inTrace)
+	{
+		next = append(next, TRACE_CLOSE, sizeof(TRACE_CLOSE) - 1);
+		html->inTrace = false;
+	}
+	next = append(next, PAGE_TAIL, sizeof(PAGE_TAIL) - 1);
+	return next - out;
+}
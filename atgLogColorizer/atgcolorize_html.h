@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * optional HTML renderer for libatgcolorize. writes a log as one self-contained page that can be
+ * mailed around: a style sheet with a class per line type in the head, then the lines. the lines
+ * go in blocks of a few hundred the browser only lays out when they're scrolled to, so a page made
+ * from a 2 GB log still opens, and every stack trace is folded under its exception line, opened
+ * with a click.
+ *
+ * the renderer is streaming and keeps one line at a time: an exception line is held until the
+ * next line shows whether a trace follows it. like the ANSI renderer it writes into a caller-
+ * provided buffer
+ */
+
+#ifndef ATGCOLORIZE_HTML_H
+#define ATGCOLORIZE_HTML_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_html atgc_html;
+
+// the most bytes atgc_html_begin or atgc_html_end write, not counting atgc_html_pending_size
+#define ATGC_HTML_MAX_FRAME_SIZE 4096
+
+// title goes in the head of the page, cut if it's long
+ATGC_API atgc_html* atgc_html_create(const char* title);
+ATGC_API void atgc_html_destroy(atgc_html* html);
+
+// the head of the page and the style sheet
+ATGC_API size_t atgc_html_begin(atgc_html* html, char* out, size_t capacity);
+
+/*
+	renders lines[0..count) into out. rendering stops before the first line that doesn't fit in
+	capacity. *rendered is set to the number of lines taken and the number of bytes written is
+	returned. the last line may be held back, see atgc_html_flush
+*/
+ATGC_API size_t atgc_html_render_batch(atgc_html* html, const char* const* lines, const size_t* lengths, const int* types, size_t count, char* out, size_t capacity, size_t* rendered);
+
+// lets a held line out, eg. when the input goes quiet
+ATGC_API size_t atgc_html_flush(atgc_html* html, char* out, size_t capacity);
+
+// lets a held line out and closes the page
+ATGC_API size_t atgc_html_end(atgc_html* html, char* out, size_t capacity);
+
+/*
+	the most bytes atgc_html_render_batch can need for a single line of the given length, and
+	what the held line can add on top of that to the next render, flush or end
+*/
+ATGC_API size_t atgc_html_max_rendered_size(size_t length);
+ATGC_API size_t atgc_html_pending_size(const atgc_html* html);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_HTML_H
@@ -0,0 +1,398 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * pieces of libatgcolorize shared between its source files. nothing in here is part of the
+ * C API and it may change at any time
+ */
+
+#ifndef ATGCOLORIZE_INTERNAL_H
+#define ATGCOLORIZE_INTERNAL_H
+
+#include "atgcolorize.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <regex>
+
+// how a rule term is matched against the trimmed line
+const uint8_t MATCH_CONTAINS = 0;
+const uint8_t MATCH_PREFIX = 1;
+const uint8_t MATCH_SUFFIX = 2;
+const uint8_t MATCH_REGEX = 3;
+
+// a rule without an "after" condition matches whatever the previous line was
+const int ANY_LINE_TYPE = -1;
+
+const uint32_t NO_LITERAL = 0xffffffff;
+const uint32_t NO_REGEX = 0xffffffff;
+const uint32_t NO_RULE = 0xffffffff;
+
+/*
+	a rule as written in a rule file (or in the built-in table) before it gets compiled. every
+	term has to match for the rule to match
+*/
+struct RuleDefinition
+{
+	int lineType;
+	int previousLineType;
+	int priority;
+	std::vector<uint8_t> matches;
+	std::vector<std::string> texts;
+	std::string source; // file:line, for error messages
+};
+
+/*
+	built-in rules, one per message the SOP's of DAS, the deployment server and friends print.
+	text must be found according to match and, when alsoContains isn't NULL, the line must also
+	contain alsoContains
+*/
+struct BuiltinRule
+{
+	uint8_t match;
+	const char* text;
+	const char* alsoContains;
+};
+
+extern const BuiltinRule SOP_ERROR_RULES[];
+extern const size_t NUM_SOP_ERROR_RULES;
+
+/*
+	the compiled form of a rule set. every literal of every rule (built-in or user-defined) goes
+	into one Aho-Corasick automaton so a line is scanned once whatever the number of rules. all
+	of the tables use fixed-width integers and offsets rather than pointers
+*/
+struct CompiledState
+{
+	uint32_t edgeBegin; // edges of this state are edges[edgeBegin, next state's edgeBegin)
+	uint32_t fail; // where to continue when no edge matches
+	uint32_t literal; // literal ending at this state, NO_LITERAL if none
+	uint32_t outputLink; // closest state down the fail chain ending a literal, 0 if none
+};
+
+struct CompiledLiteral
+{
+	uint32_t length;
+	uint32_t textOffset; // into the text pool
+	uint32_t ruleBegin; // rules keyed on this literal are literalRules[ruleBegin, next literal's ruleBegin)
+};
+
+struct CompiledRule
+{
+	int32_t lineType;
+	int32_t previousLineType;
+	int32_t priority;
+	uint32_t termBegin; // terms of this rule are terms[termBegin, termEnd)
+	uint32_t termEnd;
+};
+
+struct CompiledTerm
+{
+	uint32_t literal; // for a regex, the literal every match has to contain, NO_LITERAL if none
+	uint32_t regex; // index into atgc_rules::regexes for MATCH_REGEX terms
+	uint32_t match;
+};
+
+/*
+	the tables the scanner reads. they point either into the vectors of a rule set compiled in
+	memory or straight into a mapped rule cache file (see atgcolorize_cache.cpp)
+*/
+struct RuleTables
+{
+	const CompiledState* states; // numStates entries plus the sentinel
+	const uint32_t* edges;
+	const uint32_t* rootNext;
+	const CompiledLiteral* literals; // numLiterals entries plus the sentinel
+	const uint32_t* literalRules;
+	const CompiledRule* rules;
+	const CompiledTerm* terms;
+	const uint32_t* alwaysCheckedRules;
+	const char* textPool;
+	const uint32_t* regexSourceOffsets;
+
+	uint32_t numStates;
+	uint32_t numEdges;
+	uint32_t numLiterals;
+	uint32_t numLiteralRules;
+	uint32_t numRules;
+	uint32_t numTerms;
+	uint32_t numAlwaysCheckedRules;
+	uint32_t textPoolSize;
+	uint32_t numRegexes;
+};
+
+// the vectors behind a rule set compiled in memory
+struct RuleStorage
+{
+	// automaton. states has a sentinel entry at the end, edges are (target << 8 | byte) sorted by byte
+	std::vector<CompiledState> states;
+	std::vector<uint32_t> edges;
+	std::vector<uint32_t> rootNext; // 256 entries, transitions out of the start state
+
+	std::vector<CompiledLiteral> literals; // with a sentinel entry at the end
+	std::vector<uint32_t> literalRules;
+	std::vector<CompiledRule> rules;
+	std::vector<CompiledTerm> terms;
+	std::vector<uint32_t> alwaysCheckedRules; // regex rules with no literal to wait for
+	std::vector<char> textPool; // literal texts and regex sources, each followed by a '\0'
+	std::vector<uint32_t> regexSourceOffsets; // into the text pool
+
+	// regexes can't live in a file, they're compiled again from their source when a cache is loaded
+	std::vector<std::regex> regexes;
+};
+
+/*
+	a rule set. it has no constructor or destructor of its own so the built-in one can be put
+	together at compile time (see atgcolorize_builtin.h); rule sets are freed with destroyRules
+*/
+struct atgc_rules
+{
+	RuleTables tables;
+	const std::regex* regexes; // tables.numRegexes of them
+
+	uint32_t numBuiltinRules;
+	bool hasPositiveRules;
+
+	RuleStorage* storage; // NULL for the built-in rule set and for the tables of a mapped cache
+
+	// the mapped cache file the tables point into, NULL otherwise
+	void* mapping;
+	size_t mappingLength;
+};
+
+// the state reached from state on byte c, or 0 if state has no such edge
+inline uint32_t findEdge(const RuleTables& tables, uint32_t state, uint8_t c)
+{
+	const uint32_t* edge = tables.edges + tables.states[state].edgeBegin;
+	const uint32_t* end = tables.edges + tables.states[state+1].edgeBegin;
+	for (; edge != end; ++edge)
+	{
+		uint8_t byte = (uint8_t) (*edge & 0xff);
+		if (byte == c)
+		{
+			return *edge >> 8;
+		}
+		if (byte > c)
+		{
+			break;
+		}
+	}
+	return 0;
+}
+
+// where the automaton goes from state on byte c, following the fail links until an edge matches
+inline uint32_t nextState(const RuleTables& tables, uint32_t state, uint8_t c)
+{
+	while (true)
+	{
+		if (state == 0)
+		{
+			return tables.rootNext[c];
+		}
+		uint32_t next = findEdge(tables, state, c);
+		if (next != 0)
+		{
+			return next;
+		}
+		state = tables.states[state].fail;
+	}
+}
+
+// an empty rule set along with its storage, for the tables to be filled in
+atgc_rules* createRules();
+
+// points the tables of rules at its storage, once the storage is filled
+void useStorageTables(atgc_rules* rules);
+
+void destroyRules(atgc_rules* rules);
+
+// appends the built-in rules to definitions
+void builtinDefinitions(std::vector<RuleDefinition>& definitions);
+
+// appends the rules of a rule file to definitions. returns false and sets error on failure
+bool parseRuleFile(const char* path, std::vector<RuleDefinition>& definitions, std::string& error);
+
+// compiles rule definitions (built-in rules first) into a rule set. returns NULL and sets error on failure
+atgc_rules* compileRules(const std::vector<RuleDefinition>& definitions, std::string& error);
+
+// the built-in rules on their own, put together at compile time
+const atgc_rules* builtinRules();
+
+// compiles the regexes of a rule set whose tables came from somewhere else. false if one doesn't compile
+bool compileRegexes(atgc_rules* rules);
+
+/*
+	the rule cache. a hash of everything a rule set is compiled from (the library version, the
+	built-in rules and the contents of the rule files) decides whether a cache file is still good
+*/
+uint64_t ruleSourceHash(const char* const* paths, size_t numPaths, bool& readable);
+atgc_rules* loadRuleCache(const char* cachePath, uint64_t sourceHash);
+void unmapRuleCache(atgc_rules* rules);
+bool saveRuleCache(const atgc_rules* rules, const char* cachePath, uint64_t sourceHash);
+
+/*
+	the winning rule for each priority band, NO_RULE when no rule matched. rules with a positive
+	priority are checked before the built-in single line checks, rules with priority 0 where the
+	built-in SOP messages are checked and negative ones only instead of OTHER_LINE. within a band
+	the highest priority wins and ties go to the rule defined first
+*/
+struct RuleMatch
+{
+	uint32_t positive;
+	uint32_t zero;
+	uint32_t negative;
+};
+
+// per-stream scratch space so several streams can share one rule set
+class RuleScanner
+{
+	public:
+		RuleScanner() : stamp(0) {}
+		RuleMatch scan(const atgc_rules& rules, const std::string& trimmedLine, int previousLineType);
+
+	private:
+		std::vector<uint32_t> literalStamps;
+		std::vector<uint8_t> literalHits;
+		std::vector<uint32_t> hitLiterals;
+		uint32_t stamp;
+
+		void evaluate(const atgc_rules& rules, uint32_t rule, const std::string& trimmedLine, int previousLineType, RuleMatch& match);
+};
+
+// the lines a thread dump starts and ends with, see atgcolorize.cpp
+bool isThreadDumpStart(const char* trimmedLine, size_t length);
+bool isThreadDumpEnd(const char* trimmedLine, size_t length);
+
+// the lines a failed SQL statement block starts and ends with, see atgcolorize.cpp. kinds are Insert, Update, Delete and Select
+int failedSQLStart(const char* line, size_t length, const char** marker);
+bool isFailedSQLEnd(const char* line, size_t length);
+const char* failedSQLKindName(int kind);
+
+// pieces of stack traces, see atgcolorize_fold.cpp
+const char* findText(const char* line, size_t length, const char* text, size_t textLength);
+const char* findFrame(const char* line, size_t length, size_t& frameLength);
+const char* findExceptionClass(const char* line, size_t length, size_t& classLength);
+bool isMoreLine(const char* line, size_t length);
+
+// the frames, causes and "... n more" lines that follow the line a trace starts with
+inline bool isTraceLine(const char* line, size_t length)
+{
+	size_t frameLength = 0;
+	return findFrame(line, length, frameLength) != NULL || findText(line, length, "Caused by: ", 11) != NULL || isMoreLine(line, length);
+}
+
+/*
+	the monitor lines between the frames of a thread dump, like "- locked <0x...> (a ...)". they
+	belong to the stack they're in, but don't start one: the frames after one aren't its trace
+*/
+inline bool isMonitorLine(const char* line, size_t length)
+{
+	size_t i = 0;
+	while (i < length && (line[i] == ' ' || line[i] == '\t'))
+	{
+		i++;
+	}
+	return length - i > 3 && line[i] == '-' && line[i + 1] == ' ' && memchr(line + i, '<', length - i) != NULL;
+}
+
+inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// FNV-1a, 64 bit for the hash tables of the modules and the rule cache, 32 bit where a table keeps 32 bit hashes
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+const uint32_t FNV32_OFFSET_BASIS = 2166136261U;
+const uint32_t FNV32_PRIME = 16777619U;
+
+inline uint64_t hashBytes(uint64_t hash, const void* bytes, size_t length)
+{
+	const uint8_t* b = (const uint8_t*) bytes;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ b[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+inline uint32_t hashBytes32(uint32_t hash, const void* bytes, size_t length)
+{
+	const uint8_t* b = (const uint8_t*) bytes;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ b[i]) * FNV32_PRIME;
+	}
+	return hash;
+}
+
+// the time a line was logged at, as written in the log. see atgcolorize_report.cpp
+const char* findTimestamp(const char* line, size_t length, size_t& timestampLength);
+
+// the parts of a line header that are there, NULL for the others. see atgcolorize_stats.cpp
+struct LineFields
+{
+	const char* timestamp;
+	size_t timestampLength;
+	const char* level;
+	size_t levelLength;
+	const char* category;
+	size_t categoryLength;
+	const char* thread;
+	size_t threadLength;
+};
+
+void findLineFields(const char* line, size_t length, LineFields& fields);
+
+// room for more entries, grown the way push_back grows it, so the push_backs after it can't throw
+template <class T>
+inline void makeRoom(std::vector<T>& entries, size_t more)
+{
+	if (entries.size() + more > entries.capacity())
+	{
+		entries.reserve(entries.size() + more > entries.capacity() * 2 ? entries.size() + more : entries.capacity() * 2);
+	}
+}
+
+/*
+	strings kept once each and known by a number from then on, for the keys of the statistics and
+	the like. see atgcolorize_stats.cpp
+*/
+struct StringTable
+{
+	std::vector<char> text; // every string, '\0' terminated
+	std::vector<uint32_t> offsets; // where each string starts in text
+	std::vector<uint32_t> hashes;
+	std::vector<uint32_t> slots; // string number + 1, 0 for an empty slot
+};
+
+// interns a string. when memory runs out bad_alloc is thrown and the table is left as it was
+uint32_t internString(StringTable& table, const char* text, size_t length);
+
+inline const char* internedText(const StringTable& table, uint32_t id)
+{
+	return &table.text[table.offsets[id]];
+}
+
+#endif // ATGCOLORIZE_INTERNAL_H
@@ -0,0 +1,282 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * NDJSON renderer for libatgcolorize. see atgcolorize_json.h
+ *
+ * the header fields are pieces of the line found by findLineFields, so nothing is copied before
+ * it's escaped straight into the output. escaping looks at 16 bytes at a time where SSE2 is
+ * there: the bytes are stored as they are and the output only moves past the ones before the
+ * first quote, backslash, control character or byte of 0x80 and up, which is then written
+ * escaped. log lines rarely have any, so most of a line goes out 16 bytes per step. a byte of
+ * 0x80 and up starts a UTF-8 sequence that is copied whole when it's valid; otherwise the byte
+ * is Latin-1, as in the cp1252 logs of ATG on Windows, and goes out as \u00XX
+ */
+
+#include "atgcolorize_json.h"
+#include "atgcolorize_internal.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// the fixed parts of an object, without the field values
+static const size_t MAX_OBJECT_OVERHEAD = 128;
+
+// escaping may write this many bytes past the end of what it escapes
+static const size_t ESCAPE_SLACK = 16;
+
+// an escaped byte takes at most 6 (\u001f)
+static const size_t MAX_ESCAPED_LENGTH = 6;
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static const char* lineTypeName(int lineType)
+{
+	switch (lineType)
+	{
+		case ATGC_INFO_LINE:
+			return "info";
+		case ATGC_WARNING_LINE:
+			return "warning";
+		case ATGC_DEBUG_LINE:
+			return "debug";
+		case ATGC_ERROR_LINE:
+			return "error";
+		case ATGC_NUCLEUS_LINE:
+			return "nucleus";
+		case ATGC_OTHER_LINE:
+			return "other";
+	}
+	return "blank";
+}
+
+static const char* serverName(int serverType)
+{
+	switch (serverType)
+	{
+		case ATGC_SERVER_JBOSS:
+			return "jboss";
+		case ATGC_SERVER_WEBSPHERE:
+			return "websphere";
+		case ATGC_SERVER_WEBLOGIC:
+			return "weblogic";
+	}
+	return "unknown";
+}
+
+static char* escapeByte(char* out, char c)
+{
+	*out++ = '\\';
+	switch (c)
+	{
+		case '"':
+		case '\\':
+			*out++ = c;
+			break;
+		case '\n':
+			*out++ = 'n';
+			break;
+		case '\r':
+			*out++ = 'r';
+			break;
+		case '\t':
+			*out++ = 't';
+			break;
+		default:
+			*out++ = 'u';
+			*out++ = '0';
+			*out++ = '0';
+			*out++ = HEX_DIGITS[((unsigned char) c) >> 4];
+			*out++ = HEX_DIGITS[c & 0xF];
+			break;
+	}
+	return out;
+}
+
+static bool needsEscape(char c)
+{
+	return (unsigned char) c < 0x20 || c == '"' || c == '\\';
+}
+
+static bool isContinuation(const char* text, const char* end, unsigned char low, unsigned char high)
+{
+	return text < end && (unsigned char) *text >= low && (unsigned char) *text <= high;
+}
+
+// length of the valid UTF-8 sequence text starts, 0 when it isn't one
+static size_t utf8Length(const char* text, const char* end)
+{
+	unsigned char lead = (unsigned char) *text;
+	if (lead >= 0xC2 && lead <= 0xDF)
+	{
+		return isContinuation(text + 1, end, 0x80, 0xBF) ? 2 : 0;
+	}
+	if (lead >= 0xE0 && lead <= 0xEF)
+	{
+		// no overlong forms and no surrogates
+		unsigned char low = (lead == 0xE0 ? 0xA0 : 0x80);
+		unsigned char high = (lead == 0xED ? 0x9F : 0xBF);
+		return isContinuation(text + 1, end, low, high) && isContinuation(text + 2, end, 0x80, 0xBF) ? 3 : 0;
+	}
+	if (lead >= 0xF0 && lead <= 0xF4)
+	{
+		// nothing past U+10FFFF
+		unsigned char low = (lead == 0xF0 ? 0x90 : 0x80);
+		unsigned char high = (lead == 0xF4 ? 0x8F : 0xBF);
+		return isContinuation(text + 1, end, low, high) && isContinuation(text + 2, end, 0x80, 0xBF)
+			&& isContinuation(text + 3, end, 0x80, 0xBF) ? 4 : 0;
+	}
+	return 0;
+}
+
+// writes the UTF-8 sequence text starts as it is, or its first byte as Latin-1 when it isn't valid UTF-8
+static char* escapeHigh(char* out, const char*& text, const char* end)
+{
+	size_t length = utf8Length(text, end);
+	if (length == 0)
+	{
+		out = escapeByte(out, *text++);
+		return out;
+	}
+	memcpy(out, text, length);
+	text += length;
+	return out + length;
+}
+
+// writes text as the inside of a JSON string, may write up to ESCAPE_SLACK bytes past what it returns
+static char* escape(char* out, const char* text, size_t length)
+{
+	const char* end = text + length;
+#ifdef __SSE2__
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i lastControl = _mm_set1_epi8(0x1F);
+	while (end - text >= 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*) text);
+		_mm_storeu_si128((__m128i*) out, bytes);
+		__m128i control = _mm_cmpeq_epi8(_mm_max_epu8(bytes, lastControl), lastControl);
+		__m128i special = _mm_or_si128(control, _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)));
+
+		// the top bit is set for the bytes of 0x80 and up
+		unsigned int mask = (unsigned int) (_mm_movemask_epi8(special) | _mm_movemask_epi8(bytes));
+		if (mask == 0)
+		{
+			text += 16;
+			out += 16;
+			continue;
+		}
+		unsigned int plain = (unsigned int) __builtin_ctz(mask);
+		text += plain;
+		out += plain;
+		if ((unsigned char) *text >= 0x80)
+		{
+			out = escapeHigh(out, text, end);
+		}
+		else
+		{
+			out = escapeByte(out, *text++);
+		}
+	}
+#endif
+	while (text < end)
+	{
+		if ((unsigned char) *text >= 0x80)
+		{
+			out = escapeHigh(out, text, end);
+		}
+		else if (needsEscape(*text))
+		{
+			out = escapeByte(out, *text++);
+		}
+		else
+		{
+			*out++ = *text++;
+		}
+	}
+	return out;
+}
+
+static char* append(char* out, const char* text, size_t length)
+{
+	memcpy(out, text, length);
+	return out + length;
+}
+
+// ,"name":"value" for a field the line has
+static char* appendField(char* out, const char* name, size_t nameLength, const char* value, size_t valueLength)
+{
+	if (value == NULL)
+	{
+		return out;
+	}
+	out = append(out, name, nameLength);
+	out = escape(out, value, valueLength);
+	*out++ = '"';
+	return out;
+}
+
+size_t atgc_json_max_rendered_size(size_t length)
+{
+	// the header fields are separate pieces of the line, and the whole line again as the message
+	return MAX_OBJECT_OVERHEAD + 2 * length * MAX_ESCAPED_LENGTH + ESCAPE_SLACK;
+}
+
+size_t atgc_json_render_batch(const char* const* lines, const size_t* lengths, const int* types, size_t count, int serverType, char* out, size_t capacity, size_t* rendered)
+{
+	const char* server = serverName(serverType);
+	size_t serverLength = strlen(server);
+	char* next = out;
+	size_t i = 0;
+	for (; i < count; i++)
+	{
+		if ((size_t) (next - out) + atgc_json_max_rendered_size(lengths[i]) > capacity)
+		{
+			break;
+		}
+		LineFields fields;
+		findLineFields(lines[i], lengths[i], fields);
+
+		*next++ = '{';
+		if (fields.timestamp != NULL)
+		{
+			next = append(next, "\"time\":\"", 8);
+			next = escape(next, fields.timestamp, fields.timestampLength);
+			next = append(next, "\",", 2);
+		}
+		next = append(next, "\"server\":\"", 10);
+		next = append(next, server, serverLength);
+		next = append(next, "\",\"type\":\"", 10);
+		const char* type = lineTypeName(types[i]);
+		next = append(next, type, strlen(type));
+		*next++ = '"';
+		next = appendField(next, ",\"level\":\"", 10, fields.level, fields.levelLength);
+		next = appendField(next, ",\"category\":\"", 13, fields.category, fields.categoryLength);
+		next = appendField(next, ",\"thread\":\"", 11, fields.thread, fields.threadLength);
+		next = append(next, ",\"message\":\"", 12);
+		next = escape(next, lines[i], lengths[i]);
+		next = append(next, "\"}\n", 3);
+	}
+	if (rendered != NULL)
+	{
+		*rendered = i;
+	}
+	return next - out;
+}
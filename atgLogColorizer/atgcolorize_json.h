@@ -0,0 +1,55 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * optional NDJSON renderer for libatgcolorize. writes each line as one JSON object on a line of
+ * its own, into a caller-provided buffer like the ANSI renderer, for tools that want the line
+ * type and header without parsing the log again:
+ *
+ *		{"time":"2008-04-14 10:05:01,320","server":"jboss","type":"error","level":"ERROR",
+ *		 "category":"OrderManager","thread":"http-8080-1","message":"2008-04-14 10:05:01,320 ERROR ..."}
+ *
+ * time, level, category and thread are left out when the line doesn't have them. message is
+ * the whole line as it was read. UTF-8 is copied as it is, and any byte that isn't part of valid
+ * UTF-8 is taken as Latin-1 and written as \u00XX, so a cp1252 log still gives valid JSON
+ */
+
+#ifndef ATGCOLORIZE_JSON_H
+#define ATGCOLORIZE_JSON_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	renders lines[0..count) into out, one object and a newline per line. serverType is one of
+	the ATGC_SERVER_* constants, usually atgc_server_type of the stream that classified the lines.
+	rendering stops before the first line that doesn't fit in capacity. *rendered is set to the
+	number of lines written and the number of bytes written is returned
+*/
+ATGC_API size_t atgc_json_render_batch(const char* const* lines, const size_t* lengths, const int* types, size_t count, int serverType, char* out, size_t capacity, size_t* rendered);
+
+// the most bytes atgc_json_render_batch can need for a single line of the given length
+ATGC_API size_t atgc_json_max_rendered_size(size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_JSON_H
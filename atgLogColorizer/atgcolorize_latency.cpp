@@ -0,0 +1,139 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * latency histogram. see atgcolorize_latency.h
+ *
+ * values below 128 each have a count of their own. above that, each power of two is split into 64
+ * ranges, so a range is never wider than 1/64th of the values in it: a value keeps its top 7 bits
+ * and loses the rest
+ */
+
+#include "atgcolorize_latency.h"
+
+#include <math.h>
+#include <string.h>
+#include <new>
+
+using namespace std;
+
+// bits of a value that are kept
+const int SUB_BUCKET_BITS = 7;
+const unsigned long long SUB_BUCKET_HALF = 1ULL << (SUB_BUCKET_BITS - 1);
+
+// a 64 bit value is shifted by 57 at most
+const size_t NUM_COUNTS = (64 - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF;
+
+struct atgc_latency
+{
+	unsigned long long counts[NUM_COUNTS];
+	unsigned long long total;
+	unsigned long long max;
+};
+
+// the position of the highest bit set in value, which isn't 0
+static int highestBit(unsigned long long value)
+{
+#ifdef __GNUC__
+	return 63 - __builtin_clzll(value);
+#else
+	int bit = 0;
+	while (value >>= 1)
+	{
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+static size_t countIndex(unsigned long long value)
+{
+	if (value < 2 * SUB_BUCKET_HALF)
+	{
+		return (size_t) value;
+	}
+	int shift = highestBit(value) - SUB_BUCKET_BITS + 1;
+	return (size_t) ((shift + 1) * SUB_BUCKET_HALF + ((value >> shift) - SUB_BUCKET_HALF));
+}
+
+// the biggest value that goes in the count at index
+static unsigned long long highestValue(size_t index)
+{
+	if (index < 2 * SUB_BUCKET_HALF)
+	{
+		return index;
+	}
+	int shift = (int) (index / SUB_BUCKET_HALF) - 1;
+	unsigned long long subBucket = index % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+	return ((subBucket + 1) << shift) - 1;
+}
+
+atgc_latency* atgc_latency_create(void)
+{
+	atgc_latency* latency = new (nothrow) atgc_latency;
+	if (latency != NULL)
+	{
+		memset(latency, 0, sizeof(atgc_latency));
+	}
+	return latency;
+}
+
+void atgc_latency_destroy(atgc_latency* latency)
+{
+	delete latency;
+}
+
+void atgc_latency_record(atgc_latency* latency, unsigned long long nanoseconds, unsigned long long count)
+{
+	latency->counts[countIndex(nanoseconds)] += count;
+	latency->total += count;
+	if (nanoseconds > latency->max && count > 0)
+	{
+		latency->max = nanoseconds;
+	}
+}
+
+unsigned long long atgc_latency_percentile(const atgc_latency* latency, double percentile)
+{
+	if (latency->total == 0)
+	{
+		return 0;
+	}
+	unsigned long long wanted = (unsigned long long) ceil(percentile / 100.0 * latency->total);
+	wanted = (wanted == 0 ? 1 : wanted);
+	unsigned long long seen = 0;
+	for (size_t i = 0; i < NUM_COUNTS; i++)
+	{
+		seen += latency->counts[i];
+		if (seen >= wanted)
+		{
+			unsigned long long value = highestValue(i);
+			return (value < latency->max ? value : latency->max);
+		}
+	}
+	return latency->max;
+}
+
+unsigned long long atgc_latency_count(const atgc_latency* latency)
+{
+	return latency->total;
+}
+
+unsigned long long atgc_latency_max(const atgc_latency* latency)
+{
+	return latency->max;
+}
@@ -0,0 +1,56 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * latency histogram for libatgcolorize, an HDR histogram: a count per range of values, the
+ * ranges getting wider the bigger the values so that every value is known to within 2% whether
+ * it's 800 nanoseconds or 3 seconds. recording a value is a couple of shifts and an increment,
+ * and the histogram stays the same size (30KB) however many values go in
+ */
+
+#ifndef ATGCOLORIZE_LATENCY_H
+#define ATGCOLORIZE_LATENCY_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_latency atgc_latency;
+
+ATGC_API atgc_latency* atgc_latency_create(void);
+ATGC_API void atgc_latency_destroy(atgc_latency* latency);
+
+// records count values of nanoseconds each, eg. every line of a batch that took that long
+ATGC_API void atgc_latency_record(atgc_latency* latency, unsigned long long nanoseconds, unsigned long long count);
+
+/*
+	the value percentile percent of the values recorded are at or below, 0 to 100. it's the top
+	of the range the value falls in, so it can be up to 2% too high but never too low
+*/
+ATGC_API unsigned long long atgc_latency_percentile(const atgc_latency* latency, double percentile);
+
+// how many values were recorded, and the biggest one as it was recorded
+ATGC_API unsigned long long atgc_latency_count(const atgc_latency* latency);
+ATGC_API unsigned long long atgc_latency_max(const atgc_latency* latency);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_LATENCY_H
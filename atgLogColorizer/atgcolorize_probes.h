@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * static probes (USDT) for libatgcolorize and the colorizer, for tracing a running colorizer
+ * with bpftrace or systemtap without rebuilding it:
+ *
+ *		bpftrace -e 'usdt:./ATGLogColorizer:atgcolorize:classify /arg2 > 100000/ { @slow[arg0, arg1] = count(); }' -p [pid]
+ *
+ * a probe is a nop in the code plus a .note.stapsdt entry saying where the nop is and where its
+ * arguments are, the same format <sys/sdt.h> writes (version 3), written out here so building
+ * doesn't need the systemtap headers. each probe has a semaphore the tracer increments while it's
+ * attached; work done only for a probe, like reading the clock, is skipped while it's 0:
+ *
+ *		if (ATGC_PROBE_ENABLED(classify))
+ *
+ * the probes, all in the atgcolorize provider:
+ *
+ *		line_read(length)						a line was cut out of the input
+ *		classify(type, rule, ns)				a line was classified. rule is the rule that decided it, -1 for none
+ *		state_change(before, after)				the ATGC_STATE_ bits of the stream changed with a line
+ *		batch_flush(bytes)						colored lines were written out
+ *		backpressure(stream, queued, stopped)	a --daemon stream stopped (1) or started again (0) being read
+ *												because its client doesn't take its output fast enough
+ *
+ * arguments are integers. on anything but linux on x86-64 with gcc or clang, or with
+ * ATGC_NO_PROBES defined, the probes compile to nothing
+ */
+
+#ifndef ATGCOLORIZE_PROBES_H
+#define ATGCOLORIZE_PROBES_H
+
+#if defined(__linux__) && defined(__x86_64__) && defined(__GNUC__) && !defined(ATGC_NO_PROBES)
+
+#include <time.h>
+
+// the semaphore of a probe, defined once in the source file the probe is in
+#define ATGC_PROBE_SEMAPHORE(name) volatile unsigned short atgcolorize_##name##_semaphore __attribute__((section(".probes"), used))
+
+#define ATGC_PROBE_ENABLED(name) __builtin_expect(atgcolorize_##name##_semaphore != 0, 0)
+
+// the argument's size in bytes, negative when it's signed
+#define ATGC_PROBE_ARG(n, x) [size##n] "n" ((((__typeof__(x)) -1) < 1 ? 1 : -1) * (int) sizeof(x)), [arg##n] "nor" (x)
+
+#define ATGC_PROBE_NOTE(name, args) \
+	"990:	nop\n" \
+	".pushsection .note.stapsdt, \"?\", \"note\"\n" \
+	".balign 4\n" \
+	".4byte 992f-991f, 994f-993f, 3\n" \
+	"991:	.asciz \"stapsdt\"\n" \
+	"992:	.balign 4\n" \
+	"993:	.8byte 990b\n" \
+	".8byte _.stapsdt.base\n" \
+	".8byte atgcolorize_" #name "_semaphore\n" \
+	".asciz \"atgcolorize\"\n" \
+	".asciz \"" #name "\"\n" \
+	".asciz \"" args "\"\n" \
+	"994:	.balign 4\n" \
+	".popsection\n" \
+	".ifndef _.stapsdt.base\n" \
+	".pushsection .stapsdt.base, \"aG\", \"progbits\", .stapsdt.base, comdat\n" \
+	".weak _.stapsdt.base\n" \
+	".hidden _.stapsdt.base\n" \
+	"_.stapsdt.base: .space 1\n" \
+	".size _.stapsdt.base, 1\n" \
+	".popsection\n" \
+	".endif\n"
+
+#define ATGC_PROBE1(name, a1) \
+	__asm__ __volatile__ (ATGC_PROBE_NOTE(name, "%n[size1]@%[arg1]") :: ATGC_PROBE_ARG(1, a1))
+#define ATGC_PROBE2(name, a1, a2) \
+	__asm__ __volatile__ (ATGC_PROBE_NOTE(name, "%n[size1]@%[arg1] %n[size2]@%[arg2]") :: ATGC_PROBE_ARG(1, a1), ATGC_PROBE_ARG(2, a2))
+#define ATGC_PROBE3(name, a1, a2, a3) \
+	__asm__ __volatile__ (ATGC_PROBE_NOTE(name, "%n[size1]@%[arg1] %n[size2]@%[arg2] %n[size3]@%[arg3]") \
+		:: ATGC_PROBE_ARG(1, a1), ATGC_PROBE_ARG(2, a2), ATGC_PROBE_ARG(3, a3))
+
+// a clock for the time a probe reports, only read while the probe is enabled
+static inline unsigned long long atgc_probe_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+#else
+
+#define ATGC_PROBE_SEMAPHORE(name) extern int atgcolorize_no_##name##_semaphore
+#define ATGC_PROBE_ENABLED(name) 0
+#define ATGC_PROBE1(name, a1) do { } while (0)
+#define ATGC_PROBE2(name, a1, a2) do { } while (0)
+#define ATGC_PROBE3(name, a1, a2, a3) do { } while (0)
+
+static inline unsigned long long atgc_probe_ns(void)
+{
+	return 0;
+}
+
+#endif
+
+#endif // ATGCOLORIZE_PROBES_H
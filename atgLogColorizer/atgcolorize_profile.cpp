@@ -0,0 +1,263 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * stack profile. see atgcolorize_profile.h
+ *
+ * frames are interned in a StringTable. a stack is the run of its frame numbers in one pool,
+ * found again through an open addressing table on the hash of those numbers, so a stack seen in
+ * a hundred dumps is stored once with a count of a hundred. the self and total counts of the
+ * frames are kept up as threads come in; a frame that shows up more than once on a stack (a
+ * recursive call) only counts once towards its total, which a stamp per frame takes care of
+ */
+
+#include "atgcolorize_profile.h"
+#include "atgcolorize_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+// a stack deeper than this is cut at the outer end, the part that says least
+const size_t MAX_STACK_DEPTH = 1024;
+
+struct ProfiledStack
+{
+	uint32_t begin; // in the frame pool
+	uint32_t depth;
+	uint32_t hash;
+	unsigned long long count;
+};
+
+struct FrameCounts
+{
+	unsigned long long self;
+	unsigned long long total;
+	unsigned long long stamp; // the last sample that counted towards total
+};
+
+struct atgc_profile
+{
+	StringTable frames;
+	vector<FrameCounts> counts;
+	vector<uint32_t> pool; // the frames of every stack, innermost first
+	vector<ProfiledStack> stacks;
+	vector<uint32_t> slots; // stack number + 1, 0 for an empty slot
+	unsigned long long samples;
+	vector<uint32_t> stack; // scratch for the thread being added
+};
+
+// the frame without the source line: "atg.service.cache.Cache.get(Cache.java:412)" -> atg.service.cache.Cache.get
+static size_t methodLength(const char* frame)
+{
+	const char* open = strchr(frame, '(');
+	return (open != NULL ? open - frame : strlen(frame));
+}
+
+// 32 bit FNV-1a, over the frame numbers rather than their bytes
+static uint32_t hashStack(const uint32_t* frames, size_t depth)
+{
+	uint32_t hash = FNV32_OFFSET_BASIS;
+	for (size_t i = 0; i < depth; i++)
+	{
+		hash = (hash ^ frames[i]) * FNV32_PRIME;
+	}
+	return hash;
+}
+
+static void growSlots(atgc_profile* profile)
+{
+	if (!profile->slots.empty() && profile->stacks.size() * 2 < profile->slots.size())
+	{
+		return;
+	}
+	vector<uint32_t> grown(profile->slots.empty() ? 256 : profile->slots.size() * 2, 0);
+	size_t mask = grown.size() - 1;
+	for (uint32_t s = 0; s < profile->stacks.size(); s++)
+	{
+		size_t slot = profile->stacks[s].hash & mask;
+		while (grown[slot] != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		grown[slot] = s + 1;
+	}
+	profile->slots.swap(grown);
+}
+
+atgc_profile* atgc_profile_create(void)
+{
+	atgc_profile* profile = new (nothrow) atgc_profile();
+	if (profile == NULL)
+	{
+		return NULL;
+	}
+	profile->samples = 0;
+	try
+	{
+		growSlots(profile);
+	}
+	catch (const bad_alloc&)
+	{
+		delete profile;
+		return NULL;
+	}
+	return profile;
+}
+
+void atgc_profile_destroy(atgc_profile* profile)
+{
+	delete profile;
+}
+
+static void addStack(atgc_profile* profile, const atgc_dump_thread* thread)
+{
+	profile->samples++;
+
+	size_t depth = min(thread->numFrames, MAX_STACK_DEPTH);
+	profile->stack.resize(depth);
+	for (size_t i = 0; i < depth; i++)
+	{
+		uint32_t frame = internString(profile->frames, thread->frames[i], methodLength(thread->frames[i]));
+		if (frame >= profile->counts.size())
+		{
+			FrameCounts zero = { 0, 0, 0 };
+			profile->counts.resize(frame + 1, zero);
+		}
+		FrameCounts& counts = profile->counts[frame];
+		if (counts.stamp != profile->samples)
+		{
+			counts.stamp = profile->samples;
+			counts.total++;
+		}
+		profile->stack[i] = frame;
+	}
+	profile->counts[profile->stack[0]].self++;
+
+	uint32_t hash = hashStack(&profile->stack[0], depth);
+	size_t mask = profile->slots.size() - 1;
+	size_t slot = hash & mask;
+	while (profile->slots[slot] != 0)
+	{
+		ProfiledStack& stack = profile->stacks[profile->slots[slot] - 1];
+		if (stack.hash == hash && stack.depth == depth && memcmp(&profile->pool[stack.begin], &profile->stack[0], depth * sizeof(uint32_t)) == 0)
+		{
+			stack.count++;
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	ProfiledStack stack;
+	stack.begin = (uint32_t) profile->pool.size();
+	stack.depth = (uint32_t) depth;
+	stack.hash = hash;
+	stack.count = 1;
+	profile->pool.insert(profile->pool.end(), profile->stack.begin(), profile->stack.end());
+	profile->stacks.push_back(stack);
+	profile->slots[slot] = (uint32_t) profile->stacks.size();
+	growSlots(profile);
+}
+
+void atgc_profile_add_thread(void* context, const atgc_dump_thread* thread)
+{
+	atgc_profile* profile = (atgc_profile*) context;
+	if (thread->state != ATGC_THREAD_RUNNABLE || thread->numFrames == 0)
+	{
+		return;
+	}
+	try
+	{
+		addStack(profile, thread);
+	}
+	catch (const bad_alloc&)
+	{
+		// the sample counts for the frames it got through, its stack is left out
+	}
+}
+
+unsigned long long atgc_profile_samples(const atgc_profile* profile)
+{
+	return profile->samples;
+}
+
+void atgc_profile_folded(const atgc_profile* profile, atgc_profile_emit emit, void* context)
+{
+	string line;
+	try
+	{
+		for (size_t s = 0; s < profile->stacks.size(); s++)
+		{
+			const ProfiledStack& stack = profile->stacks[s];
+			line.clear();
+			for (uint32_t i = stack.depth; i > 0; i--)
+			{
+				line += internedText(profile->frames, profile->pool[stack.begin + i - 1]);
+				line += (i > 1 ? ';' : ' ');
+			}
+			char count[32];
+			snprintf(count, sizeof(count), "%llu", stack.count);
+			line += count;
+			emit(context, line.data(), line.size());
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		// the stacks emitted so far are all there is
+	}
+}
+
+struct MoreSelf
+{
+	const atgc_profile* profile;
+	bool operator()(uint32_t a, uint32_t b) const
+	{
+		const FrameCounts& first = profile->counts[a];
+		const FrameCounts& second = profile->counts[b];
+		return first.self > second.self || (first.self == second.self && first.total > second.total);
+	}
+};
+
+size_t atgc_profile_top_frames(const atgc_profile* profile, atgc_profile_frame* top, size_t n)
+{
+	vector<uint32_t> order;
+	try
+	{
+		order.resize(profile->counts.size());
+	}
+	catch (const bad_alloc&)
+	{
+		return 0;
+	}
+	for (uint32_t f = 0; f < order.size(); f++)
+	{
+		order[f] = f;
+	}
+	n = min(n, order.size());
+	MoreSelf moreSelf = { profile };
+	partial_sort(order.begin(), order.begin() + n, order.end(), moreSelf);
+	for (size_t i = 0; i < n; i++)
+	{
+		top[i].frame = internedText(profile->frames, order[i]);
+		top[i].self = profile->counts[order[i]].self;
+		top[i].total = profile->counts[order[i]].total;
+	}
+	return n;
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * stack profile for libatgcolorize, the poor man's profiler: thread dumps taken every few seconds
+ * while a node is under load show where its threads spend their time. the profile adds up the
+ * stacks of the RUNNABLE threads of every dump it's given, the way the thread dump analyzer
+ * reads them (atgcolorize_threads.h), and gives them back as folded stacks for flamegraph.pl:
+ *
+ *		java.lang.Thread.run;atg.servlet.pipeline.HeadPipelineServlet.service;atg.service.cache.Cache.get 42
+ *
+ * and as a table of the frames threads were seen running in most. frames are kept once each
+ * and a stack as the numbers of its frames, so memory grows with the number of different stacks,
+ * not with the number of dumps
+ */
+
+#ifndef ATGCOLORIZE_PROFILE_H
+#define ATGCOLORIZE_PROFILE_H
+
+#include "atgcolorize.h"
+#include "atgcolorize_threads.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_profile atgc_profile;
+
+typedef struct atgc_profile_frame
+{
+	const char* frame; // class and method, without the source line
+	unsigned long long self; // threads running in the frame itself
+	unsigned long long total; // threads with the frame anywhere on their stack
+} atgc_profile_frame;
+
+// called for each folded stack, a line with no trailing newline, only valid during the call
+typedef void (*atgc_profile_emit)(void* context, const char* line, size_t length);
+
+ATGC_API atgc_profile* atgc_profile_create(void);
+ATGC_API void atgc_profile_destroy(atgc_profile* profile);
+
+/*
+	adds a thread to the profile, skipped unless it's RUNNABLE. made to be handed to
+	atgc_thread_dumps_on_thread with the profile as the context. when memory runs out the thread
+	counts for the frames it got through but its stack is left out
+*/
+ATGC_API void atgc_profile_add_thread(void* profile, const atgc_dump_thread* thread);
+
+// threads added so far
+ATGC_API unsigned long long atgc_profile_samples(const atgc_profile* profile);
+
+// every different stack as "outermost;...;innermost count"
+ATGC_API void atgc_profile_folded(const atgc_profile* profile, atgc_profile_emit emit, void* context);
+
+/*
+	writes up to n of the frames with the most threads running in them into top, most first,
+	and returns how many were written. the strings stay valid until the profile is destroyed
+*/
+ATGC_API size_t atgc_profile_top_frames(const atgc_profile* profile, atgc_profile_frame* top, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_PROFILE_H
@@ -0,0 +1,434 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * exception report. see atgcolorize_report.h
+ *
+ * the counters are a fixed array. a hash table (linear probing, deleted entries shifted back so
+ * there are no tombstones) finds the counter of an exception and a binary heap on the counts
+ * finds the smallest one, the one a new exception takes over once every counter is in use. so
+ * a line costs a hash, a lookup and a heap fix-up, and nothing is allocated after create
+ */
+
+#include "atgcolorize_report.h"
+#include "atgcolorize_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+const size_t DEFAULT_CAPACITY = 1024;
+const size_t MAX_CAPACITY = 1 << 20;
+
+// longer exception templates and timestamps are cut
+const size_t MAX_EXCEPTION_LENGTH = 200;
+const size_t MAX_TIMESTAMP_LENGTH = 40;
+
+// how far into a line a timestamp is looked for
+const size_t TIMESTAMP_SEARCH_LENGTH = 64;
+
+const char NUMBER_PLACEHOLDER = '#';
+
+
+struct ExceptionCounter
+{
+	uint64_t hash;
+	unsigned long long count;
+	unsigned long long overcount;
+	size_t heapIndex;
+	char exception[MAX_EXCEPTION_LENGTH + 1];
+	char firstSeen[MAX_TIMESTAMP_LENGTH + 1];
+	char lastSeen[MAX_TIMESTAMP_LENGTH + 1];
+};
+
+struct atgc_exception_report
+{
+	vector<ExceptionCounter> counters;
+	size_t used;
+	vector<size_t> heap; // counter indexes, smallest count first
+	vector<size_t> slots; // counter index + 1, 0 for an empty slot
+	size_t slotMask;
+	unsigned long long total;
+
+	char timestamp[MAX_TIMESTAMP_LENGTH + 1]; // the last one seen on any line
+	unsigned long long lineNumber;
+
+	char exception[MAX_EXCEPTION_LENGTH + 1]; // scratch for the line being counted
+	vector<size_t> order; // scratch for atgc_exceptions_top
+};
+
+static bool isWordChar(char c)
+{
+	return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static void copyText(char* to, size_t capacity, const char* from, size_t length)
+{
+	length = (length < capacity ? length : capacity);
+	memcpy(to, from, length);
+	to[length] = '\0';
+}
+
+/*
+ *	finds the time a line was logged at, the way it's written in the log. looks for hh:mm:ss near
+ *	the start of the line and takes the date in front of it when there is one:
+ *		2008-04-14 10:05:01,320 ERROR [OrderManager] ...	-> 2008-04-14 10:05:01,320
+ *		10:05:01,320 ERROR [STDERR] ...						-> 10:05:01,320
+ *		[4/6/07 9:58:53:799 EDT] 0000000a SystemOut ...		-> 4/6/07 9:58:53:799
+ *		**** Error	Mon Apr 14 10:05:01 EDT 2008	...		-> Mon Apr 14 10:05:01
+ */
+const char* findTimestamp(const char* line, size_t length, size_t& timestampLength)
+{
+	size_t searched = (length < TIMESTAMP_SEARCH_LENGTH ? length : TIMESTAMP_SEARCH_LENGTH);
+	for (size_t i = 1; i + 5 < searched; i++)
+	{
+		// h:mm:ss or hh:mm:ss
+		if (!(line[i] == ':' && isDigit(line[i - 1]) && isDigit(line[i + 1]) && isDigit(line[i + 2])
+			&& line[i + 3] == ':' && isDigit(line[i + 4]) && isDigit(line[i + 5])))
+		{
+			continue;
+		}
+		size_t end = i + 6;
+		if (end + 1 < length && (line[end] == ',' || line[end] == '.' || line[end] == ':') && isDigit(line[end + 1]))
+		{
+			end++;
+			while (end < length && isDigit(line[end]))
+			{
+				end++;
+			}
+		}
+
+		// the date goes back to the start of the line, an opening bracket or a tab
+		size_t begin = i - 1;
+		while (begin > 0 && line[begin - 1] != '[' && line[begin - 1] != '\t' && line[begin - 1] != '*')
+		{
+			begin--;
+		}
+		while (begin < i && line[begin] == ' ')
+		{
+			begin++;
+		}
+		timestampLength = end - begin;
+		return line + begin;
+	}
+	return NULL;
+}
+
+// class and message of the exception with every word holding a digit replaced by #
+static size_t exceptionTemplate(const char* line, size_t length, const char* exceptionClass, size_t classLength, char* out)
+{
+	size_t used = 0;
+	copyText(out, MAX_EXCEPTION_LENGTH, exceptionClass, classLength);
+	used = strlen(out);
+
+	const char* message = exceptionClass + classLength;
+	const char* end = line + length;
+	while (message < end && (*message == ':' || *message == ' ' || *message == '\t'))
+	{
+		message++;
+	}
+	while (end > message && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+	{
+		end--;
+	}
+	if (message < end && used + 2 < MAX_EXCEPTION_LENGTH)
+	{
+		out[used++] = ':';
+		out[used++] = ' ';
+	}
+	while (message < end && used < MAX_EXCEPTION_LENGTH)
+	{
+		if (!isWordChar(*message))
+		{
+			out[used++] = *message++;
+			continue;
+		}
+		const char* word = message;
+		bool hasDigit = false;
+		while (message < end && isWordChar(*message))
+		{
+			hasDigit = hasDigit || isDigit(*message);
+			message++;
+		}
+		if (hasDigit)
+		{
+			out[used++] = NUMBER_PLACEHOLDER;
+		}
+		else
+		{
+			size_t wordLength = message - word;
+			wordLength = (used + wordLength > MAX_EXCEPTION_LENGTH ? MAX_EXCEPTION_LENGTH - used : wordLength);
+			memcpy(out + used, word, wordLength);
+			used += wordLength;
+		}
+	}
+	out[used] = '\0';
+	return used;
+}
+
+static void swapHeap(atgc_exception_report* report, size_t a, size_t b)
+{
+	swap(report->heap[a], report->heap[b]);
+	report->counters[report->heap[a]].heapIndex = a;
+	report->counters[report->heap[b]].heapIndex = b;
+}
+
+static unsigned long long heapCount(const atgc_exception_report* report, size_t position)
+{
+	return report->counters[report->heap[position]].count;
+}
+
+static void siftUp(atgc_exception_report* report, size_t position)
+{
+	while (position > 0 && heapCount(report, (position - 1) / 2) > heapCount(report, position))
+	{
+		swapHeap(report, position, (position - 1) / 2);
+		position = (position - 1) / 2;
+	}
+}
+
+static void siftDown(atgc_exception_report* report, size_t position)
+{
+	size_t size = report->heap.size();
+	while (true)
+	{
+		size_t smallest = position;
+		size_t left = 2 * position + 1;
+		size_t right = left + 1;
+		if (left < size && heapCount(report, left) < heapCount(report, smallest))
+		{
+			smallest = left;
+		}
+		if (right < size && heapCount(report, right) < heapCount(report, smallest))
+		{
+			smallest = right;
+		}
+		if (smallest == position)
+		{
+			return;
+		}
+		swapHeap(report, position, smallest);
+		position = smallest;
+	}
+}
+
+// the slot holding the exception, or the empty slot where it goes
+static size_t findSlot(const atgc_exception_report* report, uint64_t hash, const char* exception)
+{
+	size_t slot = (size_t) hash & report->slotMask;
+	while (report->slots[slot] != 0)
+	{
+		const ExceptionCounter& counter = report->counters[report->slots[slot] - 1];
+		if (counter.hash == hash && strcmp(counter.exception, exception) == 0)
+		{
+			break;
+		}
+		slot = (slot + 1) & report->slotMask;
+	}
+	return slot;
+}
+
+// empties a slot, moving the entries after it back so every entry stays reachable from its home slot
+static void removeSlot(atgc_exception_report* report, size_t slot)
+{
+	report->slots[slot] = 0;
+	size_t next = slot;
+	while (true)
+	{
+		next = (next + 1) & report->slotMask;
+		if (report->slots[next] == 0)
+		{
+			return;
+		}
+		size_t home = (size_t) report->counters[report->slots[next] - 1].hash & report->slotMask;
+		bool movable = (slot <= next ? (home <= slot || home > next) : (home <= slot && home > next));
+		if (movable)
+		{
+			report->slots[slot] = report->slots[next];
+			report->slots[next] = 0;
+			slot = next;
+		}
+	}
+}
+
+atgc_exception_report* atgc_exceptions_create(size_t capacity)
+{
+	atgc_exception_report* report = new (nothrow) atgc_exception_report();
+	if (report == NULL)
+	{
+		return NULL;
+	}
+	capacity = (capacity == 0 ? DEFAULT_CAPACITY : min(capacity, MAX_CAPACITY));
+	size_t numSlots = 16;
+	while (numSlots < capacity * 2)
+	{
+		numSlots *= 2;
+	}
+
+	// everything the report needs is allocated here, counting lines doesn't allocate
+	try
+	{
+		report->counters.resize(capacity);
+		report->heap.reserve(capacity);
+		report->order.reserve(capacity);
+		report->slots.assign(numSlots, 0);
+	}
+	catch (const bad_alloc&)
+	{
+		delete report;
+		return NULL;
+	}
+	report->slotMask = numSlots - 1;
+	report->used = 0;
+	report->total = 0;
+	report->timestamp[0] = '\0';
+	report->lineNumber = 0;
+	return report;
+}
+
+void atgc_exceptions_destroy(atgc_exception_report* report)
+{
+	delete report;
+}
+
+void atgc_exceptions_add(atgc_exception_report* report, const char* line, size_t length, int lineType)
+{
+	report->lineNumber++;
+	size_t timestampLength = 0;
+	const char* timestamp = findTimestamp(line, length, timestampLength);
+	if (timestamp != NULL)
+	{
+		copyText(report->timestamp, MAX_TIMESTAMP_LENGTH, timestamp, timestampLength);
+	}
+
+	// frames and causes belong to the exception that started the trace, which is already counted
+	size_t classLength = 0;
+	size_t frameLength = 0;
+	const char* exceptionClass = NULL;
+	if (lineType != ATGC_ERROR_LINE || findFrame(line, length, frameLength) != NULL || findText(line, length, "Caused by: ", 11) != NULL)
+	{
+		return;
+	}
+	// the "Error" of "**** Error" is the log level, not an exception
+	const char* search = line;
+	while ((exceptionClass = findExceptionClass(search, length - (search - line), classLength)) != NULL
+		&& classLength == 5 && memcmp(exceptionClass, "Error", 5) == 0)
+	{
+		search = exceptionClass + classLength;
+	}
+	if (exceptionClass == NULL)
+	{
+		return;
+	}
+	exceptionTemplate(line, length, exceptionClass, classLength, report->exception);
+	report->total++;
+
+	// lines with no time on them (a trace written straight to stderr) get the last one seen, or their line number
+	char when[MAX_TIMESTAMP_LENGTH + 1];
+	if (report->timestamp[0] != '\0')
+	{
+		strcpy(when, report->timestamp);
+	}
+	else
+	{
+		snprintf(when, sizeof(when), "line %llu", report->lineNumber);
+	}
+
+	uint64_t hash = hashBytes(FNV_OFFSET_BASIS, report->exception, strlen(report->exception));
+	size_t slot = findSlot(report, hash, report->exception);
+	if (report->slots[slot] != 0)
+	{
+		ExceptionCounter& counter = report->counters[report->slots[slot] - 1];
+		counter.count++;
+		strcpy(counter.lastSeen, when);
+		siftDown(report, counter.heapIndex);
+		return;
+	}
+
+	size_t index;
+	unsigned long long inherited = 0;
+	if (report->used < report->counters.size())
+	{
+		index = report->used++;
+		report->heap.push_back(index);
+		report->counters[index].heapIndex = report->heap.size() - 1;
+	}
+	else
+	{
+		// every counter is in use. the exception takes over the one with the smallest count
+		index = report->heap[0];
+		const ExceptionCounter& victim = report->counters[index];
+		inherited = victim.count;
+		removeSlot(report, findSlot(report, victim.hash, victim.exception));
+		slot = findSlot(report, hash, report->exception);
+	}
+
+	ExceptionCounter& counter = report->counters[index];
+	counter.hash = hash;
+	counter.count = inherited + 1;
+	counter.overcount = inherited;
+	strcpy(counter.exception, report->exception);
+	strcpy(counter.firstSeen, when);
+	strcpy(counter.lastSeen, when);
+	report->slots[slot] = index + 1;
+	siftUp(report, counter.heapIndex);
+	siftDown(report, counter.heapIndex);
+}
+
+struct MoreFrequent
+{
+	const atgc_exception_report* report;
+	bool operator()(size_t a, size_t b) const
+	{
+		return report->counters[a].count > report->counters[b].count;
+	}
+};
+
+size_t atgc_exceptions_top(atgc_exception_report* report, atgc_exception_count* top, size_t n)
+{
+	report->order.clear();
+	for (size_t i = 0; i < report->used; i++)
+	{
+		report->order.push_back(i);
+	}
+	n = (n < report->used ? n : report->used);
+	MoreFrequent moreFrequent = { report };
+	partial_sort(report->order.begin(), report->order.begin() + n, report->order.end(), moreFrequent);
+	for (size_t i = 0; i < n; i++)
+	{
+		const ExceptionCounter& counter = report->counters[report->order[i]];
+		top[i].exception = counter.exception;
+		top[i].count = counter.count;
+		top[i].overcount = counter.overcount;
+		top[i].firstSeen = counter.firstSeen;
+		top[i].lastSeen = counter.lastSeen;
+	}
+	return n;
+}
+
+unsigned long long atgc_exceptions_total(const atgc_exception_report* report)
+{
+	return report->total;
+}
+
+size_t atgc_exceptions_distinct(const atgc_exception_report* report)
+{
+	return report->used;
+}
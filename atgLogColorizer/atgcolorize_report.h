@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * exception report for libatgcolorize. answers "which exceptions happened most, and when" in
+ * one pass over any amount of log. every error line naming an exception is reduced to the
+ * exception class and its message with the numbers and ids taken out:
+ *
+ *		java.lang.NullPointerException: order o12345 is null	-> java.lang.NullPointerException: order # is null
+ *
+ * and counted with the Space-Saving algorithm, which keeps a fixed number of counters. the
+ * exceptions that happen most are always among them; an exception that took over the counter
+ * of another one carries that counter's count as its possible overcount
+ */
+
+#ifndef ATGCOLORIZE_REPORT_H
+#define ATGCOLORIZE_REPORT_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_exception_report atgc_exception_report;
+
+typedef struct atgc_exception_count
+{
+	const char* exception; // class and message template
+	unsigned long long count;
+	unsigned long long overcount; // count can be this much too high
+	const char* firstSeen; // timestamp of the first and last line counted, as written in the log
+	const char* lastSeen;
+} atgc_exception_count;
+
+// capacity is how many exceptions are counted at the same time, 0 for the default (1024)
+ATGC_API atgc_exception_report* atgc_exceptions_create(size_t capacity);
+ATGC_API void atgc_exceptions_destroy(atgc_exception_report* report);
+
+// hands the report the next line along with the type the classifier gave it
+ATGC_API void atgc_exceptions_add(atgc_exception_report* report, const char* line, size_t length, int lineType);
+
+/*
+	writes up to n of the most frequent exceptions into top, most frequent first, and returns
+	how many were written. the strings stay valid until the next call on the report
+*/
+ATGC_API size_t atgc_exceptions_top(atgc_exception_report* report, atgc_exception_count* top, size_t n);
+
+// exceptions counted so far, and how many different ones are held in the counters
+ATGC_API unsigned long long atgc_exceptions_total(const atgc_exception_report* report);
+ATGC_API size_t atgc_exceptions_distinct(const atgc_exception_report* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_REPORT_H
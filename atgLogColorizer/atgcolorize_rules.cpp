@@ -0,0 +1,801 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * rule files and the matcher behind them. a rule file lets you color your own messages without
+ * touching the built-in checks. one rule per line, # starts a comment:
+ *
+ *		<type> <match> "<text>" [and <match> "<text>"]... [after <type>] [priority <n>]
+ *
+ *		error contains "Order pipeline failed"
+ *		error prefix "/mycompany/commerce/" and contains "aborted" priority 10
+ *		warning suffix "retrying"
+ *		error regex "order o[0-9]+ could not be priced"
+ *		error contains "rolled back" after error
+ *		info contains "heartbeat" priority -1
+ *
+ *	<type> is one of info, warning, debug, error, nucleus or other. <match> is one of contains,
+ *	prefix, suffix or regex (ECMAScript syntax) and is applied to the line with the surrounding
+ *	whitespace trimmed. "after <type>" only matches when the previous line had that type.
+ *
+ *	priority decides where a rule is checked. the default, 0, is checked along with the built-in
+ *	SOP messages, after the built-in single line checks, and anything below 0 only applies to
+ *	lines that would have been OTHER_LINE. anything above 0 is checked before the built-in
+ *	single line checks, so it wins over them (multi-line blocks like SQL debug output or thread
+ *	dumps still come first), but every line is then scanned for the rules before those checks
+ *	run, which about doubles the time a line takes to classify. keep it for the rules that need it.
+ *
+ *	every literal of every rule, built-in ones included, goes into one Aho-Corasick automaton,
+ *	so each line is scanned once no matter how many rules there are. a regex rule waits for the
+ *	longest plain piece of text it has to contain, regexes without one are run on every line
+ */
+
+#include "atgcolorize_internal.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+
+using namespace std;
+
+// a rule with more terms than this is probably a mistake in the file
+const size_t MAX_TERMS_PER_RULE = 16;
+
+// regexes whose required text is shorter than this would wait for too many lines to be worth it
+const size_t MIN_REGEX_LITERAL_LENGTH = 3;
+
+// literal hits recorded while scanning a line, one bit per match type
+const uint8_t HIT_CONTAINS = 1 << MATCH_CONTAINS;
+const uint8_t HIT_PREFIX = 1 << MATCH_PREFIX;
+const uint8_t HIT_SUFFIX = 1 << MATCH_SUFFIX;
+
+static bool parseLineType(const string& word, int& lineType)
+{
+	if (word == "info")
+	{
+		lineType = ATGC_INFO_LINE;
+	}
+	else if (word == "warning")
+	{
+		lineType = ATGC_WARNING_LINE;
+	}
+	else if (word == "debug")
+	{
+		lineType = ATGC_DEBUG_LINE;
+	}
+	else if (word == "error")
+	{
+		lineType = ATGC_ERROR_LINE;
+	}
+	else if (word == "nucleus")
+	{
+		lineType = ATGC_NUCLEUS_LINE;
+	}
+	else if (word == "other")
+	{
+		lineType = ATGC_OTHER_LINE;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+static bool parseMatch(const string& word, uint8_t& match)
+{
+	if (word == "contains")
+	{
+		match = MATCH_CONTAINS;
+	}
+	else if (word == "prefix")
+	{
+		match = MATCH_PREFIX;
+	}
+	else if (word == "suffix")
+	{
+		match = MATCH_SUFFIX;
+	}
+	else if (word == "regex")
+	{
+		match = MATCH_REGEX;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+ *	splits a rule line into words. quoted text is one word with \" \\ and \t escapes, quoted[i]
+ *	tells whether words[i] was quoted. stops at a # outside of quotes
+ */
+static bool splitRuleLine(const string& line, vector<string>& words, vector<bool>& quoted, string& error)
+{
+	size_t i = 0;
+	while (i < line.size())
+	{
+		if (isspace((unsigned char) line[i]))
+		{
+			i++;
+		}
+		else if (line[i] == '#')
+		{
+			break;
+		}
+		else if (line[i] == '"')
+		{
+			string word;
+			for (i++; i < line.size() && line[i] != '"'; i++)
+			{
+				if (line[i] == '\\' && i + 1 < line.size())
+				{
+					i++;
+					word += (line[i] == 't' ? '\t' : line[i]);
+				}
+				else
+				{
+					word += line[i];
+				}
+			}
+			if (i == line.size())
+			{
+				error = "missing closing quote";
+				return false;
+			}
+			i++;
+			words.push_back(word);
+			quoted.push_back(true);
+		}
+		else
+		{
+			size_t start = i;
+			while (i < line.size() && !isspace((unsigned char) line[i]) && line[i] != '#')
+			{
+				i++;
+			}
+			words.push_back(line.substr(start, i - start));
+			quoted.push_back(false);
+		}
+	}
+	return true;
+}
+
+static bool parseRule(const vector<string>& words, const vector<bool>& quoted, RuleDefinition& rule, string& error)
+{
+	size_t i = 0;
+	if (quoted[i] || !parseLineType(words[i], rule.lineType))
+	{
+		error = "unknown line type '" + words[i] + "'";
+		return false;
+	}
+	i++;
+
+	rule.previousLineType = ANY_LINE_TYPE;
+	rule.priority = 0;
+	while (true)
+	{
+		uint8_t match;
+		if (i >= words.size() || quoted[i] || !parseMatch(words[i], match))
+		{
+			error = "expected contains, prefix, suffix or regex" + (i < words.size() ? " instead of '" + words[i] + "'" : string());
+			return false;
+		}
+		if (i + 1 >= words.size() || !quoted[i+1])
+		{
+			error = "expected quoted text after " + words[i];
+			return false;
+		}
+		if (words[i+1].empty())
+		{
+			error = "empty text after " + words[i];
+			return false;
+		}
+		rule.matches.push_back(match);
+		rule.texts.push_back(words[i+1]);
+		i += 2;
+
+		if (i < words.size() && !quoted[i] && words[i] == "and")
+		{
+			i++;
+			continue;
+		}
+		break;
+	}
+	if (rule.matches.size() > MAX_TERMS_PER_RULE)
+	{
+		error = "too many terms";
+		return false;
+	}
+
+	while (i < words.size())
+	{
+		if (!quoted[i] && words[i] == "after" && i + 1 < words.size())
+		{
+			if (quoted[i+1] || !parseLineType(words[i+1], rule.previousLineType))
+			{
+				error = "unknown line type '" + words[i+1] + "'";
+				return false;
+			}
+		}
+		else if (!quoted[i] && words[i] == "priority" && i + 1 < words.size())
+		{
+			char* end;
+			long priority = strtol(words[i+1].c_str(), &end, 10);
+			if (words[i+1].empty() || *end != '\0' || priority > 1000000 || priority < -1000000)
+			{
+				error = "bad priority '" + words[i+1] + "'";
+				return false;
+			}
+			rule.priority = (int) priority;
+		}
+		else
+		{
+			error = "unexpected '" + words[i] + "'";
+			return false;
+		}
+		i += 2;
+	}
+	return true;
+}
+
+bool parseRuleFile(const char* path, vector<RuleDefinition>& definitions, string& error)
+{
+	ifstream file(path);
+	if (file.fail())
+	{
+		error = string(path) + ": couldn't be read";
+		return false;
+	}
+
+	string line;
+	int lineNumber = 0;
+	while (getline(file, line))
+	{
+		lineNumber++;
+		ostringstream source;
+		source << path << ":" << lineNumber;
+
+		vector<string> words;
+		vector<bool> quoted;
+		string lineError;
+		if (!splitRuleLine(line, words, quoted, lineError))
+		{
+			error = source.str() + ": " + lineError;
+			return false;
+		}
+		if (words.empty())
+		{
+			continue;
+		}
+
+		RuleDefinition rule;
+		rule.source = source.str();
+		if (!parseRule(words, quoted, rule, lineError))
+		{
+			error = source.str() + ": " + lineError;
+			return false;
+		}
+		definitions.push_back(rule);
+	}
+	return true;
+}
+
+void builtinDefinitions(vector<RuleDefinition>& definitions)
+{
+	for (size_t i = 0; i < NUM_SOP_ERROR_RULES; i++)
+	{
+		RuleDefinition rule;
+		rule.lineType = ATGC_ERROR_LINE;
+		rule.previousLineType = ANY_LINE_TYPE;
+		rule.priority = 0;
+		rule.matches.push_back(SOP_ERROR_RULES[i].match);
+		rule.texts.push_back(SOP_ERROR_RULES[i].text);
+		if (SOP_ERROR_RULES[i].alsoContains != NULL)
+		{
+			rule.matches.push_back(MATCH_CONTAINS);
+			rule.texts.push_back(SOP_ERROR_RULES[i].alsoContains);
+		}
+		rule.source = "built-in";
+		definitions.push_back(rule);
+	}
+}
+
+/*
+ *	finds the longest piece of plain text every match of pattern has to contain, so the regex
+ *	only runs on lines where the automaton saw it. anything in a group, a class or next to a
+ *	quantifier that makes it optional is left out. patterns with | are too hard to reason about
+ *	and get an empty string
+ */
+static string requiredLiteral(const string& pattern)
+{
+	if (pattern.find('|') != string::npos)
+	{
+		return "";
+	}
+
+	string best;
+	string current;
+	int depth = 0;
+	for (size_t i = 0; i < pattern.size(); i++)
+	{
+		char c = pattern[i];
+		bool flush = false;
+		if (c == '\\' && i + 1 < pattern.size())
+		{
+			i++;
+			if (!isalnum((unsigned char) pattern[i]) && depth == 0)
+			{
+				current += pattern[i];
+			}
+			else
+			{
+				flush = true; // \d, \w, \b and friends
+			}
+		}
+		else if (c == '*' || c == '?' || c == '{')
+		{
+			// the character before is optional
+			if (!current.empty())
+			{
+				current.erase(current.size() - 1);
+			}
+			flush = true;
+			if (c == '{')
+			{
+				while (i < pattern.size() && pattern[i] != '}')
+				{
+					i++;
+				}
+			}
+		}
+		else if (c == '[')
+		{
+			for (i++; i < pattern.size() && pattern[i] != ']'; i++)
+			{
+				if (pattern[i] == '\\')
+				{
+					i++;
+				}
+			}
+			flush = true;
+		}
+		else if (c == '(' || c == ')')
+		{
+			depth += (c == '(' ? 1 : -1);
+			flush = true;
+		}
+		else if (c == '.' || c == '^' || c == '$' || c == '+')
+		{
+			// with +, the character before is still required once
+			flush = true;
+		}
+		else if (depth == 0)
+		{
+			current += c;
+		}
+
+		if (flush || i + 1 == pattern.size())
+		{
+			if (current.size() > best.size())
+			{
+				best = current;
+			}
+			current.clear();
+		}
+	}
+	return (best.size() >= MIN_REGEX_LITERAL_LENGTH ? best : string());
+}
+
+static uint32_t addToPool(RuleStorage* storage, const string& text)
+{
+	uint32_t offset = (uint32_t) storage->textPool.size();
+	storage->textPool.insert(storage->textPool.end(), text.begin(), text.end());
+	storage->textPool.push_back('\0');
+	return offset;
+}
+
+// fills in the rules createRules made, or destroys them and returns NULL when a definition can't be compiled
+static atgc_rules* fillRules(atgc_rules* rules, const vector<RuleDefinition>& definitions, string& error)
+{
+	RuleStorage* storage = rules->storage;
+
+	// every distinct literal gets an id, and every rule is keyed on its longest literal
+	map<string, uint32_t> literalIds;
+	vector<string> literalTexts;
+	vector< vector<uint32_t> > rulesByLiteral;
+
+	for (size_t r = 0; r < definitions.size(); r++)
+	{
+		const RuleDefinition& definition = definitions[r];
+		CompiledRule rule;
+		rule.lineType = definition.lineType;
+		rule.previousLineType = definition.previousLineType;
+		rule.priority = definition.priority;
+		rule.termBegin = (uint32_t) storage->terms.size();
+
+		uint32_t keyLiteral = NO_LITERAL;
+		for (size_t t = 0; t < definition.matches.size(); t++)
+		{
+			CompiledTerm term;
+			term.match = definition.matches[t];
+			term.regex = NO_REGEX;
+			string literal = definition.texts[t];
+			if (term.match == MATCH_REGEX)
+			{
+				try
+				{
+					storage->regexes.push_back(regex(definition.texts[t], regex::ECMAScript | regex::optimize));
+				}
+				catch (const regex_error& e)
+				{
+					error = definition.source + ": bad regex \"" + definition.texts[t] + "\": " + e.what();
+					destroyRules(rules);
+					return NULL;
+				}
+				term.regex = (uint32_t) storage->regexSourceOffsets.size();
+				storage->regexSourceOffsets.push_back(addToPool(storage, definition.texts[t]));
+				literal = requiredLiteral(definition.texts[t]);
+			}
+
+			term.literal = NO_LITERAL;
+			if (!literal.empty())
+			{
+				map<string, uint32_t>::iterator found = literalIds.find(literal);
+				if (found == literalIds.end())
+				{
+					found = literalIds.insert(make_pair(literal, (uint32_t) literalTexts.size())).first;
+					literalTexts.push_back(literal);
+					rulesByLiteral.push_back(vector<uint32_t>());
+				}
+				term.literal = found->second;
+				if (keyLiteral == NO_LITERAL || literal.size() > literalTexts[keyLiteral].size())
+				{
+					keyLiteral = term.literal;
+				}
+			}
+			storage->terms.push_back(term);
+		}
+		rule.termEnd = (uint32_t) storage->terms.size();
+		storage->rules.push_back(rule);
+
+		if (keyLiteral == NO_LITERAL)
+		{
+			storage->alwaysCheckedRules.push_back((uint32_t) r);
+		}
+		else
+		{
+			rulesByLiteral[keyLiteral].push_back((uint32_t) r);
+		}
+		if (definition.source == "built-in")
+		{
+			rules->numBuiltinRules++;
+		}
+		if (rule.priority > 0)
+		{
+			rules->hasPositiveRules = true;
+		}
+	}
+
+	// build the trie. state 0 is the start state
+	vector< map<uint8_t, uint32_t> > children(1);
+	vector<uint32_t> stateLiterals(1, NO_LITERAL);
+	for (uint32_t l = 0; l < literalTexts.size(); l++)
+	{
+		uint32_t state = 0;
+		for (size_t i = 0; i < literalTexts[l].size(); i++)
+		{
+			uint8_t c = (uint8_t) literalTexts[l][i];
+			map<uint8_t, uint32_t>::iterator child = children[state].find(c);
+			if (child == children[state].end())
+			{
+				children[state][c] = (uint32_t) children.size();
+				state = (uint32_t) children.size();
+				children.push_back(map<uint8_t, uint32_t>());
+				stateLiterals.push_back(NO_LITERAL);
+			}
+			else
+			{
+				state = child->second;
+			}
+		}
+		stateLiterals[state] = l;
+	}
+	if (children.size() >= (1u << 24))
+	{
+		error = "too many rules";
+		destroyRules(rules);
+		return NULL;
+	}
+
+	// fail and output links, breadth first so a state's fail target is always done before it
+	size_t numStates = children.size();
+	vector<uint32_t> fail(numStates, 0);
+	vector<uint32_t> outputLink(numStates, 0);
+	vector<uint32_t> queue;
+	for (map<uint8_t, uint32_t>::iterator child = children[0].begin(); child != children[0].end(); ++child)
+	{
+		queue.push_back(child->second);
+	}
+	for (size_t q = 0; q < queue.size(); q++)
+	{
+		uint32_t state = queue[q];
+		for (map<uint8_t, uint32_t>::iterator child = children[state].begin(); child != children[state].end(); ++child)
+		{
+			uint32_t target = fail[state];
+			while (true)
+			{
+				map<uint8_t, uint32_t>::iterator next = children[target].find(child->first);
+				if (next != children[target].end())
+				{
+					target = next->second;
+					break;
+				}
+				if (target == 0)
+				{
+					break;
+				}
+				target = fail[target];
+			}
+			fail[child->second] = target;
+			outputLink[child->second] = (stateLiterals[target] != NO_LITERAL ? target : outputLink[target]);
+			queue.push_back(child->second);
+		}
+	}
+
+	// flatten everything into the tables
+	storage->rootNext.assign(256, 0);
+	for (map<uint8_t, uint32_t>::iterator child = children[0].begin(); child != children[0].end(); ++child)
+	{
+		storage->rootNext[child->first] = child->second;
+	}
+	for (size_t s = 0; s < numStates; s++)
+	{
+		CompiledState state;
+		state.edgeBegin = (uint32_t) storage->edges.size();
+		state.fail = fail[s];
+		state.literal = stateLiterals[s];
+		state.outputLink = outputLink[s];
+		storage->states.push_back(state);
+		for (map<uint8_t, uint32_t>::iterator child = children[s].begin(); child != children[s].end(); ++child)
+		{
+			storage->edges.push_back((child->second << 8) | child->first);
+		}
+	}
+	CompiledState sentinel = { (uint32_t) storage->edges.size(), 0, NO_LITERAL, 0 };
+	storage->states.push_back(sentinel);
+
+	for (uint32_t l = 0; l < literalTexts.size(); l++)
+	{
+		CompiledLiteral literal;
+		literal.length = (uint32_t) literalTexts[l].size();
+		literal.textOffset = addToPool(storage, literalTexts[l]);
+		literal.ruleBegin = (uint32_t) storage->literalRules.size();
+		storage->literals.push_back(literal);
+		storage->literalRules.insert(storage->literalRules.end(), rulesByLiteral[l].begin(), rulesByLiteral[l].end());
+	}
+	CompiledLiteral lastLiteral = { 0, 0, (uint32_t) storage->literalRules.size() };
+	storage->literals.push_back(lastLiteral);
+
+	useStorageTables(rules);
+	return rules;
+}
+
+atgc_rules* compileRules(const vector<RuleDefinition>& definitions, string& error)
+{
+	atgc_rules* rules = createRules();
+	try
+	{
+		return fillRules(rules, definitions, error);
+	}
+	catch (const bad_alloc&)
+	{
+		destroyRules(rules);
+		throw;
+	}
+}
+
+atgc_rules* createRules()
+{
+	atgc_rules* rules = new atgc_rules();
+	memset(&rules->tables, 0, sizeof(rules->tables));
+	rules->regexes = NULL;
+	rules->numBuiltinRules = 0;
+	rules->hasPositiveRules = false;
+	try
+	{
+		rules->storage = new RuleStorage();
+	}
+	catch (const bad_alloc&)
+	{
+		delete rules;
+		throw;
+	}
+	rules->mapping = NULL;
+	rules->mappingLength = 0;
+	return rules;
+}
+
+void useStorageTables(atgc_rules* rules)
+{
+	const RuleStorage* storage = rules->storage;
+	RuleTables& tables = rules->tables;
+	tables.states = storage->states.data();
+	tables.edges = storage->edges.data();
+	tables.rootNext = storage->rootNext.data();
+	tables.literals = storage->literals.data();
+	tables.literalRules = storage->literalRules.data();
+	tables.rules = storage->rules.data();
+	tables.terms = storage->terms.data();
+	tables.alwaysCheckedRules = storage->alwaysCheckedRules.data();
+	tables.textPool = storage->textPool.data();
+	tables.regexSourceOffsets = storage->regexSourceOffsets.data();
+
+	tables.numStates = (uint32_t) storage->states.size() - 1;
+	tables.numEdges = (uint32_t) storage->edges.size();
+	tables.numLiterals = (uint32_t) storage->literals.size() - 1;
+	tables.numLiteralRules = (uint32_t) storage->literalRules.size();
+	tables.numRules = (uint32_t) storage->rules.size();
+	tables.numTerms = (uint32_t) storage->terms.size();
+	tables.numAlwaysCheckedRules = (uint32_t) storage->alwaysCheckedRules.size();
+	tables.textPoolSize = (uint32_t) storage->textPool.size();
+	tables.numRegexes = (uint32_t) storage->regexSourceOffsets.size();
+	rules->regexes = storage->regexes.data();
+}
+
+void destroyRules(atgc_rules* rules)
+{
+	if (rules == NULL || rules == builtinRules())
+	{
+		return;
+	}
+	if (rules->mapping != NULL)
+	{
+		unmapRuleCache(rules);
+	}
+	delete rules->storage;
+	delete rules;
+}
+
+bool compileRegexes(atgc_rules* rules)
+{
+	vector<regex>& regexes = rules->storage->regexes;
+	regexes.clear();
+	for (uint32_t i = 0; i < rules->tables.numRegexes; i++)
+	{
+		try
+		{
+			regexes.push_back(regex(rules->tables.textPool + rules->tables.regexSourceOffsets[i], regex::ECMAScript | regex::optimize));
+		}
+		catch (const regex_error&)
+		{
+			return false;
+		}
+	}
+	rules->regexes = regexes.data();
+	return true;
+}
+
+RuleMatch RuleScanner::scan(const atgc_rules& rules, const string& trimmedLine, int previousLineType)
+{
+	RuleMatch match = { NO_RULE, NO_RULE, NO_RULE };
+	const RuleTables& tables = rules.tables;
+
+	size_t numLiterals = tables.numLiterals;
+	if (literalStamps.size() < numLiterals)
+	{
+		literalStamps.resize(numLiterals, 0);
+		literalHits.resize(numLiterals, 0);
+	}
+	if (++stamp == 0)
+	{
+		// wrapped around, forget every old stamp
+		literalStamps.assign(literalStamps.size(), 0);
+		stamp = 1;
+	}
+	hitLiterals.clear();
+
+	const CompiledState* states = tables.states;
+	const size_t length = trimmedLine.size();
+	uint32_t state = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		state = nextState(tables, state, (uint8_t) trimmedLine[i]);
+
+		for (uint32_t output = (states[state].literal != NO_LITERAL ? state : states[state].outputLink); output != 0; output = states[output].outputLink)
+		{
+			uint32_t literal = states[output].literal;
+			uint8_t hit = HIT_CONTAINS;
+			if (i + 1 == tables.literals[literal].length)
+			{
+				hit |= HIT_PREFIX;
+			}
+			if (i + 1 == length)
+			{
+				hit |= HIT_SUFFIX;
+			}
+			if (literalStamps[literal] != stamp)
+			{
+				literalStamps[literal] = stamp;
+				literalHits[literal] = hit;
+				hitLiterals.push_back(literal);
+			}
+			else
+			{
+				literalHits[literal] |= hit;
+			}
+		}
+	}
+
+	for (size_t h = 0; h < hitLiterals.size(); h++)
+	{
+		const CompiledLiteral& literal = tables.literals[hitLiterals[h]];
+		uint32_t end = tables.literals[hitLiterals[h] + 1].ruleBegin;
+		for (uint32_t r = literal.ruleBegin; r < end; r++)
+		{
+			evaluate(rules, tables.literalRules[r], trimmedLine, previousLineType, match);
+		}
+	}
+	for (uint32_t r = 0; r < tables.numAlwaysCheckedRules; r++)
+	{
+		evaluate(rules, tables.alwaysCheckedRules[r], trimmedLine, previousLineType, match);
+	}
+	return match;
+}
+
+// checks every term of rule against the hits of the last scan and keeps it if it beats the current winner of its band
+void RuleScanner::evaluate(const atgc_rules& rules, uint32_t rule, const string& trimmedLine, int previousLineType, RuleMatch& match)
+{
+	const CompiledRule& compiled = rules.tables.rules[rule];
+	if (compiled.previousLineType != ANY_LINE_TYPE && compiled.previousLineType != previousLineType)
+	{
+		return;
+	}
+
+	uint32_t* band = (compiled.priority > 0 ? &match.positive : (compiled.priority == 0 ? &match.zero : &match.negative));
+	if (*band != NO_RULE)
+	{
+		const CompiledRule& winner = rules.tables.rules[*band];
+		if (winner.priority > compiled.priority || (winner.priority == compiled.priority && *band < rule))
+		{
+			return;
+		}
+	}
+
+	for (uint32_t t = compiled.termBegin; t < compiled.termEnd; t++)
+	{
+		const CompiledTerm& term = rules.tables.terms[t];
+		if (term.literal != NO_LITERAL)
+		{
+			uint8_t wanted = (term.match == MATCH_REGEX ? HIT_CONTAINS : (uint8_t) (1 << term.match));
+			if (literalStamps[term.literal] != stamp || (literalHits[term.literal] & wanted) == 0)
+			{
+				return;
+			}
+		}
+		if (term.match == MATCH_REGEX && !regex_search(trimmedLine, rules.regexes[term.regex]))
+		{
+			return;
+		}
+	}
+	*band = rule;
+}
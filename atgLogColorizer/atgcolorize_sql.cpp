@@ -0,0 +1,421 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * failed SQL report. see atgcolorize_sql.h
+ *
+ * the lines of a block are gathered as they come, the statement lines into one string and the
+ * parameter lines into another. when the block ends the statement is reduced to its shape in
+ * one pass and the shape interned, its number picking the counts kept for it. a block is only
+ * a few lines among millions, so only the first line of each block costs more than a look at
+ * its line type
+ */
+
+#include "atgcolorize_sql.h"
+#include "atgcolorize_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <string>
+
+using namespace std;
+
+// longer statements and parameter lists are cut. a block that doesn't end within MAX_BLOCK_LINES, or runs into a line with a timestamp, is dropped
+const size_t MAX_STATEMENT_LENGTH = 8192;
+const size_t MAX_PARAMETERS_LENGTH = 2048;
+const size_t MAX_BLOCK_LINES = 1000;
+const size_t MAX_TIMESTAMP_LENGTH = 40;
+
+const char PARAMETERS_LINE[] = "-- Parameters --";
+const char PLACEHOLDER = '?';
+const char PLACEHOLDER_LIST[] = "?,...";
+
+struct FailedStatement
+{
+	int kind;
+	unsigned long long count;
+	string component;
+	string firstSeen;
+	string lastSeen;
+	string parameters;
+};
+
+struct atgc_failed_sql_report
+{
+	StringTable shapes;
+	vector<FailedStatement> statements; // by shape number
+	unsigned long long total;
+
+	string timestamp; // the last one seen on any line
+	unsigned long long lineNumber;
+
+	// the block being read
+	bool inBlock;
+	bool inParameters;
+	int kind;
+	size_t blockLines;
+	string component;
+	string when;
+	string statement;
+	string parameters;
+
+	string shape; // scratch for the statement being counted
+	vector<uint32_t> order; // scratch for atgc_failed_sql_top
+};
+
+static bool isWordChar(char c)
+{
+	return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+}
+
+static bool endsWith(const string& text, const char* suffix)
+{
+	size_t length = strlen(suffix);
+	return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+/*
+ *	the shape of a statement: whitespace evened out, literals replaced by ? and the placeholders
+ *	of a list in parentheses written once, however many there are
+ *		SELECT id FROM dcspp_order WHERE profile_id = 'u123' AND state IN (?, ?, ?)
+ *			-> SELECT id FROM dcspp_order WHERE profile_id = ? AND state IN (?,...)
+ */
+static void statementShape(const string& statement, string& shape)
+{
+	shape.clear();
+	const char* c = statement.data();
+	const char* end = c + statement.size();
+	while (c < end)
+	{
+		if (isSpace(*c))
+		{
+			// no space just inside parentheses or after a comma
+			if (!shape.empty() && shape[shape.size() - 1] != ' ' && shape[shape.size() - 1] != '(' && shape[shape.size() - 1] != ',')
+			{
+				shape += ' ';
+			}
+			c++;
+			continue;
+		}
+
+		char next = *c;
+		if (*c == '\'')
+		{
+			// a string literal, '' being a quote inside it
+			for (c++; c < end; c++)
+			{
+				if (*c == '\'' && (c + 1 == end || c[1] != '\''))
+				{
+					break;
+				}
+				if (*c == '\'')
+				{
+					c++;
+				}
+			}
+			c++;
+			next = PLACEHOLDER;
+		}
+		else if (isDigit(*c) && (c == statement.data() || !isWordChar(c[-1])))
+		{
+			while (c < end && (isDigit(*c) || *c == '.'))
+			{
+				c++;
+			}
+			next = PLACEHOLDER;
+		}
+		else
+		{
+			c++;
+		}
+
+		if ((next == ',' || next == ')') && !shape.empty() && shape[shape.size() - 1] == ' ')
+		{
+			shape.erase(shape.size() - 1);
+		}
+		if (next == PLACEHOLDER && endsWith(shape, "?,...,"))
+		{
+			shape.erase(shape.size() - 1);
+		}
+		else if (next == PLACEHOLDER && endsWith(shape, "?,"))
+		{
+			shape.erase(shape.size() - 2);
+			shape += PLACEHOLDER_LIST;
+		}
+		else if (next == PLACEHOLDER && endsWith(shape, "("))
+		{
+			// a list of one, IN (?)
+			shape += PLACEHOLDER_LIST;
+		}
+		else
+		{
+			shape += next;
+		}
+	}
+	if (!shape.empty() && shape[shape.size() - 1] == ' ')
+	{
+		shape.erase(shape.size() - 1);
+	}
+}
+
+// the repository in front of the marker, as in "O /atg/dynamo/security/AdminSqlRepository   SQL Statement Failed"
+static void findComponent(const char* line, const char* marker, string& component)
+{
+	const char* end = marker;
+	while (end > line && (isSpace(end[-1]) || end[-1] == ']' || end[-1] == ':'))
+	{
+		end--;
+	}
+	const char* begin = end;
+	while (begin > line && !isSpace(begin[-1]) && begin[-1] != '[')
+	{
+		begin--;
+	}
+	if (begin < end && *begin == '/')
+	{
+		component.assign(begin, end - begin);
+	}
+	else
+	{
+		component.clear();
+	}
+}
+
+static void appendLimited(string& to, const char* text, size_t length, size_t limit)
+{
+	if (to.size() < limit)
+	{
+		to.append(text, min(length, limit - to.size()));
+	}
+}
+
+// counts the block that was just read
+static void countBlock(atgc_failed_sql_report* report)
+{
+	report->inBlock = false;
+	statementShape(report->statement, report->shape);
+	if (report->shape.empty())
+	{
+		return;
+	}
+
+	// a new shape gets its counts pushed without allocating, so shapes and statements stay in step
+	makeRoom(report->statements, 1);
+	uint32_t id = internString(report->shapes, report->shape.data(), report->shape.size());
+	if (id >= report->statements.size())
+	{
+		FailedStatement first;
+		first.kind = report->kind;
+		first.count = 0;
+		report->statements.push_back(first);
+		report->statements[id].firstSeen = report->when;
+	}
+	report->total++;
+	FailedStatement& statement = report->statements[id];
+	statement.count++;
+	statement.kind = report->kind;
+	statement.lastSeen = report->when;
+	statement.parameters = report->parameters;
+	if (!report->component.empty())
+	{
+		statement.component = report->component;
+	}
+}
+
+atgc_failed_sql_report* atgc_failed_sql_create(void)
+{
+	atgc_failed_sql_report* report = new (nothrow) atgc_failed_sql_report();
+	if (report == NULL)
+	{
+		return NULL;
+	}
+	report->total = 0;
+	report->lineNumber = 0;
+	report->inBlock = false;
+	report->inParameters = false;
+	report->kind = 0;
+	report->blockLines = 0;
+	return report;
+}
+
+void atgc_failed_sql_destroy(atgc_failed_sql_report* report)
+{
+	delete report;
+}
+
+static void addLine(atgc_failed_sql_report* report, const char* line, size_t length, int lineType)
+{
+	size_t timestampLength = 0;
+	const char* timestamp = (report->inBlock ? NULL : findTimestamp(line, length, timestampLength));
+	if (timestamp != NULL)
+	{
+		report->timestamp.assign(timestamp, min(timestampLength, MAX_TIMESTAMP_LENGTH));
+	}
+
+	// every line of a block is an error line to the classifier
+	if (lineType != ATGC_ERROR_LINE)
+	{
+		return;
+	}
+	while (length > 0 && isSpace(line[length - 1]))
+	{
+		length--;
+	}
+	while (length > 0 && isSpace(*line))
+	{
+		line++;
+		length--;
+	}
+
+	const char* marker = NULL;
+	int kind = failedSQLStart(line, length, &marker);
+	if (kind >= 0)
+	{
+		if (report->inBlock)
+		{
+			countBlock(report);
+		}
+		report->inBlock = true;
+		report->inParameters = false;
+		report->kind = kind;
+		report->blockLines = 0;
+		report->statement.clear();
+		report->parameters.clear();
+		findComponent(line, marker, report->component);
+		if (!report->timestamp.empty())
+		{
+			report->when = report->timestamp;
+		}
+		else
+		{
+			char number[32];
+			snprintf(number, sizeof(number), "line %llu", report->lineNumber);
+			report->when = number;
+		}
+		return;
+	}
+	if (!report->inBlock)
+	{
+		return;
+	}
+
+	if (isFailedSQLEnd(line, length))
+	{
+		countBlock(report);
+	}
+	else if (++report->blockLines > MAX_BLOCK_LINES || findTimestamp(line, length, timestampLength) != NULL)
+	{
+		// the block was cut short, the log went on with other lines
+		report->inBlock = false;
+	}
+	else if (length == sizeof(PARAMETERS_LINE) - 1 && memcmp(line, PARAMETERS_LINE, length) == 0)
+	{
+		report->inParameters = true;
+	}
+	else if (report->inParameters)
+	{
+		appendLimited(report->parameters, line, length, MAX_PARAMETERS_LENGTH);
+		appendLimited(report->parameters, "\n", 1, MAX_PARAMETERS_LENGTH + 1);
+	}
+	else
+	{
+		appendLimited(report->statement, " ", 1, MAX_STATEMENT_LENGTH);
+		appendLimited(report->statement, line, length, MAX_STATEMENT_LENGTH);
+	}
+}
+
+void atgc_failed_sql_add(atgc_failed_sql_report* report, const char* line, size_t length, int lineType)
+{
+	report->lineNumber++;
+	try
+	{
+		addLine(report, line, length, lineType);
+	}
+	catch (const bad_alloc&)
+	{
+		// the block being read is dropped
+		report->inBlock = false;
+	}
+}
+
+void atgc_failed_sql_finish(atgc_failed_sql_report* report)
+{
+	if (report->inBlock)
+	{
+		try
+		{
+			countBlock(report);
+		}
+		catch (const bad_alloc&)
+		{
+			report->inBlock = false;
+		}
+	}
+}
+
+struct MoreFailures
+{
+	const atgc_failed_sql_report* report;
+	bool operator()(uint32_t a, uint32_t b) const
+	{
+		return report->statements[a].count > report->statements[b].count;
+	}
+};
+
+size_t atgc_failed_sql_top(atgc_failed_sql_report* report, atgc_failed_sql* top, size_t n)
+{
+	report->order.clear();
+	try
+	{
+		report->order.reserve(report->statements.size());
+	}
+	catch (const bad_alloc&)
+	{
+		return 0;
+	}
+	for (uint32_t i = 0; i < report->statements.size(); i++)
+	{
+		report->order.push_back(i);
+	}
+	n = min(n, report->order.size());
+	MoreFailures moreFailures = { report };
+	partial_sort(report->order.begin(), report->order.begin() + n, report->order.end(), moreFailures);
+	for (size_t i = 0; i < n; i++)
+	{
+		const FailedStatement& statement = report->statements[report->order[i]];
+		top[i].statement = internedText(report->shapes, report->order[i]);
+		top[i].kind = failedSQLKindName(statement.kind);
+		top[i].component = statement.component.c_str();
+		top[i].count = statement.count;
+		top[i].firstSeen = statement.firstSeen.c_str();
+		top[i].lastSeen = statement.lastSeen.c_str();
+		top[i].parameters = statement.parameters.c_str();
+	}
+	return n;
+}
+
+unsigned long long atgc_failed_sql_total(const atgc_failed_sql_report* report)
+{
+	return report->total;
+}
+
+size_t atgc_failed_sql_distinct(const atgc_failed_sql_report* report)
+{
+	return report->statements.size();
+}
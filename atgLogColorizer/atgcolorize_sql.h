@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * failed SQL report for libatgcolorize. a SQL repository that has a statement fail writes it out
+ * with its parameters, between two markers:
+ *
+ *		/atg/dynamo/security/AdminSqlRepository	SQL Statement Failed: [++SQLInsert++]
+ *		INSERT INTO das_account(account_name,type,description,lastpwdupdate)
+ *		VALUES(?,?,?,?)
+ *		-- Parameters --
+ *		p[1] = {pd} tools-integrations-privilege (java.lang.String)
+ *		p[2] = {pd: type} 4 (java.lang.Integer)
+ *		[--SQLInsert--]
+ *
+ * the report takes each of those blocks apart and counts the statements by their shape: the
+ * statement with its whitespace evened out, its string and number literals replaced by ? and a
+ * list of placeholders written as one, so the same query failing for different orders or with
+ * an IN list of another length counts as the same failure. for each shape it keeps when it first
+ * and last failed and the parameters it failed with the last time
+ */
+
+#ifndef ATGCOLORIZE_SQL_H
+#define ATGCOLORIZE_SQL_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_failed_sql_report atgc_failed_sql_report;
+
+typedef struct atgc_failed_sql
+{
+	const char* statement; // the shape of the statement
+	const char* kind; // Insert, Update, Delete or Select
+	const char* component; // the repository that ran it the last time, "" when the log doesn't say
+	unsigned long long count;
+	const char* firstSeen; // timestamp of the first and last failure, as written in the log
+	const char* lastSeen;
+	const char* parameters; // the "p[1] = ..." lines of the last failure, each ending in '\n', "" for none
+} atgc_failed_sql;
+
+ATGC_API atgc_failed_sql_report* atgc_failed_sql_create(void);
+ATGC_API void atgc_failed_sql_destroy(atgc_failed_sql_report* report);
+
+// hands the report the next line along with the type the classifier gave it. a block memory runs out in isn't counted
+ATGC_API void atgc_failed_sql_add(atgc_failed_sql_report* report, const char* line, size_t length, int lineType);
+
+// counts a block the log ended in the middle of
+ATGC_API void atgc_failed_sql_finish(atgc_failed_sql_report* report);
+
+/*
+	writes up to n of the statements that failed most into top, most first, and returns how many
+	were written. the strings stay valid until the next call on the report
+*/
+ATGC_API size_t atgc_failed_sql_top(atgc_failed_sql_report* report, atgc_failed_sql* top, size_t n);
+
+// failed statements counted so far, and how many different shapes they came in
+ATGC_API unsigned long long atgc_failed_sql_total(const atgc_failed_sql_report* report);
+ATGC_API size_t atgc_failed_sql_distinct(const atgc_failed_sql_report* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_SQL_H
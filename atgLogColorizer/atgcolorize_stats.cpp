@@ -0,0 +1,525 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * line statistics. see atgcolorize_stats.h
+ *
+ * times and categories are interned, so a line is counted with a couple of hash lookups and no
+ * allocation, and most of the time not even that: the lines of a log mostly come in runs with
+ * the same time bucket and category, and the cell of the last line is checked first. the cells
+ * hold 32 bit counters, the totals per time and per category 64 bit ones
+ */
+
+#include "atgcolorize_stats.h"
+#include "atgcolorize_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+using namespace std;
+
+const unsigned int DEFAULT_BUCKET_MINUTES = 60;
+const unsigned int MINUTES_PER_DAY = 24 * 60;
+
+// how far into a line a Nucleus component is looked for
+const size_t COMPONENT_SEARCH_LENGTH = 256;
+
+// longer dates and categories are cut
+const size_t MAX_DATE_LENGTH = 40;
+const size_t MAX_CATEGORY_LENGTH = 120;
+
+// lines with a time but no category
+const char NO_CATEGORY[] = "-";
+
+// log4j categories and WebSphere streams everything ends up in when nobody configured logging
+const char* const CATCH_ALL_CATEGORIES[] = { "STDOUT", "STDERR", "SystemOut", "SystemErr" };
+
+
+const uint32_t NOTHING_YET = 0xFFFFFFFF;
+
+// the counts of one time bucket and category
+struct StatsCell
+{
+	uint32_t time;
+	uint32_t category;
+	uint32_t counts[ATGC_NUM_LINE_TYPES];
+};
+
+struct StatsTotals
+{
+	unsigned long long counts[ATGC_NUM_LINE_TYPES];
+};
+
+struct atgc_stats
+{
+	unsigned int bucketMinutes;
+	StringTable times;
+	StringTable categories;
+	vector<StatsCell> cells;
+	vector<uint32_t> cellSlots; // cell number + 1, 0 for an empty slot
+	vector<StatsTotals> timeTotals;
+	vector<StatsTotals> categoryTotals;
+
+	// where the last line went
+	uint32_t time;
+	uint32_t cell;
+	char date[MAX_DATE_LENGTH + 1];
+	size_t dateLength;
+	unsigned int bucketStart;
+};
+
+static bool isNameChar(char c)
+{
+	return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$' || c == '.' || c == '-';
+}
+
+static uint32_t hashText(const char* text, size_t length)
+{
+	return hashBytes32(FNV32_OFFSET_BASIS, text, length);
+}
+
+// doubles the slots of a hash table once it's half full. entries go back in with the given hash
+template <class HashOf>
+static void growSlots(vector<uint32_t>& slots, size_t entries, HashOf hashOf)
+{
+	if (!slots.empty() && entries * 2 < slots.size())
+	{
+		return;
+	}
+	vector<uint32_t> grown(slots.empty() ? 64 : slots.size() * 2, 0);
+	size_t mask = grown.size() - 1;
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if (slots[i] != 0)
+		{
+			size_t slot = hashOf(slots[i] - 1) & mask;
+			while (grown[slot] != 0)
+			{
+				slot = (slot + 1) & mask;
+			}
+			grown[slot] = slots[i];
+		}
+	}
+	slots.swap(grown);
+}
+
+struct StringHash
+{
+	const StringTable* table;
+	uint32_t operator()(uint32_t id) const
+	{
+		return table->hashes[id];
+	}
+};
+
+uint32_t internString(StringTable& table, const char* text, size_t length)
+{
+	uint32_t hash = hashText(text, length);
+	size_t mask = table.slots.size() - 1;
+	size_t slot = hash & mask;
+	while (!table.slots.empty() && table.slots[slot] != 0)
+	{
+		uint32_t id = table.slots[slot] - 1;
+		const char* interned = internedText(table, id);
+		if (table.hashes[id] == hash && strncmp(interned, text, length) == 0 && interned[length] == '\0')
+		{
+			return id;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	// everything that allocates first, so running out of memory leaves the table as it was
+	makeRoom(table.offsets, 1);
+	makeRoom(table.hashes, 1);
+	makeRoom(table.text, length + 1);
+	StringHash hashOf = { &table };
+	growSlots(table.slots, table.offsets.size() + 1, hashOf);
+
+	uint32_t id = (uint32_t) table.offsets.size();
+	table.offsets.push_back((uint32_t) table.text.size());
+	table.hashes.push_back(hash);
+	table.text.insert(table.text.end(), text, text + length);
+	table.text.push_back('\0');
+
+	mask = table.slots.size() - 1;
+	slot = hash & mask;
+	while (table.slots[slot] != 0)
+	{
+		slot = (slot + 1) & mask;
+	}
+	table.slots[slot] = id + 1;
+	return id;
+}
+
+static uint32_t cellHash(uint32_t time, uint32_t category)
+{
+	return (time * 0x9E3779B1U) ^ (category * 0x85EBCA77U);
+}
+
+static void skipSpaces(const char*& c, const char* end)
+{
+	while (c < end && *c == ' ')
+	{
+		c++;
+	}
+}
+
+/*
+	the header of a line, the parts of it that are there:
+
+		2008-04-14 10:05:01,320 ERROR [OrderManager] (http-8080-1) ...
+			time, log4j level, category and, when the layout has it, thread
+		[4/6/07 9:58:53:799 EDT] 0000000a SystemOut     O /atg/dynamo/security/AdminSqlRepository ...
+			time, thread and component
+		**** Error	Mon Apr 14 10:05:01 EDT 2008	1208181901320	/atg/commerce/order/OrderManager	...
+			ATG level, time and Nucleus component
+
+	the category is the log4j category or the WebSphere component, or a Nucleus component path
+	further on when those are missing or just say STDOUT. the level ATG writes wins over the log4j
+	one, which is always INFO for what ATG writes to STDOUT
+*/
+void findLineFields(const char* line, size_t length, LineFields& fields)
+{
+	memset(&fields, 0, sizeof(fields));
+	const char* end = line + length;
+	fields.timestamp = findTimestamp(line, length, fields.timestampLength);
+	if (fields.timestamp == NULL)
+	{
+		return;
+	}
+	const char* c = fields.timestamp + fields.timestampLength;
+
+	// the level after a log4j time, the time zone after a WebSphere one
+	skipSpaces(c, end);
+	const char* word = c;
+	while (c < end && *c >= 'A' && *c <= 'Z')
+	{
+		c++;
+	}
+	size_t wordLength = c - word;
+	skipSpaces(c, end);
+
+	if (c < end && *c == ']')
+	{
+		// WebSphere: "] thread component"
+		c++;
+		const char** parts[2] = { &fields.thread, &fields.category };
+		size_t* partLengths[2] = { &fields.threadLength, &fields.categoryLength };
+		for (int part = 0; part < 2; part++)
+		{
+			skipSpaces(c, end);
+			*parts[part] = c;
+			while (c < end && *c != ' ' && *c != '\t')
+			{
+				c++;
+			}
+			*partLengths[part] = c - *parts[part];
+		}
+	}
+	else if (c < end && *c == '[')
+	{
+		// log4j: "LEVEL [category] (thread)"
+		fields.level = (wordLength > 0 ? word : NULL);
+		fields.levelLength = wordLength;
+		const char* close = (const char*) memchr(c, ']', (end - c < (ptrdiff_t) MAX_CATEGORY_LENGTH ? end - c : MAX_CATEGORY_LENGTH));
+		if (close != NULL)
+		{
+			fields.category = c + 1;
+			fields.categoryLength = close - fields.category;
+			c = close + 1;
+			skipSpaces(c, end);
+			const char* closeThread = (c < end && *c == '(' ? (const char*) memchr(c, ')', (end - c < (ptrdiff_t) MAX_CATEGORY_LENGTH ? end - c : MAX_CATEGORY_LENGTH)) : NULL);
+			if (closeThread != NULL)
+			{
+				fields.thread = c + 1;
+				fields.threadLength = closeThread - fields.thread;
+				c = closeThread + 1;
+			}
+		}
+	}
+
+	// "**** Error", at the start of the line or of what log4j or WebSphere put in front of it
+	const char* stars = findText(line, (end - line < (ptrdiff_t) COMPONENT_SEARCH_LENGTH ? end - line : COMPONENT_SEARCH_LENGTH), "**** ", 5);
+	if (stars != NULL && (stars < fields.timestamp || stars >= c || fields.level == NULL))
+	{
+		fields.level = stars + 5;
+		fields.levelLength = 0;
+		while (fields.level + fields.levelLength < end && fields.level[fields.levelLength] != '\t' && fields.level[fields.levelLength] != ' ')
+		{
+			fields.levelLength++;
+		}
+	}
+
+	bool catchAll = (fields.categoryLength == 0);
+	for (size_t i = 0; i < sizeof(CATCH_ALL_CATEGORIES) / sizeof(CATCH_ALL_CATEGORIES[0]) && !catchAll; i++)
+	{
+		catchAll = (strlen(CATCH_ALL_CATEGORIES[i]) == fields.categoryLength && memcmp(CATCH_ALL_CATEGORIES[i], fields.category, fields.categoryLength) == 0);
+	}
+	if (!catchAll)
+	{
+		return;
+	}
+
+	// a Nucleus component: a path of at least two names, standing on its own
+	const char* searchEnd = (end - c > (ptrdiff_t) COMPONENT_SEARCH_LENGTH ? c + COMPONENT_SEARCH_LENGTH : end);
+	for (; c < searchEnd; c++)
+	{
+		if (*c != '/' || (c > line && c[-1] != ' ' && c[-1] != '\t') || c + 1 >= end || !isNameChar(c[1]))
+		{
+			continue;
+		}
+		const char* component = c;
+		int slashes = 0;
+		while (c < end && (*c == '/' || isNameChar(*c)))
+		{
+			slashes += (*c == '/');
+			c++;
+		}
+		if (slashes >= 2 && c[-1] != '/')
+		{
+			fields.category = component;
+			fields.categoryLength = c - component;
+			return;
+		}
+	}
+	if (fields.categoryLength == 0)
+	{
+		fields.category = NULL;
+	}
+}
+
+// the time bucket of a line with a time on it: the date, then the start of the bucket as hh:mm
+static uint32_t findTimeBucket(atgc_stats* stats, const char* timestamp, size_t timestampLength)
+{
+	const char* colon = (const char*) memchr(timestamp, ':', timestampLength);
+	const char* hour = colon;
+	while (hour > timestamp && isDigit(hour[-1]))
+	{
+		hour--;
+	}
+	unsigned int minute = 0;
+	for (const char* c = hour; c < colon; c++)
+	{
+		minute = minute * 10 + (*c - '0');
+	}
+	minute = minute * 60 + (colon[1] - '0') * 10 + (colon[2] - '0');
+	unsigned int bucketStart = (minute % MINUTES_PER_DAY) / stats->bucketMinutes * stats->bucketMinutes;
+
+	size_t dateLength = hour - timestamp;
+	while (dateLength > 0 && (timestamp[dateLength - 1] == ' ' || timestamp[dateLength - 1] == 'T'))
+	{
+		dateLength--;
+	}
+	dateLength = (dateLength < MAX_DATE_LENGTH ? dateLength : MAX_DATE_LENGTH);
+
+	// same bucket as the last line
+	if (stats->time != NOTHING_YET && bucketStart == stats->bucketStart && dateLength == stats->dateLength && memcmp(timestamp, stats->date, dateLength) == 0)
+	{
+		return stats->time;
+	}
+	memcpy(stats->date, timestamp, dateLength);
+	stats->dateLength = dateLength;
+	stats->bucketStart = bucketStart;
+
+	char name[MAX_DATE_LENGTH + 8];
+	memcpy(name, timestamp, dateLength);
+	int nameLength = (int) dateLength;
+	nameLength += snprintf(name + nameLength, sizeof(name) - nameLength, "%s%02u:%02u", (dateLength > 0 ? " " : ""), bucketStart / 60, bucketStart % 60);
+	return internString(stats->times, name, nameLength);
+}
+
+struct CellHash
+{
+	const atgc_stats* stats;
+	uint32_t operator()(uint32_t id) const
+	{
+		return cellHash(stats->cells[id].time, stats->cells[id].category);
+	}
+};
+
+static uint32_t findCell(atgc_stats* stats, uint32_t time, uint32_t category)
+{
+	uint32_t hash = cellHash(time, category);
+	size_t mask = stats->cellSlots.size() - 1;
+	size_t slot = hash & mask;
+	while (!stats->cellSlots.empty() && stats->cellSlots[slot] != 0)
+	{
+		const StatsCell& cell = stats->cells[stats->cellSlots[slot] - 1];
+		if (cell.time == time && cell.category == category)
+		{
+			return stats->cellSlots[slot] - 1;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	if (time >= stats->timeTotals.size())
+	{
+		stats->timeTotals.resize(time + 1, StatsTotals());
+	}
+	if (category >= stats->categoryTotals.size())
+	{
+		stats->categoryTotals.resize(category + 1, StatsTotals());
+	}
+	makeRoom(stats->cells, 1);
+	CellHash hashOf = { stats };
+	growSlots(stats->cellSlots, stats->cells.size() + 1, hashOf);
+
+	StatsCell cell;
+	memset(&cell, 0, sizeof(cell));
+	cell.time = time;
+	cell.category = category;
+	stats->cells.push_back(cell);
+
+	const vector<StatsCell>& cells = stats->cells;
+	mask = stats->cellSlots.size() - 1;
+	slot = hash & mask;
+	while (stats->cellSlots[slot] != 0)
+	{
+		slot = (slot + 1) & mask;
+	}
+	stats->cellSlots[slot] = (uint32_t) cells.size();
+	return (uint32_t) cells.size() - 1;
+}
+
+atgc_stats* atgc_stats_create(unsigned int bucketMinutes)
+{
+	atgc_stats* stats = new (nothrow) atgc_stats();
+	if (stats == NULL)
+	{
+		return NULL;
+	}
+	stats->bucketMinutes = (bucketMinutes == 0 ? DEFAULT_BUCKET_MINUTES : bucketMinutes);
+	stats->time = NOTHING_YET;
+	stats->cell = NOTHING_YET;
+	stats->dateLength = 0;
+	stats->bucketStart = 0;
+	return stats;
+}
+
+void atgc_stats_destroy(atgc_stats* stats)
+{
+	delete stats;
+}
+
+void atgc_stats_add(atgc_stats* stats, const char* line, size_t length, int lineType)
+{
+	if (lineType < 0 || lineType >= ATGC_NUM_LINE_TYPES || lineType == ATGC_BLANK_LINE)
+	{
+		return;
+	}
+
+	LineFields fields;
+	findLineFields(line, length, fields);
+	if (fields.timestamp != NULL || stats->cell == NOTHING_YET)
+	{
+		try
+		{
+			uint32_t time;
+			uint32_t category;
+			if (fields.timestamp != NULL)
+			{
+				time = findTimeBucket(stats, fields.timestamp, fields.timestampLength);
+				if (fields.category != NULL)
+				{
+					size_t categoryLength = (fields.categoryLength < MAX_CATEGORY_LENGTH ? fields.categoryLength : MAX_CATEGORY_LENGTH);
+					category = internString(stats->categories, fields.category, categoryLength);
+				}
+				else
+				{
+					category = internString(stats->categories, NO_CATEGORY, sizeof(NO_CATEGORY) - 1);
+				}
+			}
+			else
+			{
+				// the log starts without a time
+				time = internString(stats->times, NO_CATEGORY, sizeof(NO_CATEGORY) - 1);
+				category = internString(stats->categories, NO_CATEGORY, sizeof(NO_CATEGORY) - 1);
+				stats->time = time;
+			}
+			if (stats->cell == NOTHING_YET || stats->cells[stats->cell].time != time || stats->cells[stats->cell].category != category)
+			{
+				stats->cell = findCell(stats, time, category);
+			}
+			stats->time = time;
+		}
+		catch (const bad_alloc&)
+		{
+			// the line isn't counted, and the next one looks its time bucket up again
+			stats->time = NOTHING_YET;
+			stats->dateLength = 0;
+			return;
+		}
+	}
+
+	StatsCell& cell = stats->cells[stats->cell];
+	cell.counts[lineType]++;
+	stats->timeTotals[cell.time].counts[lineType]++;
+	stats->categoryTotals[cell.category].counts[lineType]++;
+}
+
+size_t atgc_stats_count(const atgc_stats* stats, int grouping)
+{
+	switch (grouping)
+	{
+		case ATGC_STATS_BY_TIME:
+			return stats->times.offsets.size();
+		case ATGC_STATS_BY_CATEGORY:
+			return stats->categories.offsets.size();
+		case ATGC_STATS_BY_TIME_AND_CATEGORY:
+			return stats->cells.size();
+	}
+	return 0;
+}
+
+void atgc_stats_get(const atgc_stats* stats, int grouping, size_t index, atgc_stats_row* row)
+{
+	memset(row, 0, sizeof(*row));
+	if (index >= atgc_stats_count(stats, grouping))
+	{
+		return;
+	}
+	for (int type = 0; type < ATGC_NUM_LINE_TYPES; type++)
+	{
+		switch (grouping)
+		{
+			case ATGC_STATS_BY_TIME:
+				row->counts[type] = (index < stats->timeTotals.size() ? stats->timeTotals[index].counts[type] : 0);
+				break;
+			case ATGC_STATS_BY_CATEGORY:
+				row->counts[type] = (index < stats->categoryTotals.size() ? stats->categoryTotals[index].counts[type] : 0);
+				break;
+			default:
+				row->counts[type] = stats->cells[index].counts[type];
+				break;
+		}
+		row->total += row->counts[type];
+	}
+	if (grouping == ATGC_STATS_BY_TIME)
+	{
+		row->time = internedText(stats->times, (uint32_t) index);
+	}
+	else if (grouping == ATGC_STATS_BY_CATEGORY)
+	{
+		row->category = internedText(stats->categories, (uint32_t) index);
+	}
+	else
+	{
+		row->time = internedText(stats->times, stats->cells[index].time);
+		row->category = internedText(stats->categories, stats->cells[index].category);
+	}
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * line statistics for libatgcolorize. counts the lines of a log by the type the classifier gave
+ * them, per stretch of time (an hour unless told otherwise) and per log4j category or Nucleus
+ * component, in one pass and without keeping the lines:
+ *
+ *		2008-04-14 10:05:01,320 ERROR [OrderManager] ...				-> 2008-04-14 10:00, OrderManager
+ *		**** Error	Mon Apr 14 10:05:01 EDT 2008	1208181901320	/atg/commerce/order/OrderManager	...
+ *																		-> Mon Apr 14 10:00, /atg/commerce/order/OrderManager
+ *
+ * a component path wins over a catch-all category like STDOUT or SystemOut. a line with no time on
+ * it (a stack frame, the rest of a multi line message) is counted with the line before it
+ */
+
+#ifndef ATGCOLORIZE_STATS_H
+#define ATGCOLORIZE_STATS_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_stats atgc_stats;
+
+// the ways counts are grouped
+#define ATGC_STATS_BY_TIME 0
+#define ATGC_STATS_BY_CATEGORY 1
+#define ATGC_STATS_BY_TIME_AND_CATEGORY 2
+
+typedef struct atgc_stats_row
+{
+	const char* time; // start of the stretch of time, NULL when grouped by category only
+	const char* category; // NULL when grouped by time only
+	unsigned long long counts[ATGC_NUM_LINE_TYPES]; // by line type, blank lines aren't counted
+	unsigned long long total;
+} atgc_stats_row;
+
+// bucketMinutes is how long a stretch of time is, 0 for the default (60)
+ATGC_API atgc_stats* atgc_stats_create(unsigned int bucketMinutes);
+ATGC_API void atgc_stats_destroy(atgc_stats* stats);
+
+// hands the statistics the next line along with the type the classifier gave it. when memory runs out the line isn't counted
+ATGC_API void atgc_stats_add(atgc_stats* stats, const char* line, size_t length, int lineType);
+
+// how many rows a grouping has, and one of them. rows come in the order they were first seen
+ATGC_API size_t atgc_stats_count(const atgc_stats* stats, int grouping);
+ATGC_API void atgc_stats_get(const atgc_stats* stats, int grouping, size_t index, atgc_stats_row* row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_STATS_H
@@ -0,0 +1,514 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * log storm collapsing. see atgcolorize_storm.h
+ *
+ * every slot keeps its own count, and the slots being counted are listed in countingSlots so the
+ * ones whose storm went quiet can be found without going through the table on every line. a
+ * summary goes out in front of the line it was noticed on, so it's never printed after a line
+ * that was logged before the last of the lines it counts.
+ *
+ * the table is direct mapped: a template goes in the slot its hash picks, and takes it over from
+ * whatever template had it, letting out the summary of the old one first. a storm is one template
+ * seen over and over, so it stays in its slot; the templates that only show up now and then come
+ * and go without a storm ever being noticed for them, which is what they should get.
+ *
+ * a batch goes through in three steps: every line is looked up and either let through or
+ * counted, the lines let through are classified together, then they go out in order with the
+ * summaries between them. a summary takes the type of the last line of its template let through,
+ * which the third step has always seen by the time it gets to the summary
+ */
+
+#include "atgcolorize_storm.h"
+#include "atgcolorize_internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <new>
+
+using namespace std;
+
+const unsigned int DEFAULT_FIRST_LINES = 5;
+const unsigned int DEFAULT_SUMMARY_MS = 5000;
+
+// a template that isn't seen for this long, or for this many lines, is no longer a storm. the
+// lines of a log file all come in at once, it's the second one that tells a storm from a line
+// that's just common
+const unsigned long long QUIET_MS = 1000;
+const unsigned long long QUIET_LINES = 1000;
+
+// must be a power of two
+const size_t TABLE_SIZE = 256;
+
+// bytes of a line without its digits hashed together
+const size_t HASH_CHUNK = 256;
+
+// longer templates are cut in the summary
+const size_t MAX_TEMPLATE_LENGTH = 160;
+
+const unsigned long long MS_PER_DAY = 24 * 60 * 60 * 1000ULL;
+
+// what happens to each line of a batch
+const unsigned char LINE_COUNTED = 0;
+const unsigned char LINE_LET_THROUGH = 1; // and its type goes to its slot
+const unsigned char LINE_PASSED = 2; // a blank or trace line let through, no slot
+
+struct StormSlot
+{
+	uint64_t hash; // 0 for an empty slot
+	int lineType; // of the last line let through
+	unsigned int letThrough; // lines let through since the template was last quiet
+	unsigned long long counted; // lines counted since the last summary
+	unsigned long long countingSinceMs;
+	unsigned long long lastSeenMs;
+	unsigned long long lastSeenLine;
+
+	// the first line counted with its digits as #, and the time written on the first and last ones
+	char pattern[MAX_TEMPLATE_LENGTH];
+	size_t patternLength;
+	bool logTimed;
+	unsigned long long firstLogMs;
+	unsigned long long lastLogMs;
+};
+
+// a summary going out in front of a line of the batch
+struct StormSummary
+{
+	size_t before;
+	size_t slot;
+	unsigned long long count;
+	unsigned long long elapsedMs;
+	char pattern[MAX_TEMPLATE_LENGTH];
+	size_t patternLength;
+};
+
+struct atgc_storm
+{
+	StormSlot slots[TABLE_SIZE];
+	unsigned int firstLines;
+	unsigned int summaryMs;
+	// the slots with lines counted that no summary went out for yet, in the order counting started
+	size_t countingSlots[TABLE_SIZE];
+	size_t numCounting;
+	bool droppingTrace; // the line the current trace follows was only counted
+	unsigned long long lines; // lines looked up in the table so far
+	unsigned long long collapsed;
+
+	// the batch being worked on
+	vector<unsigned char> actions;
+	vector<size_t> actionSlots;
+	vector<const char*> classifiedLines;
+	vector<size_t> classifiedLengths;
+	vector<int> classifiedTypes;
+	vector<StormSummary> summaries;
+};
+
+// FNV-1a taken 8 bytes at a time and mixed some more
+static uint64_t hashChunk(uint64_t hash, const char* bytes, size_t length)
+{
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, bytes + i, 8);
+		hash = (hash ^ word) * FNV_PRIME;
+		hash ^= hash >> 29;
+	}
+	uint64_t word = 0;
+	memcpy(&word, bytes + i, length - i);
+	hash = (hash ^ word ^ length) * FNV_PRIME;
+	return hash ^ (hash >> 29);
+}
+
+/*
+ *	the hash of the line with its digits taken out. the bytes that stay are copied together a
+ *	chunk at a time without a branch on each of them, then hashed 8 at a time
+ */
+static uint64_t templateHash(const char* line, size_t length)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	char chunk[HASH_CHUNK];
+	for (size_t begin = 0; begin < length; begin += HASH_CHUNK)
+	{
+		size_t end = min(length, begin + HASH_CHUNK);
+		size_t kept = 0;
+		for (size_t i = begin; i < end; i++)
+		{
+			chunk[kept] = line[i];
+			kept += ((unsigned char) (line[i] - '0') > 9);
+		}
+		hash = hashChunk(hash, chunk, kept);
+	}
+	return (hash != 0 ? hash : 1);
+}
+
+static bool isBlank(const char* line, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ *	the time of day written on the line, in milliseconds, from the hh:mm:ss of its timestamp and
+ *	the milliseconds after it when there are some. false when the line has no timestamp
+ */
+static bool logTimeMs(const char* line, size_t length, unsigned long long& ms)
+{
+	size_t timestampLength = 0;
+	const char* timestamp = findTimestamp(line, length, timestampLength);
+	if (timestamp == NULL)
+	{
+		return false;
+	}
+	const char* colon = (const char*) memchr(timestamp, ':', timestampLength);
+	while (colon != NULL && !(colon > timestamp && isDigit(colon[-1]) && colon + 5 < timestamp + timestampLength && colon[3] == ':'))
+	{
+		colon = (const char*) memchr(colon + 1, ':', timestamp + timestampLength - colon - 1);
+	}
+	if (colon == NULL)
+	{
+		return false;
+	}
+	const char* hour = colon - 1;
+	unsigned long long hours = *hour - '0';
+	if (hour > timestamp && isDigit(hour[-1]))
+	{
+		hours += (hour[-1] - '0') * 10;
+	}
+	unsigned long long minutes = (colon[1] - '0') * 10 + (colon[2] - '0');
+	unsigned long long seconds = (colon[4] - '0') * 10 + (colon[5] - '0');
+	ms = ((hours * 60 + minutes) * 60 + seconds) * 1000;
+
+	// ,320 .320 or :799, to the millisecond
+	const char* end = timestamp + timestampLength;
+	const char* fraction = colon + 6;
+	if (fraction + 1 < end && (*fraction == ',' || *fraction == '.' || *fraction == ':'))
+	{
+		unsigned long long scale = 100;
+		for (fraction++; fraction < end && isDigit(*fraction) && scale > 0; fraction++, scale /= 10)
+		{
+			ms += (*fraction - '0') * scale;
+		}
+	}
+	return true;
+}
+
+// the line after its timestamp with each run of digits as a #, as it's shown in the summary
+static void templateText(const char* line, size_t length, char* pattern, size_t& patternLength)
+{
+	patternLength = 0;
+	size_t start = 0;
+	size_t timestampLength = 0;
+	const char* timestamp = findTimestamp(line, length, timestampLength);
+	if (timestamp != NULL)
+	{
+		start = timestamp - line + timestampLength;
+		while (start < length && (line[start] == ' ' || line[start] == '\t'))
+		{
+			start++;
+		}
+	}
+	for (size_t i = start; i < length && patternLength < MAX_TEMPLATE_LENGTH; i++)
+	{
+		if (!isDigit(line[i]))
+		{
+			pattern[patternLength++] = line[i];
+		}
+		else if (i == start || !isDigit(line[i - 1]))
+		{
+			pattern[patternLength++] = '#';
+		}
+	}
+}
+
+// "... repeated N times in Xs: template"
+static void emitSummary(unsigned long long count, unsigned long long elapsedMs, const char* pattern, size_t patternLength, int lineType, atgc_storm_emit emit, void* context)
+{
+	char summary[96 + MAX_TEMPLATE_LENGTH];
+	int headerLength = snprintf(summary, 96, "... repeated %llu times in %llu.%llus: ", count, elapsedMs / 1000, (elapsedMs % 1000) / 100);
+	memcpy(summary + headerLength, pattern, patternLength);
+	emit(context, summary, headerLength + patternLength, lineType);
+}
+
+// how long the lines counted in slot went on for: by the times written on them when they had some, by the clock otherwise
+static unsigned long long countedMs(const StormSlot& slot, unsigned long long nowMs)
+{
+	if (slot.logTimed)
+	{
+		// past midnight
+		return (slot.lastLogMs >= slot.firstLogMs ? slot.lastLogMs - slot.firstLogMs : slot.lastLogMs + MS_PER_DAY - slot.firstLogMs);
+	}
+	return (nowMs > slot.countingSinceMs ? nowMs - slot.countingSinceMs : 0);
+}
+
+// the summary of the lines counted in slot, to go out in front of line before of the batch
+static void summarize(atgc_storm* storm, size_t slot, unsigned long long nowMs, size_t before)
+{
+	StormSlot& counting = storm->slots[slot];
+	if (counting.counted == 0)
+	{
+		return;
+	}
+	StormSummary summary;
+	summary.before = before;
+	summary.slot = slot;
+	summary.count = counting.counted;
+	summary.elapsedMs = countedMs(counting, nowMs);
+	memcpy(summary.pattern, counting.pattern, counting.patternLength);
+	summary.patternLength = counting.patternLength;
+	storm->summaries.push_back(summary);
+	counting.counted = 0;
+	for (size_t i = 0; i < storm->numCounting; i++)
+	{
+		if (storm->countingSlots[i] == slot)
+		{
+			memmove(&storm->countingSlots[i], &storm->countingSlots[i + 1], (storm->numCounting - i - 1) * sizeof(size_t));
+			storm->numCounting--;
+			break;
+		}
+	}
+}
+
+// the summaries of the storms that stopped, a second or a thousand lines ago, go out in front of line before
+static void summarizeQuiet(atgc_storm* storm, unsigned long long nowMs, size_t before)
+{
+	for (size_t i = 0; i < storm->numCounting; )
+	{
+		StormSlot& slot = storm->slots[storm->countingSlots[i]];
+		if (nowMs - slot.lastSeenMs > QUIET_MS || storm->lines - slot.lastSeenLine > QUIET_LINES)
+		{
+			// takes it off the list, the next one moves to i
+			summarize(storm, storm->countingSlots[i], slot.lastSeenMs, before);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+// looks line up in the table and says what happens to it
+static unsigned char collapse(atgc_storm* storm, const char* line, size_t length, unsigned long long nowMs, size_t index, size_t& slotIndex)
+{
+	if (isBlank(line, length))
+	{
+		return LINE_PASSED;
+	}
+	if (isTraceLine(line, length))
+	{
+		if (storm->droppingTrace)
+		{
+			storm->collapsed++;
+			return LINE_COUNTED;
+		}
+		return LINE_PASSED;
+	}
+
+	uint64_t hash = templateHash(line, length);
+	storm->lines++;
+	slotIndex = hash & (TABLE_SIZE - 1);
+	StormSlot& slot = storm->slots[slotIndex];
+
+	/*
+	 *	templates are counted each in its own slot, so storms of several lines taking turns (an
+	 *	error, its exception and its trace) are all collapsed. a count only goes out once its storm
+	 *	is over, every summaryMs while it lasts, or when another template takes its slot
+	 */
+	if (storm->numCounting > 0)
+	{
+		summarizeQuiet(storm, nowMs, index);
+	}
+	if (slot.hash != hash)
+	{
+		summarize(storm, slotIndex, nowMs, index);
+		slot.hash = hash;
+		slot.letThrough = 0;
+	}
+	else if (nowMs - slot.lastSeenMs > QUIET_MS || storm->lines - slot.lastSeenLine > QUIET_LINES)
+	{
+		// the storm is over
+		summarize(storm, slotIndex, slot.lastSeenMs, index);
+		slot.letThrough = 0;
+	}
+	slot.lastSeenMs = nowMs;
+	slot.lastSeenLine = storm->lines;
+
+	if (slot.letThrough < storm->firstLines)
+	{
+		slot.letThrough++;
+		storm->droppingTrace = false;
+		return LINE_LET_THROUGH;
+	}
+	storm->droppingTrace = true;
+	storm->collapsed++;
+	unsigned long long logMs = 0;
+	bool logTimed = logTimeMs(line, length, logMs);
+	if (slot.counted++ == 0)
+	{
+		slot.countingSinceMs = nowMs;
+		templateText(line, length, slot.pattern, slot.patternLength);
+		slot.logTimed = logTimed;
+		slot.firstLogMs = logMs;
+		slot.lastLogMs = logMs;
+		storm->countingSlots[storm->numCounting++] = slotIndex;
+	}
+	else if (logTimed && slot.logTimed)
+	{
+		slot.lastLogMs = logMs;
+	}
+	if (nowMs - slot.countingSinceMs >= storm->summaryMs)
+	{
+		summarize(storm, slotIndex, nowMs, index + 1);
+	}
+	return LINE_COUNTED;
+}
+
+atgc_storm* atgc_storm_create(unsigned int firstLines, unsigned int summaryMs)
+{
+	atgc_storm* storm = new (nothrow) atgc_storm();
+	if (storm == NULL)
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i < TABLE_SIZE; i++)
+	{
+		StormSlot& slot = storm->slots[i];
+		slot.hash = 0;
+		slot.lineType = 0;
+		slot.letThrough = 0;
+		slot.counted = 0;
+		slot.countingSinceMs = 0;
+		slot.lastSeenMs = 0;
+		slot.lastSeenLine = 0;
+		slot.patternLength = 0;
+		slot.logTimed = false;
+		slot.firstLogMs = 0;
+		slot.lastLogMs = 0;
+	}
+	storm->firstLines = (firstLines > 0 ? firstLines : DEFAULT_FIRST_LINES);
+	storm->summaryMs = (summaryMs > 0 ? summaryMs : DEFAULT_SUMMARY_MS);
+	storm->numCounting = 0;
+	storm->droppingTrace = false;
+	storm->lines = 0;
+	storm->collapsed = 0;
+	return storm;
+}
+
+void atgc_storm_destroy(atgc_storm* storm)
+{
+	delete storm;
+}
+
+void atgc_storm_classify_batch(atgc_storm* storm, atgc_stream* stream, const char* const* lines, const size_t* lengths, size_t count,
+	unsigned long long nowMs, atgc_storm_emit emit, void* context)
+{
+	storm->classifiedLines.clear();
+	storm->classifiedLengths.clear();
+	storm->classifiedTypes.clear();
+	storm->summaries.clear();
+	size_t collapsed = 0; // the lines looked up before memory ran out, all of them when it didn't
+	try
+	{
+		storm->actions.resize(count);
+		storm->actionSlots.resize(count);
+		for (; collapsed < count; collapsed++)
+		{
+			// room for what looking the line up can add, so collapse never allocates
+			makeRoom(storm->summaries, storm->numCounting + 1);
+			makeRoom(storm->classifiedLines, 1);
+			makeRoom(storm->classifiedLengths, 1);
+			makeRoom(storm->classifiedTypes, storm->classifiedLines.size() + 1);
+			size_t i = collapsed;
+			storm->actions[i] = collapse(storm, lines[i], lengths[i], nowMs, i, storm->actionSlots[i]);
+			if (storm->actions[i] != LINE_COUNTED)
+			{
+				storm->classifiedLines.push_back(lines[i]);
+				storm->classifiedLengths.push_back(lengths[i]);
+			}
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		// the rest of the batch goes through below
+	}
+
+	size_t classified = storm->classifiedLines.size();
+	storm->classifiedTypes.resize(classified);
+	if (classified > 0)
+	{
+		atgc_classify_batch(stream, &storm->classifiedLines[0], &storm->classifiedLengths[0], classified, &storm->classifiedTypes[0]);
+	}
+
+	size_t next = 0; // next classified line
+	size_t summary = 0;
+	for (size_t i = 0; i <= collapsed; i++)
+	{
+		for (; summary < storm->summaries.size() && storm->summaries[summary].before == i; summary++)
+		{
+			const StormSummary& pending = storm->summaries[summary];
+			emitSummary(pending.count, pending.elapsedMs, pending.pattern, pending.patternLength, storm->slots[pending.slot].lineType, emit, context);
+		}
+		if (i == collapsed || storm->actions[i] == LINE_COUNTED)
+		{
+			continue;
+		}
+		int lineType = storm->classifiedTypes[next++];
+		if (storm->actions[i] == LINE_LET_THROUGH)
+		{
+			storm->slots[storm->actionSlots[i]].lineType = lineType;
+		}
+		emit(context, lines[i], lengths[i], lineType);
+	}
+
+	// memory ran out: the lines that weren't looked up are let through, classified one at a time
+	for (size_t i = collapsed; i < count; i++)
+	{
+		int lineType = atgc_classify_line(stream, lines[i], lengths[i]);
+		emit(context, lines[i], lengths[i], (lineType == ATGC_NO_MEMORY ? ATGC_OTHER_LINE : lineType));
+	}
+}
+
+int atgc_storm_pending(const atgc_storm* storm)
+{
+	return storm->numCounting > 0;
+}
+
+void atgc_storm_flush(atgc_storm* storm, unsigned long long nowMs, atgc_storm_emit emit, void* context)
+{
+	for (size_t i = 0; i < storm->numCounting; i++)
+	{
+		StormSlot& slot = storm->slots[storm->countingSlots[i]];
+		emitSummary(slot.counted, countedMs(slot, nowMs), slot.pattern, slot.patternLength, slot.lineType, emit, context);
+		slot.counted = 0;
+	}
+	storm->numCounting = 0;
+}
+
+unsigned long long atgc_storm_collapsed(const atgc_storm* storm)
+{
+	return storm->collapsed;
+}
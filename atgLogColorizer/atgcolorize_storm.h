@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * log storm collapsing for libatgcolorize. a component stuck in a loop can write the same error
+ * hundreds of thousands of times a minute, and the terminal can't keep up. each line is reduced
+ * to a template, the line with its digits taken out, so timestamps, thread names and order ids
+ * don't make lines different. a template that keeps coming back less than a second and a
+ * thousand lines apart has its first few lines let through, then is only counted, with a line like
+ *
+ *		... repeated 48213 times in 5.0s: ERROR [OrderManager] order o# failed
+ *
+ * let through every few seconds while it lasts and once it's over, in the color of the line.
+ * templates are counted each on its own, so a storm of several lines taking turns, like an error
+ * followed by its exception and stack trace, is collapsed as well. the time is the one written
+ * on the lines when they have one, so a log file says how long the storm went on for, not how
+ * long it took to read.
+ * the collapser sits in front of the classifier: templates are kept in a small table indexed by
+ * their hash, so a line costs a pass over its bytes and a table lookup, and a line that is only
+ * counted is neither classified nor rendered. a stack trace goes with the line in front of it:
+ * it's let through or counted along with it
+ */
+
+#ifndef ATGCOLORIZE_STORM_H
+#define ATGCOLORIZE_STORM_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_storm atgc_storm;
+
+// called for every line let through and for the summaries, in order. the line is only valid during the call
+typedef void (*atgc_storm_emit)(void* context, const char* line, size_t length, int lineType);
+
+/*
+	firstLines is how many lines of a storm are let through before it's only counted, 0 for the
+	default (5). summaryMs is how often the count is let through while the storm goes on, 0 for
+	the default (5000)
+*/
+ATGC_API atgc_storm* atgc_storm_create(unsigned int firstLines, unsigned int summaryMs);
+ATGC_API void atgc_storm_destroy(atgc_storm* storm);
+
+/*
+	takes the next lines of the log, classifies with stream the ones it lets through and hands
+	them to emit with their type, along with the summaries. nowMs is the time in milliseconds from
+	any fixed start. a line only counted is the same line as the ones let through before it, and
+	would have been classified the same way, so leaving it out doesn't change how the lines after
+	it are classified. when memory runs out the rest of the batch is let through as it is
+*/
+ATGC_API void atgc_storm_classify_batch(atgc_storm* storm, atgc_stream* stream, const char* const* lines, const size_t* lengths, size_t count,
+	unsigned long long nowMs, atgc_storm_emit emit, void* context);
+
+// non-zero when lines were counted that no summary went out for yet
+ATGC_API int atgc_storm_pending(const atgc_storm* storm);
+
+// lets the summaries of the counted lines through, eg. when the input goes quiet or ends
+ATGC_API void atgc_storm_flush(atgc_storm* storm, unsigned long long nowMs, atgc_storm_emit emit, void* context);
+
+// lines only counted so far
+ATGC_API unsigned long long atgc_storm_collapsed(const atgc_storm* storm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_STORM_H
@@ -0,0 +1,532 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * thread dump analyzer. see atgcolorize_threads.h
+ *
+ * what a HotSpot dump looks like, the state line only being there from Java 6 on:
+ *
+ *		Full thread dump Java HotSpot(TM) Server VM (1.5.0_12-b04 mixed mode):
+ *
+ *		"http-8080-Processor25" daemon prio=1 tid=0x08a4b0d8 nid=0x2d3d waiting for monitor entry [0xa2fff000..0xa2fff8c0]
+ *		   java.lang.Thread.State: BLOCKED (on object monitor)
+ *			at atg.service.cache.Cache.get(Cache.java:412)
+ *			- waiting to lock <0x5e8b2c38> (a atg.service.cache.Cache)
+ *			at atg.commerce.catalog.CatalogTools.findProduct(CatalogTools.java:301)
+ *			- locked <0x5e8b2c40> (a atg.commerce.catalog.CatalogTools)
+ *
+ * a thread blocked on a monitor ("waiting to lock") or a java.util.concurrent lock ("parking to
+ * wait for") waits for the thread holding it ("locked", or listed under "Locked ownable
+ * synchronizers"). every thread waits for at most one other, so following those links from each
+ * thread finds every deadlock in one pass over the threads
+ */
+
+#include "atgcolorize_threads.h"
+#include "atgcolorize_internal.h"
+
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <new>
+
+using namespace std;
+
+const char* const THREAD_STATE_NAMES[ATGC_NUM_THREAD_STATES] = { "UNKNOWN", "NEW", "RUNNABLE", "BLOCKED", "WAITING", "TIMED_WAITING", "TERMINATED" };
+
+// what the thread header says on VMs that don't print the state, checked in this order
+struct StateHint
+{
+	const char* text;
+	int state;
+};
+
+const StateHint STATE_HINTS[] =
+{
+	{ "waiting for monitor entry", ATGC_THREAD_BLOCKED },
+	{ "in Object.wait()", ATGC_THREAD_WAITING },
+	{ "waiting on condition", ATGC_THREAD_WAITING },
+	{ "sleeping", ATGC_THREAD_TIMED_WAITING },
+	{ "runnable", ATGC_THREAD_RUNNABLE },
+};
+
+const uint32_t NO_THREAD = 0xFFFFFFFF;
+
+struct DumpThread
+{
+	string name;
+	int state;
+	string blockedOn;
+	string blockedOnClass;
+	vector<string> locksHeld;
+};
+
+struct MonitorSummary
+{
+	string address;
+	string className;
+	string owner;
+	bool owned;
+	size_t waiters;
+};
+
+struct DumpSummary
+{
+	string time;
+	size_t threads;
+	size_t states[ATGC_NUM_THREAD_STATES];
+	vector<string> deadlocks;
+	vector<const char*> deadlockTexts;
+	vector<MonitorSummary> monitors;
+	vector<atgc_contended_monitor> monitorViews;
+};
+
+struct atgc_thread_dumps
+{
+	atgc_dump_thread_callback callback;
+	void* context;
+
+	bool inDump;
+	bool inThread;
+	string lastTime; // the time on the last line before a dump
+	string dumpTime;
+	vector<DumpThread> threads; // of the dump being read, reused from dump to dump
+	size_t numThreads;
+
+	// frames of the thread being read, kept apart so their strings are reused from thread to thread
+	vector<string> frames;
+	size_t numFrames;
+	vector<const char*> frameTexts;
+	vector<const char*> lockTexts;
+
+	deque<DumpSummary> summaries; // a deque so the summaries don't move
+};
+
+static bool startsWith(const char* line, size_t length, const char* text)
+{
+	size_t textLength = strlen(text);
+	return length >= textLength && memcmp(line, text, textLength) == 0;
+}
+
+// the text between < and > after where, as in "- locked <0x5e8b2c38> (a java.lang.Object)"
+static bool readAddress(const char* line, size_t length, string& address)
+{
+	const char* open = (const char*) memchr(line, '<', length);
+	const char* close = (open != NULL ? (const char*) memchr(open, '>', line + length - open) : NULL);
+	if (close == NULL)
+	{
+		return false;
+	}
+	address.assign(open + 1, close - open - 1);
+	return true;
+}
+
+static void readClassName(const char* line, size_t length, string& className)
+{
+	const char* a = findText(line, length, "(a ", 3);
+	const char* close = (a != NULL ? (const char*) memchr(a, ')', line + length - a) : NULL);
+	if (close == NULL)
+	{
+		className.clear();
+		return;
+	}
+	className.assign(a + 3, close - a - 3);
+}
+
+static DumpThread& currentThread(atgc_thread_dumps* dumps)
+{
+	return dumps->threads[dumps->numThreads - 1];
+}
+
+// "name" daemon prio=1 tid=0x08a4b0d8 nid=0x2d3d waiting for monitor entry [0xa2fff000..0xa2fff8c0]
+static void beginThread(atgc_thread_dumps* dumps, const char* line, size_t length)
+{
+	if (dumps->numThreads == dumps->threads.size())
+	{
+		dumps->threads.push_back(DumpThread());
+	}
+	dumps->numThreads++;
+	DumpThread& thread = currentThread(dumps);
+	thread.state = ATGC_THREAD_UNKNOWN;
+	thread.blockedOn.clear();
+	thread.blockedOnClass.clear();
+	thread.locksHeld.clear();
+	dumps->numFrames = 0;
+	dumps->inThread = true;
+
+	// the name ends at the last quote before the attributes, names can have quotes in them
+	const char* attributes = findText(line, length, " prio=", 6);
+	const char* tid = findText(line, length, " tid=", 5);
+	attributes = (attributes == NULL || (tid != NULL && tid < attributes) ? tid : attributes);
+	const char* nameEnd = (attributes != NULL ? attributes : line + length);
+	while (nameEnd > line + 1 && nameEnd[-1] != '"')
+	{
+		nameEnd--;
+	}
+	nameEnd = (nameEnd > line + 1 ? nameEnd - 1 : line + length);
+	thread.name.assign(line + 1, nameEnd - line - 1);
+
+	for (size_t i = 0; i < sizeof(STATE_HINTS) / sizeof(STATE_HINTS[0]); i++)
+	{
+		if (findText(nameEnd, line + length - nameEnd, STATE_HINTS[i].text, strlen(STATE_HINTS[i].text)) != NULL)
+		{
+			thread.state = STATE_HINTS[i].state;
+			break;
+		}
+	}
+}
+
+static void finishThread(atgc_thread_dumps* dumps)
+{
+	if (!dumps->inThread)
+	{
+		return;
+	}
+	dumps->inThread = false;
+	if (dumps->callback == NULL)
+	{
+		return;
+	}
+
+	const DumpThread& thread = currentThread(dumps);
+	dumps->frameTexts.clear();
+	for (size_t i = 0; i < dumps->numFrames; i++)
+	{
+		dumps->frameTexts.push_back(dumps->frames[i].c_str());
+	}
+	dumps->lockTexts.clear();
+	for (size_t i = 0; i < thread.locksHeld.size(); i++)
+	{
+		dumps->lockTexts.push_back(thread.locksHeld[i].c_str());
+	}
+	atgc_dump_thread view;
+	view.dump = dumps->summaries.size();
+	view.name = thread.name.c_str();
+	view.state = thread.state;
+	view.frames = (dumps->frameTexts.empty() ? NULL : &dumps->frameTexts[0]);
+	view.numFrames = dumps->frameTexts.size();
+	view.blockedOn = (thread.blockedOn.empty() ? NULL : thread.blockedOn.c_str());
+	view.locksHeld = (dumps->lockTexts.empty() ? NULL : &dumps->lockTexts[0]);
+	view.numLocksHeld = dumps->lockTexts.size();
+	dumps->callback(dumps->context, &view);
+}
+
+struct MoreWaiters
+{
+	bool operator()(const MonitorSummary& a, const MonitorSummary& b) const
+	{
+		return a.waiters > b.waiters;
+	}
+};
+
+// "t1" is blocked on <0x5e8b2c38> (a atg.service.cache.Cache), held by "t2"
+static string describeWait(const DumpThread& thread, const DumpThread& owner)
+{
+	string text = "\"" + thread.name + "\" is blocked on <" + thread.blockedOn + ">";
+	if (!thread.blockedOnClass.empty())
+	{
+		text += " (a " + thread.blockedOnClass + ")";
+	}
+	return text + ", held by \"" + owner.name + "\"";
+}
+
+static void finishDump(atgc_thread_dumps* dumps)
+{
+	finishThread(dumps);
+	dumps->inDump = false;
+	dumps->summaries.push_back(DumpSummary());
+	DumpSummary& summary = dumps->summaries.back();
+	summary.time = dumps->dumpTime;
+	summary.threads = dumps->numThreads;
+	memset(summary.states, 0, sizeof(summary.states));
+
+	// who holds what
+	unordered_map<string, uint32_t> owners;
+	owners.reserve(dumps->numThreads * 2);
+	for (uint32_t t = 0; t < dumps->numThreads; t++)
+	{
+		const DumpThread& thread = dumps->threads[t];
+		summary.states[thread.state]++;
+		for (size_t l = 0; l < thread.locksHeld.size(); l++)
+		{
+			owners[thread.locksHeld[l]] = t;
+		}
+	}
+
+	// who waits for whom, and how many wait for each monitor
+	vector<uint32_t> waitsFor(dumps->numThreads, NO_THREAD);
+	unordered_map<string, size_t> monitorIndex;
+	for (uint32_t t = 0; t < dumps->numThreads; t++)
+	{
+		const DumpThread& thread = dumps->threads[t];
+		if (thread.blockedOn.empty())
+		{
+			continue;
+		}
+		unordered_map<string, uint32_t>::const_iterator owner = owners.find(thread.blockedOn);
+		if (owner != owners.end() && owner->second != t)
+		{
+			waitsFor[t] = owner->second;
+		}
+		pair<unordered_map<string, size_t>::iterator, bool> added = monitorIndex.insert(make_pair(thread.blockedOn, summary.monitors.size()));
+		if (added.second)
+		{
+			MonitorSummary monitor;
+			monitor.address = thread.blockedOn;
+			monitor.className = thread.blockedOnClass;
+			monitor.owned = (waitsFor[t] != NO_THREAD);
+			monitor.owner = (monitor.owned ? dumps->threads[waitsFor[t]].name : string());
+			monitor.waiters = 0;
+			summary.monitors.push_back(monitor);
+		}
+		summary.monitors[added.first->second].waiters++;
+	}
+
+	/*
+		deadlocks. each walk follows the waits-for links from a thread not seen yet, marking the
+		threads with the walk's number; running into a thread of the same walk closes a cycle.
+		threads marked by an earlier walk lead to a cycle already reported, or to none
+	*/
+	vector<uint32_t> walk(dumps->numThreads, NO_THREAD);
+	for (uint32_t start = 0; start < dumps->numThreads; start++)
+	{
+		uint32_t t = start;
+		while (t != NO_THREAD && walk[t] == NO_THREAD)
+		{
+			walk[t] = start;
+			t = waitsFor[t];
+		}
+		if (t == NO_THREAD || walk[t] != start)
+		{
+			continue;
+		}
+		string cycle;
+		uint32_t first = t;
+		do
+		{
+			cycle += describeWait(dumps->threads[t], dumps->threads[waitsFor[t]]);
+			cycle += "\n";
+			t = waitsFor[t];
+		}
+		while (t != first);
+		summary.deadlocks.push_back(cycle);
+	}
+	for (size_t i = 0; i < summary.deadlocks.size(); i++)
+	{
+		summary.deadlockTexts.push_back(summary.deadlocks[i].c_str());
+	}
+
+	// the monitors with the most waiters
+	size_t kept = min(summary.monitors.size(), (size_t) ATGC_MAX_CONTENDED_MONITORS);
+	partial_sort(summary.monitors.begin(), summary.monitors.begin() + kept, summary.monitors.end(), MoreWaiters());
+	summary.monitors.resize(kept);
+	for (size_t i = 0; i < kept; i++)
+	{
+		const MonitorSummary& monitor = summary.monitors[i];
+		atgc_contended_monitor view;
+		view.address = monitor.address.c_str();
+		view.className = monitor.className.c_str();
+		view.owner = (monitor.owned ? monitor.owner.c_str() : NULL);
+		view.waiters = monitor.waiters;
+		summary.monitorViews.push_back(view);
+	}
+	dumps->numThreads = 0;
+}
+
+atgc_thread_dumps* atgc_thread_dumps_create(void)
+{
+	// the deque of summaries allocates in its constructor, nothrow would only cover the object itself
+	atgc_thread_dumps* dumps = NULL;
+	try
+	{
+		dumps = new atgc_thread_dumps();
+	}
+	catch (const bad_alloc&)
+	{
+		return NULL;
+	}
+	dumps->callback = NULL;
+	dumps->context = NULL;
+	dumps->inDump = false;
+	dumps->inThread = false;
+	dumps->numThreads = 0;
+	dumps->numFrames = 0;
+	return dumps;
+}
+
+void atgc_thread_dumps_destroy(atgc_thread_dumps* dumps)
+{
+	delete dumps;
+}
+
+void atgc_thread_dumps_on_thread(atgc_thread_dumps* dumps, atgc_dump_thread_callback callback, void* context)
+{
+	dumps->callback = callback;
+	dumps->context = context;
+}
+
+static void addLine(atgc_thread_dumps* dumps, const char* line, size_t length)
+{
+	while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' '))
+	{
+		length--;
+	}
+	while (length > 0 && (*line == ' ' || *line == '\t'))
+	{
+		line++;
+		length--;
+	}
+
+	if (isThreadDumpStart(line, length))
+	{
+		if (dumps->inDump)
+		{
+			finishDump(dumps);
+		}
+		dumps->inDump = true;
+		dumps->dumpTime = dumps->lastTime;
+		return;
+	}
+	if (!dumps->inDump)
+	{
+		// a dump is usually printed with the time on the line before it
+		size_t timestampLength = 0;
+		const char* timestamp = (length > 0 ? findTimestamp(line, length, timestampLength) : NULL);
+		if (length > 0)
+		{
+			dumps->lastTime.assign(timestamp != NULL ? timestamp : "", timestamp != NULL ? timestampLength : 0);
+		}
+		return;
+	}
+
+	if (length > 0 && line[0] == '"')
+	{
+		finishThread(dumps);
+		beginThread(dumps, line, length);
+		if (isThreadDumpEnd(line, length))
+		{
+			finishDump(dumps);
+		}
+		return;
+	}
+	if (!dumps->inThread)
+	{
+		return;
+	}
+
+	DumpThread& thread = currentThread(dumps);
+	if (startsWith(line, length, "at "))
+	{
+		if (dumps->numFrames == dumps->frames.size())
+		{
+			dumps->frames.push_back(string());
+		}
+		dumps->frames[dumps->numFrames++].assign(line + 3, length - 3);
+	}
+	else if (startsWith(line, length, "java.lang.Thread.State: "))
+	{
+		for (int state = 0; state < ATGC_NUM_THREAD_STATES; state++)
+		{
+			const char* name = THREAD_STATE_NAMES[state];
+			size_t nameLength = strlen(name);
+			if (length >= 24 + nameLength && memcmp(line + 24, name, nameLength) == 0 && (length == 24 + nameLength || line[24 + nameLength] == ' '))
+			{
+				thread.state = state;
+				break;
+			}
+		}
+	}
+	else if (startsWith(line, length, "- waiting to lock ") || startsWith(line, length, "- parking to wait for "))
+	{
+		if (readAddress(line, length, thread.blockedOn))
+		{
+			readClassName(line, length, thread.blockedOnClass);
+		}
+	}
+	else if (startsWith(line, length, "- locked ") || startsWith(line, length, "- <"))
+	{
+		// "- <0x...>" is a lock under "Locked ownable synchronizers:"
+		thread.locksHeld.push_back(string());
+		if (!readAddress(line, length, thread.locksHeld.back()))
+		{
+			thread.locksHeld.pop_back();
+		}
+	}
+}
+
+// out of memory. the dump being read is left out, a summary it already got keeps what was filled in
+static void dropDump(atgc_thread_dumps* dumps)
+{
+	dumps->inDump = false;
+	dumps->inThread = false;
+	dumps->numThreads = 0;
+	dumps->numFrames = 0;
+}
+
+void atgc_thread_dumps_add(atgc_thread_dumps* dumps, const char* line, size_t length)
+{
+	try
+	{
+		addLine(dumps, line, length);
+	}
+	catch (const bad_alloc&)
+	{
+		dropDump(dumps);
+	}
+}
+
+void atgc_thread_dumps_finish(atgc_thread_dumps* dumps)
+{
+	if (dumps->inDump)
+	{
+		try
+		{
+			finishDump(dumps);
+		}
+		catch (const bad_alloc&)
+		{
+			dropDump(dumps);
+		}
+	}
+}
+
+size_t atgc_thread_dumps_count(const atgc_thread_dumps* dumps)
+{
+	return dumps->summaries.size();
+}
+
+void atgc_thread_dumps_summary(const atgc_thread_dumps* dumps, size_t dump, atgc_thread_dump_summary* summary)
+{
+	memset(summary, 0, sizeof(*summary));
+	if (dump >= dumps->summaries.size())
+	{
+		return;
+	}
+	const DumpSummary& found = dumps->summaries[dump];
+	summary->time = found.time.c_str();
+	summary->threads = found.threads;
+	memcpy(summary->states, found.states, sizeof(summary->states));
+	summary->deadlocks = (found.deadlockTexts.empty() ? NULL : &found.deadlockTexts[0]);
+	summary->numDeadlocks = found.deadlockTexts.size();
+	summary->monitors = (found.monitorViews.empty() ? NULL : &found.monitorViews[0]);
+	summary->numMonitors = found.monitorViews.size();
+}
+
+const char* atgc_thread_state_name(int state)
+{
+	return (state >= 0 && state < ATGC_NUM_THREAD_STATES ? THREAD_STATE_NAMES[state] : THREAD_STATE_NAMES[ATGC_THREAD_UNKNOWN]);
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * thread dump analyzer for libatgcolorize. picks the HotSpot thread dumps (kill -3) out of a log,
+ * between the lines the classifier knows a dump by, and reads every thread in them: its name,
+ * state, stack frames, the monitors it holds and the one it's blocked on. once a dump is complete
+ * it's summed up: how many threads are in each state, whether any threads are deadlocked and
+ * which monitors have the most threads waiting for them.
+ *
+ * only the dump being read is kept, finished dumps are kept as their summary. threads can also
+ * be handed to a callback as they're read, see atgc_thread_dumps_on_thread
+ */
+
+#ifndef ATGCOLORIZE_THREADS_H
+#define ATGCOLORIZE_THREADS_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_thread_dumps atgc_thread_dumps;
+
+// thread states, as in java.lang.Thread.State. older VMs don't print the state, it's guessed from the thread header
+#define ATGC_THREAD_UNKNOWN 0
+#define ATGC_THREAD_NEW 1
+#define ATGC_THREAD_RUNNABLE 2
+#define ATGC_THREAD_BLOCKED 3
+#define ATGC_THREAD_WAITING 4
+#define ATGC_THREAD_TIMED_WAITING 5
+#define ATGC_THREAD_TERMINATED 6
+#define ATGC_NUM_THREAD_STATES 7
+
+// at most this many monitors are kept per dump
+#define ATGC_MAX_CONTENDED_MONITORS 10
+
+typedef struct atgc_dump_thread
+{
+	size_t dump; // which dump, from 0
+	const char* name;
+	int state; // one of the ATGC_THREAD_ constants
+	const char* const* frames; // "atg.commerce.order.OrderManager.loadOrder(OrderManager.java:1280)", innermost first
+	size_t numFrames;
+	const char* blockedOn; // address of the monitor or lock the thread waits to get, NULL if none
+	const char* const* locksHeld; // addresses
+	size_t numLocksHeld;
+} atgc_dump_thread;
+
+typedef struct atgc_contended_monitor
+{
+	const char* address; // as in the dump, eg. 0x5e8b2c38
+	const char* className; // "" when the dump doesn't say
+	const char* owner; // name of the thread holding it, NULL when no thread in the dump does
+	size_t waiters;
+} atgc_contended_monitor;
+
+typedef struct atgc_thread_dump_summary
+{
+	const char* time; // the time on the line before the dump, "" if there was none
+	size_t threads;
+	size_t states[ATGC_NUM_THREAD_STATES];
+	const char* const* deadlocks; // each a cycle of threads, one line per thread
+	size_t numDeadlocks;
+	const atgc_contended_monitor* monitors; // most waiters first
+	size_t numMonitors;
+} atgc_thread_dump_summary;
+
+// called for every thread as soon as it's read. the thread is only valid during the call
+typedef void (*atgc_dump_thread_callback)(void* context, const atgc_dump_thread* thread);
+
+ATGC_API atgc_thread_dumps* atgc_thread_dumps_create(void);
+ATGC_API void atgc_thread_dumps_destroy(atgc_thread_dumps* dumps);
+
+ATGC_API void atgc_thread_dumps_on_thread(atgc_thread_dumps* dumps, atgc_dump_thread_callback callback, void* context);
+
+// hands the analyzer the next line of the log. lines outside of thread dumps are skipped, and so is the rest of a dump memory ran out in
+ATGC_API void atgc_thread_dumps_add(atgc_thread_dumps* dumps, const char* line, size_t length);
+
+// the log ended, a dump that wasn't complete is summed up as it is
+ATGC_API void atgc_thread_dumps_finish(atgc_thread_dumps* dumps);
+
+// dumps summed up so far, and the summary of one of them. the summary stays valid until the analyzer is destroyed
+ATGC_API size_t atgc_thread_dumps_count(const atgc_thread_dumps* dumps);
+ATGC_API void atgc_thread_dumps_summary(const atgc_thread_dumps* dumps, size_t dump, atgc_thread_dump_summary* summary);
+
+ATGC_API const char* atgc_thread_state_name(int state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_THREADS_H
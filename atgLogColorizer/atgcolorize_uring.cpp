@@ -0,0 +1,649 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * io_uring reading and writing. see atgcolorize_uring.h
+ *
+ * the read buffers are a ring of depth chunks: chunk n of the files, counted across all of them,
+ * is read into buffer n % depth, and the buffer only gets the next read once chunk n was handed
+ * over. reads come back in whatever order the disk gets to them but the chunks are handed over in
+ * order, so a slow read holds up the ones behind it without them stopping being read.
+ *
+ * the write buffers are a ring as well. only the oldest one queued is ever being written, so what
+ * goes out stays in order whatever fd it goes to; it's a pipe or a terminal most of the time and
+ * the kernel couldn't write two buffers to those at once anyway
+ *
+ * io_uring is Linux only. elsewhere atgc_uring_create always returns NULL, see the end of the file
+ */
+
+#include "atgcolorize_uring.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include <algorithm>
+#include <vector>
+#include <new>
+
+using namespace std;
+
+const unsigned int DEFAULT_DEPTH = 8;
+const unsigned int MAX_DEPTH = 64;
+
+// the kernel reads ahead by itself within a file, a chunk this size is worth a read of its own
+const size_t READ_CHUNK_SIZE = 256 * 1024;
+
+const unsigned int WRITE_BUFFERS = 4;
+const size_t WRITE_BUFFER_SIZE = 1024 * 1024;
+
+// user_data of a submission is the index of its buffer, with the low bit telling writes from reads
+const unsigned long long WRITE_TAG = 1;
+
+struct UringRead
+{
+	char* buffer;
+	int fd; // closed once the last chunk of the file was handed over
+	size_t file;
+	unsigned long long offset; // in the file, of the first byte of the chunk
+	size_t wanted;
+	size_t length; // read so far
+	bool reading;
+	bool failed;
+	bool endOfFile;
+};
+
+struct UringWrite
+{
+	char* buffer;
+	int fd;
+	size_t length;
+	size_t written;
+};
+
+struct atgc_uring
+{
+	int ringFd;
+	bool fixedBuffers; // the buffers couldn't be registered when the locked memory limit is too low
+
+	void* sqRing;
+	size_t sqRingSize;
+	void* cqRing; // the same mapping as sqRing when the kernel maps both rings at once
+	size_t cqRingSize;
+	io_uring_sqe* sqes;
+	size_t sqesSize;
+	unsigned int* sqHead;
+	unsigned int* sqTail;
+	unsigned int* sqMask;
+	unsigned int* sqArray;
+	unsigned int sqEntries;
+	unsigned int* cqHead;
+	unsigned int* cqTail;
+	unsigned int* cqMask;
+	io_uring_cqe* cqes;
+	unsigned int toSubmit;
+
+	char* buffers; // the read chunks, then the write buffers
+	size_t buffersSize;
+	vector<UringRead> reads;
+	unsigned int depth;
+
+	// where the reads running ahead are at. openFd is -1 between two files
+	size_t nextFile;
+	int openFd;
+	unsigned long long openSize;
+	unsigned long long nextOffset;
+
+	UringWrite writes[WRITE_BUFFERS];
+	unsigned int writeHead; // oldest buffer queued
+	unsigned int writesQueued; // buffers waiting to be written, not counting the one being filled
+	bool writing; // writeHead is being written
+	bool writeFailed;
+};
+
+static int uringSetup(unsigned int entries, io_uring_params* params)
+{
+	return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uringEnter(int ringFd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags)
+{
+	return (int) syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static int uringRegister(int ringFd, unsigned int opcode, const void* arg, unsigned int count)
+{
+	return (int) syscall(__NR_io_uring_register, ringFd, opcode, arg, count);
+}
+
+static void unmapRings(atgc_uring* uring)
+{
+	if (uring->sqes != NULL)
+	{
+		munmap(uring->sqes, uring->sqesSize);
+	}
+	if (uring->cqRing != NULL && uring->cqRing != uring->sqRing)
+	{
+		munmap(uring->cqRing, uring->cqRingSize);
+	}
+	if (uring->sqRing != NULL)
+	{
+		munmap(uring->sqRing, uring->sqRingSize);
+	}
+}
+
+static bool mapRings(atgc_uring* uring, const io_uring_params& params)
+{
+	uring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	uring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap)
+	{
+		uring->sqRingSize = max(uring->sqRingSize, uring->cqRingSize);
+		uring->cqRingSize = uring->sqRingSize;
+	}
+	void* sqRing = mmap(NULL, uring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ringFd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED)
+	{
+		return false;
+	}
+	uring->sqRing = sqRing;
+	void* cqRing = sqRing;
+	if (!singleMap)
+	{
+		cqRing = mmap(NULL, uring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ringFd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED)
+		{
+			return false;
+		}
+	}
+	uring->cqRing = cqRing;
+	uring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes = mmap(NULL, uring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ringFd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+	{
+		return false;
+	}
+	uring->sqes = (io_uring_sqe*) sqes;
+
+	char* sq = (char*) sqRing;
+	uring->sqHead = (unsigned int*) (sq + params.sq_off.head);
+	uring->sqTail = (unsigned int*) (sq + params.sq_off.tail);
+	uring->sqMask = (unsigned int*) (sq + params.sq_off.ring_mask);
+	uring->sqArray = (unsigned int*) (sq + params.sq_off.array);
+	uring->sqEntries = params.sq_entries;
+	char* cq = (char*) cqRing;
+	uring->cqHead = (unsigned int*) (cq + params.cq_off.head);
+	uring->cqTail = (unsigned int*) (cq + params.cq_off.tail);
+	uring->cqMask = (unsigned int*) (cq + params.cq_off.ring_mask);
+	uring->cqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+	return true;
+}
+
+static void submitAndWait(atgc_uring* uring, unsigned int minComplete);
+
+// the next free submission entry, cleared
+static io_uring_sqe* nextSqe(atgc_uring* uring)
+{
+	unsigned int tail = *uring->sqTail;
+	if (tail - __atomic_load_n(uring->sqHead, __ATOMIC_ACQUIRE) >= uring->sqEntries)
+	{
+		submitAndWait(uring, 0);
+	}
+	unsigned int index = tail & *uring->sqMask;
+	io_uring_sqe* sqe = &uring->sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	uring->sqArray[index] = index;
+	__atomic_store_n(uring->sqTail, tail + 1, __ATOMIC_RELEASE);
+	uring->toSubmit++;
+	return sqe;
+}
+
+static void submitRead(atgc_uring* uring, size_t index)
+{
+	UringRead& read = uring->reads[index];
+	io_uring_sqe* sqe = nextSqe(uring);
+	sqe->opcode = (uring->fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ);
+	sqe->fd = read.fd;
+	sqe->off = read.offset + read.length;
+	sqe->addr = (unsigned long long) (read.buffer + read.length);
+	sqe->len = (unsigned int) (read.wanted - read.length);
+	sqe->buf_index = (unsigned short) index;
+	sqe->user_data = index << 1;
+	read.reading = true;
+}
+
+static void submitWrite(atgc_uring* uring)
+{
+	UringWrite& write = uring->writes[uring->writeHead];
+	io_uring_sqe* sqe = nextSqe(uring);
+	sqe->opcode = (uring->fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+	sqe->fd = write.fd;
+	sqe->off = (unsigned long long) -1; // wherever the fd is at, which is all a pipe has
+	sqe->addr = (unsigned long long) (write.buffer + write.written);
+	sqe->len = (unsigned int) (write.length - write.written);
+	sqe->buf_index = (unsigned short) (uring->depth + uring->writeHead);
+	sqe->user_data = ((unsigned long long) uring->writeHead << 1) | WRITE_TAG;
+	uring->writing = true;
+}
+
+static void readCompleted(atgc_uring* uring, size_t index, int result)
+{
+	UringRead& read = uring->reads[index];
+	read.reading = false;
+	if (result == -EINTR || result == -EAGAIN)
+	{
+		submitRead(uring, index);
+	}
+	else if (result < 0)
+	{
+		read.failed = true;
+	}
+	else if (result == 0)
+	{
+		// the file got shorter since it was opened
+		read.wanted = read.length;
+	}
+	else
+	{
+		read.length += result;
+		if (read.length < read.wanted)
+		{
+			submitRead(uring, index);
+		}
+	}
+}
+
+static void writeCompleted(atgc_uring* uring, int result)
+{
+	UringWrite& write = uring->writes[uring->writeHead];
+	uring->writing = false;
+	if (result == -EINTR || result == -EAGAIN)
+	{
+		submitWrite(uring);
+		return;
+	}
+	if (result <= 0)
+	{
+		// the reader went away; what's still queued goes nowhere
+		uring->writeFailed = true;
+		for (unsigned int i = 0; i < WRITE_BUFFERS; i++)
+		{
+			uring->writes[i].length = 0;
+			uring->writes[i].written = 0;
+		}
+		uring->writesQueued = 0;
+		return;
+	}
+	write.written += result;
+	if (write.written < write.length)
+	{
+		submitWrite(uring);
+		return;
+	}
+	write.length = 0;
+	write.written = 0;
+	uring->writeHead = (uring->writeHead + 1) % WRITE_BUFFERS;
+	uring->writesQueued--;
+	if (uring->writesQueued > 0)
+	{
+		submitWrite(uring);
+	}
+}
+
+// submits what was queued, waits for at least minComplete completions and handles all that came back
+static void submitAndWait(atgc_uring* uring, unsigned int minComplete)
+{
+	while (uring->toSubmit > 0 || minComplete > 0)
+	{
+		int submitted = uringEnter(uring->ringFd, uring->toSubmit, minComplete, minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+		if (submitted < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+			{
+				continue;
+			}
+			// nothing will ever complete, don't wait on it
+			uring->toSubmit = 0;
+			break;
+		}
+		uring->toSubmit -= min((unsigned int) submitted, uring->toSubmit);
+		break;
+	}
+
+	unsigned int head = *uring->cqHead;
+	unsigned int tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+	while (head != tail)
+	{
+		const io_uring_cqe& cqe = uring->cqes[head & *uring->cqMask];
+		unsigned long long userData = cqe.user_data;
+		int result = cqe.res;
+		head++;
+		__atomic_store_n(uring->cqHead, head, __ATOMIC_RELEASE);
+		if ((userData & WRITE_TAG) != 0)
+		{
+			writeCompleted(uring, result);
+		}
+		else
+		{
+			readCompleted(uring, (size_t) (userData >> 1), result);
+		}
+		tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+	}
+	if (uring->toSubmit > 0)
+	{
+		// completions handled above can resubmit short reads and writes
+		uringEnter(uring->ringFd, uring->toSubmit, 0, 0);
+		uring->toSubmit = 0;
+	}
+}
+
+/*
+	starts reading the next chunk of the files into buffer index, opening the next file when the
+	last one was read to the end. false when the file can't be opened or isn't a regular file
+*/
+static bool startRead(atgc_uring* uring, const char* const* paths, size_t index)
+{
+	if (uring->openFd < 0)
+	{
+		int fd = open(paths[uring->nextFile], O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return false;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			close(fd);
+			return false;
+		}
+		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		uring->openFd = fd;
+		uring->openSize = st.st_size;
+		uring->nextOffset = 0;
+	}
+
+	UringRead& read = uring->reads[index];
+	read.fd = uring->openFd;
+	read.file = uring->nextFile;
+	read.offset = uring->nextOffset;
+	read.wanted = (size_t) min((unsigned long long) READ_CHUNK_SIZE, uring->openSize - uring->nextOffset);
+	read.length = 0;
+	read.failed = false;
+	read.reading = false;
+	uring->nextOffset += read.wanted;
+	read.endOfFile = (uring->nextOffset == uring->openSize);
+	if (read.endOfFile)
+	{
+		uring->openFd = -1;
+		uring->nextFile++;
+	}
+	if (read.wanted > 0)
+	{
+		submitRead(uring, index);
+	}
+	return true;
+}
+
+atgc_uring* atgc_uring_create(unsigned int depth)
+{
+	if (depth == 0)
+	{
+		depth = DEFAULT_DEPTH;
+	}
+	depth = min(depth, MAX_DEPTH);
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int ringFd = uringSetup(depth + WRITE_BUFFERS, &params);
+	if (ringFd < 0)
+	{
+		return NULL;
+	}
+	// writes go wherever the fd is at, which needs 5.6 or later
+	if ((params.features & IORING_FEAT_RW_CUR_POS) == 0)
+	{
+		close(ringFd);
+		return NULL;
+	}
+
+	atgc_uring* uring = new (nothrow) atgc_uring();
+	if (uring == NULL)
+	{
+		close(ringFd);
+		return NULL;
+	}
+	uring->ringFd = ringFd;
+	uring->depth = depth;
+	uring->openFd = -1;
+	if (!mapRings(uring, params))
+	{
+		atgc_uring_destroy(uring);
+		return NULL;
+	}
+
+	uring->buffersSize = depth * READ_CHUNK_SIZE + WRITE_BUFFERS * WRITE_BUFFER_SIZE;
+	void* buffers = mmap(NULL, uring->buffersSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (buffers == MAP_FAILED)
+	{
+		atgc_uring_destroy(uring);
+		return NULL;
+	}
+	uring->buffers = (char*) buffers;
+
+	vector<iovec> registered;
+	try
+	{
+		registered.resize(depth + WRITE_BUFFERS);
+		uring->reads.resize(depth);
+	}
+	catch (const bad_alloc&)
+	{
+		atgc_uring_destroy(uring);
+		return NULL;
+	}
+	for (unsigned int i = 0; i < depth; i++)
+	{
+		uring->reads[i].buffer = uring->buffers + i * READ_CHUNK_SIZE;
+		uring->reads[i].fd = -1;
+		registered[i].iov_base = uring->reads[i].buffer;
+		registered[i].iov_len = READ_CHUNK_SIZE;
+	}
+	for (unsigned int i = 0; i < WRITE_BUFFERS; i++)
+	{
+		uring->writes[i].buffer = uring->buffers + depth * READ_CHUNK_SIZE + i * WRITE_BUFFER_SIZE;
+		registered[depth + i].iov_base = uring->writes[i].buffer;
+		registered[depth + i].iov_len = WRITE_BUFFER_SIZE;
+	}
+	uring->fixedBuffers = (uringRegister(ringFd, IORING_REGISTER_BUFFERS, &registered[0], (unsigned int) registered.size()) == 0);
+	return uring;
+}
+
+void atgc_uring_destroy(atgc_uring* uring)
+{
+	if (uring == NULL)
+	{
+		return;
+	}
+	unmapRings(uring);
+	// closing the ring waits for whatever is still in flight, only then can the buffers go
+	close(uring->ringFd);
+	if (uring->buffers != NULL)
+	{
+		munmap(uring->buffers, uring->buffersSize);
+	}
+	delete uring;
+}
+
+size_t atgc_uring_read_files(atgc_uring* uring, const char* const* paths, size_t count, atgc_uring_chunk chunk, void* context)
+{
+	uring->nextFile = 0;
+	uring->openFd = -1;
+	size_t failed = count;
+	unsigned long long started = 0;
+	unsigned long long handedOver = 0;
+	while (true)
+	{
+		// keep depth reads going, running ahead into the next files
+		while (failed == count && uring->nextFile < count && started - handedOver < uring->depth)
+		{
+			if (!startRead(uring, paths, (size_t) (started % uring->depth)))
+			{
+				failed = uring->nextFile;
+				break;
+			}
+			started++;
+		}
+		if (handedOver == started)
+		{
+			break;
+		}
+
+		UringRead& read = uring->reads[handedOver % uring->depth];
+		if (read.reading)
+		{
+			submitAndWait(uring, 1);
+			continue;
+		}
+		if (read.failed)
+		{
+			failed = min(failed, read.file);
+			break;
+		}
+		if (uring->toSubmit > 0)
+		{
+			// the reads started above get going before the chunk is worked on
+			submitAndWait(uring, 0);
+		}
+		chunk(context, read.file, read.buffer, read.length, read.endOfFile);
+		if (read.endOfFile)
+		{
+			close(read.fd);
+		}
+		handedOver++;
+	}
+
+	// after a failure the reads still in flight have to come back before their buffers are used again
+	for (; handedOver < started; handedOver++)
+	{
+		UringRead& read = uring->reads[handedOver % uring->depth];
+		while (read.reading)
+		{
+			submitAndWait(uring, 1);
+		}
+		if (read.endOfFile)
+		{
+			close(read.fd);
+		}
+	}
+	if (uring->openFd >= 0)
+	{
+		close(uring->openFd);
+		uring->openFd = -1;
+	}
+	return failed;
+}
+
+int atgc_uring_write(atgc_uring* uring, int fd, const char* bytes, size_t length)
+{
+	while (length > 0 && !uring->writeFailed)
+	{
+		UringWrite& filling = uring->writes[(uring->writeHead + uring->writesQueued) % WRITE_BUFFERS];
+		if (filling.length > 0 && filling.fd != fd)
+		{
+			atgc_uring_flush(uring);
+			continue;
+		}
+		filling.fd = fd;
+		size_t taken = min(length, WRITE_BUFFER_SIZE - filling.length);
+		memcpy(filling.buffer + filling.length, bytes, taken);
+		filling.length += taken;
+		bytes += taken;
+		length -= taken;
+		if (filling.length < WRITE_BUFFER_SIZE)
+		{
+			break;
+		}
+
+		// full, queue it and wait for a buffer to fill next
+		uring->writesQueued++;
+		if (!uring->writing)
+		{
+			submitWrite(uring);
+			submitAndWait(uring, 0);
+		}
+		while (uring->writesQueued == WRITE_BUFFERS && !uring->writeFailed)
+		{
+			submitAndWait(uring, 1);
+		}
+	}
+	return (uring->writeFailed ? -1 : 0);
+}
+
+int atgc_uring_flush(atgc_uring* uring)
+{
+	UringWrite& filling = uring->writes[(uring->writeHead + uring->writesQueued) % WRITE_BUFFERS];
+	if (filling.length > 0 && !uring->writeFailed)
+	{
+		uring->writesQueued++;
+		if (!uring->writing)
+		{
+			submitWrite(uring);
+		}
+	}
+	while (uring->writesQueued > 0 && !uring->writeFailed)
+	{
+		submitAndWait(uring, 1);
+	}
+	return (uring->writeFailed ? -1 : 0);
+}
+
+#else
+
+atgc_uring* atgc_uring_create(unsigned int)
+{
+	return NULL;
+}
+
+void atgc_uring_destroy(atgc_uring*)
+{
+}
+
+size_t atgc_uring_read_files(atgc_uring*, const char* const*, size_t, atgc_uring_chunk, void*)
+{
+	return 0;
+}
+
+int atgc_uring_write(atgc_uring*, int, const char*, size_t)
+{
+	return -1;
+}
+
+int atgc_uring_flush(atgc_uring*)
+{
+	return -1;
+}
+
+#endif // __linux__
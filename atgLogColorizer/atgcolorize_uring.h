@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * io_uring reading and writing for libatgcolorize, for going through a pile of archived logs.
+ * read() and write() one after the other leave the classifier waiting on the disk every time the
+ * next part of a file isn't in the page cache. here several reads are kept in flight, running
+ * ahead into the next files, into buffers registered with the kernel once; the classifier gets
+ * the chunks in order straight out of those buffers. what's written out is queued and written
+ * while the next chunks are classified.
+ *
+ * only the kernel's io_uring system calls are used, no liburing. when io_uring isn't there (an old
+ * kernel, turned off, or not Linux) atgc_uring_create returns NULL and the caller goes back to read() and write()
+ */
+
+#ifndef ATGCOLORIZE_URING_H
+#define ATGCOLORIZE_URING_H
+
+#include "atgcolorize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct atgc_uring atgc_uring;
+
+/*
+	called for each chunk of the files, in order. file is the index of the file in paths, endOfFile
+	is non-zero for its last chunk. the chunk can be written to and is only valid during the call
+*/
+typedef void (*atgc_uring_chunk)(void* context, size_t file, char* chunk, size_t length, int endOfFile);
+
+// depth is how many reads are kept in flight, 0 for the default (8). NULL when io_uring can't be used
+ATGC_API atgc_uring* atgc_uring_create(unsigned int depth);
+ATGC_API void atgc_uring_destroy(atgc_uring* uring);
+
+/*
+	reads the files one after the other and hands their chunks to chunk. only regular files can be
+	read this way. returns the index of the first file that couldn't be read, count when they all were
+*/
+ATGC_API size_t atgc_uring_read_files(atgc_uring* uring, const char* const* paths, size_t count, atgc_uring_chunk chunk, void* context);
+
+/*
+	queues bytes to be written to fd after everything queued before, and returns without waiting
+	for the write unless all the write buffers are taken. -1 once a write failed
+*/
+ATGC_API int atgc_uring_write(atgc_uring* uring, int fd, const char* bytes, size_t length);
+
+// waits until everything queued was written. -1 when a write failed
+ATGC_API int atgc_uring_flush(atgc_uring* uring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATGCOLORIZE_URING_H
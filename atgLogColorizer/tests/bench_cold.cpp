@@ -0,0 +1,180 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * cold cache benchmark of reading log files with io_uring and with read(). writes a directory of
+ * log files, then colors it with the ATGLogColorizer given, --io blocking and --io uring taking
+ * turns, with the files dropped from the page cache before each run. prints the real time, the
+ * CPU time and the difference, the time spent waiting for the disk. run with make bench-cold from
+ * this directory, or as bench_cold [colorizer] [files] [runs]
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// scratch directory for the log files, removed at the end
+const char LOG_DIRECTORY[] = "bench_cold.d";
+
+// 4000 files of about 20KB, 82MB in all
+const int DEFAULT_FILES = 4000;
+const int LINES_PER_FILE = 200;
+const int DEFAULT_RUNS = 3;
+
+const char* const BACKENDS[] = { "blocking", "uring" };
+
+static unsigned int nextRandom(unsigned int& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+// a mix of what an ATG server logs: info lines, errors with their traces, warnings and debug lines
+static void writeLogFile(const string& path, unsigned int seed)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL)
+	{
+		perror(path.c_str());
+		exit(1);
+	}
+	for (int line = 0; line < LINES_PER_FILE; line++)
+	{
+		unsigned int kind = nextRandom(seed) % 20;
+		unsigned int id = nextRandom(seed);
+		if (kind == 0)
+		{
+			fprintf(file, "**** Error\tMon Apr 14 10:05:%02u EDT 2008\t1208181901320\t/atg/commerce/order/OrderManager\tCould not load order o%u\n", id % 60, id);
+			fprintf(file, "CONTAINER:atg.repository.RepositoryException; SOURCE:java.sql.SQLException: Io exception: Connection reset\n");
+			for (int frame = 0; frame < 12; frame++)
+			{
+				fprintf(file, "\tat atg.adapter.gsa.GSAItemDescriptor.loadItem(GSAItemDescriptor.java:%u)\n", 4000 + (id + frame) % 900);
+			}
+			line += 13;
+		}
+		else if (kind == 1)
+		{
+			fprintf(file, "**** Warning\tMon Apr 14 10:05:%02u EDT 2008\t1208181901320\t/atg/dynamo/servlet/pipeline/DynamoHandler\tRequest took %ums\n", id % 60, id);
+		}
+		else if (kind < 5)
+		{
+			fprintf(file, "**** debug\tMon Apr 14 10:05:%02u EDT 2008\t1208181901320\t/atg/userprofiling/ProfileTools\tfound profile u%u\n", id % 60, id);
+		}
+		else
+		{
+			fprintf(file, "2008-04-14 10:05:%02u,%03u INFO  [atg.commerce.order.OrderManager] (http-8080-%u) order o%u loaded for profile u%u\n", id % 60, id % 1000, id % 16, id, id * 7);
+		}
+	}
+	// flushed to the disk, the page cache only drops clean pages
+	fflush(file);
+	fsync(fileno(file));
+	fclose(file);
+}
+
+static void dropFromCache(const string& path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+}
+
+static double seconds(const timeval& time)
+{
+	return time.tv_sec + time.tv_usec / 1e6;
+}
+
+// one run of the colorizer over the directory, output to /dev/null
+static void timeRun(const char* colorizer, const char* backend)
+{
+	timespec start;
+	timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pid_t child = fork();
+	if (child == 0)
+	{
+		int devNull = open("/dev/null", O_WRONLY);
+		dup2(devNull, STDOUT_FILENO);
+		execl(colorizer, colorizer, "--io", backend, LOG_DIRECTORY, (char*) NULL);
+		perror(colorizer);
+		_exit(127);
+	}
+	int status = 0;
+	rusage usage;
+	wait4(child, &status, 0, &usage);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	// the colorizer exits with 1 when it's done, whatever happened
+	if (!WIFEXITED(status) || WEXITSTATUS(status) == 127)
+	{
+		fprintf(stderr, "%s --io %s failed\n", colorizer, backend);
+		exit(1);
+	}
+	double real = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	double cpu = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+	printf("  %-8s  %.2fs  %.2fs  %.2fs\n", backend, real, cpu, (real > cpu ? real - cpu : 0));
+	fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+	const char* colorizer = (argc > 1 ? argv[1] : "./ATGLogColorizer");
+	int numFiles = (argc > 2 ? atoi(argv[2]) : DEFAULT_FILES);
+	int runs = (argc > 3 ? atoi(argv[3]) : DEFAULT_RUNS);
+
+	mkdir(LOG_DIRECTORY, 0755);
+	vector<string> paths;
+	for (int i = 0; i < numFiles; i++)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "%s/server%05d.log", LOG_DIRECTORY, i);
+		paths.push_back(name);
+		writeLogFile(paths.back(), (unsigned int) i + 1);
+	}
+
+	printf("%d files, real, CPU and waiting time of %d runs each\n", numFiles, runs);
+	fflush(stdout);
+	for (int run = 0; run < runs; run++)
+	{
+		for (size_t backend = 0; backend < sizeof(BACKENDS) / sizeof(BACKENDS[0]); backend++)
+		{
+			for (size_t i = 0; i < paths.size(); i++)
+			{
+				dropFromCache(paths[i]);
+			}
+			timeRun(colorizer, BACKENDS[backend]);
+		}
+	}
+
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		unlink(paths[i].c_str());
+	}
+	rmdir(LOG_DIRECTORY);
+	return 0;
+}
@@ -0,0 +1,508 @@
+/**
+ * Copyright (C) 2007-2008 Kelly Goetsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * checks of libatgcolorize. the parsers of the files a user writes or that an earlier run left
+ * behind are fed the fixtures next to this file, or damaged copies of them; the modules that
+ * change what lines go out (storm collapsing, trace folding and filtering) are fed made-up logs.
+ * each case looks at what comes back. run with make check from this directory; the exit code is
+ * the number of failed checks
+ */
+
+#include "atgcolorize.h"
+#include "atgcolorize_ansi.h"
+#include "atgcolorize_filter.h"
+#include "atgcolorize_fold.h"
+#include "atgcolorize_internal.h"
+#include "atgcolorize_storm.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// scratch files for the cache checks, removed at the end
+const char CACHE_RULES_PATH[] = "check_parsers.rules";
+const char CACHE_PATH[] = "check_parsers.cache";
+
+int failures = 0;
+
+static void check(const string& name, bool passed, const char* detail)
+{
+	printf("%s %s", passed ? "ok    " : "FAILED", name.c_str());
+	if (!passed && detail != NULL && detail[0] != '\0')
+	{
+		printf(" (%s)", detail);
+	}
+	printf("\n");
+	failures += (passed ? 0 : 1);
+}
+
+// the type the rules give a line, on a stream of its own
+static int classify(const atgc_rules* rules, const char* line)
+{
+	atgc_stream* stream = atgc_stream_create_with_rules(rules);
+	int lineType = atgc_classify_line(stream, line, strlen(line));
+	atgc_stream_destroy(stream);
+	return lineType;
+}
+
+// a rule file that mustn't compile, with a message naming the file, the line and what's wrong
+static void checkRuleError(const char* path, const char* expected)
+{
+	char error[256] = "";
+	const char* paths[] = { path };
+	atgc_rules* rules = atgc_rules_compile(paths, 1, error, sizeof(error));
+	check(string("rules: ") + path + " is refused", rules == NULL && strstr(error, expected) != NULL, error);
+	atgc_rules_destroy(rules);
+}
+
+static void checkRules()
+{
+	char error[256] = "";
+	const char* paths[] = { "rules/good.rules" };
+	atgc_rules* rules = atgc_rules_compile(paths, 1, error, sizeof(error));
+	check("rules: rules/good.rules compiles", rules != NULL, error);
+	if (rules != NULL)
+	{
+		check("rules: every rule of rules/good.rules is added", atgc_rules_count(rules) == atgc_rules_count(atgc_rules_compile(NULL, 0, NULL, 0)) + 4, NULL);
+		check("rules: contains", classify(rules, "checkout: Order pipeline failed for o123") == ATGC_ERROR_LINE, NULL);
+		check("rules: prefix and contains", classify(rules, "/mycompany/commerce/Checkout aborted") == ATGC_ERROR_LINE, NULL);
+		check("rules: suffix", classify(rules, "payment gateway busy, retrying") == ATGC_WARNING_LINE, NULL);
+		check("rules: regex", classify(rules, "order o42 could not be priced") == ATGC_ERROR_LINE, NULL);
+		check("rules: regex without its text", classify(rules, "order ox could not be priced") != ATGC_ERROR_LINE, NULL);
+		atgc_rules_destroy(rules);
+	}
+
+	// a rule with no priority is checked after the built-in checks, so it doesn't cost every line a scan
+	vector<RuleDefinition> definitions;
+	string parseError;
+	bool parsed = parseRuleFile("rules/good.rules", definitions, parseError);
+	check("rules: a rule has priority 0 unless it says otherwise", parsed && definitions.size() == 4
+		&& definitions[0].priority == 0 && definitions[1].priority == 10, parseError.c_str());
+
+	checkRuleError("rules/bad_regex.rules", "rules/bad_regex.rules:3: bad regex \"order ([0-9]+ failed\"");
+	checkRuleError("rules/unknown_match.rules", "rules/unknown_match.rules:2: expected contains, prefix, suffix or regex instead of 'contans'");
+	checkRuleError("rules/unknown_type.rules", "rules/unknown_type.rules:1: unknown line type 'fatal'");
+	checkRuleError("rules/missing_quote.rules", "rules/missing_quote.rules:1: missing closing quote");
+	checkRuleError("rules/bad_priority.rules", "rules/bad_priority.rules:1: bad priority 'high'");
+	checkRuleError("rules/missing.rules", "rules/missing.rules: couldn't be read");
+}
+
+static vector<char> readFile(const char* path)
+{
+	vector<char> bytes;
+	FILE* file = fopen(path, "rb");
+	if (file != NULL)
+	{
+		char buffer[4096];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			bytes.insert(bytes.end(), buffer, buffer + read);
+		}
+		fclose(file);
+	}
+	return bytes;
+}
+
+static void writeFile(const char* path, const vector<char>& bytes)
+{
+	FILE* file = fopen(path, "wb");
+	if (file != NULL)
+	{
+		if (!bytes.empty())
+		{
+			fwrite(&bytes[0], 1, bytes.size(), file);
+		}
+		fclose(file);
+	}
+}
+
+static void writeText(const char* path, const char* text)
+{
+	writeFile(path, vector<char>(text, text + strlen(text)));
+}
+
+/*
+	loads the scratch rule file through the cache and checks the rule set came from where it
+	should have: mapped from the cache file or compiled again, with the rules of the file in both
+	cases
+*/
+static void checkCacheLoad(const string& name, bool fromCache, size_t numRules)
+{
+	char error[256] = "";
+	const char* paths[] = { CACHE_RULES_PATH };
+	atgc_rules* rules = atgc_rules_load(paths, 1, CACHE_PATH, error, sizeof(error));
+	check("cache: " + name, rules != NULL && (rules->mapping != NULL) == fromCache && atgc_rules_count(rules) == numRules
+		&& classify(rules, "checkout: Order pipeline failed for o123") == ATGC_ERROR_LINE, error);
+	atgc_rules_destroy(rules);
+}
+
+// puts a damaged cache in place of the good one, and checks the next load compiles the rules and writes a good one again
+static void checkDamagedCache(const string& name, size_t numRules, const vector<char>& damaged)
+{
+	writeFile(CACHE_PATH, damaged);
+	checkCacheLoad(name + " is compiled again", false, numRules);
+	checkCacheLoad(name + " is rewritten", true, numRules);
+}
+
+// the cache with length bytes from offset flipped by mask
+static vector<char> flipped(const vector<char>& cache, size_t offset, size_t length, char mask)
+{
+	vector<char> damaged = cache;
+	for (size_t i = offset; i < offset + length && i < damaged.size(); i++)
+	{
+		damaged[i] ^= mask;
+	}
+	return damaged;
+}
+
+static void checkCache()
+{
+	size_t numBuiltinRules = atgc_rules_count(atgc_rules_compile(NULL, 0, NULL, 0));
+	remove(CACHE_PATH);
+	writeText(CACHE_RULES_PATH, "error contains \"Order pipeline failed\"\n");
+	checkCacheLoad("no cache file, the rules are compiled", false, numBuiltinRules + 1);
+	checkCacheLoad("the cache written by the last load is mapped", true, numBuiltinRules + 1);
+
+	// stale: the rule file changed since
+	writeText(CACHE_RULES_PATH, "error contains \"Order pipeline failed\"\nwarning suffix \"retrying\"\n");
+	checkCacheLoad("a stale cache is compiled again", false, numBuiltinRules + 2);
+	checkCacheLoad("a stale cache is rewritten", true, numBuiltinRules + 2);
+
+	// the header starts with an 8 byte magic and the format version
+	vector<char> cache = readFile(CACHE_PATH);
+	checkDamagedCache("a cache with a wrong magic", numBuiltinRules + 2, flipped(cache, 0, 1, 0x20));
+	checkDamagedCache("a cache of another format version", numBuiltinRules + 2, flipped(cache, 8, 1, 0x01));
+	checkDamagedCache("a cache with a byte flipped in its tables", numBuiltinRules + 2, flipped(cache, cache.size() - 2, 1, 0x01));
+	checkDamagedCache("a cache with its tables scrambled", numBuiltinRules + 2, flipped(cache, cache.size() / 2, 64, 0x5a));
+	checkDamagedCache("a truncated cache", numBuiltinRules + 2, vector<char>(cache.begin(), cache.begin() + cache.size() / 2));
+	checkDamagedCache("an empty cache", numBuiltinRules + 2, vector<char>());
+	checkDamagedCache("a cache that is something else", numBuiltinRules + 2, readFile("rules/good.rules"));
+
+	// a cache that can't be written isn't an error
+	char error[256] = "";
+	const char* paths[] = { CACHE_RULES_PATH };
+	atgc_rules* rules = atgc_rules_load(paths, 1, "missing/check_parsers.cache", error, sizeof(error));
+	check("cache: a cache that can't be written", rules != NULL && atgc_rules_count(rules) == numBuiltinRules + 2, error);
+	atgc_rules_destroy(rules);
+
+	remove(CACHE_RULES_PATH);
+	remove(CACHE_PATH);
+}
+
+// the escape sequence a theme compiled for depth starts lines of lineType with
+static void checkThemeColor(const char* name, int depth, int lineType, const char* expected)
+{
+	char error[256] = "";
+	atgc_theme* theme = atgc_theme_load("themes/good.theme", depth, error, sizeof(error));
+	check(string("themes: ") + name, theme != NULL && strcmp(atgc_theme_color(theme, lineType), expected) == 0, error);
+	atgc_theme_destroy(theme);
+}
+
+// a theme file that mustn't load, with a message naming the file, the line and what's wrong
+static void checkThemeError(const char* path, const char* expected)
+{
+	char error[256] = "";
+	atgc_theme* theme = atgc_theme_load(path, ATGC_COLORS_256, error, sizeof(error));
+	check(string("themes: ") + path + " is refused", theme == NULL && strstr(error, expected) != NULL, error);
+	atgc_theme_destroy(theme);
+}
+
+static void checkThemes()
+{
+	checkThemeColor("attribute and basic color", ATGC_COLORS_256, ATGC_ERROR_LINE, "\x1b[1;31m");
+	checkThemeColor("bright color", ATGC_COLORS_16, ATGC_INFO_LINE, "\x1b[92m");
+	checkThemeColor("palette index", ATGC_COLORS_256, ATGC_DEBUG_LINE, "\x1b[38;5;245m");
+	checkThemeColor("background", ATGC_COLORS_256, ATGC_NUCLEUS_LINE, "\x1b[40;35m");
+	checkThemeColor("#rrggbb on a truecolor terminal", ATGC_COLORS_TRUECOLOR, ATGC_WARNING_LINE, "\x1b[38;2;181;137;0m");
+	checkThemeColor("#rrggbb on a 256 color terminal", ATGC_COLORS_256, ATGC_WARNING_LINE, "\x1b[38;5;136m");
+	checkThemeColor("#rrggbb on a 16 color terminal", ATGC_COLORS_16, ATGC_WARNING_LINE, "\x1b[33m");
+	checkThemeColor("a type the file leaves out", ATGC_COLORS_256, ATGC_OTHER_LINE, "\x1b[1;33m");
+	checkThemeColor("no colors", ATGC_COLORS_NONE, ATGC_ERROR_LINE, "");
+
+	checkThemeError("themes/bad_color.theme", "themes/bad_color.theme:3: unknown color 'purple'");
+	checkThemeError("themes/second_color.theme", "themes/second_color.theme:1: 'blue' is a second color, the background one goes after 'on'");
+	checkThemeError("themes/on_without_color.theme", "themes/on_without_color.theme:1: a color has to follow 'on'");
+	checkThemeError("themes/unknown_type.theme", "themes/unknown_type.theme:1: unknown line type 'fatal'");
+	checkThemeError("themes/bad_palette.theme", "themes/bad_palette.theme:1: unknown color '256'");
+	checkThemeError("themes/bad_hex.theme", "themes/bad_hex.theme:1: unknown color '#b5890g'");
+	checkThemeError("themes/missing.theme", "themes/missing.theme: couldn't be read");
+}
+
+// the lines a module let through, in order
+static void collectLine(void* context, const char* line, size_t length, int /*lineType*/)
+{
+	((vector<string>*) context)->push_back(string(line, length));
+}
+
+static size_t countPrefixed(const vector<string>& lines, const char* prefix)
+{
+	size_t found = 0;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		found += (lines[i].compare(0, strlen(prefix), prefix) == 0 ? 1 : 0);
+	}
+	return found;
+}
+
+/*
+	what the storm collapser lets through of lines, all read at once, and of a last line (when not
+	NULL) read two seconds later. then what it lets through once the input ends
+*/
+static void runStorm(const vector<string>& lines, vector<string>& passed, vector<string>& flushed, const char* later = NULL)
+{
+	vector<const char*> pointers;
+	vector<size_t> lengths;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		pointers.push_back(lines[i].data());
+		lengths.push_back(lines[i].size());
+	}
+	atgc_storm* storm = atgc_storm_create(0, 0);
+	atgc_stream* stream = atgc_stream_create();
+	atgc_storm_classify_batch(storm, stream, &pointers[0], &lengths[0], lines.size(), 0, collectLine, &passed);
+	if (later != NULL)
+	{
+		size_t length = strlen(later);
+		atgc_storm_classify_batch(storm, stream, &later, &length, 1, 2000, collectLine, &passed);
+	}
+	atgc_storm_flush(storm, 2000, collectLine, &flushed);
+	atgc_stream_destroy(stream);
+	atgc_storm_destroy(storm);
+}
+
+static void checkStorm()
+{
+	char line[128];
+	vector<string> lines;
+	vector<string> passed;
+	vector<string> flushed;
+
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf(line, sizeof(line), "10:00:%02d,%03d ERROR [OrderManager] order o%d failed", i / 100, (i * 10) % 1000, i);
+		lines.push_back(line);
+		snprintf(line, sizeof(line), "10:00:%02d,%03d WARN [Cache] miss on key %d", i / 100, (i * 10) % 1000, i);
+		lines.push_back(line);
+	}
+	runStorm(lines, passed, flushed);
+	check("storm: two templates taking turns have their first lines let through", passed.size() == 10 && countPrefixed(passed, "...") == 0, NULL);
+	check("storm: two templates taking turns are each counted", flushed.size() == 2
+		&& flushed[0] == "... repeated 995 times in 9.9s: ERROR [OrderManager] order o# failed"
+		&& flushed[1] == "... repeated 995 times in 9.9s: WARN [Cache] miss on key #", NULL);
+
+	lines.clear();
+	passed.clear();
+	flushed.clear();
+	for (int i = 0; i < 500; i++)
+	{
+		snprintf(line, sizeof(line), "10:00:%02d,%03d ERROR [OrderManager] order o%d failed", i / 100, (i * 10) % 1000, i);
+		lines.push_back(line);
+		lines.push_back("java.lang.IllegalStateException: boom");
+		lines.push_back("\tat atg.commerce.order.OrderManager.loadOrder(OrderManager.java:1280)");
+		lines.push_back("\tat atg.service.pipeline.PipelineManager.runProcess(PipelineManager.java:90)");
+	}
+	runStorm(lines, passed, flushed);
+	check("storm: an error and its stack trace over and over have the first few let through", passed.size() == 20 && countPrefixed(passed, "...") == 0, NULL);
+	check("storm: an error and its stack trace over and over are counted, trace and all", flushed.size() == 2
+		&& flushed[0].compare(0, 20, "... repeated 495 tim") == 0 && flushed[0].find(": ERROR [OrderManager] order o# failed") != string::npos
+		&& flushed[1].compare(0, 20, "... repeated 495 tim") == 0 && flushed[1].find(": java.lang.IllegalStateException: boom") != string::npos, NULL);
+
+	// a storm nothing was heard of for a while is over, its count goes out in front of the next line
+	lines.clear();
+	passed.clear();
+	flushed.clear();
+	for (int i = 0; i < 20; i++)
+	{
+		snprintf(line, sizeof(line), "10:00:00,%03d ERROR [OrderManager] order o%d failed", i * 10, i);
+		lines.push_back(line);
+	}
+	runStorm(lines, passed, flushed, "10:00:05,000 INFO [Scheduler] job ran");
+	check("storm: the count goes out once the storm is over", flushed.empty() && passed.size() == 5 + 2
+		&& passed[5] == "... repeated 15 times in 0.1s: ERROR [OrderManager] order o# failed" && passed[6] == "10:00:05,000 INFO [Scheduler] job ran", NULL);
+}
+
+// an exception and its trace, the frames of a thread dump, with a monitor line in the middle
+const char* const TRACE_LINES[] = {
+	"java.lang.IllegalStateException: boom",
+	"\tat atg.commerce.order.OrderManager.loadOrder(OrderManager.java:1280)",
+	"\t- locked <0x00000000c0a1b2c3> (a java.lang.Object)",
+	"\tat atg.service.pipeline.PipelineManager.runProcess(PipelineManager.java:90)"
+};
+const char* const THREAD_LINES[] = {
+	"\"http-8080-1\" daemon prio=10 tid=0x01 nid=0x02 runnable [0x03]",
+	"   java.lang.Thread.State: RUNNABLE",
+	"\tat java.net.SocketInputStream.socketRead0(Native Method)",
+	"\t- locked <0x00000000c0a1b2c3> (a java.io.BufferedInputStream)",
+	"\tat java.io.BufferedInputStream.fill(BufferedInputStream.java:218)",
+	""
+};
+
+static void addLines(vector<string>& lines, const char* const* added, size_t count)
+{
+	lines.insert(lines.end(), added, added + count);
+}
+
+// what the trace folder lets through of lines, classified one after the other
+static void runFold(const vector<string>& lines, vector<string>& passed)
+{
+	atgc_folder* folder = atgc_folder_create(0);
+	atgc_stream* stream = atgc_stream_create();
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		int lineType = atgc_classify_line(stream, lines[i].data(), lines[i].size());
+		atgc_folder_add(folder, lines[i].data(), lines[i].size(), lineType, collectLine, &passed);
+	}
+	atgc_folder_flush(folder, collectLine, &passed);
+	atgc_stream_destroy(stream);
+	atgc_folder_destroy(folder);
+}
+
+static void checkFold()
+{
+	vector<string> lines;
+	vector<string> passed;
+
+	// the monitor line of the second trace locks another object, it's still the same trace
+	lines.push_back("2008-04-14 10:05:01,320 ERROR [OrderManager] load failed");
+	addLines(lines, TRACE_LINES, 4);
+	lines.push_back("2008-04-14 10:05:02,320 ERROR [OrderManager] load failed");
+	addLines(lines, TRACE_LINES, 4);
+	lines[8] = "\t- locked <0x00000000deadbeef> (a java.lang.Object)";
+	lines.push_back("2008-04-14 10:05:03,320 INFO [Scheduler] job ran");
+	runFold(lines, passed);
+	check("fold: a trace is let through whole the first time, tagged with its number", passed.size() == 8
+		&& passed[1] == "java.lang.IllegalStateException: boom  [stack trace #1]"
+		&& passed[3] == TRACE_LINES[2] && passed[4] == TRACE_LINES[3], NULL);
+	check("fold: the same trace again is folded into its exception line", passed.size() == 8
+		&& passed[5] == lines[5] && passed[6] == "java.lang.IllegalStateException: boom  [same stack trace as #1, seen 2 times, 3 lines folded]"
+		&& passed[7] == lines[10], NULL);
+
+	// the same stack in two threads of a dump, with no exception line in front
+	lines.clear();
+	passed.clear();
+	lines.push_back("Full thread dump Java HotSpot(TM) Server VM (1.5.0_22-b03 mixed mode):");
+	lines.push_back("");
+	addLines(lines, THREAD_LINES, 6);
+	addLines(lines, THREAD_LINES, 6);
+	runFold(lines, passed);
+	check("fold: the stacks of a thread dump go through untouched", passed == lines, NULL);
+}
+
+// what a filter for the types in typeMask and literal lets through of lines
+static void runFilter(unsigned int typeMask, const char* literal, const vector<string>& lines, vector<string>& passed)
+{
+	atgc_filter* filter = atgc_filter_create(typeMask, &literal, (literal != NULL ? 1 : 0));
+	atgc_stream* stream = atgc_stream_create();
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		int lineType = atgc_classify_line(stream, lines[i].data(), lines[i].size());
+		atgc_filter_add(filter, lines[i].data(), lines[i].size(), lineType, collectLine, &passed);
+	}
+	atgc_stream_destroy(stream);
+	atgc_filter_destroy(filter);
+}
+
+/*
+	a literal put at every position of lines of every length up to 40 bytes, on both sides of the
+	16 byte blocks the prefilter compares at once, has to be found where it was put and nowhere else
+*/
+static bool findsEverywhere(const char* literal, const char* other, string& detail)
+{
+	atgc_filter* filter = atgc_filter_create(~0u, &literal, 1);
+	size_t literalLength = strlen(literal);
+	bool found = true;
+	for (size_t length = literalLength; length <= 40 && found; length++)
+	{
+		for (size_t at = 0; at + literalLength <= length && found; at++)
+		{
+			string line(length, '.');
+			line.replace(at, literalLength, literal);
+			if (at >= literalLength)
+			{
+				// a literal that only shares its first bytes, in front of it
+				line.replace(0, strlen(other), other);
+			}
+			size_t offsets[4];
+			size_t lengths[4];
+			size_t count = atgc_filter_find(filter, line.data(), line.size(), offsets, lengths, 4);
+			found = (count == 1 && offsets[0] == at && lengths[0] == literalLength);
+			if (!found)
+			{
+				detail = "'" + string(literal) + "' in '" + line + "'";
+			}
+		}
+	}
+	atgc_filter_destroy(filter);
+	return found;
+}
+
+static void checkFilter()
+{
+	vector<string> lines;
+	vector<string> passed;
+
+	lines.push_back("2008-04-14 10:05:01,320 ERROR [OrderManager] load failed");
+	addLines(lines, TRACE_LINES, 4);
+	lines.push_back("2008-04-14 10:05:02,320 INFO [Scheduler] job ran");
+	runFilter(~0u, "OrderManager]", lines, passed);
+	check("filter: the trace after a line that got through goes through with it", passed.size() == 5
+		&& passed[0] == lines[0] && passed[4] == lines[4], NULL);
+
+	passed.clear();
+	runFilter(~0u, "PipelineManager.runProcess", lines, passed);
+	check("filter: a trace one of whose frames got through goes through from its exception line", passed.size() == 4
+		&& passed[0] == lines[1] && passed[3] == lines[4], NULL);
+
+	// without the monitor line, which is an other line itself
+	passed.clear();
+	lines.erase(lines.begin() + 3);
+	runFilter(ATGC_TYPE_BIT(ATGC_OTHER_LINE), NULL, lines, passed);
+	check("filter: a line of another type and its trace are left out", passed.size() == 1 && passed[0] == lines[4], NULL);
+
+	// the monitor line is a line of the stack, it doesn't start a block of its own
+	lines.clear();
+	passed.clear();
+	addLines(lines, THREAD_LINES, 6);
+	runFilter(~0u, "socketRead0", lines, passed);
+	check("filter: the monitor line of a stack goes through with the frame that got through", passed.size() == 4
+		&& passed[2] == THREAD_LINES[3] && passed[3] == THREAD_LINES[4], NULL);
+	passed.clear();
+	runFilter(~0u, "(a java.io.BufferedInputStream)", lines, passed);
+	check("filter: a stack whose monitor line got through goes through", passed.size() == 4 && passed[2] == THREAD_LINES[3], NULL);
+
+	string detail;
+	check("filter: a two byte literal is found anywhere in a line", findsEverywhere("ab", "aX", detail), detail.c_str());
+	check("filter: a one byte literal is found anywhere in a line", findsEverywhere("Z", "", detail), detail.c_str());
+	check("filter: a long literal is found anywhere in a line", findsEverywhere("OrderManager", "OrderMan.", detail), detail.c_str());
+}
+
+int main()
+{
+	checkRules();
+	checkCache();
+	checkThemes();
+	checkStorm();
+	checkFold();
+	checkFilter();
+	printf("%d failed\n", failures);
+	return failures;
+}